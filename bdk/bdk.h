@@ -23,6 +23,7 @@
 #include <input/als.h>
 #include <input/joycon.h>
 #include <input/touch.h>
+#include <mem/arena.h>
 #include <mem/emc.h>
 #include <mem/heap.h>
 #include <mem/mc.h>
@@ -43,6 +44,7 @@
 #include <soc/actmon.h>
 #include <soc/bpmp.h>
 #include <soc/ccplex.h>
+#include <soc/ccplex_job.h>
 #include <soc/clock.h>
 #include <soc/fuse.h>
 #include <soc/gpio.h>
@@ -70,6 +72,7 @@
 #include <utils/ini.h>
 #include <utils/list.h>
 #include <utils/sprintf.h>
+#include <utils/trace.h>
 #include <utils/types.h>
 #include <utils/util.h>
 
@@ -24,6 +24,7 @@
 #include <power/max7762x.h>
 #include <storage/sd.h>
 #include <utils/types.h>
+#include <utils/util.h>
 
 #include <gfx_utils.h>
 
@@ -69,17 +70,22 @@ static bool _ianos_read_cb(el_ctx *ctx, void *dest, size_t numberBytes, size_t o
 }
 
 //TODO: Support shared libraries.
-uintptr_t ianos_loader(char *path, elfType_t type, void *moduleConfig)
+uintptr_t ianos_loader(char *path, elfType_t type, void *moduleConfig, u32 *file_crc32)
 {
 	el_ctx ctx;
 	uintptr_t epaddr = 0;
+	u32 file_size;
 
 	// Read library.
-	fileBuf = sd_file_read(path, NULL);
+	fileBuf = sd_file_read(path, &file_size);
 
 	if (!fileBuf)
 		goto out;
 
+	// Identify the library file if requested.
+	if (file_crc32)
+		*file_crc32 = crc32_calc(0, fileBuf, file_size);
+
 	ctx.pread = _ianos_read_cb;
 
 	if (el_init(&ctx))
@@ -33,20 +33,28 @@ const blz_footer *blz_get_footer(const unsigned char *compData, unsigned int com
 }
 
 // From https://github.com/SciresM/hactool/blob/master/kip.c which is exactly how kernel does it, thanks SciresM!
-int blz_uncompress_inplace(unsigned char *dataBuf, unsigned int compSize, const blz_footer *footer)
+static int _blz_uncompress(unsigned char *dataBuf, unsigned int compSize, const blz_footer *footer, bool safe)
 {
 	u32 addl_size = footer->addl_size;
 	u32 header_size = footer->header_size;
 	u32 cmp_and_hdr_size = footer->cmp_and_hdr_size;
 
+	// Safe mode also validates the footer and that every copy stays inside the buffer.
+	if (safe && (cmp_and_hdr_size > compSize || header_size > cmp_and_hdr_size))
+		return 0;
+
 	unsigned char* cmp_start = &dataBuf[compSize] - cmp_and_hdr_size;
 	u32 cmp_ofs = cmp_and_hdr_size - header_size;
-	u32 out_ofs = cmp_and_hdr_size + addl_size;
+	u32 out_size = cmp_and_hdr_size + addl_size;
+	u32 out_ofs = out_size;
 
 	while (out_ofs)
 	{
-		unsigned char control = cmp_start[--cmp_ofs];
-		for (unsigned int i=0; i<8; i++)
+		if (cmp_ofs < 1)
+			return 0; // Out of bounds.
+
+		u32 control = cmp_start[--cmp_ofs];
+		for (u32 i = 0; i < 8 && out_ofs; i++, control <<= 1)
 		{
 			if (control & 0x80)
 			{
@@ -62,37 +70,80 @@ int blz_uncompress_inplace(unsigned char *dataBuf, unsigned int compSize, const
 
 				out_ofs -= seg_size;
 
-				for (unsigned int j = 0; j < seg_size; j++)
-					cmp_start[out_ofs + j] = cmp_start[out_ofs + j + seg_ofs];
+				if (safe && (out_ofs + seg_ofs + seg_size > out_size || out_ofs < cmp_ofs))
+					return 0; // Out of bounds.
+
+				unsigned char *dst = &cmp_start[out_ofs];
+				if (seg_ofs >= seg_size) // Non overlapping, copy in bulk.
+					memcpy(dst, dst + seg_ofs, seg_size);
+				else
+				{
+					for (u32 j = 0; j < seg_size; j++)
+						dst[j] = dst[j + seg_ofs];
+				}
 			}
 			else
 			{
-				// Copy directly.
-				if (cmp_ofs < 1)
-					return 0; //out of bounds
+				// Gather the whole run of literals and copy it at once.
+				u32 run = 1;
+				while ((i + run) < 8 && !((control << run) & 0x80))
+					run++;
+				if (run > out_ofs)
+					run = out_ofs;
+
+				if (cmp_ofs < run)
+					return 0; // Out of bounds.
 
-				cmp_start[--out_ofs] = cmp_start[--cmp_ofs];
-			}
-			control <<= 1;
-			if (out_ofs == 0) // Blz works backwards, so if it reaches byte 0, it's done.
-				return 1;
+				i += run - 1;
+				control <<= run - 1;
+				out_ofs -= run;
+				cmp_ofs -= run;
+
+				if (safe && out_ofs < cmp_ofs)
+					return 0; // Output overwrites unread input.
+
+				if (out_ofs >= cmp_ofs + run)
+					memcpy(&cmp_start[out_ofs], &cmp_start[cmp_ofs], run);
+				else
+				{
+					for (u32 j = run; j > 0; j--)
+						cmp_start[out_ofs + j - 1] = cmp_start[cmp_ofs + j - 1];
+				}
 			}
 		}
+	}
 
 	return 1;
 }
 
-int blz_uncompress_srcdest(const unsigned char *compData, unsigned int compDataLen, unsigned char *dstData, unsigned int dstSize)
+int blz_uncompress_inplace(unsigned char *dataBuf, unsigned int compSize, const blz_footer *footer)
 {
-	blz_footer footer;
-	const blz_footer *compFooterPtr = blz_get_footer(compData, compDataLen, &footer);
+	return _blz_uncompress(dataBuf, compSize, footer, false);
+}
+
+int blz_srcdest_prepare(const unsigned char *compData, unsigned int compDataLen, unsigned char *dstData, unsigned int dstSize, blz_footer *footer)
+{
+	const blz_footer *compFooterPtr = blz_get_footer(compData, compDataLen, footer);
 	if (compFooterPtr == NULL)
 		return 0;
 
+	// Decompressed data must fit in destination.
+	if (compDataLen + footer->addl_size > dstSize)
+		return 0;
+
 	// Decompression must be done in-place, so need to copy the relevant compressed data first.
 	unsigned int numCompBytes = (const unsigned char*)(compFooterPtr)-compData;
 	memcpy(dstData, compData, numCompBytes);
 	memset(&dstData[numCompBytes], 0, dstSize - numCompBytes);
 
-	return blz_uncompress_inplace(dstData, compDataLen, &footer);
+	return 1;
+}
+
+int blz_uncompress_srcdest(const unsigned char *compData, unsigned int compDataLen, unsigned char *dstData, unsigned int dstSize)
+{
+	blz_footer footer;
+	if (!blz_srcdest_prepare(compData, compDataLen, dstData, dstSize, &footer))
+		return 0;
+
+	return _blz_uncompress(dstData, compDataLen, &footer, true);
 }
@@ -421,6 +421,25 @@ void lv_obj_clean(lv_obj_t * obj)
  * @param obj pointer to an object
  */
 void lv_obj_invalidate(const lv_obj_t * obj)
+{
+    /*Start with the original coordinates*/
+    lv_coord_t ext_size = obj->ext_size;
+    lv_area_t area;
+    lv_area_copy(&area, &obj->coords);
+    area.x1 -= ext_size;
+    area.y1 -= ext_size;
+    area.x2 += ext_size;
+    area.y2 += ext_size;
+
+    lv_obj_invalidate_area(obj, &area);
+}
+
+/**
+ * Mark a part of an object as invalid, therefore only that part will be redrawn by 'lv_refr_task'
+ * @param obj pointer to an object
+ * @param area the area to redraw, in absolute coordinates
+ */
+void lv_obj_invalidate_area(const lv_obj_t * obj, const lv_area_t * area)
 {
     if(lv_obj_get_hidden(obj)) return;
 
@@ -433,13 +452,7 @@ void lv_obj_invalidate(const lv_obj_t * obj)
         lv_area_t area_trunc;
         lv_obj_t * par = lv_obj_get_parent(obj);
         bool union_ok = true;
-        /*Start with the original coordinates*/
-        lv_coord_t ext_size = obj->ext_size;
-        lv_area_copy(&area_trunc, &obj->coords);
-        area_trunc.x1 -= ext_size;
-        area_trunc.y1 -= ext_size;
-        area_trunc.x2 += ext_size;
-        area_trunc.y2 += ext_size;
+        lv_area_copy(&area_trunc, area);
 
         /*Check through all parents*/
         while(par != NULL) {
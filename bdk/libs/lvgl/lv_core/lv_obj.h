@@ -268,6 +268,13 @@ void lv_obj_clean(lv_obj_t *obj);
  */
 void lv_obj_invalidate(const lv_obj_t * obj);
 
+/**
+ * Mark a part of an object as invalid, therefore only that part will be redrawn by 'lv_refr_task'
+ * @param obj pointer to an object
+ * @param area the area to redraw, in absolute coordinates
+ */
+void lv_obj_invalidate_area(const lv_obj_t * obj, const lv_area_t * area);
+
 /*=====================
  * Setter functions
  *====================*/
@@ -472,6 +472,27 @@ void lv_vmap(const lv_area_t * cords_p, const lv_area_t * mask_p,
         }
     }
 
+#if LV_COLOR_DEPTH == 32 && LV_COLOR_SCREEN_TRANSP == 0
+    /*Images with only an alpha byte (e.g. icons). Keep the per pixel checks out of the loop*/
+    else if(alpha_byte && chroma_key == false && recolor_opa == LV_OPA_TRANSP && disp->driver.vdb_wr == NULL) {
+        lv_coord_t col;
+        for(row = masked_a.y1; row <= masked_a.y2; row++) {
+            const lv_color_t * map_px = (const lv_color_t *)map_p;
+            for(col = 0; col < map_useful_w; col++) {
+                lv_color_t px_color = map_px[col];
+                if(px_color.alpha == LV_OPA_TRANSP) continue;
+
+                lv_opa_t opa_result = px_color.alpha == LV_OPA_COVER ? opa : (uint32_t)((uint32_t)px_color.alpha * opa) >> 8;
+                if(opa_result == LV_OPA_COVER) vdb_buf_tmp[col] = px_color;
+                else vdb_buf_tmp[col] = lv_color_mix(px_color, vdb_buf_tmp[col], opa_result);
+            }
+
+            map_p += map_width * px_size_byte;  /*Next row on the map*/
+            vdb_buf_tmp += vdb_width;           /*Next row on the VDB*/
+        }
+    }
+#endif
+
     /*In the other cases every pixel need to be checked one-by-one*/
     else {
         lv_color_t chroma_key_color = LV_COLOR_TRANSP;
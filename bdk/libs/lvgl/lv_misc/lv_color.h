@@ -359,7 +359,7 @@ static inline lv_color_t lv_color_mix(const lv_color_t c1, const lv_color_t c2,
 #else
 #   if LV_COLOR_DEPTH == 32
     uint32_t rb = (((c1.full & 0x00FF00FF) * mix) + ((c2.full & 0x00FF00FF) * (255 - mix))) >> 8;
-    uint32_t g = (((((c1.full & 0x0000FF00) >> 8) * mix) + (((c2.full & 0x0000FF00) >> 8) * (255 - mix))) >> 8) << 8;
+    uint32_t g = (((c1.full & 0x0000FF00) * mix) + ((c2.full & 0x0000FF00) * (255 - mix))) >> 8;
     ret.full = 0xFF000000 | (0x00FF00FF & rb) | (0x0000FF00 & g);
 #   else
     /*LV_COLOR_DEPTH == 1*/
@@ -37,6 +37,7 @@
  *      DEFINES
  *********************/
 #define LV_MEM_ADD_JUNK     0   /*Add memory junk on alloc (0xaa) and free(0xbb) (just for testing purposes)*/
+#define LV_MEM_BINS         24  /*Free list bins. Bin n holds entries of [2^n, 2^(n+1)) headers size*/
 
 
 #ifdef LV_MEM_ENV64
@@ -57,6 +58,9 @@ typedef union {
     struct {
         MEM_UNIT used: 1;       //1: if the entry is used
         MEM_UNIT d_size: 31;    //Size of the data
+        MEM_UNIT prev_size;     //Size of the data of the previous entry
+        struct _lv_mem_ent_t * next_free; //Free list links. Only valid if the entry is free
+        struct _lv_mem_ent_t * prev_free;
     };
     MEM_UNIT header;            //The header (used + d_size)
     MEM_UNIT align[8];          //Align header size to MEM_UNIT * 8 bytes
@@ -64,7 +68,7 @@ typedef union {
 
 static_assert(sizeof(lv_mem_header_t) == 32, "Node header must be 32 bytes!");
 
-typedef struct {
+typedef struct _lv_mem_ent_t {
     lv_mem_header_t header;
     uint8_t first_data;        /*First data byte in the allocated data (Just for easily create a pointer)*/
 } lv_mem_ent_t;
@@ -76,8 +80,13 @@ typedef struct {
  **********************/
 #if LV_MEM_CUSTOM == 0
 static lv_mem_ent_t  * ent_get_next(lv_mem_ent_t * act_e);
+static lv_mem_ent_t  * ent_get_prev(lv_mem_ent_t * act_e);
+static lv_mem_ent_t  * ent_find(uint32_t size);
 static void * ent_alloc(lv_mem_ent_t * e, uint32_t size);
 static void ent_trunc(lv_mem_ent_t * e, uint32_t size);
+static void ent_release(lv_mem_ent_t * e);
+static void ent_link(lv_mem_ent_t * e);
+static void ent_unlink(lv_mem_ent_t * e);
 #endif
 
 /**********************
@@ -85,6 +94,15 @@ static void ent_trunc(lv_mem_ent_t * e, uint32_t size);
  **********************/
 #if LV_MEM_CUSTOM == 0
 static uint8_t * work_mem;
+
+static lv_mem_ent_t * free_bins[LV_MEM_BINS];
+static uint32_t free_bins_map;  /*Bit n is set if 'free_bins[n]' is not empty*/
+
+static uint32_t mem_free_cnt;
+static uint32_t mem_free_size;
+static uint32_t mem_used_cnt;
+static uint32_t mem_used_size;
+static uint32_t mem_peak_size;  /*High-water mark of 'mem_used_size'*/
 #endif
 
 static uint32_t zero_mem;       /*Give the address of this variable if 0 byte should be allocated*/
@@ -112,10 +130,20 @@ void lv_mem_init(void)
     work_mem = (uint8_t *) LV_MEM_ADR;
 #endif
 
+    memset(free_bins, 0, sizeof(free_bins));
+    free_bins_map = 0;
+    mem_free_cnt = 0;
+    mem_free_size = 0;
+    mem_used_cnt = 0;
+    mem_used_size = 0;
+    mem_peak_size = 0;
+
     lv_mem_ent_t * full = (lv_mem_ent_t *)work_mem;
     full->header.used = 0;
     /*The total mem size id reduced by the first header and the close patterns */
     full->header.d_size = LV_MEM_SIZE - sizeof(lv_mem_header_t);
+    full->header.prev_size = 0;
+    ent_link(full);
 #endif
 }
 
@@ -139,20 +167,11 @@ void * lv_mem_alloc(uint32_t size)
     void * alloc = NULL;
 
 #if LV_MEM_CUSTOM == 0 /*Use the allocation from dyn_mem*/
-    lv_mem_ent_t * e = NULL;
-
-    //Search for a appropriate entry
-    do {
-        //Get the next entry
-        e = ent_get_next(e);
-
-        /*If there is next entry then try to allocate there*/
-        if(e != NULL) {
-            alloc = ent_alloc(e, size);
-        }
-        //End if there is not next entry OR the alloc. is successful
-    } while(e != NULL && alloc == NULL);
-
+    /*Get a free entry from the free lists*/
+    lv_mem_ent_t * e = ent_find(size);
+    if(e != NULL) {
+        alloc = ent_alloc(e, size);
+    }
 
 #else  /*Use custom, user defined malloc function*/
 #if LV_ENABLE_GC == 1 /*gc must not include header*/
@@ -194,24 +213,18 @@ void lv_mem_free(const void * data)
 #if LV_ENABLE_GC==0
     /*e points to the header*/
     lv_mem_ent_t * e = (lv_mem_ent_t *)((uint8_t *) data - sizeof(lv_mem_header_t));
+#if LV_MEM_CUSTOM == 0
+    if(e->header.used == 0) return; /*Already freed*/
+
+    mem_used_cnt--;
+    mem_used_size -= e->header.d_size;
+#endif
     e->header.used = 0;
 #endif
 
 #if LV_MEM_CUSTOM == 0
-#if LV_MEM_AUTO_DEFRAG
-    /* Make a simple defrag.
-     * Join the following free entries after this*/
-    lv_mem_ent_t * e_next;
-    e_next = ent_get_next(e);
-    while(e_next != NULL) {
-        if(e_next->header.used == 0) {
-            e->header.d_size += e_next->header.d_size + sizeof(e->header);
-        } else {
-            break;
-        }
-        e_next = ent_get_next(e_next);
-    }
-#endif
+    /*Join the free neighbours and put the entry back to the free lists*/
+    ent_release(e);
 #else /*Use custom, user defined free function*/
 #if LV_ENABLE_GC==0
     LV_MEM_CUSTOM_FREE(e);
@@ -252,10 +265,12 @@ void * lv_mem_realloc(void * data_p, uint32_t new_size)
 
 #if LV_MEM_CUSTOM == 0
     /* Only truncate the memory is possible
-     * If the 'old_size' was extended by a header size in 'ent_trunc' it avoids reallocating this same memory */
-    if(new_size < old_size) {
+     * If the 'old_size' was extended by a header size in 'ent_trunc' it avoids reallocating this same memory
+     * Zero size is not truncated, so no entry is left without data */
+    if(new_size && new_size < old_size) {
         lv_mem_ent_t * e = (lv_mem_ent_t *)((uint8_t *) data_p - sizeof(lv_mem_header_t));
         ent_trunc(e, new_size);
+        mem_used_size -= old_size - e->header.d_size;
         return &e->first_data;
     }
 #endif
@@ -293,41 +308,7 @@ void * lv_mem_realloc(void * data_p, uint32_t new_size)
  */
 void lv_mem_defrag(void)
 {
-#if LV_MEM_CUSTOM == 0
-    lv_mem_ent_t * e_free;
-    lv_mem_ent_t * e_next;
-    e_free = ent_get_next(NULL);
-
-    while(1) {
-        /*Search the next free entry*/
-        while(e_free != NULL) {
-            if(e_free->header.used != 0) {
-                e_free = ent_get_next(e_free);
-            } else {
-                break;
-            }
-        }
-
-        if(e_free == NULL) return;
-
-        /*Joint the following free entries to the free*/
-        e_next = ent_get_next(e_free);
-        while(e_next != NULL) {
-            if(e_next->header.used == 0) {
-                e_free->header.d_size += e_next->header.d_size + sizeof(e_next->header);
-            } else {
-                break;
-            }
-
-            e_next = ent_get_next(e_next);
-        }
-
-        if(e_next == NULL) return;
-
-        /*Continue from the lastly checked entry*/
-        e_free = e_next;
-    }
-#endif
+    /*Free entries are always joined with their free neighbours on free*/
 }
 
 /**
@@ -340,28 +321,29 @@ void lv_mem_monitor(lv_mem_monitor_t * mon_p)
     /*Init the data*/
     memset(mon_p, 0, sizeof(lv_mem_monitor_t));
 #if LV_MEM_CUSTOM == 0
-    lv_mem_ent_t * e;
-    e = NULL;
-
-    e = ent_get_next(e);
-
-    while(e != NULL)  {
-        if(e->header.used == 0) {
-            mon_p->free_cnt++;
-            mon_p->free_size += e->header.d_size;
+    mon_p->free_cnt = mem_free_cnt;
+    mon_p->free_size = mem_free_size;
+    mon_p->used_cnt = mem_used_cnt;
+    mon_p->used_size = mem_used_size;
+    mon_p->peak_size = mem_peak_size;
+
+    /*The biggest free entry is in the highest non-empty bin*/
+    if(free_bins_map) {
+        lv_mem_ent_t * e = free_bins[31 - __builtin_clz(free_bins_map)];
+        for(; e != NULL; e = e->header.next_free) {
             if(e->header.d_size > mon_p->free_biggest_size) {
                 mon_p->free_biggest_size = e->header.d_size;
             }
-        } else {
-            mon_p->used_cnt++;
         }
-
-        e = ent_get_next(e);
     }
+
     mon_p->total_size = LV_MEM_SIZE;
     mon_p->used_pct = 100 - ((uint64_t)100U * mon_p->free_size) / mon_p->total_size;
-    mon_p->frag_pct = (uint32_t)mon_p->free_biggest_size * 100U / mon_p->free_size;
-    mon_p->frag_pct = 100 - mon_p->frag_pct;
+    mon_p->peak_pct = ((uint64_t)100U * mon_p->peak_size) / mon_p->total_size;
+    if(mon_p->free_size) {
+        mon_p->frag_pct = (uint64_t)mon_p->free_biggest_size * 100U / mon_p->free_size;
+        mon_p->frag_pct = 100 - mon_p->frag_pct;
+    }
 #endif
 }
 
@@ -418,29 +400,73 @@ static lv_mem_ent_t * ent_get_next(lv_mem_ent_t * act_e)
     return next_e;
 }
 
+/**
+ * Give the previous entry before 'act_e'
+ * @param act_e pointer to an entry
+ * @return pointer to an entry before 'act_e' or NULL if 'act_e' is the first
+ */
+static lv_mem_ent_t * ent_get_prev(lv_mem_ent_t * act_e)
+{
+    if((uint8_t *)act_e == work_mem) return NULL;
+
+    return (lv_mem_ent_t *)((uint8_t *)act_e - act_e->header.prev_size - sizeof(lv_mem_header_t));
+}
+
+/**
+ * Get the bin of the free lists for a data size
+ * @param size data size in bytes. Must be at least the header size.
+ * @return index of the bin
+ */
+static inline uint32_t ent_bin(uint32_t size)
+{
+    uint32_t bin = 31 - __builtin_clz(size / sizeof(lv_mem_header_t));
+
+    return LV_MATH_MIN(bin, LV_MEM_BINS - 1);
+}
+
+/**
+ * Find a free entry for the given size
+ * @param size size of the new memory in bytes
+ * @return pointer to a free entry that fits or NULL if there is not enough memory
+ */
+static lv_mem_ent_t * ent_find(uint32_t size)
+{
+    uint32_t bin = ent_bin(size);
+
+    /*First fit in the bin of the size. Its entries are less than twice the size*/
+    lv_mem_ent_t * e = free_bins[bin];
+    for(; e != NULL; e = e->header.next_free) {
+        if(e->header.d_size >= size) return e;
+    }
+
+    /*Any entry in a higher bin fits, so take the smallest one*/
+    uint32_t map = free_bins_map & ~((2U << bin) - 1);
+    if(!map) return NULL;
+
+    return free_bins[__builtin_ctz(map)];
+}
 
 /**
- * Try to do the real allocation with a given size
- * @param e try to allocate to this entry
+ * Do the real allocation with a given size
+ * @param e a free entry from 'ent_find'
  * @param size size of the new memory in bytes
- * @return pointer to the allocated memory or NULL if not enough memory in the entry
+ * @return pointer to the allocated memory
  */
 static void * ent_alloc(lv_mem_ent_t * e, uint32_t size)
 {
-    void * alloc = NULL;
+    ent_unlink(e);
 
-    /*If the memory is free and big enough then use it */
-    if(e->header.used == 0 && e->header.d_size >= size) {
-        /*Truncate the entry to the desired size */
-        ent_trunc(e, size),
+    /*Mark it used first, so the truncated part will not be joined back*/
+    e->header.used = 1;
 
-                  e->header.used = 1;
+    /*Truncate the entry to the desired size */
+    ent_trunc(e, size);
 
-        /*Save the allocated data*/
-        alloc = &e->first_data;
-    }
+    mem_used_cnt++;
+    mem_used_size += e->header.d_size;
+    if(mem_used_size > mem_peak_size) mem_peak_size = mem_used_size;
 
-    return alloc;
+    return &e->first_data;
 }
 
 /**
@@ -461,10 +487,75 @@ static void ent_trunc(lv_mem_ent_t * e, uint32_t size)
         lv_mem_ent_t * after_new_e = (lv_mem_ent_t *)&e_data[size];
         after_new_e->header.used = 0;
         after_new_e->header.d_size = e->header.d_size - size - sizeof(lv_mem_header_t);
+        after_new_e->header.prev_size = size;
+
+        /* Set the new size for the original entry */
+        e->header.d_size = size;
+
+        ent_release(after_new_e);
     }
+}
+
+/**
+ * Join a free entry with its free neighbours and add it to the free lists
+ * @param e pointer to a free entry which is not in the free lists
+ */
+static void ent_release(lv_mem_ent_t * e)
+{
+    lv_mem_ent_t * e_next = ent_get_next(e);
+    if(e_next != NULL && e_next->header.used == 0) {
+        ent_unlink(e_next);
+        e->header.d_size += e_next->header.d_size + sizeof(lv_mem_header_t);
+    }
+
+    lv_mem_ent_t * e_prev = ent_get_prev(e);
+    if(e_prev != NULL && e_prev->header.used == 0) {
+        ent_unlink(e_prev);
+        e_prev->header.d_size += e->header.d_size + sizeof(lv_mem_header_t);
+        e = e_prev;
+    }
+
+    /*Update the back link of the following entry*/
+    e_next = ent_get_next(e);
+    if(e_next != NULL) e_next->header.prev_size = e->header.d_size;
+
+    ent_link(e);
+}
+
+/**
+ * Add a free entry to the head of its bin
+ * @param e pointer to a free entry
+ */
+static void ent_link(lv_mem_ent_t * e)
+{
+    uint32_t bin = ent_bin(e->header.d_size);
+
+    e->header.prev_free = NULL;
+    e->header.next_free = free_bins[bin];
+    if(free_bins[bin] != NULL) free_bins[bin]->header.prev_free = e;
+    free_bins[bin] = e;
+    free_bins_map |= 1U << bin;
+
+    mem_free_cnt++;
+    mem_free_size += e->header.d_size;
+}
+
+/**
+ * Remove a free entry from its bin
+ * @param e pointer to a free entry
+ */
+static void ent_unlink(lv_mem_ent_t * e)
+{
+    uint32_t bin = ent_bin(e->header.d_size);
+
+    if(e->header.prev_free != NULL) e->header.prev_free->header.next_free = e->header.next_free;
+    else free_bins[bin] = e->header.next_free;
+    if(e->header.next_free != NULL) e->header.next_free->header.prev_free = e->header.prev_free;
+
+    if(free_bins[bin] == NULL) free_bins_map &= ~(1U << bin);
 
-    /* Set the new size for the original entry */
-    e->header.d_size = size;
+    mem_free_cnt--;
+    mem_free_size -= e->header.d_size;
 }
 
 #endif
@@ -50,7 +50,10 @@ typedef struct
     uint32_t free_size;
     uint32_t free_biggest_size;
     uint32_t used_cnt;
+    uint32_t used_size;
+    uint32_t peak_size;
     uint8_t used_pct;
+    uint8_t peak_pct;
     uint8_t frag_pct;
 } lv_mem_monitor_t;
 
@@ -88,6 +91,7 @@ void * lv_mem_realloc(void * data_p, uint32_t new_size);
 
 /**
  * Join the adjacent free memory blocks
+ * No-op with the built-in allocator, since lv_mem_free already joins free neighbours.
  */
 void lv_mem_defrag(void);
 
@@ -14,6 +14,7 @@
 #include "../lv_draw/lv_draw.h"
 #include "../lv_themes/lv_theme.h"
 #include "../lv_misc/lv_anim.h"
+#include "../lv_misc/lv_math.h"
 #include <stdio.h>
 
 /*********************
@@ -29,6 +30,7 @@
  **********************/
 static bool lv_bar_design(lv_obj_t * bar, const lv_area_t * mask, lv_design_mode_t mode);
 static lv_res_t lv_bar_signal(lv_obj_t * bar, lv_signal_t sign, void * param);
+static void lv_bar_inv_value(lv_obj_t * bar, int16_t old_value);
 
 /**********************
  *  STATIC VARIABLES
@@ -121,9 +123,10 @@ void lv_bar_set_value(lv_obj_t * bar, int16_t value)
     lv_bar_ext_t * ext = lv_obj_get_ext_attr(bar);
     if(ext->cur_value == value) return;
 
+    int16_t old_value = ext->cur_value;
     ext->cur_value = value > ext->max_value ? ext->max_value : value;
     ext->cur_value = ext->cur_value < ext->min_value ? ext->min_value : ext->cur_value;
-    lv_obj_invalidate(bar);
+    lv_bar_inv_value(bar, old_value);
 }
 
 #if USE_LV_ANIMATION
@@ -426,4 +429,59 @@ static lv_res_t lv_bar_signal(lv_obj_t * bar, lv_signal_t sign, void * param)
 }
 
 
+/**
+ * Invalidate only the part of the bar which changes when the value moves
+ * @param bar pointer to a bar object
+ * @param old_value the value before the change
+ */
+static void lv_bar_inv_value(lv_obj_t * bar, int16_t old_value)
+{
+    lv_bar_ext_t * ext = lv_obj_get_ext_attr(bar);
+    lv_style_t * style_indic = lv_bar_get_style(bar, LV_BAR_STYLE_INDIC);
+
+    /*Symmetric bars and derived objects (e.g. slider knobs) change more than the indicator end*/
+    if(ext->sym || ext->max_value == ext->min_value || lv_obj_get_design_func(bar) != lv_bar_design) {
+        lv_obj_invalidate(bar);
+        return;
+    }
+
+    lv_area_t area;
+    lv_area_copy(&area, &bar->coords);
+    area.x1 += style_indic->body.padding.hor;
+    area.x2 -= style_indic->body.padding.hor;
+    area.y1 += style_indic->body.padding.ver;
+    area.y2 -= style_indic->body.padding.ver;
+
+    lv_coord_t w = lv_area_get_width(&area);
+    lv_coord_t h = lv_area_get_height(&area);
+    int32_t range = ext->max_value - ext->min_value;
+
+    /*The gradient runs from top to bottom, so it is stretched over a vertical indicator*/
+    if(w < h && style_indic->body.main_color.full != style_indic->body.grad_color.full) {
+        lv_obj_invalidate(bar);
+        return;
+    }
+
+    /*The rounded end and the shadow of the indicator also move with the value*/
+    lv_coord_t margin = style_indic->body.radius * 2 + style_indic->body.shadow.width + 1;
+
+    if(w >= h) {
+        lv_coord_t old_x = area.x1 + (int32_t)w * (old_value - ext->min_value) / range;
+        lv_coord_t new_x = area.x1 + (int32_t)w * (ext->cur_value - ext->min_value) / range;
+        area.x1 = LV_MATH_MAX(LV_MATH_MIN(old_x, new_x) - margin, bar->coords.x1 - bar->ext_size);
+        area.x2 = LV_MATH_MIN(LV_MATH_MAX(old_x, new_x) + margin, bar->coords.x2 + bar->ext_size);
+        area.y1 = bar->coords.y1 - bar->ext_size;
+        area.y2 = bar->coords.y2 + bar->ext_size;
+    } else {
+        lv_coord_t old_y = area.y2 - (int32_t)h * (old_value - ext->min_value) / range;
+        lv_coord_t new_y = area.y2 - (int32_t)h * (ext->cur_value - ext->min_value) / range;
+        area.y1 = LV_MATH_MAX(LV_MATH_MIN(old_y, new_y) - margin, bar->coords.y1 - bar->ext_size);
+        area.y2 = LV_MATH_MIN(LV_MATH_MAX(old_y, new_y) + margin, bar->coords.y2 + bar->ext_size);
+        area.x1 = bar->coords.x1 - bar->ext_size;
+        area.x2 = bar->coords.x2 + bar->ext_size;
+    }
+
+    lv_obj_invalidate_area(bar, &area);
+}
+
 #endif
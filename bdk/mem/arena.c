@@ -0,0 +1,98 @@
+/*
+ * Bump pointer arena allocator.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "arena.h"
+#include "heap.h"
+
+void arena_init(arena_t *arena, u32 block_size)
+{
+	memset(arena, 0, sizeof(arena_t));
+	arena->block_size = block_size;
+}
+
+void *arena_alloc(arena_t *arena, u32 size)
+{
+	arena_block_t *block = arena->curr;
+
+	size = ALIGN(size, ARENA_ALIGN);
+
+	// Move to the next kept block or get a new one if it doesn't fit.
+	while (!block || (block->used + size) > block->size)
+	{
+		arena_block_t *next = block ? block->next : NULL;
+		if (!next)
+		{
+			u32 block_size = MAX(arena->block_size, size);
+
+			next = (arena_block_t *)malloc(sizeof(arena_block_t) + block_size);
+			next->next = NULL;
+			next->size = block_size;
+			next->used = 0;
+
+			if (block)
+				block->next = next;
+			else
+				arena->first = next;
+		}
+
+		block = next;
+		arena->curr = block;
+	}
+
+	void *ptr = (void *)block + sizeof(arena_block_t) + block->used;
+	block->used += size;
+
+	arena->used += size;
+	arena->peak = MAX(arena->peak, arena->used);
+	arena->allocs++;
+
+	return ptr;
+}
+
+void *arena_calloc(arena_t *arena, u32 num, u32 size)
+{
+	void *res = arena_alloc(arena, num * size);
+	memset(res, 0, num * size);
+
+	return res;
+}
+
+void arena_reset(arena_t *arena)
+{
+	// Keep blocks for reuse.
+	for (arena_block_t *block = arena->first; block; block = block->next)
+		block->used = 0;
+
+	arena->curr = arena->first;
+	arena->used = 0;
+	arena->allocs = 0;
+}
+
+void arena_free(arena_t *arena)
+{
+	arena_block_t *block = arena->first;
+
+	while (block)
+	{
+		arena_block_t *next = block->next;
+		free(block);
+		block = next;
+	}
+
+	memset(arena, 0, sizeof(arena_t));
+}
@@ -0,0 +1,48 @@
+/*
+ * Bump pointer arena allocator.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <utils/types.h>
+
+#define ARENA_ALIGN 32 // Arch cache line size.
+
+typedef struct _arena_block_t
+{
+	struct _arena_block_t *next;
+	u32 size;
+	u32 used;
+	u32 rsvd[(ARENA_ALIGN - sizeof(void *) - 2 * sizeof(u32)) / sizeof(u32)]; // Align data to arch cache line size.
+} arena_block_t;
+
+typedef struct _arena_t
+{
+	arena_block_t *first;
+	arena_block_t *curr;
+	u32 block_size;
+	u32 used;
+	u32 peak; // High-water mark.
+	u32 allocs;
+} arena_t;
+
+void  arena_init(arena_t *arena, u32 block_size);
+void *arena_alloc(arena_t *arena, u32 size);
+void *arena_calloc(arena_t *arena, u32 num, u32 size);
+void  arena_reset(arena_t *arena);
+void  arena_free(arena_t *arena);
+
+#endif
@@ -19,13 +19,24 @@
 #include "heap.h"
 #include <gfx_utils.h>
 
+#define HSLAB_CHUNK_HDR_SZ ALIGN(sizeof(hslab_chunk_t), sizeof(hnode_t))
+
 heap_t _heap;
 
+// Small allocation size classes. All are multiples of cache line size.
+static const u32 _slab_class_size[HEAP_SLAB_CLASSES] = {
+	32, 64, 96, 128, 192, 256, 384, 512
+};
+
+// Class index per 32-byte size unit.
+static const u8 _slab_class_idx[HEAP_SLAB_MAX_SZ / 32] = {
+	0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7
+};
+
 static void _heap_create(void *start)
 {
+	memset(&_heap, 0, sizeof(heap_t));
 	_heap.start = start;
-	_heap.first = NULL;
-	_heap.last = NULL;
 }
 
 // Node info is before node address.
@@ -135,6 +146,75 @@ static void _heap_free(void *addr)
 #endif
 }
 
+static bool _heap_slab_grow(u32 cls)
+{
+	hslab_chunk_t *chunk = _heap.chunks_num ? _heap.chunks[_heap.chunks_num - 1] : NULL;
+
+	// Get a new chunk if current one is full.
+	if (!chunk || chunk->pages_used == HEAP_SLAB_PAGES)
+	{
+		if (_heap.chunks_num == HEAP_SLAB_CHUNKS_MAX)
+			return false;
+
+		chunk = (hslab_chunk_t *)_heap_alloc(HSLAB_CHUNK_HDR_SZ + HEAP_SLAB_CHUNK_SZ);
+		memset(chunk, 0, sizeof(hslab_chunk_t));
+		chunk->pages = (void *)chunk + HSLAB_CHUNK_HDR_SZ;
+		_heap.chunks[_heap.chunks_num++] = chunk;
+	}
+
+	// Assign a page to the class and carve it into objects.
+	u32 page = chunk->pages_used++;
+	chunk->page_class[page] = cls + 1;
+
+	hslab_class_t *slab = &_heap.slab[cls];
+	u32 obj_size = _slab_class_size[cls];
+	void *page_addr = chunk->pages + page * HEAP_SLAB_PAGE_SZ;
+	for (u32 off = 0; (off + obj_size) <= HEAP_SLAB_PAGE_SZ; off += obj_size)
+	{
+		*(void **)(page_addr + off) = slab->free;
+		slab->free = page_addr + off;
+		slab->total++;
+	}
+
+	return true;
+}
+
+static void *_heap_slab_alloc(u32 size)
+{
+	u32 cls = _slab_class_idx[(size - 1) >> 5];
+	hslab_class_t *slab = &_heap.slab[cls];
+
+	if (!slab->free && !_heap_slab_grow(cls))
+		return NULL;
+
+	void *obj = slab->free;
+	slab->free = *(void **)obj;
+	slab->used++;
+
+	return obj;
+}
+
+static bool _heap_slab_free(void *addr)
+{
+	for (u32 i = 0; i < _heap.chunks_num; i++)
+	{
+		hslab_chunk_t *chunk = _heap.chunks[i];
+		if (addr < chunk->pages || addr >= (chunk->pages + HEAP_SLAB_CHUNK_SZ))
+			continue;
+
+		u32 cls = chunk->page_class[(addr - chunk->pages) / HEAP_SLAB_PAGE_SZ] - 1;
+		hslab_class_t *slab = &_heap.slab[cls];
+
+		*(void **)addr = slab->free;
+		slab->free = addr;
+		slab->used--;
+
+		return true;
+	}
+
+	return false;
+}
+
 void heap_init(void *base)
 {
 	_heap_create(base);
@@ -147,19 +227,27 @@ void heap_set(heap_t *heap)
 
 void *malloc(u32 size)
 {
+	// Serve small allocations from size class slabs.
+	if (size && size <= HEAP_SLAB_MAX_SZ)
+	{
+		void *res = _heap_slab_alloc(size);
+		if (res)
+			return res;
+	}
+
 	return _heap_alloc(size);
 }
 
 void *calloc(u32 num, u32 size)
 {
-	void *res = (void *)_heap_alloc(num * size);
+	void *res = malloc(num * size);
 	memset(res, 0, ALIGN(num * size, sizeof(hnode_t))); // Clear the aligned size.
 	return res;
 }
 
 void free(void *buf)
 {
-	if (buf >= _heap.start)
+	if (buf >= _heap.start && !_heap_slab_free(buf))
 		_heap_free(buf);
 }
 
@@ -192,4 +280,17 @@ void heap_monitor(heap_monitor_t *mon, bool print_node_stats)
 	}
 	mon->total += mon->used;
 	mon->nodes_total = count;
+
+	// Get slab stats.
+	mon->slab_chunks = _heap.chunks_num;
+	for (u32 i = 0; i < HEAP_SLAB_CLASSES; i++)
+	{
+		mon->slab[i].size  = _slab_class_size[i];
+		mon->slab[i].used  = _heap.slab[i].used;
+		mon->slab[i].total = _heap.slab[i].total;
+
+		if (print_node_stats)
+			gfx_printf("slab %3d - used: %d, total: %d\n",
+				mon->slab[i].size, mon->slab[i].used, mon->slab[i].total);
+	}
 }
@@ -20,28 +20,63 @@
 
 #include <utils/types.h>
 
+#define HEAP_SLAB_CLASSES    8
+#define HEAP_SLAB_MAX_SZ     512
+#ifndef HEAP_SLAB_CHUNKS_MAX
+#define HEAP_SLAB_CHUNKS_MAX 16 // 0 disables slabs.
+#endif
+#define HEAP_SLAB_CHUNK_SZ   SZ_1M
+#define HEAP_SLAB_PAGE_SZ    SZ_4K
+#define HEAP_SLAB_PAGES      (HEAP_SLAB_CHUNK_SZ / HEAP_SLAB_PAGE_SZ)
+
 typedef struct _hnode
 {
 	int used;
 	u32 size;
 	struct _hnode *prev;
 	struct _hnode *next;
-	u32 align[4]; // Align to arch cache line size.
+	u32 align[(32 - 2 * sizeof(u32) - 2 * sizeof(void *)) / sizeof(u32)]; // Align to arch cache line size.
 } hnode_t;
 
+typedef struct _hslab_chunk
+{
+	void *pages;
+	u32 pages_used;
+	u8  page_class[HEAP_SLAB_PAGES]; // Class index + 1. 0 if unassigned.
+} hslab_chunk_t;
+
+typedef struct _hslab_class
+{
+	void *free;
+	u32 used;
+	u32 total;
+} hslab_class_t;
+
 typedef struct _heap
 {
 	void *start;
 	hnode_t *first;
     hnode_t *last;
+	hslab_class_t slab[HEAP_SLAB_CLASSES];
+	hslab_chunk_t *chunks[HEAP_SLAB_CHUNKS_MAX];
+	u32 chunks_num;
 } heap_t;
 
+typedef struct
+{
+    u32 size;
+    u32 used;
+    u32 total;
+} heap_slab_monitor_t;
+
 typedef struct
 {
     u32 total;
     u32 used;
     u32 nodes_total;
     u32 nodes_used;
+    u32 slab_chunks;
+    heap_slab_monitor_t slab[HEAP_SLAB_CLASSES];
 } heap_monitor_t;
 
 void heap_init(void *base);
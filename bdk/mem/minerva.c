@@ -20,20 +20,142 @@
 #include "minerva.h"
 
 #include <ianos/ianos.h>
+#include <libs/fatfs/ff.h>
 #include <mem/emc.h>
+#include <mem/heap.h>
 #include <soc/clock.h>
 #include <soc/fuse.h>
 #include <soc/hw_init.h>
 #include <soc/t210.h>
+#include <thermal/tmp451.h>
 #include <utils/util.h>
 
+#define MTC_MODULE_PATH "bootloader/sys/libsys_minerva.bso"
+
+#define MTC_CACHE_MAGIC      0x4843544D // MTCH.
+#define MTC_CACHE_VERSION    2
+#define MTC_CACHE_ECID_WORDS 7 // Vendor, fab, lot 0/1, wafer, x, y.
+#define MTC_CACHE_TEMP_DELTA 20 // oC.
+
+typedef struct _mtc_cache_hdr_t
+{
+	u32 magic;
+	u32 version;
+	u32 sdram_id;
+	u32 soc_rev;
+	u32 ecid[MTC_CACHE_ECID_WORDS];
+	u32 module_hash;
+	u32 table_entries;
+	u32 table_size;
+	u32 temp;
+	u32 crc32;
+} mtc_cache_hdr_t;
+
 extern volatile nyx_storage_t *nyx_str;
 
 void (*minerva_cfg)(mtc_config_t *mtc_cfg, void *);
 
+static void _minerva_cache_hdr_init(mtc_cache_hdr_t *hdr, mtc_config_t *mtc_cfg, u32 module_hash)
+{
+	memset(hdr, 0, sizeof(mtc_cache_hdr_t));
+
+	hdr->magic         = MTC_CACHE_MAGIC;
+	hdr->version       = MTC_CACHE_VERSION;
+	hdr->sdram_id      = mtc_cfg->sdram_id;
+	hdr->soc_rev       = APB_MISC(APB_MISC_GP_HIDREV);
+	hdr->module_hash   = module_hash;
+	hdr->table_entries = mtc_cfg->table_entries;
+	hdr->table_size    = mtc_cfg->table_entries * sizeof(emc_table_t);
+
+	// The sensor is not set up yet in the bootloader and in Nyx before its GUI.
+	tmp451_init();
+	hdr->temp = tmp451_get_soc_temp(true);
+
+	// Unique chip ID. Tables are only valid for the SoC and DRAM they were trained on.
+	for (u32 i = 0; i < MTC_CACHE_ECID_WORDS; i++)
+		hdr->ecid[i] = FUSE(FUSE_OPT_VENDOR_CODE + i * sizeof(u32));
+}
+
+static bool _minerva_cache_load(mtc_config_t *mtc_cfg, const mtc_cache_hdr_t *curr)
+{
+	FIL fp;
+	mtc_cache_hdr_t hdr;
+	emc_table_t *table;
+	int temp_delta;
+	bool loaded = false;
+
+	if (!curr->module_hash)
+		return false;
+
+	if (f_open(&fp, MTC_CACHE_PATH, FA_READ) != FR_OK)
+		return false;
+
+	// Check that trained tables were made for this DRAM, SoC and Minerva.
+	if (f_read(&fp, &hdr, sizeof(mtc_cache_hdr_t), NULL) != FR_OK ||
+		hdr.magic         != curr->magic         ||
+		hdr.version       != curr->version       ||
+		hdr.sdram_id      != curr->sdram_id      ||
+		hdr.soc_rev       != curr->soc_rev       ||
+		memcmp(hdr.ecid, curr->ecid, sizeof(hdr.ecid)) ||
+		hdr.module_hash   != curr->module_hash   ||
+		hdr.table_entries != curr->table_entries ||
+		hdr.table_size    != curr->table_size)
+		goto out;
+
+	// Retrain if temperature drifted too much since training.
+	temp_delta = (int)hdr.temp - (int)curr->temp;
+	if (temp_delta > MTC_CACHE_TEMP_DELTA || temp_delta < -MTC_CACHE_TEMP_DELTA)
+		goto out;
+
+	table = malloc(hdr.table_size);
+	if (f_read(&fp, table, hdr.table_size, NULL) == FR_OK &&
+		crc32_calc(0, (u8 *)table, hdr.table_size) == hdr.crc32)
+	{
+		memcpy(mtc_cfg->mtc_table, table, hdr.table_size);
+		loaded = true;
+	}
+	free(table);
+
+out:
+	f_close(&fp);
+
+	return loaded;
+}
+
+static void _minerva_cache_save(mtc_config_t *mtc_cfg, mtc_cache_hdr_t *hdr)
+{
+	FIL fp;
+
+	if (!hdr->module_hash)
+		return;
+
+	hdr->crc32 = crc32_calc(0, (u8 *)mtc_cfg->mtc_table, hdr->table_size);
+
+	if (f_open(&fp, MTC_CACHE_PATH, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+		return;
+
+	if (f_write(&fp, hdr, sizeof(mtc_cache_hdr_t), NULL) != FR_OK ||
+		f_write(&fp, mtc_cfg->mtc_table, hdr->table_size, NULL) != FR_OK)
+	{
+		f_close(&fp);
+		f_unlink(MTC_CACHE_PATH);
+
+		return;
+	}
+
+	f_close(&fp);
+}
+
+void minerva_cache_invalidate()
+{
+	f_unlink(MTC_CACHE_PATH);
+}
+
 u32 minerva_init()
 {
 	u32 curr_ram_idx = 0;
+	u32 module_hash = 0;
+	mtc_cache_hdr_t cache_hdr;
 
 	minerva_cfg = NULL;
 	mtc_config_t *mtc_cfg = (mtc_config_t *)&nyx_str->mtc_cfg;
@@ -50,7 +172,7 @@ u32 minerva_init()
 	if (mtc_cfg->init_done == MTC_INIT_MAGIC)
 	{
 		mtc_cfg->train_mode = OP_PERIODIC_TRAIN; // Retrain if needed.
-		u32 ep_addr = ianos_loader("bootloader/sys/libsys_minerva.bso", DRAM_LIB, (void *)mtc_cfg);
+		u32 ep_addr = ianos_loader(MTC_MODULE_PATH, DRAM_LIB, (void *)mtc_cfg, NULL);
 		minerva_cfg = (void *)ep_addr;
 
 		return !minerva_cfg ? 1 : 0;
@@ -63,7 +185,7 @@ u32 minerva_init()
 		mtc_tmp.sdram_id  = fuse_read_dramid(false);
 		mtc_tmp.init_done = MTC_NEW_MAGIC;
 
-		u32 ep_addr = ianos_loader("bootloader/sys/libsys_minerva.bso", DRAM_LIB, (void *)&mtc_tmp);
+		u32 ep_addr = ianos_loader(MTC_MODULE_PATH, DRAM_LIB, (void *)&mtc_tmp, &module_hash);
 
 		// Ensure that Minerva is new.
 		if (mtc_tmp.init_done == MTC_INIT_MAGIC)
@@ -84,7 +206,7 @@ u32 minerva_init()
 	mtc_cfg->sdram_id  = fuse_read_dramid(false);
 	mtc_cfg->init_done = MTC_NEW_MAGIC; // Initialize mtc table.
 
-	u32 ep_addr = ianos_loader("bootloader/sys/libsys_minerva.bso", DRAM_LIB, (void *)mtc_cfg);
+	u32 ep_addr = ianos_loader(MTC_MODULE_PATH, DRAM_LIB, (void *)mtc_cfg, &module_hash);
 
 	// Ensure that Minerva is new.
 	if (mtc_cfg->init_done == MTC_INIT_MAGIC)
@@ -96,6 +218,10 @@ u32 minerva_init()
 	if (!minerva_cfg)
 		return 1;
 
+	// Load previously trained tables if they are still valid.
+	_minerva_cache_hdr_init(&cache_hdr, mtc_cfg, module_hash);
+	bool cached = _minerva_cache_load(mtc_cfg, &cache_hdr);
+
 	// Get current frequency
 	u32 current_emc_clk_src = CLOCK(CLK_RST_CONTROLLER_CLK_SOURCE_EMC);
 	for (curr_ram_idx = 0; curr_ram_idx < 10; curr_ram_idx++)
@@ -122,6 +248,15 @@ u32 minerva_init()
 	mtc_cfg->rate_to = FREQ_1600;
 	minerva_cfg(mtc_cfg, NULL);
 
+	// Compensate cached tables for current drift. Otherwise save the new training.
+	if (cached)
+	{
+		mtc_cfg->train_mode = OP_PERIODIC_TRAIN;
+		minerva_cfg(mtc_cfg, NULL);
+	}
+	else
+		_minerva_cache_save(mtc_cfg, &cache_hdr);
+
 	return 0;
 }
 
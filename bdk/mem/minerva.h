@@ -25,6 +25,8 @@
 
 #define EMC_PERIODIC_TRAIN_MS 250
 
+#define MTC_CACHE_PATH "bootloader/sys/libsys_minerva.bin"
+
 typedef struct
 {
 	u32 rate_to;
@@ -60,6 +62,7 @@ typedef enum
 
 extern void (*minerva_cfg)(mtc_config_t *mtc_cfg, void *);
 u32  minerva_init();
+void minerva_cache_invalidate();
 void minerva_change_freq(minerva_freq_t freq);
 void minerva_prep_boot_freq();
 void minerva_prep_boot_l4t(int oc_freq);
@@ -60,7 +60,7 @@
 
 // NX BIS driver sector cache.
 #define NX_BIS_CACHE_ADDR  0xC5000000
-#define  NX_BIS_CACHE_SZ   0x10020000 // 256MB.
+#define  NX_BIS_CACHE_SZ   0x10080000 // 256MB + header.
 #define NX_BIS_LOOKUP_ADDR 0xD6000000
 #define  NX_BIS_LOOKUP_SZ   0xF000000 // 240MB.
 
@@ -101,6 +101,10 @@
 #define NYX_FB2_ADDRESS  0xF6600000
 #define  NYX_FB_SZ         0x384000 // 1280 x 720 x 4.
 
+// Boot trace ring. Kept across payload reloads, like PSTORE.
+#define BOOT_TRACE_ADDR  0xF6990000
+#define  BOOT_TRACE_SZ       0x2000
+
 /* OBSOLETE: Very old hwinit based payloads were setting a carveout here. */
 #define DRAM_MEM_HOLE_ADR 0xF6A00000
 #define DRAM_MEM_HOLE_SZ   0x8140000
@@ -26,6 +26,8 @@
 #include <soc/timer.h>
 #include <soc/t210.h>
 
+#define SE_AES_XTS_NX_MAX_SECS 32
+
 typedef struct _se_ll_t
 {
 	vu32 num;
@@ -445,6 +447,68 @@ int se_aes_xts_crypt_sec_nx(u32 tweak_ks, u32 crypt_ks, u32 enc, u64 sec, u8 *tw
 	return 1;
 }
 
+static void _se_aes_xts_nx_xor(void *dst, void *src, const u8 *tweaks, u32 sec_size, u32 num_secs)
+{
+	u32 *pdst = (u32 *)dst;
+	u32 *psrc = (u32 *)src;
+	u8 tweak[SE_KEY_128_SIZE] __attribute__((aligned(4)));
+	u32 *ptweak = (u32 *)tweak;
+
+	for (u32 sec = 0; sec < num_secs; sec++)
+	{
+		memcpy(tweak, tweaks + sec * SE_AES_BLOCK_SIZE, SE_AES_BLOCK_SIZE);
+
+		for (u32 i = 0; i < (sec_size >> 4); i++)
+		{
+			for (u32 j = 0; j < 4; j++)
+				pdst[j] = psrc[j] ^ ptweak[j];
+
+			_gf256_mul_x_le(tweak);
+			psrc += 4;
+			pdst += 4;
+		}
+	}
+}
+
+int se_aes_xts_crypt_nx(u32 tweak_ks, u32 crypt_ks, u32 enc, u64 sec, void *dst, void *src, u32 sec_size, u32 num_secs)
+{
+	u8 tweaks[SE_AES_BLOCK_SIZE * SE_AES_XTS_NX_MAX_SECS] __attribute__((aligned(4)));
+	u8 *pdst = (u8 *)dst;
+	u8 *psrc = (u8 *)src;
+
+	while (num_secs)
+	{
+		u32 batch = MIN(num_secs, SE_AES_XTS_NX_MAX_SECS);
+		u32 batch_size = batch * sec_size;
+
+		// Generate all tweaks of the batch in one operation.
+		for (u32 i = 0; i < batch; i++)
+		{
+			u64 tweak_sec = sec + i;
+			for (int j = 0xF; j >= 0; j--)
+			{
+				tweaks[i * SE_AES_BLOCK_SIZE + j] = tweak_sec & 0xFF;
+				tweak_sec >>= 8;
+			}
+		}
+		if (!se_aes_crypt_ecb(tweak_ks, ENCRYPT, tweaks, batch * SE_AES_BLOCK_SIZE, tweaks, batch * SE_AES_BLOCK_SIZE))
+			return 0;
+
+		// Crypt all sectors of the batch in one operation.
+		_se_aes_xts_nx_xor(pdst, psrc, tweaks, sec_size, batch);
+		if (!se_aes_crypt_ecb(crypt_ks, enc, pdst, batch_size, pdst, batch_size))
+			return 0;
+		_se_aes_xts_nx_xor(pdst, pdst, tweaks, sec_size, batch);
+
+		sec      += batch;
+		num_secs -= batch;
+		pdst     += batch_size;
+		psrc     += batch_size;
+	}
+
+	return 1;
+}
+
 int se_aes_xts_crypt(u32 tweak_ks, u32 crypt_ks, u32 enc, u64 sec, void *dst, void *src, u32 secsize, u32 num_secs)
 {
 	u8 *pdst = (u8 *)dst;
@@ -529,6 +593,7 @@ int se_calc_sha256_oneshot(void *hash, const void *src, u32 src_size)
 int se_calc_sha256_finalize(void *hash, u32 *msg_left)
 {
 	u32 hash32[SE_SHA_256_SIZE / 4];
+
 	int res = _se_execute_finalize();
 
 	// Backup message left.
@@ -140,6 +140,23 @@ void bpmp_mmu_maintenance(u32 op, bool force)
 	BPMP_CACHE_CTRL(BPMP_CACHE_INT_CLEAR) = BPMP_CACHE_CTRL(BPMP_CACHE_INT_RAW_EVENT);
 }
 
+void bpmp_mmu_maintenance_addr(u32 op, u32 addr)
+{
+	if (!(BPMP_CACHE_CTRL(BPMP_CACHE_CONFIG) & CFG_ENABLE_CACHE))
+		return;
+
+	BPMP_CACHE_CTRL(BPMP_CACHE_INT_CLEAR) = INT_MAINT_DONE;
+
+	// Physical address ops act on the single line that holds addr.
+	BPMP_CACHE_CTRL(BPMP_CACHE_MAINT_ADDR) = ALIGN_DOWN(addr, BPMP_MMU_CACHE_LINE_SIZE);
+	BPMP_CACHE_CTRL(BPMP_CACHE_MAINT_REQ) = MAINT_REQ_WAY_BITMAP(0xF) | op;
+
+	while(!(BPMP_CACHE_CTRL(BPMP_CACHE_INT_RAW_EVENT) & INT_MAINT_DONE))
+		;
+
+	BPMP_CACHE_CTRL(BPMP_CACHE_INT_CLEAR) = BPMP_CACHE_CTRL(BPMP_CACHE_INT_RAW_EVENT);
+}
+
 void bpmp_mmu_set_entry(int idx, bpmp_mmu_entry_t *entry, bool apply)
 {
 	if (idx > 31)
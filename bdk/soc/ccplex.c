@@ -107,3 +107,12 @@ void ccplex_boot_cpu0(u32 entry)
 	// < 5.x: 0x411F000F, Clear CPU{0,1,2,3} POR and CORE, CX0, L2, and DBG reset.
 	CLOCK(CLK_RST_CONTROLLER_RST_CPUG_CMPLX_CLR) = 0x41010001;
 }
+
+void ccplex_powergate_cpu0()
+{
+	// Put CPU0 back in reset. Same bits that ccplex_boot_cpu0 clears.
+	CLOCK(CLK_RST_CONTROLLER_RST_CPUG_CMPLX_SET) = 0x41010001;
+
+	// Power gate CPU0 rail. Next ccplex_boot_cpu0 powers it up again.
+	pmc_enable_partition(POWER_RAIL_CE0, DISABLE);
+}
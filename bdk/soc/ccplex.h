@@ -20,5 +20,6 @@
 #include <utils/types.h>
 
 void ccplex_boot_cpu0(u32 entry);
+void ccplex_powergate_cpu0();
 
 #endif
@@ -0,0 +1,283 @@
+/*
+ * CCPLEX job offload.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <memory_map.h>
+#include <mem/heap.h>
+#include <mem/smmu.h>
+#include <soc/bpmp.h>
+#include <soc/ccplex.h>
+#include <soc/ccplex_job.h>
+#include <soc/t210.h>
+
+#define CCPLEX_JOB_MBOX_OFF 0x1C0
+
+// AArch64 translation table descriptors.
+#define TTE_BLOCK        0x1
+#define TTE_TABLE        0x3
+#define TTE_ATTR_WB      (0 << 2) // MAIR attribute 0: normal write-back.
+#define TTE_SH_INNER     (3 << 8)
+#define TTE_AF           BIT(10)
+#define TTE_NORMAL_BLOCK (TTE_BLOCK | TTE_ATTR_WB | TTE_SH_INNER | TTE_AF)
+
+typedef struct _ccplex_job_mbox_t
+{
+	vu32 state;
+	vu32 result;
+	vu32 buf;
+	vu32 comp_size;
+	vu32 cmp_and_hdr_size;
+	vu32 header_size;
+	vu32 addl_size;
+	vu32 ttbr;
+} ccplex_job_mbox_t;
+
+static bool ccplex_job_running = false;
+static void *ccplex_job_ttb_buf = NULL;
+
+/*
+ * AArch64 worker. Enables MMU and caches, polls the mailbox and runs a safe-mode in-place BLZ decompression per job.
+ * Job buffer and mailbox are cleaned and invalidated by the worker, since BPMP is not coherent with it.
+ * Source is in tools/ccplex_job_payload.py.
+ */
+static u8 ccplex_job_payload[] __attribute__((aligned(CCPLEX_JOB_CACHE_LINE_SZ))) = {
+	0x20, 0xF2, 0x39, 0xD5, // 0x000: MRS  X0, S3_1_C15_C2_1
+	0x00, 0x00, 0x7A, 0xB2, // 0x004: ORR  X0, X0, #0x40
+	0x20, 0xF2, 0x19, 0xD5, // 0x008: MSR  S3_1_C15_C2_1, X0
+	0xDF, 0x3F, 0x03, 0xD5, // 0x00C: ISB
+	0x94, 0x0D, 0x00, 0x10, // 0x010: ADR  X20, #432
+	0xE0, 0x1F, 0x80, 0xD2, // 0x014: MOV  X0, #255
+	0x00, 0xA2, 0x1E, 0xD5, // 0x018: MSR  MAIR_EL3, X0
+	0x00, 0xA4, 0x86, 0xD2, // 0x01C: MOV  X0, #13600
+	0x00, 0x10, 0xB0, 0xF2, // 0x020: MOVK X0, #32896, LSL #16
+	0x40, 0x20, 0x1E, 0xD5, // 0x024: MSR  TCR_EL3, X0
+	0x80, 0x1E, 0x40, 0xB9, // 0x028: LDR  W0, [X20, #28]
+	0x00, 0x20, 0x1E, 0xD5, // 0x02C: MSR  TTBR0_EL3, X0
+	0x1F, 0x87, 0x0E, 0xD5, // 0x030: TLBI ALLE3
+	0x9F, 0x3F, 0x03, 0xD5, // 0x034: DSB  SY
+	0xDF, 0x3F, 0x03, 0xD5, // 0x038: ISB
+	0x00, 0x10, 0x3E, 0xD5, // 0x03C: MRS  X0, SCTLR_EL3
+	0xA1, 0x00, 0x82, 0xD2, // 0x040: MOV  X1, #4101
+	0x00, 0x00, 0x01, 0xAA, // 0x044: ORR  X0, X0, X1
+	0x00, 0x10, 0x1E, 0xD5, // 0x048: MSR  SCTLR_EL3, X0
+	0xDF, 0x3F, 0x03, 0xD5, // 0x04C: ISB
+	0x34, 0x7E, 0x0B, 0xD5, // 0x050: DC   CIVAC, X20
+	0x9F, 0x3F, 0x03, 0xD5, // 0x054: DSB  SY
+	0x84, 0x02, 0x40, 0xB9, // 0x058: LDR  W4, [X20]
+	0x9F, 0x04, 0x00, 0x71, // 0x05C: CMP  W4, #1
+	0x81, 0xFF, 0xFF, 0x54, // 0x060: B.NE 0x50
+	0x85, 0x0A, 0x40, 0xB9, // 0x064: LDR  W5, [X20, #8]
+	0x86, 0x0E, 0x40, 0xB9, // 0x068: LDR  W6, [X20, #12]
+	0x87, 0x12, 0x40, 0xB9, // 0x06C: LDR  W7, [X20, #16]
+	0x88, 0x16, 0x40, 0xB9, // 0x070: LDR  W8, [X20, #20]
+	0x89, 0x1A, 0x40, 0xB9, // 0x074: LDR  W9, [X20, #24]
+	0x0A, 0x00, 0x80, 0x52, // 0x078: MOV  W10, #0
+	0xFF, 0x00, 0x06, 0x6B, // 0x07C: CMP  W7, W6
+	0x48, 0x07, 0x00, 0x54, // 0x080: B.HI 0x168
+	0x1F, 0x01, 0x07, 0x6B, // 0x084: CMP  W8, W7
+	0x08, 0x07, 0x00, 0x54, // 0x088: B.HI 0x168
+	0xAB, 0x00, 0x06, 0x8B, // 0x08C: ADD  X11, X5, X6
+	0x6B, 0x01, 0x07, 0xCB, // 0x090: SUB  X11, X11, X7
+	0xEC, 0x00, 0x08, 0x4B, // 0x094: SUB  W12, W7, W8
+	0xED, 0x00, 0x09, 0x0B, // 0x098: ADD  W13, W7, W9
+	0x3A, 0x00, 0x00, 0x94, // 0x09C: BL   0x184
+	0xEE, 0x03, 0x0D, 0x2A, // 0x0A0: MOV  W14, W13
+	0xEE, 0x05, 0x00, 0x34, // 0x0A4: CBZ  W14, 0x160
+	0xEC, 0x05, 0x00, 0x34, // 0x0A8: CBZ  W12, 0x164
+	0x8C, 0x05, 0x00, 0x51, // 0x0AC: SUB  W12, W12, #1
+	0x6F, 0x49, 0x6C, 0x38, // 0x0B0: LDRB W15, [X11, W12, UXTW]
+	0x10, 0x01, 0x80, 0x52, // 0x0B4: MOV  W16, #8
+	0x4E, 0x05, 0x00, 0x34, // 0x0B8: CBZ  W14, 0x160
+	0xCF, 0x03, 0x38, 0x36, // 0x0BC: TBZ  W15, #7, 0x134
+	0x9F, 0x09, 0x00, 0x71, // 0x0C0: CMP  W12, #2
+	0x03, 0x05, 0x00, 0x54, // 0x0C4: B.LO 0x164
+	0x8C, 0x09, 0x00, 0x51, // 0x0C8: SUB  W12, W12, #2
+	0x71, 0x41, 0x2C, 0x8B, // 0x0CC: ADD  X17, X11, W12, UXTW
+	0x35, 0x02, 0x40, 0x39, // 0x0D0: LDRB W21, [X17]
+	0x36, 0x06, 0x40, 0x39, // 0x0D4: LDRB W22, [X17, #1]
+	0xB5, 0x22, 0x16, 0x2A, // 0x0D8: ORR  W21, W21, W22, LSL #8
+	0xB6, 0x3E, 0x0C, 0x53, // 0x0DC: UBFX W22, W21, #12, #4
+	0xD6, 0x0E, 0x00, 0x11, // 0x0E0: ADD  W22, W22, #3
+	0xB7, 0x2E, 0x00, 0x12, // 0x0E4: AND  W23, W21, #0xFFF
+	0xF7, 0x0E, 0x00, 0x11, // 0x0E8: ADD  W23, W23, #3
+	0xDF, 0x01, 0x16, 0x6B, // 0x0EC: CMP  W14, W22
+	0xD6, 0x31, 0x96, 0x1A, // 0x0F0: CSEL W22, W14, W22, LO
+	0xCE, 0x01, 0x16, 0x4B, // 0x0F4: SUB  W14, W14, W22
+	0xD8, 0x01, 0x17, 0x0B, // 0x0F8: ADD  W24, W14, W23
+	0x18, 0x03, 0x16, 0x0B, // 0x0FC: ADD  W24, W24, W22
+	0x1F, 0x03, 0x0D, 0x6B, // 0x100: CMP  W24, W13
+	0x08, 0x03, 0x00, 0x54, // 0x104: B.HI 0x164
+	0xDF, 0x01, 0x0C, 0x6B, // 0x108: CMP  W14, W12
+	0xC3, 0x02, 0x00, 0x54, // 0x10C: B.LO 0x164
+	0x71, 0x41, 0x2E, 0x8B, // 0x110: ADD  X17, X11, W14, UXTW
+	0x39, 0x42, 0x37, 0x8B, // 0x114: ADD  X25, X17, W23, UXTW
+	0x18, 0x00, 0x80, 0x52, // 0x118: MOV  W24, #0
+	0x3A, 0x4B, 0x78, 0x38, // 0x11C: LDRB W26, [X25, W24, UXTW]
+	0x3A, 0x4A, 0x38, 0x38, // 0x120: STRB W26, [X17, W24, UXTW]
+	0x18, 0x07, 0x00, 0x11, // 0x124: ADD  W24, W24, #1
+	0x1F, 0x03, 0x16, 0x6B, // 0x128: CMP  W24, W22
+	0x83, 0xFF, 0xFF, 0x54, // 0x12C: B.LO 0x11C
+	0x08, 0x00, 0x00, 0x14, // 0x130: B    0x150
+	0x8C, 0x01, 0x00, 0x34, // 0x134: CBZ  W12, 0x164
+	0x8C, 0x05, 0x00, 0x51, // 0x138: SUB  W12, W12, #1
+	0xCE, 0x05, 0x00, 0x51, // 0x13C: SUB  W14, W14, #1
+	0xDF, 0x01, 0x0C, 0x6B, // 0x140: CMP  W14, W12
+	0x03, 0x01, 0x00, 0x54, // 0x144: B.LO 0x164
+	0x7A, 0x49, 0x6C, 0x38, // 0x148: LDRB W26, [X11, W12, UXTW]
+	0x7A, 0x49, 0x2E, 0x38, // 0x14C: STRB W26, [X11, W14, UXTW]
+	0xEF, 0x79, 0x1F, 0x53, // 0x150: LSL  W15, W15, #1
+	0x10, 0x06, 0x00, 0x71, // 0x154: SUBS W16, W16, #1
+	0x01, 0xFB, 0xFF, 0x54, // 0x158: B.NE 0xB8
+	0xD2, 0xFF, 0xFF, 0x17, // 0x15C: B    0xA4
+	0x2A, 0x00, 0x80, 0x52, // 0x160: MOV  W10, #1
+	0x08, 0x00, 0x00, 0x94, // 0x164: BL   0x184
+	0x8A, 0x06, 0x00, 0xB9, // 0x168: STR  W10, [X20, #4]
+	0xBF, 0x3F, 0x03, 0xD5, // 0x16C: DMB  SY
+	0x44, 0x00, 0x80, 0x52, // 0x170: MOV  W4, #2
+	0x84, 0x02, 0x00, 0xB9, // 0x174: STR  W4, [X20]
+	0x34, 0x7E, 0x0B, 0xD5, // 0x178: DC   CIVAC, X20
+	0x9F, 0x3F, 0x03, 0xD5, // 0x17C: DSB  SY
+	0xB4, 0xFF, 0xFF, 0x17, // 0x180: B    0x50
+	0x60, 0xE5, 0x7A, 0x92, // 0x184: AND  X0, X11, #0xFFFFFFFFFFFFFFC0
+	0x61, 0x41, 0x2D, 0x8B, // 0x188: ADD  X1, X11, W13, UXTW
+	0x20, 0x7E, 0x0B, 0xD5, // 0x18C: DC   CIVAC, X0
+	0x00, 0x00, 0x01, 0x91, // 0x190: ADD  X0, X0, #64
+	0x1F, 0x00, 0x01, 0xEB, // 0x194: CMP  X0, X1
+	0xA3, 0xFF, 0xFF, 0x54, // 0x198: B.LO 0x18C
+	0x9F, 0x3F, 0x03, 0xD5, // 0x19C: DSB  SY
+	0xC0, 0x03, 0x5F, 0xD6, // 0x1A0: RET
+	0x00, 0x00, 0x00, 0x00, // 0x1A4: Padding
+	0x00, 0x00, 0x00, 0x00, // 0x1A8: Padding
+	0x00, 0x00, 0x00, 0x00, // 0x1AC: Padding
+	0x00, 0x00, 0x00, 0x00, // 0x1B0: Padding
+	0x00, 0x00, 0x00, 0x00, // 0x1B4: Padding
+	0x00, 0x00, 0x00, 0x00, // 0x1B8: Padding
+	0x00, 0x00, 0x00, 0x00, // 0x1BC: Padding
+	0x00, 0x00, 0x00, 0x00, // 0x1C0: Mailbox: state
+	0x00, 0x00, 0x00, 0x00, // 0x1C4: Mailbox: result
+	0x00, 0x00, 0x00, 0x00, // 0x1C8: Mailbox: data buffer
+	0x00, 0x00, 0x00, 0x00, // 0x1CC: Mailbox: compressed size
+	0x00, 0x00, 0x00, 0x00, // 0x1D0: Mailbox: cmp_and_hdr_size
+	0x00, 0x00, 0x00, 0x00, // 0x1D4: Mailbox: header_size
+	0x00, 0x00, 0x00, 0x00, // 0x1D8: Mailbox: addl_size
+	0x00, 0x00, 0x00, 0x00, // 0x1DC: Mailbox: page table
+	0x00, 0x00, 0x00, 0x00, // 0x1E0: Mailbox: padding
+	0x00, 0x00, 0x00, 0x00, // 0x1E4: Mailbox: padding
+	0x00, 0x00, 0x00, 0x00, // 0x1E8: Mailbox: padding
+	0x00, 0x00, 0x00, 0x00, // 0x1EC: Mailbox: padding
+	0x00, 0x00, 0x00, 0x00, // 0x1F0: Mailbox: padding
+	0x00, 0x00, 0x00, 0x00, // 0x1F4: Mailbox: padding
+	0x00, 0x00, 0x00, 0x00, // 0x1F8: Mailbox: padding
+	0x00, 0x00, 0x00, 0x00  // 0x1FC: Mailbox: padding
+};
+
+static ccplex_job_mbox_t *mbox = (ccplex_job_mbox_t *)(ccplex_job_payload + CCPLEX_JOB_MBOX_OFF);
+
+// Identity map of IRAM and DRAM. Everything else is left unmapped.
+static u32 _ccplex_job_ttb_init()
+{
+	// L2 table must be 4KB aligned. L1 table follows it.
+	ccplex_job_ttb_buf = malloc(SZ_4K * 3);
+	u64 *l2 = (u64 *)ALIGN((u32)ccplex_job_ttb_buf, SZ_4K);
+	u64 *l1 = l2 + 512;
+
+	memset(l2, 0, SZ_4K + 4 * sizeof(u64));
+
+	// IRAM, 2MB block. Holds the worker and its mailbox.
+	l2[0] = IRAM_BASE | TTE_NORMAL_BLOCK;
+
+	// 1GB blocks.
+	l1[1] = (u32)l2 | TTE_TABLE;
+	l1[2] = DRAM_START | TTE_NORMAL_BLOCK;
+	l1[3] = (DRAM_START + SZ_1G) | TTE_NORMAL_BLOCK;
+
+	return (u32)l1;
+}
+
+bool ccplex_job_start()
+{
+	if (ccplex_job_running)
+		return true;
+
+	// CPU0 is occupied by the SMMU payload.
+	if (smmu_is_used())
+		return false;
+
+	mbox->state = CCPLEX_JOB_IDLE;
+	mbox->ttbr = _ccplex_job_ttb_init();
+	bpmp_mmu_maintenance(BPMP_MMU_MAINT_CLEAN_WAY, false);
+
+	ccplex_boot_cpu0((u32)ccplex_job_payload);
+	ccplex_job_running = true;
+
+	return true;
+}
+
+void ccplex_job_stop()
+{
+	if (!ccplex_job_running)
+		return;
+
+	// Reset and power off CPU0. Any job in flight is abandoned.
+	ccplex_powergate_cpu0();
+
+	free(ccplex_job_ttb_buf);
+	ccplex_job_ttb_buf = NULL;
+	ccplex_job_running = false;
+}
+
+bool ccplex_job_is_running()
+{
+	return ccplex_job_running;
+}
+
+int ccplex_job_blz_submit(u8 *buf, u32 comp_size, const blz_footer *footer)
+{
+	// Worker write-backs are per cache line, so buffer must not share lines with anything else.
+	if (!ccplex_job_running || ((u32)buf & (CCPLEX_JOB_CACHE_LINE_SZ - 1)) || ccplex_job_poll() == CCPLEX_JOB_SUBMITTED)
+		return 0;
+
+	mbox->buf = (u32)buf;
+	mbox->comp_size = comp_size;
+	mbox->cmp_and_hdr_size = footer->cmp_and_hdr_size;
+	mbox->header_size = footer->header_size;
+	mbox->addl_size = footer->addl_size;
+	mbox->result = 0;
+
+	// Flush arguments and data before handing the job over.
+	bpmp_mmu_maintenance(BPMP_MMU_MAINT_CLEAN_WAY, false);
+	mbox->state = CCPLEX_JOB_SUBMITTED;
+	bpmp_mmu_maintenance(BPMP_MMU_MAINT_CLEAN_WAY, false);
+
+	return 1;
+}
+
+u32 ccplex_job_poll()
+{
+	// Only the mailbox line is refetched. The rest of the cache may hold dirty BPMP data.
+	bpmp_mmu_maintenance_addr(BPMP_MMU_MAINT_INVALID_PHY, (u32)&mbox->state);
+
+	return mbox->state;
+}
+
+int ccplex_job_wait()
+{
+	while (ccplex_job_poll() == CCPLEX_JOB_SUBMITTED)
+		;
+
+	return mbox->result;
+}
@@ -0,0 +1,36 @@
+/*
+ * CCPLEX job offload.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _CCPLEX_JOB_H_
+#define _CCPLEX_JOB_H_
+
+#include <libs/compr/blz.h>
+#include <utils/types.h>
+
+#define CCPLEX_JOB_IDLE      0
+#define CCPLEX_JOB_SUBMITTED 1
+#define CCPLEX_JOB_DONE      2
+
+#define CCPLEX_JOB_CACHE_LINE_SZ 64
+
+bool ccplex_job_start();
+void ccplex_job_stop();
+bool ccplex_job_is_running();
+int  ccplex_job_blz_submit(u8 *buf, u32 comp_size, const blz_footer *footer);
+u32  ccplex_job_poll();
+int  ccplex_job_wait();
+
+#endif
@@ -24,6 +24,7 @@
 #include <mem/heap.h>
 #include <sec/se.h>
 #include <storage/emmc.h>
+#include <storage/nx_emmc_bis.h>
 #include <storage/sd.h>
 #include <storage/sdmmc.h>
 #include <utils/types.h>
@@ -31,12 +32,15 @@
 #define BIS_CLUSTER_SECTORS   32
 #define BIS_CLUSTER_SIZE      16384
 #define BIS_CACHE_MAX_ENTRIES 16384
+#define BIS_READAHEAD_CLUSTERS 16
 #define BIS_CACHE_LOOKUP_TBL_EMPTY_ENTRY -1
 
 typedef struct _cluster_cache_t
 {
 	u32  cluster_idx;            // Index of the cluster in the partition.
 	bool dirty;                  // Has been modified without write-back flag.
+	bool accessed;               // Referenced since the clock hand last passed over it.
+	bool reserved;               // Taken by a batched miss in flight. Not evictable.
 	u8   data[BIS_CLUSTER_SIZE]; // The cached cluster itself. Aligned to 8 bytes for DMA engine.
 } cluster_cache_t;
 
@@ -46,7 +50,10 @@ typedef struct _bis_cache_t
 	bool enabled;
 	u32  dirty_cnt;
 	u32  top_idx;
-	u8   dma_buff[BIS_CLUSTER_SIZE]; // Aligned to 8 bytes for DMA engine.
+	u32  clock_hand;
+	u32  last_cluster;
+	nx_emmc_bis_cache_stats_t stats;
+	u8   dma_buff[BIS_CLUSTER_SIZE * BIS_READAHEAD_CLUSTERS]; // Aligned to 8 bytes for DMA engine.
 	cluster_cache_t clusters[];
 } bis_cache_t;
 
@@ -73,6 +80,8 @@ static int nx_emmc_bis_write_block(u32 sector, u32 count, void *buff, bool flush
 	// Write to cached cluster.
 	if (is_cached)
 	{
+		bis_cache->clusters[lookup_idx].accessed = true;
+
 		if (buff)
 			memcpy(bis_cache->clusters[lookup_idx].data + sector_in_cluster * EMMC_BLOCKSIZE, buff, count * EMMC_BLOCKSIZE);
 		else
@@ -131,17 +140,73 @@ static void _nx_emmc_bis_flush_cache()
 	if (!bis_cache->enabled || !bis_cache->dirty_cnt)
 		return;
 
+	// Dirty count is decremented by the write-back itself.
 	for (u32 i = 0; i < bis_cache->top_idx && bis_cache->dirty_cnt; i++)
 	{
-		if (bis_cache->clusters[i].dirty) {
+		if (bis_cache->clusters[i].dirty)
 			nx_emmc_bis_write_block(bis_cache->clusters[i].cluster_idx * BIS_CLUSTER_SECTORS, BIS_CLUSTER_SECTORS, NULL, true);
-			bis_cache->dirty_cnt--;
-		}
 	}
 
 	_nx_emmc_bis_cluster_cache_init(true);
 }
 
+static u32 _nx_emmc_bis_cache_evict()
+{
+	// CLOCK replacement. Give recently accessed clusters a second chance.
+	while (true)
+	{
+		u32 idx = bis_cache->clock_hand;
+		cluster_cache_t *entry = &bis_cache->clusters[idx];
+
+		bis_cache->clock_hand = (idx + 1) % BIS_CACHE_MAX_ENTRIES;
+
+		if (entry->reserved)
+			continue;
+
+		if (entry->accessed)
+		{
+			entry->accessed = false;
+			continue;
+		}
+
+		// Write back victim if modified.
+		if (entry->dirty)
+		{
+			if (nx_emmc_bis_write_block(entry->cluster_idx * BIS_CLUSTER_SECTORS, BIS_CLUSTER_SECTORS, NULL, true))
+				return BIS_CACHE_LOOKUP_TBL_EMPTY_ENTRY; // R/W error.
+			bis_cache->stats.writebacks++;
+		}
+
+		// Entries of failed reads stay unmapped, so only unmap if still owned.
+		if (cache_lookup_tbl[entry->cluster_idx] == idx)
+			cache_lookup_tbl[entry->cluster_idx] = BIS_CACHE_LOOKUP_TBL_EMPTY_ENTRY;
+		bis_cache->stats.evictions++;
+
+		return idx;
+	}
+}
+
+static int _nx_emmc_bis_read_clusters(u32 cluster, u32 num, void *buff)
+{
+	int res;
+	u32 sector = cluster * BIS_CLUSTER_SECTORS;
+	u32 count  = num * BIS_CLUSTER_SECTORS;
+
+	// Read all clusters with one transfer.
+	if (!emu_offset)
+		res = emmc_part_read(system_part, sector, count, bis_cache->dma_buff);
+	else
+		res = sdmmc_storage_read(&sd_storage, emu_offset + system_part->lba_start + sector, count, bis_cache->dma_buff);
+	if (!res)
+		return 1; // R/W error.
+
+	// Decrypt all clusters with one SE operation.
+	if (!se_aes_xts_crypt_nx(ks_tweak, ks_crypt, DECRYPT, cluster, buff, bis_cache->dma_buff, BIS_CLUSTER_SIZE, num))
+		return 1; // Decryption error.
+
+	return 0; // Success.
+}
+
 static int nx_emmc_bis_read_block_normal(u32 sector, u32 count, void *buff)
 {
 	static u32 prev_cluster = -1;
@@ -185,61 +250,90 @@ static int nx_emmc_bis_read_block_normal(u32 sector, u32 count, void *buff)
 	return 0; // Success.
 }
 
-static int nx_emmc_bis_read_block_cached(u32 sector, u32 count, void *buff)
+static int nx_emmc_bis_read_block_cached(u32 sector, u32 count, void *buff, u32 req_clusters)
 {
-	int res;
-	u8  cache_tweak[SE_KEY_128_SIZE] __attribute__((aligned(4)));
 	u32 cluster = sector / BIS_CLUSTER_SECTORS;
-	u32 cluster_sector = cluster * BIS_CLUSTER_SECTORS;
 	u32 sector_in_cluster = sector % BIS_CLUSTER_SECTORS;
 	u32 lookup_idx = cache_lookup_tbl[cluster];
+	u32 entries[BIS_READAHEAD_CLUSTERS];
+
+	bool sequential = cluster == bis_cache->last_cluster + 1;
+	bis_cache->last_cluster = cluster;
 
 	// Read from cached cluster.
 	if (lookup_idx != (u32)BIS_CACHE_LOOKUP_TBL_EMPTY_ENTRY)
 	{
+		bis_cache->clusters[lookup_idx].accessed = true;
+		bis_cache->stats.hits++;
 		memcpy(buff, bis_cache->clusters[lookup_idx].data + sector_in_cluster * EMMC_BLOCKSIZE, count * EMMC_BLOCKSIZE);
 
 		return 0; // Success.
 	}
 
-	// Flush cache if full.
-	if (bis_cache->top_idx >= BIS_CACHE_MAX_ENTRIES)
-		_nx_emmc_bis_flush_cache();
+	bis_cache->stats.misses++;
 
-	// Set new cached cluster parameters.
-	bis_cache->clusters[bis_cache->top_idx].cluster_idx = cluster;
-	bis_cache->clusters[bis_cache->top_idx].dirty = false;
-	cache_lookup_tbl[cluster] = bis_cache->top_idx;
+	// Fetch the rest of the request together and read ahead on sequential access.
+	u32 max_clusters = sequential ? BIS_READAHEAD_CLUSTERS : MIN(req_clusters, BIS_READAHEAD_CLUSTERS);
+	u32 part_clusters = (system_part->lba_end - system_part->lba_start + 1) / BIS_CLUSTER_SECTORS;
+	u32 num = 1;
+	while (num < max_clusters && (cluster + num) < part_clusters &&
+		   cache_lookup_tbl[cluster + num] == (u32)BIS_CACHE_LOOKUP_TBL_EMPTY_ENTRY)
+		num++;
 
-	// Read the whole cluster the sector resides in.
-	if (!emu_offset)
-		res = emmc_part_read(system_part, cluster_sector, BIS_CLUSTER_SECTORS, bis_cache->dma_buff);
-	else
-		res = sdmmc_storage_read(&sd_storage, emu_offset + system_part->lba_start + cluster_sector, BIS_CLUSTER_SECTORS, bis_cache->dma_buff);
-	if (!res)
-		return 1; // R/W error.
+	// Take free entries or evict some if cache is full.
+	for (u32 i = 0; i < num; i++)
+	{
+		if (bis_cache->top_idx < BIS_CACHE_MAX_ENTRIES)
+			lookup_idx = bis_cache->top_idx++;
+		else
+		{
+			// Clock can wrap within a batch, so entries taken so far are reserved.
+			lookup_idx = _nx_emmc_bis_cache_evict();
+			if (lookup_idx == (u32)BIS_CACHE_LOOKUP_TBL_EMPTY_ENTRY)
+			{
+				num = i;
+				goto error;
+			}
+		}
 
-	// Decrypt cluster.
-	if (!se_aes_xts_crypt_sec_nx(ks_tweak, ks_crypt, DECRYPT, cluster, cache_tweak, true, 0, bis_cache->dma_buff, bis_cache->dma_buff, BIS_CLUSTER_SIZE))
-		return 1; // Decryption error.
+		// Set new cached cluster parameters. Entry is mapped only after a successful read.
+		bis_cache->clusters[lookup_idx].cluster_idx = cluster + i;
+		bis_cache->clusters[lookup_idx].dirty = false;
+		bis_cache->clusters[lookup_idx].accessed = false;
+		bis_cache->clusters[lookup_idx].reserved = true;
+		entries[i] = lookup_idx;
+	}
+
+	// Read and decrypt all clusters.
+	if (_nx_emmc_bis_read_clusters(cluster, num, bis_cache->dma_buff))
+		goto error;
 
 	// Copy to cluster cache.
-	memcpy(bis_cache->clusters[bis_cache->top_idx].data, bis_cache->dma_buff, BIS_CLUSTER_SIZE);
+	for (u32 i = 0; i < num; i++)
+	{
+		memcpy(bis_cache->clusters[entries[i]].data, bis_cache->dma_buff + i * BIS_CLUSTER_SIZE, BIS_CLUSTER_SIZE);
+		bis_cache->clusters[entries[i]].reserved = false;
+		cache_lookup_tbl[cluster + i] = entries[i];
+	}
 	memcpy(buff, bis_cache->dma_buff + sector_in_cluster * EMMC_BLOCKSIZE, count * EMMC_BLOCKSIZE);
 
-	// Increment cache count.
-	bis_cache->top_idx++;
-
 	return 0; // Success.
+
+error:
+	// Release taken entries. They stay unmapped.
+	for (u32 i = 0; i < num; i++)
+		bis_cache->clusters[entries[i]].reserved = false;
+
+	return 1; // R/W error.
 }
 
-static int nx_emmc_bis_read_block(u32 sector, u32 count, void *buff)
+static int nx_emmc_bis_read_block(u32 sector, u32 count, void *buff, u32 req_clusters)
 {
 	if (!system_part)
 		return 3; // Not ready.
 
 	if (bis_cache->enabled)
-		return nx_emmc_bis_read_block_cached(sector, count, buff);
+		return nx_emmc_bis_read_block_cached(sector, count, buff, req_clusters);
 	else
 		return nx_emmc_bis_read_block_normal(sector, count, buff);
 }
@@ -251,14 +345,29 @@ int nx_emmc_bis_read(u32 sector, u32 count, void *buff)
 
 	while (count)
 	{
-		// Get sector index in cluster and use it as boundary check.
-		u32 cnt_max = (curr_sct % BIS_CLUSTER_SECTORS);
-		cnt_max = BIS_CLUSTER_SECTORS - cnt_max;
+		u32 sct_cnt;
+		u32 sector_in_cluster = curr_sct % BIS_CLUSTER_SECTORS;
 
-		u32 sct_cnt = MIN(count, cnt_max); // Only allow cluster sized access.
+		// Decrypt whole clusters in batches if not caching.
+		if (system_part && !bis_cache->enabled && !sector_in_cluster && count >= BIS_CLUSTER_SECTORS * 2)
+		{
+			u32 clusters = MIN(count / BIS_CLUSTER_SECTORS, BIS_READAHEAD_CLUSTERS);
+			sct_cnt = clusters * BIS_CLUSTER_SECTORS;
 
-		if (nx_emmc_bis_read_block(curr_sct, sct_cnt, buf))
-			return 0;
+			if (_nx_emmc_bis_read_clusters(curr_sct / BIS_CLUSTER_SECTORS, clusters, buf))
+				return 0;
+		}
+		else
+		{
+			// Use sector index in cluster as boundary check.
+			u32 cnt_max = BIS_CLUSTER_SECTORS - sector_in_cluster;
+			u32 req_clusters = (count + sector_in_cluster + BIS_CLUSTER_SECTORS - 1) / BIS_CLUSTER_SECTORS;
+
+			sct_cnt = MIN(count, cnt_max); // Only allow cluster sized access.
+
+			if (nx_emmc_bis_read_block(curr_sct, sct_cnt, buf, req_clusters))
+				return 0;
+		}
 
 		count    -= sct_cnt;
 		curr_sct += sct_cnt;
@@ -318,6 +427,11 @@ void nx_emmc_bis_init(emmc_part_t *part, bool enable_cache, u32 emummc_offset)
 		system_part = NULL;
 }
 
+void nx_emmc_bis_cache_stats(nx_emmc_bis_cache_stats_t *stats)
+{
+	memcpy(stats, &bis_cache->stats, sizeof(nx_emmc_bis_cache_stats_t));
+}
+
 void nx_emmc_bis_end()
 {
 	_nx_emmc_bis_flush_cache();
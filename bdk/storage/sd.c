@@ -207,7 +207,7 @@ bool sd_is_gpt()
 	return sd_fs.part_type;
 }
 
-void *sd_file_read(const char *path, u32 *fsize)
+static void *_sd_file_read(const char *path, u32 *fsize, arena_t *arena)
 {
 	FIL fp;
 	if (!sd_get_card_mounted())
@@ -220,11 +220,13 @@ void *sd_file_read(const char *path, u32 *fsize)
 	if (fsize)
 		*fsize = size;
 
-	void *buf = malloc(size);
+	void *buf = arena ? arena_alloc(arena, size) : malloc(size);
 
 	if (f_read(&fp, buf, size, NULL) != FR_OK)
 	{
-		free(buf);
+		// Arena space is reclaimed when the arena is reset.
+		if (!arena)
+			free(buf);
 		f_close(&fp);
 
 		return NULL;
@@ -235,6 +237,16 @@ void *sd_file_read(const char *path, u32 *fsize)
 	return buf;
 }
 
+void *sd_file_read(const char *path, u32 *fsize)
+{
+	return _sd_file_read(path, fsize, NULL);
+}
+
+void *sd_file_read_arena(const char *path, u32 *fsize, arena_t *arena)
+{
+	return _sd_file_read(path, fsize, arena);
+}
+
 int sd_save_to_file(void *buf, u32 size, const char *filename)
 {
 	FIL fp;
@@ -21,6 +21,7 @@
 #include <storage/sdmmc.h>
 #include <storage/sdmmc_driver.h>
 #include <libs/fatfs/ff.h>
+#include <mem/arena.h>
 
 #define SD_BLOCKSIZE 512
 
@@ -57,6 +58,7 @@ void sd_unmount();
 void sd_end();
 bool sd_is_gpt();
 void *sd_file_read(const char *path, u32 *fsize);
+void *sd_file_read_arena(const char *path, u32 *fsize, arena_t *arena);
 int  sd_save_to_file(void *buf, u32 size, const char *filename);
 
 #endif
\ No newline at end of file
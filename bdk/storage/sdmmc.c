@@ -362,6 +362,100 @@ int sdmmc_storage_write(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, v
 	return _sdmmc_storage_readwrite(storage, sector, num_sectors, tmp_buf, 1);
 }
 
+static int _sdmmc_storage_readwrite_async(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf, u32 is_write)
+{
+	// Exit if not initialized or a request is already pending.
+	if (!storage->initialized || storage->async.pending)
+		return 0;
+
+	storage->async.sector = sector;
+	storage->async.num_sectors = num_sectors;
+	storage->async.buf = buf;
+	storage->async.is_write = is_write;
+	storage->async.pending = 1;
+	storage->async.in_flight = 0;
+
+	// Only single command requests on SDMMC DMA capable buffers can run in background.
+	if (num_sectors > 0xFFFF || !mc_client_has_access(buf) || ((u32)buf % 8))
+		return 1;
+
+	u32 tmp = 0;
+	sdmmc_cmd_t cmdbuf;
+	sdmmc_req_t reqbuf;
+
+	// If SDSC convert block address to byte address.
+	if (!storage->has_sector_access)
+		sector <<= 9;
+
+	sdmmc_init_cmd(&cmdbuf, is_write ? MMC_WRITE_MULTIPLE_BLOCK : MMC_READ_MULTIPLE_BLOCK, sector, SDMMC_RSP_TYPE_1, 0);
+
+	reqbuf.buf = buf;
+	reqbuf.num_sectors = num_sectors;
+	reqbuf.blksize = 512;
+	reqbuf.is_write = is_write;
+	reqbuf.is_multi_block = 1;
+	reqbuf.is_auto_stop_trn = 1;
+
+	if (sdmmc_execute_cmd_async(storage->sdmmc, &cmdbuf, &reqbuf))
+		storage->async.in_flight = 1;
+	else
+	{
+		// Failed to start. Request will be served synchronously on wait.
+		sdmmc_stop_transmission(storage->sdmmc, &tmp);
+		_sdmmc_storage_get_status(storage, &tmp, 0);
+	}
+
+	return 1;
+}
+
+int sdmmc_storage_read_async(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf)
+{
+	return _sdmmc_storage_readwrite_async(storage, sector, num_sectors, buf, 0);
+}
+
+int sdmmc_storage_write_async(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf)
+{
+	return _sdmmc_storage_readwrite_async(storage, sector, num_sectors, buf, 1);
+}
+
+u32 sdmmc_storage_async_poll(sdmmc_storage_t *storage)
+{
+	if (!storage->async.pending)
+		return SDMMC_ASYNC_IDLE;
+
+	// Requests not running in background are served on wait.
+	if (!storage->async.in_flight)
+		return SDMMC_ASYNC_DONE;
+
+	return sdmmc_execute_cmd_async_poll(storage->sdmmc);
+}
+
+int sdmmc_storage_async_wait(sdmmc_storage_t *storage)
+{
+	if (!storage->async.pending)
+		return 0;
+
+	storage->async.pending = 0;
+
+	if (storage->async.in_flight)
+	{
+		storage->async.in_flight = 0;
+
+		if (sdmmc_execute_cmd_async_end(storage->sdmmc, NULL))
+			return 1;
+
+		u32 tmp = 0;
+		sdmmc_stop_transmission(storage->sdmmc, &tmp);
+		_sdmmc_storage_get_status(storage, &tmp, 0);
+	}
+
+	// Serve it synchronously. Retries and reinit on failures are handled there.
+	if (storage->async.is_write)
+		return sdmmc_storage_write(storage, storage->async.sector, storage->async.num_sectors, storage->async.buf);
+
+	return sdmmc_storage_read(storage, storage->async.sector, storage->async.num_sectors, storage->async.buf);
+}
+
 /*
 * MMC specific functions.
 */
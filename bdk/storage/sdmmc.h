@@ -176,6 +176,17 @@ typedef struct _sd_ssr
 	u32 protected_size;
 } sd_ssr_t;
 
+/*! SDMMC storage async request. */
+typedef struct _sdmmc_storage_async_t
+{
+	u32 sector;
+	u32 num_sectors;
+	void *buf;
+	int is_write;
+	int pending;
+	int in_flight;
+} sdmmc_storage_async_t;
+
 /*! SDMMC storage context. */
 typedef struct _sdmmc_storage_t
 {
@@ -195,11 +206,16 @@ typedef struct _sdmmc_storage_t
 	mmc_ext_csd_t ext_csd;
 	sd_scr_t      scr;
 	sd_ssr_t      ssr;
+	sdmmc_storage_async_t async;
 } sdmmc_storage_t;
 
 int  sdmmc_storage_end(sdmmc_storage_t *storage);
 int  sdmmc_storage_read(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf);
 int  sdmmc_storage_write(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf);
+int  sdmmc_storage_read_async(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf);
+int  sdmmc_storage_write_async(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf);
+u32  sdmmc_storage_async_poll(sdmmc_storage_t *storage);
+int  sdmmc_storage_async_wait(sdmmc_storage_t *storage);
 int  sdmmc_storage_init_mmc(sdmmc_storage_t *storage, sdmmc_t *sdmmc, u32 bus_width, u32 type);
 int  sdmmc_storage_set_mmc_partition(sdmmc_storage_t *storage, u32 partition);
 void sdmmc_storage_init_wait_sd();
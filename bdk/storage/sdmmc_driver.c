@@ -47,6 +47,9 @@ static const u32 _sdmmc_bases[4] = {
 	0x700B0600,
 };
 
+/*! SDMMC controllers with an async transfer in flight. */
+static sdmmc_t *_sdmmc_async_active[4] = { NULL };
+
 int sdmmc_get_io_power(sdmmc_t *sdmmc)
 {
 	u32 p = sdmmc->regs->pwrcon;
@@ -835,6 +838,72 @@ DPRINTF("norintsts %08X, errintsts %08X\n", norintsts, errintsts);
 	return SDMMC_MASKINT_NOERROR;
 }
 
+static u32 _sdmmc_async_service(sdmmc_t *sdmmc)
+{
+	if (sdmmc->async_state != SDMMC_ASYNC_BUSY)
+		return sdmmc->async_state;
+
+	u32 result = SDMMC_MASKINT_MASKED;
+	while (true)
+	{
+		u16 intr = 0;
+		result = _sdmmc_check_mask_interrupt(sdmmc, &intr,
+			SDHCI_INT_DATA_END | SDHCI_INT_DMA_END);
+		if (result != SDMMC_MASKINT_MASKED)
+			break;
+
+		if (intr & SDHCI_INT_DATA_END)
+		{
+			sdmmc->async_state = SDMMC_ASYNC_DONE; // Transfer complete.
+			return SDMMC_ASYNC_DONE;
+		}
+
+		if (intr & SDHCI_INT_DMA_END)
+		{
+			// Update DMA.
+			sdmmc->regs->admaaddr = sdmmc->dma_addr_next;
+			sdmmc->regs->admaaddr_hi = 0;
+			sdmmc->dma_addr_next += 0x80000;
+
+			sdmmc->async_timeout = get_tmr_ms() + 1500;
+		}
+	}
+
+	if (result != SDMMC_MASKINT_NOERROR)
+	{
+#ifdef ERROR_EXTRA_PRINTING
+		EPRINTFARGS("%08X!", result);
+#endif
+		_sdmmc_reset(sdmmc);
+		sdmmc->async_state = SDMMC_ASYNC_ERROR;
+
+		return SDMMC_ASYNC_ERROR;
+	}
+
+	// Check that transfer is progressing. A paused DMA always has a pending DMA END.
+	u16 blkcnt = sdmmc->regs->blkcnt;
+	if (blkcnt != sdmmc->async_blkcnt_last)
+	{
+		sdmmc->async_blkcnt_last = blkcnt;
+		sdmmc->async_timeout = get_tmr_ms() + 1500;
+	}
+	else if (get_tmr_ms() > sdmmc->async_timeout)
+	{
+		_sdmmc_reset(sdmmc);
+		sdmmc->async_state = SDMMC_ASYNC_ERROR;
+	}
+
+	return sdmmc->async_state;
+}
+
+static void _sdmmc_async_service_others(sdmmc_t *sdmmc)
+{
+	// Keep DMA of other controllers going while this one is waited on.
+	for (u32 i = 0; i < ARRAY_SIZE(_sdmmc_async_active); i++)
+		if (_sdmmc_async_active[i] && _sdmmc_async_active[i] != sdmmc)
+			_sdmmc_async_service(_sdmmc_async_active[i]);
+}
+
 static int _sdmmc_wait_response(sdmmc_t *sdmmc)
 {
 	_sdmmc_commit_changes(sdmmc);
@@ -985,6 +1054,8 @@ static int _sdmmc_update_dma(sdmmc_t *sdmmc)
 				}
 			}
 
+			_sdmmc_async_service_others(sdmmc);
+
 			if (result != SDMMC_MASKINT_NOERROR)
 			{
 #ifdef ERROR_EXTRA_PRINTING
@@ -1261,6 +1332,7 @@ int sdmmc_init(sdmmc_t *sdmmc, u32 id, u32 power, u32 bus_width, u32 type, int p
 		return 0;
 
 	memset(sdmmc, 0, sizeof(sdmmc_t));
+	_sdmmc_async_active[id] = NULL;
 
 	sdmmc->regs = (t210_sdmmc_t *)_sdmmc_bases[id];
 	sdmmc->id = id;
@@ -1385,6 +1457,9 @@ void sdmmc_end(sdmmc_t *sdmmc)
 
 		clock_sdmmc_disable(sdmmc->id);
 		sdmmc->clock_stopped = 1;
+
+		_sdmmc_async_active[sdmmc->id] = NULL;
+		sdmmc->async_state = SDMMC_ASYNC_IDLE;
 	}
 }
 
@@ -1423,6 +1498,134 @@ int sdmmc_execute_cmd(sdmmc_t *sdmmc, sdmmc_cmd_t *cmd, sdmmc_req_t *req, u32 *b
 	return result;
 }
 
+static int _sdmmc_execute_cmd_async_inner(sdmmc_t *sdmmc, sdmmc_cmd_t *cmd, sdmmc_req_t *req)
+{
+	if (!_sdmmc_wait_cmd_data_inhibit(sdmmc, true))
+		return 0;
+
+	u32 blkcnt = 0;
+	if (!_sdmmc_config_dma(sdmmc, &blkcnt, req))
+	{
+#ifdef ERROR_EXTRA_PRINTING
+		EPRINTF("SDMMC: DMA Wrong cfg!");
+#endif
+		return 0;
+	}
+
+	// Flush cache before starting the transfer.
+	bpmp_mmu_maintenance(BPMP_MMU_MAINT_CLEAN_WAY, false);
+
+	_sdmmc_enable_interrupts(sdmmc);
+
+	int result = _sdmmc_send_cmd(sdmmc, cmd, true);
+	if (result)
+		result = _sdmmc_wait_response(sdmmc);
+	if (result && cmd->rsp_type)
+	{
+		sdmmc->expected_rsp_type = cmd->rsp_type;
+		result = _sdmmc_cache_rsp(sdmmc, sdmmc->rsp, 0x10, cmd->rsp_type);
+	}
+
+	if (!result)
+	{
+#ifdef ERROR_EXTRA_PRINTING
+		EPRINTF("SDMMC: Async transfer failed to start!");
+#endif
+		_sdmmc_mask_interrupts(sdmmc);
+		return 0;
+	}
+
+	// Data transfer is now running. DMA is served by poll/end or by other controllers' waits.
+	sdmmc->async_blkcnt = blkcnt;
+	sdmmc->async_blkcnt_last = blkcnt;
+	sdmmc->async_timeout = get_tmr_ms() + 1500;
+	sdmmc->async_auto_stop_trn = req->is_auto_stop_trn;
+	sdmmc->async_state = SDMMC_ASYNC_BUSY;
+	_sdmmc_async_active[sdmmc->id] = sdmmc;
+
+	return 1;
+}
+
+int sdmmc_execute_cmd_async(sdmmc_t *sdmmc, sdmmc_cmd_t *cmd, sdmmc_req_t *req)
+{
+	if (!sdmmc->card_clock_enabled || !req || sdmmc->async_state != SDMMC_ASYNC_IDLE)
+		return 0;
+
+	// Recalibrate periodically for SDMMC1.
+	if (sdmmc->manual_cal && sdmmc->powersave_enabled)
+		_sdmmc_autocal_execute(sdmmc, sdmmc_get_io_power(sdmmc));
+
+	sdmmc->async_disable_sd_clock = 0;
+	if (!(sdmmc->regs->clkcon & SDHCI_CLOCK_CARD_EN))
+	{
+		sdmmc->async_disable_sd_clock = 1;
+		sdmmc->regs->clkcon |= SDHCI_CLOCK_CARD_EN;
+		_sdmmc_commit_changes(sdmmc);
+		usleep((8000 + sdmmc->divisor - 1) / sdmmc->divisor);
+	}
+
+	int result = _sdmmc_execute_cmd_async_inner(sdmmc, cmd, req);
+	if (!result)
+	{
+		usleep((8000 + sdmmc->divisor - 1) / sdmmc->divisor);
+
+		if (sdmmc->async_disable_sd_clock)
+			sdmmc->regs->clkcon &= ~SDHCI_CLOCK_CARD_EN;
+	}
+
+	return result;
+}
+
+u32 sdmmc_execute_cmd_async_poll(sdmmc_t *sdmmc)
+{
+	return _sdmmc_async_service(sdmmc);
+}
+
+int sdmmc_execute_cmd_async_end(sdmmc_t *sdmmc, u32 *blkcnt_out)
+{
+	if (sdmmc->async_state == SDMMC_ASYNC_IDLE)
+		return 0;
+
+	// Wait for transfer to end and keep any other in flight transfer going.
+	while (_sdmmc_async_service(sdmmc) == SDMMC_ASYNC_BUSY)
+		_sdmmc_async_service_others(sdmmc);
+
+	int result = sdmmc->async_state == SDMMC_ASYNC_DONE;
+	sdmmc->async_state = SDMMC_ASYNC_IDLE;
+	_sdmmc_async_active[sdmmc->id] = NULL;
+
+	_sdmmc_mask_interrupts(sdmmc);
+
+	if (result)
+	{
+		// Invalidate cache after transfer.
+		bpmp_mmu_maintenance(BPMP_MMU_MAINT_INVALID_WAY, false);
+
+		if (blkcnt_out)
+			*blkcnt_out = sdmmc->async_blkcnt;
+
+		if (sdmmc->async_auto_stop_trn)
+			sdmmc->rsp3 = sdmmc->regs->rspreg3;
+
+		result = _sdmmc_wait_card_busy(sdmmc);
+#ifdef ERROR_EXTRA_PRINTING
+		if (!result)
+			EPRINTF("SDMMC: Busy timeout!");
+#endif
+	}
+#ifdef ERROR_EXTRA_PRINTING
+	else
+		EPRINTF("SDMMC: DMA Update failed!");
+#endif
+
+	usleep((8000 + sdmmc->divisor - 1) / sdmmc->divisor);
+
+	if (sdmmc->async_disable_sd_clock)
+		sdmmc->regs->clkcon &= ~SDHCI_CLOCK_CARD_EN;
+
+	return result;
+}
+
 int sdmmc_enable_low_voltage(sdmmc_t *sdmmc)
 {
 	if(sdmmc->id != SDMMC_1)
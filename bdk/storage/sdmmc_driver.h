@@ -50,6 +50,12 @@
 #define SDMMC_MASKINT_NOERROR  1
 #define SDMMC_MASKINT_ERROR    2
 
+/*! SDMMC async transfer state. */
+#define SDMMC_ASYNC_IDLE  0
+#define SDMMC_ASYNC_BUSY  1
+#define SDMMC_ASYNC_DONE  2
+#define SDMMC_ASYNC_ERROR 3
+
 /*! SDMMC present state. */
 #define SDHCI_CMD_INHIBIT      BIT(0)
 #define SDHCI_DATA_INHIBIT     BIT(1)
@@ -236,6 +242,12 @@ typedef struct _sdmmc_t
 	u32 rsp[4];
 	u32 rsp3;
 	int t210b01;
+	u32 async_state;
+	u32 async_blkcnt;
+	u32 async_blkcnt_last;
+	u32 async_timeout;
+	int async_auto_stop_trn;
+	int async_disable_sd_clock;
 } sdmmc_t;
 
 /*! SDMMC command. */
@@ -272,6 +284,9 @@ int  sdmmc_init(sdmmc_t *sdmmc, u32 id, u32 power, u32 bus_width, u32 type, int
 void sdmmc_end(sdmmc_t *sdmmc);
 void sdmmc_init_cmd(sdmmc_cmd_t *cmdbuf, u16 cmd, u32 arg, u32 rsp_type, u32 check_busy);
 int  sdmmc_execute_cmd(sdmmc_t *sdmmc, sdmmc_cmd_t *cmd, sdmmc_req_t *req, u32 *blkcnt_out);
+int  sdmmc_execute_cmd_async(sdmmc_t *sdmmc, sdmmc_cmd_t *cmd, sdmmc_req_t *req);
+u32  sdmmc_execute_cmd_async_poll(sdmmc_t *sdmmc);
+int  sdmmc_execute_cmd_async_end(sdmmc_t *sdmmc, u32 *blkcnt_out);
 int  sdmmc_enable_low_voltage(sdmmc_t *sdmmc);
 
 #endif
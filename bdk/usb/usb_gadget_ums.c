@@ -37,7 +37,7 @@
 //#define DPRINTF(...) gfx_printf(__VA_ARGS__)
 #define DPRINTF(...)
 
-#define UMS_MAX_LUN 1 // Only 1 disk/partition for now.
+#define UMS_MAX_LUN USB_UMS_MAX_LUN
 
 #define USB_BULK_CB_WRAP_LEN 31
 #define USB_BULK_CB_SIG      0x43425355 // USBC.
@@ -60,6 +60,14 @@
 
 #define UMS_EP_OUT_MAX_XFER (USB_EP_BULK_OUT_MAX_XFER)
 
+#define UMS_READ_RING_SLOTS 16 // 1MB read ahead with 64KB IO.
+
+#define UMS_STATS_UPDATE_MS 2000
+
+#define UMS_WCACHE_ADDR     (SDXC_BUF_ALIGNED + SZ_8M) // Read ring uses the first 1MB.
+#define UMS_WCACHE_MAX_SCT  (SZ_8M >> UMS_DISK_LBA_SHIFT)
+#define UMS_WCACHE_IDLE_MS  1000
+
 // Length of a SCSI Command Data Block.
 #define SCSI_MAX_CMD_SZ 16
 
@@ -175,6 +183,7 @@ typedef struct _logical_unit_t
 	u32 partition;
 	u32 removable;
 	u32 prevent_medium_removal;
+	u32 write_cache;
 
 	u32 info_valid;
 
@@ -200,6 +209,23 @@ typedef struct _bulk_ctxt_t {
 	enum buffer_state bulk_out_buf_state;
 } bulk_ctxt_t;
 
+typedef struct _ums_stats_t {
+	u32 read_bytes;
+	u32 write_bytes;
+	u32 timer;
+} ums_stats_t;
+
+typedef struct _ums_wcache_t {
+	sdmmc_storage_t *storage;
+	u8 *buf;
+	u32 sectors; // Window size. 0 if cache is disabled.
+	u32 sector;  // Window start on storage.
+	u32 start;   // Dirty range start in window.
+	u32 end;     // Dirty range end in window. 0 if clean.
+	u32 timer;
+	u32 error;   // Deferred write error, reported on the next command.
+} ums_wcache_t;
+
 typedef struct _usbd_gadget_ums_t {
 	bulk_ctxt_t bulk_ctxt;
 
@@ -207,7 +233,9 @@ typedef struct _usbd_gadget_ums_t {
 	u8   cmnd[SCSI_MAX_CMD_SZ];
 
 	u32  lun_idx; // lun index
-	logical_unit_t lun;
+	u32  lun_cnt;
+	logical_unit_t *lun; // Current lun.
+	logical_unit_t luns[UMS_MAX_LUN];
 
 	enum ums_state state; // For exception handling.
 
@@ -228,6 +256,9 @@ typedef struct _usbd_gadget_ums_t {
 	u32 timeouts;
 	bool xusb;
 
+	ums_stats_t stats;
+	ums_wcache_t wcache;
+
 	void (*system_maintenance)(bool);
 	void *label;
 	void (*set_text)(void *, const char *);
@@ -235,6 +266,9 @@ typedef struct _usbd_gadget_ums_t {
 
 static usb_ops_t usb_ops;
 
+static void (*ums_label_set_text)(void *, const char *);
+static bool ums_label_error = false;
+
 static inline void put_array_le_to_be16(u16 val, void *p)
 {
 	u8 *_p = p;
@@ -407,6 +441,142 @@ static void _ums_reset_buffer(bulk_ctxt_t *bulk_ctxt, u32 ep)
 		bulk_ctxt->bulk_out_buf = (u8 *)USB_EP_BULK_OUT_BUF_ADDR;
 }
 
+static void _ums_wcache_init(usbd_gadget_ums_t *ums)
+{
+	ums_wcache_t *wc = &ums->wcache;
+
+	memset(wc, 0, sizeof(ums_wcache_t));
+
+	// Only SD cards report an allocation unit.
+	for (u32 i = 0; i < ums->lun_cnt; i++)
+	{
+		logical_unit_t *lun = &ums->luns[i];
+
+		if (lun->write_cache && (lun->type != MMC_SD || lun->ro))
+			lun->write_cache = 0;
+		if (lun->write_cache)
+			wc->storage = lun->storage;
+	}
+
+	if (!wc->storage)
+		return;
+
+	u32 au_sectors = sd_storage_get_ssr_au(wc->storage) * 2;
+	if (!au_sectors)
+	{
+		for (u32 i = 0; i < ums->lun_cnt; i++)
+			ums->luns[i].write_cache = 0;
+		return;
+	}
+
+	// Use the largest power of 2 window that fits and evenly divides the AU.
+	u32 sectors = UMS_WCACHE_MAX_SCT;
+	while (sectors > au_sectors || (au_sectors % sectors))
+		sectors >>= 1;
+
+	wc->buf = (u8 *)UMS_WCACHE_ADDR;
+	wc->sectors = sectors;
+}
+
+static int _ums_wcache_flush(usbd_gadget_ums_t *ums)
+{
+	ums_wcache_t *wc = &ums->wcache;
+
+	if (!wc->end)
+		return 1;
+
+	// Range stays dirty on error and is retried on the next flush.
+	if (!sdmmc_storage_write(wc->storage, wc->sector + wc->start, wc->end - wc->start,
+		wc->buf + (wc->start << UMS_DISK_LBA_SHIFT)))
+		return 0;
+
+	wc->start = 0;
+	wc->end = 0;
+
+	return 1;
+}
+
+static int _ums_wcache_flush_range(usbd_gadget_ums_t *ums, u32 lba_offset, u32 num_sectors)
+{
+	ums_wcache_t *wc = &ums->wcache;
+
+	if (!wc->end || ums->lun->storage != wc->storage)
+		return 1;
+
+	u32 sector = ums->lun->offset + lba_offset;
+	if (sector + num_sectors <= wc->sector + wc->start || sector >= wc->sector + wc->end)
+		return 1;
+
+	return _ums_wcache_flush(ums);
+}
+
+static int _ums_wcache_write(usbd_gadget_ums_t *ums, u32 lba_offset, u32 num_sectors, u8 *buf, bool fua)
+{
+	ums_wcache_t *wc = &ums->wcache;
+	u32 sector = ums->lun->offset + lba_offset;
+
+	// Write through if cache is disabled or Forced Unit Access was requested.
+	if (!ums->lun->write_cache || fua)
+	{
+		if (!_ums_wcache_flush_range(ums, lba_offset, num_sectors))
+			return 0;
+
+		return sdmmc_storage_write(ums->lun->storage, sector, num_sectors, buf);
+	}
+
+	while (num_sectors)
+	{
+		u32 window = sector & ~(wc->sectors - 1);
+		u32 start  = sector - window;
+		u32 count  = MIN(num_sectors, wc->sectors - start);
+		u32 end    = start + count;
+
+		// Write out the previous window if the write moved to another AU.
+		if (wc->end && window != wc->sector)
+		{
+			if (!_ums_wcache_flush(ums))
+				return 0;
+		}
+
+		if (!wc->end)
+		{
+			wc->sector = window;
+			wc->start  = start;
+			wc->end    = end;
+		}
+		else
+		{
+			// Fill any gap from the card so the dirty range is programmed in one go.
+			if (start > wc->end && !sdmmc_storage_read(wc->storage, window + wc->end,
+				start - wc->end, wc->buf + (wc->end << UMS_DISK_LBA_SHIFT)))
+				return 0;
+			if (end < wc->start && !sdmmc_storage_read(wc->storage, window + end,
+				wc->start - end, wc->buf + (end << UMS_DISK_LBA_SHIFT)))
+				return 0;
+
+			wc->start = MIN(wc->start, start);
+			wc->end   = MAX(wc->end, end);
+		}
+
+		memcpy(wc->buf + (start << UMS_DISK_LBA_SHIFT), buf, count << UMS_DISK_LBA_SHIFT);
+
+		// Program full AU windows right away.
+		if (!wc->start && wc->end == wc->sectors)
+		{
+			if (!_ums_wcache_flush(ums))
+				return 0;
+		}
+
+		sector      += count;
+		num_sectors -= count;
+		buf         += count << UMS_DISK_LBA_SHIFT;
+	}
+
+	wc->timer = get_tmr_ms();
+
+	return 1;
+}
+
 /*
  * The following are old data based on max 64KB SCSI transfers.
  * The endpoint xfer is actually 41.2 MB/s and SD card max 39.2 MB/s, with higher SCSI
@@ -441,8 +611,13 @@ static void _ums_reset_buffer(bulk_ctxt_t *bulk_ctxt, u32 ep)
 static int _scsi_read(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 {
 	u32 lba_offset;
-	bool first_read = true;
-	u8 *sdmmc_buf = (u8 *)SDXC_BUF_ALIGNED;
+	u8 *ring_buf = (u8 *)SDXC_BUF_ALIGNED;
+	u32 ring_len[UMS_READ_RING_SLOTS];
+	u32 sdmmc_idx = 0; // Buffers read from SDMMC.
+	u32 usb_idx = 0;   // Buffers queued to USB.
+	u32 sdmmc_amount = 0;
+	bool sdmmc_active = false;
+	bool usb_active = false;
 
 	// Get the starting LBA and check that it's not too big.
 	if (ums->cmnd[0] == SC_READ_6)
@@ -454,15 +629,15 @@ static int _scsi_read(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 		// We allow DPO and FUA bypass cache bits, but we don't use them.
 		if ((ums->cmnd[1] & ~0x18) != 0)
 		{
-			ums->lun.sense_data = SS_INVALID_FIELD_IN_CDB;
+			ums->lun->sense_data = SS_INVALID_FIELD_IN_CDB;
 
 			return UMS_RES_INVALID_ARG;
 		}
 	}
-	if (lba_offset >= ums->lun.num_sectors)
+	if (lba_offset >= ums->lun->num_sectors)
 	{
 		ums->set_text(ums->label, "#FF8000 Warn:# Read - Out of range! Host notified.");
-		ums->lun.sense_data = SS_LOGICAL_BLOCK_ADDRESS_OUT_OF_RANGE;
+		ums->lun->sense_data = SS_LOGICAL_BLOCK_ADDRESS_OUT_OF_RANGE;
 
 		return UMS_RES_INVALID_ARG;
 	}
@@ -472,63 +647,130 @@ static int _scsi_read(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 	if (!amount_left)
 		return UMS_RES_IO_ERROR; // No default reply.
 
+	// Make sure cached writes in the read range hit the storage first.
+	if (!_ums_wcache_flush_range(ums, lba_offset, amount_left))
+	{
+		ums->set_text(ums->label, "#FFDD00 Error:# SDMMC Write!");
+		ums->lun->sense_data = SS_WRITE_ERROR;
+		ums->lun->sense_data_info = lba_offset;
+		ums->lun->info_valid = 1;
+
+		return UMS_RES_INVALID_ARG;
+	}
+
 	// Limit IO transfers based on request for faster concurrent reads.
 	u32 max_io_transfer = (amount_left >= UMS_SCSI_TRANSFER_512K) ?
 		UMS_DISK_MAX_IO_TRANSFER_64K : UMS_DISK_MAX_IO_TRANSFER_32K;
 
+	/*
+	 * SDMMC reads fill a ring of buffers ahead of the USB transfers.
+	 * One card read runs in background while USB transfers are reaped and queued,
+	 * so SDMMC only idles when the ring is full or everything has been read.
+	 */
 	while (true)
 	{
-		// Max io size and end sector limits.
-		u32 amount = MIN(amount_left, max_io_transfer);
-		amount = MIN(amount, ums->lun.num_sectors - lba_offset);
+		u32 ready = sdmmc_idx - usb_idx;
 
-		// Check if it is a read past the end sector.
-		if (!amount)
+		// Reap the SDMMC read once the card is done.
+		if (sdmmc_active && sdmmc_storage_async_poll(ums->lun->storage) != SDMMC_ASYNC_BUSY)
 		{
-			ums->lun.sense_data = SS_LOGICAL_BLOCK_ADDRESS_OUT_OF_RANGE;
-			ums->lun.sense_data_info = lba_offset;
-			ums->lun.info_valid = 1;
-			bulk_ctxt->bulk_in_length = 0;
-			bulk_ctxt->bulk_in_buf_state = BUF_STATE_FULL;
-			break;
+			u32 slot = sdmmc_idx % UMS_READ_RING_SLOTS;
+			sdmmc_active = false;
+			sdmmc_idx++;
+
+			if (!sdmmc_storage_async_wait(ums->lun->storage))
+			{
+				// Report the error and its position. Already read data will still be sent.
+				ums->set_text(ums->label, "#FFDD00 Error:# SDMMC Read!");
+				ums->lun->sense_data = SS_UNRECOVERED_READ_ERROR;
+				ums->lun->sense_data_info = lba_offset;
+				ums->lun->info_valid = 1;
+				ring_len[slot] = 0;
+				amount_left = 0;
+				continue;
+			}
+
+			lba_offset   += sdmmc_amount;
+			amount_left  -= sdmmc_amount;
+			ums->residue -= sdmmc_amount << UMS_DISK_LBA_SHIFT;
+			ums->stats.read_bytes += sdmmc_amount << UMS_DISK_LBA_SHIFT;
+
+			ring_len[slot] = sdmmc_amount << UMS_DISK_LBA_SHIFT;
+			continue;
 		}
 
-		// Do the SDMMC read.
-		if (!sdmmc_storage_read(ums->lun.storage, ums->lun.offset + lba_offset, amount, sdmmc_buf))
-			amount = 0;
+		// Start the next SDMMC read if there's a free buffer.
+		if (!sdmmc_active && amount_left && (ready + usb_active) < UMS_READ_RING_SLOTS)
+		{
+			// Max io size and end sector limits.
+			u32 amount = MIN(amount_left, max_io_transfer);
+			amount = MIN(amount, ums->lun->num_sectors - lba_offset);
 
-		// Wait for the async USB transfer to finish.
-		if (!first_read)
-			_ums_transfer_finish(ums, bulk_ctxt, bulk_ctxt->bulk_in, USB_XFER_SYNCED);
+			u32 slot = sdmmc_idx % UMS_READ_RING_SLOTS;
 
-		lba_offset   += amount;
-		amount_left  -= amount;
-		ums->residue -= amount << UMS_DISK_LBA_SHIFT;
+			// Check if it is a read past the end sector.
+			if (!amount)
+			{
+				ums->lun->sense_data = SS_LOGICAL_BLOCK_ADDRESS_OUT_OF_RANGE;
+				ums->lun->sense_data_info = lba_offset;
+				ums->lun->info_valid = 1;
+				ring_len[slot] = 0;
+				amount_left = 0;
+				sdmmc_idx++;
+				continue;
+			}
 
-		bulk_ctxt->bulk_in_length    = amount << UMS_DISK_LBA_SHIFT;
-		bulk_ctxt->bulk_in_buf_state = BUF_STATE_FULL;
-		bulk_ctxt->bulk_in_buf       = sdmmc_buf;
+			if (!sdmmc_storage_read_async(ums->lun->storage, ums->lun->offset + lba_offset, amount,
+				ring_buf + slot * (max_io_transfer << UMS_DISK_LBA_SHIFT)))
+			{
+				ums->set_text(ums->label, "#FFDD00 Error:# SDMMC Read!");
+				ums->lun->sense_data = SS_UNRECOVERED_READ_ERROR;
+				ums->lun->sense_data_info = lba_offset;
+				ums->lun->info_valid = 1;
+				ring_len[slot] = 0;
+				amount_left = 0;
+				sdmmc_idx++;
+				continue;
+			}
 
-		// If an error occurred, report it and its position.
-		if (!amount)
+			sdmmc_active = true;
+			sdmmc_amount = amount;
+			continue;
+		}
+
+		// Reap the USB transfer. Wait for it only if the card is not busy either.
+		if (usb_active && (!sdmmc_active || !usb_ops.usb_device_ep1_in_writing_busy()))
 		{
-			ums->set_text(ums->label, "#FFDD00 Error:# SDMMC Read!");
-			ums->lun.sense_data = SS_UNRECOVERED_READ_ERROR;
-			ums->lun.sense_data_info = lba_offset;
-			ums->lun.info_valid = 1;
-			break;
+			_ums_transfer_finish(ums, bulk_ctxt, bulk_ctxt->bulk_in, USB_XFER_SYNCED);
+			usb_active = false;
+			continue;
 		}
 
-		// Last SDMMC read. Last part will be sent by the finish reply function.
-		if (!amount_left)
-			break;
+		// Queue the next buffer to USB. Last one will be sent by the finish reply function.
+		if (!usb_active && ready > ((amount_left || sdmmc_active) ? 0 : 1))
+		{
+			u32 slot = usb_idx % UMS_READ_RING_SLOTS;
+			bulk_ctxt->bulk_in_length    = ring_len[slot];
+			bulk_ctxt->bulk_in_buf_state = BUF_STATE_FULL;
+			bulk_ctxt->bulk_in_buf       = ring_buf + slot * (max_io_transfer << UMS_DISK_LBA_SHIFT);
 
-		// Start the USB transfer.
-		_ums_transfer_start(ums, bulk_ctxt, bulk_ctxt->bulk_in, USB_XFER_START);
-		first_read = false;
+			_ums_transfer_start(ums, bulk_ctxt, bulk_ctxt->bulk_in, USB_XFER_START);
+			usb_active = true;
+			usb_idx++;
+			continue;
+		}
+
+		// Everything is read and sent except the last buffer.
+		if (!amount_left && !sdmmc_active && !usb_active)
+		{
+			u32 slot = usb_idx % UMS_READ_RING_SLOTS;
+			bulk_ctxt->bulk_in_length    = ring_len[slot];
+			bulk_ctxt->bulk_in_buf_state = BUF_STATE_FULL;
+			bulk_ctxt->bulk_in_buf       = ring_buf + slot * (max_io_transfer << UMS_DISK_LBA_SHIFT);
+			break;
+		}
 
-		// Increment our buffer to read new data.
-		sdmmc_buf += amount << UMS_DISK_LBA_SHIFT;
+		// Card read is still running and there's nothing to send. Poll it again.
 	}
 
 	return UMS_RES_IO_ERROR; // No default reply.
@@ -547,11 +789,12 @@ static int _scsi_write(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 	u32 amount_left_to_req, amount_left_to_write;
 	u32 usb_lba_offset, lba_offset;
 	u32 amount;
+	bool fua = false;
 
-	if (ums->lun.ro)
+	if (ums->lun->ro)
 	{
 		ums->set_text(ums->label, "#FF8000 Warn:# Write - Read only! Host notified.");
-		ums->lun.sense_data = SS_WRITE_PROTECTED;
+		ums->lun->sense_data = SS_WRITE_PROTECTED;
 
 		return UMS_RES_INVALID_ARG;
 	}
@@ -562,20 +805,22 @@ static int _scsi_write(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 	{
 		lba_offset = get_array_be_to_le32(&ums->cmnd[2]);
 
-		// We allow DPO and FUA bypass cache bits. We only implement FUA by performing synchronous output.
+		// We allow DPO and FUA bypass cache bits. FUA writes bypass the write cache.
 		if (ums->cmnd[1] & ~0x18)
 		{
-			ums->lun.sense_data = SS_INVALID_FIELD_IN_CDB;
+			ums->lun->sense_data = SS_INVALID_FIELD_IN_CDB;
 
 			return UMS_RES_INVALID_ARG;
 		}
+
+		fua = ums->cmnd[1] & 0x08;
 	}
 
 	// Check that starting LBA is not past the end sector offset.
-	if (lba_offset >= ums->lun.num_sectors)
+	if (lba_offset >= ums->lun->num_sectors)
 	{
 		ums->set_text(ums->label, "#FF8000 Warn:# Write - Out of range! Host notified.");
-		ums->lun.sense_data = SS_LOGICAL_BLOCK_ADDRESS_OUT_OF_RANGE;
+		ums->lun->sense_data = SS_LOGICAL_BLOCK_ADDRESS_OUT_OF_RANGE;
 
 		return UMS_RES_INVALID_ARG;
 	}
@@ -594,12 +839,12 @@ static int _scsi_write(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 			// Limit write to max supported read from EP OUT.
 			amount = MIN(amount_left_to_req, UMS_EP_OUT_MAX_XFER);
 
-			if (usb_lba_offset >= ums->lun.num_sectors)
+			if (usb_lba_offset >= ums->lun->num_sectors)
 			{
 				ums->set_text(ums->label, "#FFDD00 Error:# Write - Past last sector!");
-				ums->lun.sense_data = SS_LOGICAL_BLOCK_ADDRESS_OUT_OF_RANGE;
-				ums->lun.sense_data_info = usb_lba_offset;
-				ums->lun.info_valid = 1;
+				ums->lun->sense_data = SS_LOGICAL_BLOCK_ADDRESS_OUT_OF_RANGE;
+				ums->lun->sense_data_info = usb_lba_offset;
+				ums->lun->info_valid = 1;
 				break;
 			}
 
@@ -620,9 +865,9 @@ static int _scsi_write(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 			// Did something go wrong with the transfer?.
 			if (bulk_ctxt->bulk_out_status != 0)
 			{
-				ums->lun.sense_data = SS_COMMUNICATION_FAILURE;
-				ums->lun.sense_data_info = lba_offset;
-				ums->lun.info_valid = 1;
+				ums->lun->sense_data = SS_COMMUNICATION_FAILURE;
+				ums->lun->sense_data_info = lba_offset;
+				ums->lun->info_valid = 1;
 				s_printf(txt_buf, "#FFDD00 Error:# Write - Comm failure %d!", bulk_ctxt->bulk_out_status);
 				ums->set_text(ums->label, txt_buf);
 				break;
@@ -630,10 +875,10 @@ static int _scsi_write(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 
 			amount = bulk_ctxt->bulk_out_length_actual;
 
-			if ((ums->lun.num_sectors - lba_offset) < (amount >> UMS_DISK_LBA_SHIFT))
+			if ((ums->lun->num_sectors - lba_offset) < (amount >> UMS_DISK_LBA_SHIFT))
 			{
-				DPRINTF("write %X @ %X beyond end %X\n", amount, lba_offset, ums->lun.num_sectors);
-				amount = (ums->lun.num_sectors - lba_offset) << UMS_DISK_LBA_SHIFT;
+				DPRINTF("write %X @ %X beyond end %X\n", amount, lba_offset, ums->lun->num_sectors);
+				amount = (ums->lun->num_sectors - lba_offset) << UMS_DISK_LBA_SHIFT;
 			}
 
 			/*
@@ -648,8 +893,8 @@ static int _scsi_write(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 				goto empty_write;
 
 			// Perform the write.
-			if (!sdmmc_storage_write(ums->lun.storage, ums->lun.offset + lba_offset,
-				amount >> UMS_DISK_LBA_SHIFT, (u8 *)bulk_ctxt->bulk_out_buf))
+			if (!_ums_wcache_write(ums, lba_offset, amount >> UMS_DISK_LBA_SHIFT,
+				(u8 *)bulk_ctxt->bulk_out_buf, fua))
 				amount = 0;
 
 DPRINTF("file write %X @ %X\n", amount, lba_offset);
@@ -657,14 +902,15 @@ DPRINTF("file write %X @ %X\n", amount, lba_offset);
 			lba_offset           += amount >> UMS_DISK_LBA_SHIFT;
 			amount_left_to_write -= amount;
 			ums->residue         -= amount;
+			ums->stats.write_bytes += amount;
 
 			// If an error occurred, report it and its position.
 			if (!amount)
 			{
 				ums->set_text(ums->label, "#FFDD00 Error:# SDMMC Write!");
-				ums->lun.sense_data = SS_WRITE_ERROR;
-				ums->lun.sense_data_info = lba_offset;
-				ums->lun.info_valid = 1;
+				ums->lun->sense_data = SS_WRITE_ERROR;
+				ums->lun->sense_data_info = lba_offset;
+				ums->lun->info_valid = 1;
 				break;
 			}
 
@@ -686,10 +932,10 @@ static int _scsi_verify(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 {
 	// Check that start LBA is past the end sector offset.
 	u32 lba_offset = get_array_be_to_le32(&ums->cmnd[2]);
-	if (lba_offset >= ums->lun.num_sectors)
+	if (lba_offset >= ums->lun->num_sectors)
 	{
 		ums->set_text(ums->label, "#FF8000 Warn:# Verif - Out of range! Host notified.");
-		ums->lun.sense_data = SS_LOGICAL_BLOCK_ADDRESS_OUT_OF_RANGE;
+		ums->lun->sense_data = SS_LOGICAL_BLOCK_ADDRESS_OUT_OF_RANGE;
 
 		return UMS_RES_INVALID_ARG;
 	}
@@ -697,7 +943,7 @@ static int _scsi_verify(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 	// We allow DPO but we don't implement it. Check that nothing else is enabled.
 	if (ums->cmnd[1] & ~0x10)
 	{
-		ums->lun.sense_data = SS_INVALID_FIELD_IN_CDB;
+		ums->lun->sense_data = SS_INVALID_FIELD_IN_CDB;
 
 		return UMS_RES_INVALID_ARG;
 	}
@@ -706,21 +952,32 @@ static int _scsi_verify(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 	if (verification_length == 0)
 		return UMS_RES_IO_ERROR; // No default reply.
 
+	// Verify what is on the storage, so cached writes in the range go first.
+	if (!_ums_wcache_flush_range(ums, lba_offset, verification_length))
+	{
+		ums->set_text(ums->label, "#FFDD00 Error:# SDMMC Write!");
+		ums->lun->sense_data = SS_WRITE_ERROR;
+		ums->lun->sense_data_info = lba_offset;
+		ums->lun->info_valid = 1;
+
+		return UMS_RES_INVALID_ARG;
+	}
+
 	u32 amount;
 	while (verification_length > 0)
 	{
 
 		// Limit to EP buffer size and end sector offset.
 		amount = MIN(verification_length, USB_EP_BUFFER_MAX_SIZE >> UMS_DISK_LBA_SHIFT);
-		amount = MIN(amount, ums->lun.num_sectors - lba_offset);
+		amount = MIN(amount, ums->lun->num_sectors - lba_offset);
 		if (amount == 0) {
-			ums->lun.sense_data = SS_LOGICAL_BLOCK_ADDRESS_OUT_OF_RANGE;
-			ums->lun.sense_data_info = lba_offset;
-			ums->lun.info_valid = 1;
+			ums->lun->sense_data = SS_LOGICAL_BLOCK_ADDRESS_OUT_OF_RANGE;
+			ums->lun->sense_data_info = lba_offset;
+			ums->lun->info_valid = 1;
 			break;
 		}
 
-		if (!sdmmc_storage_read(ums->lun.storage, ums->lun.offset + lba_offset, amount, bulk_ctxt->bulk_in_buf))
+		if (!sdmmc_storage_read(ums->lun->storage, ums->lun->offset + lba_offset, amount, bulk_ctxt->bulk_in_buf))
 			amount = 0;
 
 DPRINTF("File read %X @ %X\n", amount, lba_offset);
@@ -728,9 +985,9 @@ DPRINTF("File read %X @ %X\n", amount, lba_offset);
 		if (!amount)
 		{
 			ums->set_text(ums->label, "#FFDD00 Error:# File verify!");
-			ums->lun.sense_data = SS_UNRECOVERED_READ_ERROR;
-			ums->lun.sense_data_info = lba_offset;
-			ums->lun.info_valid = 1;
+			ums->lun->sense_data = SS_UNRECOVERED_READ_ERROR;
+			ums->lun->sense_data_info = lba_offset;
+			ums->lun->info_valid = 1;
 			break;
 		}
 		lba_offset += amount;
@@ -755,9 +1012,9 @@ static int _scsi_inquiry(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 
 		buf += 4;
 		s_printf((char *)buf, "%04X%s",
-			ums->lun.storage->cid.serial, ums->lun.type == MMC_SD ? " SD " : " eMMC ");
+			ums->lun->storage->cid.serial, ums->lun->type == MMC_SD ? " SD " : " eMMC ");
 
-		switch (ums->lun.partition)
+		switch (ums->lun->partition)
 		{
 		case 0:
 			strcpy((char *)buf + strlen((char *)buf), "RAW");
@@ -781,7 +1038,7 @@ static int _scsi_inquiry(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 	else /* if (ums->cmnd[1] == 0 && ums->cmnd[2] == 0) */ // Standard inquiry.
 	{
 		buf[0] = SCSI_TYPE_DISK;
-		buf[1] = ums->lun.removable ? 0x80 : 0;
+		buf[1] = ums->lun->removable ? 0x80 : 0;
 		buf[2] = 6;  // ANSI INCITS 351-2001 (SPC-2).////////SPC2: 4, SPC4: 6
 		buf[3] = 2;  // SCSI-2 INQUIRY data format.
 		buf[4] = 31; // Additional length.
@@ -793,22 +1050,22 @@ static int _scsi_inquiry(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 
 		// Product ID. Max 16 chars.
 		buf += 8;
-		switch (ums->lun.partition)
+		switch (ums->lun->partition)
 		{
 		case 0:
 			s_printf((char *)buf, "%s", "SD RAW");
 			break;
 		case EMMC_GPP + 1:
 			s_printf((char *)buf, "%s%s",
-				ums->lun.type == MMC_SD ? "SD " : "eMMC ", "GPP");
+				ums->lun->type == MMC_SD ? "SD " : "eMMC ", "GPP");
 			break;
 		case EMMC_BOOT0 + 1:
 			s_printf((char *)buf, "%s%s",
-				ums->lun.type == MMC_SD ? "SD " : "eMMC ", "BOOT0");
+				ums->lun->type == MMC_SD ? "SD " : "eMMC ", "BOOT0");
 			break;
 		case EMMC_BOOT1 + 1:
 			s_printf((char *)buf, "%s%s",
-				ums->lun.type == MMC_SD ? "SD " : "eMMC ", "BOOT1");
+				ums->lun->type == MMC_SD ? "SD " : "eMMC ", "BOOT1");
 			break;
 		}
 
@@ -826,12 +1083,12 @@ static int _scsi_request_sense(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 	u32 sd, sdinfo;
 	int valid;
 
-	sd = ums->lun.sense_data;
-	sdinfo = ums->lun.sense_data_info;
-	valid = ums->lun.info_valid << 7;
-	ums->lun.sense_data = SS_NO_SENSE;
-	ums->lun.sense_data_info = 0;
-	ums->lun.info_valid = 0;
+	sd = ums->lun->sense_data;
+	sdinfo = ums->lun->sense_data_info;
+	valid = ums->lun->info_valid << 7;
+	ums->lun->sense_data = SS_NO_SENSE;
+	ums->lun->sense_data_info = 0;
+	ums->lun->info_valid = 0;
 
 	memset(buf, 0, 18);
 	buf[0]  = valid | 0x70; // Valid, current error.
@@ -853,12 +1110,12 @@ static int _scsi_read_capacity(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 	// Check the PMI and LBA fields.
 	if (pmi > 1 || (pmi == 0 && lba != 0))
 	{
-		ums->lun.sense_data = SS_INVALID_FIELD_IN_CDB;
+		ums->lun->sense_data = SS_INVALID_FIELD_IN_CDB;
 
 		return UMS_RES_INVALID_ARG;
 	}
 
-	put_array_le_to_be32(ums->lun.num_sectors - 1, &buf[0]); // Max logical block.
+	put_array_le_to_be32(ums->lun->num_sectors - 1, &buf[0]); // Max logical block.
 	put_array_le_to_be32(UMS_DISK_LBA_SIZE, &buf[4]);        // Block length.
 
 	return 8;
@@ -876,14 +1133,14 @@ static int _scsi_log_sense(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 
 	if (ums->cmnd[1] & 1)
 	{
-		ums->lun.sense_data = SS_SAVING_PARAMETERS_NOT_SUPPORTED;
+		ums->lun->sense_data = SS_SAVING_PARAMETERS_NOT_SUPPORTED;
 
 		return UMS_RES_INVALID_ARG;
 	}
 
 	if (pc != 1) // Current cumulative values.
 	{
-		ums->lun.sense_data = SS_INVALID_FIELD_IN_CDB;
+		ums->lun->sense_data = SS_INVALID_FIELD_IN_CDB;
 
 		return UMS_RES_INVALID_ARG;
 	}
@@ -925,7 +1182,7 @@ static int _scsi_log_sense(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 	u32 len = buf - buf0;
 	if (!valid_page)
 	{
-		ums->lun.sense_data = SS_INVALID_FIELD_IN_CDB;
+		ums->lun->sense_data = SS_INVALID_FIELD_IN_CDB;
 
 		return UMS_RES_INVALID_ARG;
 	}
@@ -948,14 +1205,14 @@ static int _scsi_mode_sense(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 
 	if ((ums->cmnd[1] & ~0x08) != 0) // Mask away DBD.
 	{
-		ums->lun.sense_data = SS_INVALID_FIELD_IN_CDB;
+		ums->lun->sense_data = SS_INVALID_FIELD_IN_CDB;
 
 		return UMS_RES_INVALID_ARG;
 	}
 
 	if (pc == 3)
 	{
-		ums->lun.sense_data = SS_SAVING_PARAMETERS_NOT_SUPPORTED;
+		ums->lun->sense_data = SS_SAVING_PARAMETERS_NOT_SUPPORTED;
 
 		return UMS_RES_INVALID_ARG;
 	}
@@ -967,12 +1224,12 @@ static int _scsi_mode_sense(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 	memset(buf, 0, 8);
 	if (ums->cmnd[0] == SC_MODE_SENSE_6)
 	{
-		buf[2] = (ums->lun.ro ? 0x80 : 0x00); // WP, DPOFUA.
+		buf[2] = (ums->lun->ro ? 0x80 : 0x00); // WP, DPOFUA.
 		buf += 4;
 	}
 	else // SC_MODE_SENSE_10.
 	{
-		buf[3] = (ums->lun.ro ? 0x80 : 0x00); // WP, DPOFUA.
+		buf[3] = (ums->lun->ro ? 0x80 : 0x00); // WP, DPOFUA.
 		buf += 8;
 	}
 
@@ -988,8 +1245,8 @@ static int _scsi_mode_sense(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 		// None of the fields are changeable.
 		if (!changeable_values)
 		{
-			// Write Cache enable, Read Cache not disabled, Multiplication Factor off.
-			buf[2] = 0x04;
+			// Write Cache enable (if used), Read Cache not disabled, Multiplication Factor off.
+			buf[2] = ums->lun->write_cache ? 0x04 : 0x00;
 
 			// Multiplication Factor is disabled, so all values below are 1x LBA.
 			put_array_le_to_be16(0xFFFF, &buf[4]);  // Disable Prefetch if >32MB.
@@ -1005,7 +1262,7 @@ static int _scsi_mode_sense(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 	u32 len = buf - buf0;
 	if (!valid_page)
 	{
-		ums->lun.sense_data = SS_INVALID_FIELD_IN_CDB;
+		ums->lun->sense_data = SS_INVALID_FIELD_IN_CDB;
 
 		return UMS_RES_INVALID_ARG;
 	}
@@ -1023,16 +1280,16 @@ static int _scsi_start_stop(usbd_gadget_ums_t *ums)
 {
 	int loej, start;
 
-	if (!ums->lun.removable)
+	if (!ums->lun->removable)
 	{
-		ums->lun.sense_data = SS_INVALID_COMMAND;
+		ums->lun->sense_data = SS_INVALID_COMMAND;
 
 		return UMS_RES_INVALID_ARG;
 	}
 	else if ((ums->cmnd[1] & ~0x01) != 0 || // Mask away Immed.
 		(ums->cmnd[4] & ~0x03) != 0)        // Mask LoEj, Start.
 	{
-		ums->lun.sense_data = SS_INVALID_FIELD_IN_CDB;
+		ums->lun->sense_data = SS_INVALID_FIELD_IN_CDB;
 
 		return UMS_RES_INVALID_ARG;
 	}
@@ -1043,9 +1300,9 @@ static int _scsi_start_stop(usbd_gadget_ums_t *ums)
 	// We do not support re-mounting.
 	if (start)
 	{
-		if (ums->lun.unmounted)
+		if (ums->lun->unmounted)
 		{
-			ums->lun.sense_data = SS_MEDIUM_NOT_PRESENT;
+			ums->lun->sense_data = SS_MEDIUM_NOT_PRESENT;
 
 			return UMS_RES_INVALID_ARG;
 		}
@@ -1054,10 +1311,19 @@ static int _scsi_start_stop(usbd_gadget_ums_t *ums)
 	}
 
 	// Check if we are allowed to unload the media.
-	if (ums->lun.prevent_medium_removal)
+	if (ums->lun->prevent_medium_removal)
 	{
 		ums->set_text(ums->label, "#C7EA46 Status:# Unload attempt prevented");
-		ums->lun.sense_data = SS_MEDIUM_REMOVAL_PREVENTED;
+		ums->lun->sense_data = SS_MEDIUM_REMOVAL_PREVENTED;
+
+		return UMS_RES_INVALID_ARG;
+	}
+
+	// Host expects the media to be consistent after a stop.
+	if (!_ums_wcache_flush(ums))
+	{
+		ums->set_text(ums->label, "#FFDD00 Error:# SDMMC Write!");
+		ums->lun->sense_data = SS_WRITE_ERROR;
 
 		return UMS_RES_INVALID_ARG;
 	}
@@ -1066,7 +1332,7 @@ static int _scsi_start_stop(usbd_gadget_ums_t *ums)
 		return UMS_RES_OK;
 
 	// Unmount means we exit UMS because of ejection.
-	ums->lun.unmounted = 1;
+	ums->lun->unmounted = 1;
 
 	return UMS_RES_OK;
 }
@@ -1075,9 +1341,9 @@ static int _scsi_prevent_allow_removal(usbd_gadget_ums_t *ums)
 {
 	int prevent;
 
-	if (!ums->lun.removable)
+	if (!ums->lun->removable)
 	{
-		ums->lun.sense_data = SS_INVALID_COMMAND;
+		ums->lun->sense_data = SS_INVALID_COMMAND;
 
 		return UMS_RES_INVALID_ARG;
 	}
@@ -1085,16 +1351,21 @@ static int _scsi_prevent_allow_removal(usbd_gadget_ums_t *ums)
 	prevent = ums->cmnd[4] & 0x01;
 	if ((ums->cmnd[4] & ~0x01) != 0) // Mask away Prevent.
 	{
-		ums->lun.sense_data = SS_INVALID_FIELD_IN_CDB;
+		ums->lun->sense_data = SS_INVALID_FIELD_IN_CDB;
 
 		return UMS_RES_INVALID_ARG;
 	}
 
-	// Notify for possible unmounting?
-	// Normally we sync here but we do synced writes to SDMMC.
-	if (ums->lun.prevent_medium_removal && !prevent) { /* Do nothing */ }
+	// Sync on possible unmounting.
+	if (ums->lun->prevent_medium_removal && !prevent && !_ums_wcache_flush(ums))
+	{
+		ums->set_text(ums->label, "#FFDD00 Error:# SDMMC Write!");
+		ums->lun->sense_data = SS_WRITE_ERROR;
+
+		return UMS_RES_INVALID_ARG;
+	}
 
-	ums->lun.prevent_medium_removal = prevent;
+	ums->lun->prevent_medium_removal = prevent;
 
 	return UMS_RES_OK;
 }
@@ -1107,7 +1378,7 @@ static int _scsi_read_format_capacities(usbd_gadget_ums_t *ums, bulk_ctxt_t *bul
 	buf[3] = 8; // Only the Current/Maximum Capacity Descriptor.
 	buf += 4;
 
-	put_array_le_to_be32(ums->lun.num_sectors, &buf[0]); // Number of blocks.
+	put_array_le_to_be32(ums->lun->num_sectors, &buf[0]); // Number of blocks.
 	put_array_le_to_be32(UMS_DISK_LBA_SIZE, &buf[4]);    // Block length.
 	buf[4] = 0x02; // Current capacity.
 
@@ -1165,18 +1436,28 @@ DPRINTF("SCSI command: %X;  Dc=%d, D%c=%X;  Hc=%d, H%c=%X\n",
 
 	if (ums->cmnd[0] != SC_REQUEST_SENSE)
 	{
-		ums->lun.sense_data = SS_NO_SENSE;
-		ums->lun.sense_data_info = 0;
-		ums->lun.info_valid = 0;
+		ums->lun->sense_data = SS_NO_SENSE;
+		ums->lun->sense_data_info = 0;
+		ums->lun->info_valid = 0;
 	}
 
 	// If a unit attention condition exists, only INQUIRY and REQUEST SENSE
 	// commands are allowed.
-	if (ums->lun.unit_attention_data != SS_NO_SENSE && ums->cmnd[0] != SC_INQUIRY &&
+	if (ums->lun->unit_attention_data != SS_NO_SENSE && ums->cmnd[0] != SC_INQUIRY &&
 		ums->cmnd[0] != SC_REQUEST_SENSE)
 	{
-		ums->lun.sense_data = ums->lun.unit_attention_data;
-		ums->lun.unit_attention_data = SS_NO_SENSE;
+		ums->lun->sense_data = ums->lun->unit_attention_data;
+		ums->lun->unit_attention_data = SS_NO_SENSE;
+
+		return UMS_RES_INVALID_ARG;
+	}
+
+	// Report a failed background flush of the write cache once, same as a unit attention.
+	if (ums->wcache.error != SS_NO_SENSE && ums->lun->storage == ums->wcache.storage &&
+		ums->cmnd[0] != SC_INQUIRY && ums->cmnd[0] != SC_REQUEST_SENSE)
+	{
+		ums->lun->sense_data = ums->wcache.error;
+		ums->wcache.error = SS_NO_SENSE;
 
 		return UMS_RES_INVALID_ARG;
 	}
@@ -1187,20 +1468,32 @@ DPRINTF("SCSI command: %X;  Dc=%d, D%c=%X;  Hc=%d, H%c=%X\n",
 	{
 		if (ums->cmnd[i] && !(mask & BIT(i)))
 		{
-			ums->lun.sense_data = SS_INVALID_FIELD_IN_CDB;
+			ums->lun->sense_data = SS_INVALID_FIELD_IN_CDB;
 
 			return UMS_RES_INVALID_ARG;
 		}
 	}
 
 	// If the medium isn't mounted and the command needs to access it, return an error.
-	if (ums->lun.unmounted && needs_medium)
+	if (ums->lun->unmounted && needs_medium)
 	{
-		ums->lun.sense_data = SS_MEDIUM_NOT_PRESENT;
+		ums->lun->sense_data = SS_MEDIUM_NOT_PRESENT;
 
 		return UMS_RES_INVALID_ARG;
 	}
 
+	// eMMC luns share the storage, so switch to the lun's hardware partition if needed.
+	if (needs_medium && ums->lun->type == MMC_EMMC && ums->lun->storage->partition != ums->lun->partition - 1)
+	{
+		if (!sdmmc_storage_set_mmc_partition(ums->lun->storage, ums->lun->partition - 1))
+		{
+			ums->set_text(ums->label, "#FFDD00 Error:# eMMC partition switch!");
+			ums->lun->sense_data = SS_COMMUNICATION_FAILURE;
+
+			return UMS_RES_INVALID_ARG;
+		}
+	}
+
 	return UMS_RES_OK;
 }
 
@@ -1237,7 +1530,7 @@ static int _ums_parse_scsi_cmd(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 		if (reply == 0)
 		{
 			// We don't support MODE SELECT.
-			ums->lun.sense_data = SS_INVALID_COMMAND;
+			ums->lun->sense_data = SS_INVALID_COMMAND;
 			reply = UMS_RES_INVALID_ARG;
 		}
 		break;
@@ -1248,7 +1541,7 @@ static int _ums_parse_scsi_cmd(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 		if (reply == 0)
 		{
 			// We don't support MODE SELECT.
-			ums->lun.sense_data = SS_INVALID_COMMAND;
+			ums->lun->sense_data = SS_INVALID_COMMAND;
 			reply = UMS_RES_INVALID_ARG;
 		}
 		break;
@@ -1326,8 +1619,12 @@ static int _ums_parse_scsi_cmd(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 	case SC_SYNCHRONIZE_CACHE:
 		ums->data_size_from_cmnd = 0;
 		reply = _ums_check_scsi_cmd(ums, 10, DATA_DIR_NONE, (0xf<<2) | (3<<7), 1);
-		if (reply == 0)
-			reply = 0; // Don't bother
+		if (reply == 0 && !_ums_wcache_flush(ums))
+		{
+			ums->set_text(ums->label, "#FFDD00 Error:# SDMMC Write!");
+			ums->lun->sense_data = SS_WRITE_ERROR;
+			reply = UMS_RES_INVALID_ARG;
+		}
 		break;
 
 	case SC_TEST_UNIT_READY:
@@ -1377,7 +1674,7 @@ static int _ums_parse_scsi_cmd(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 		reply = _ums_check_scsi_cmd(ums, ums->cmnd_size, DATA_DIR_UNKNOWN, 0xFF, 0);
 		if (reply == 0)
 		{
-			ums->lun.sense_data = SS_INVALID_COMMAND;
+			ums->lun->sense_data = SS_INVALID_COMMAND;
 			reply = UMS_RES_INVALID_ARG;
 		}
 		break;
@@ -1540,18 +1837,38 @@ static int finish_reply(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
  * Line always at SE0.
  */
 
+static bool _ums_luns_unmounted(usbd_gadget_ums_t *ums)
+{
+	for (u32 i = 0; i < ums->lun_cnt; i++)
+		if (!ums->luns[i].unmounted)
+			return false;
+
+	return true;
+}
+
+static bool _ums_luns_removal_prevented(usbd_gadget_ums_t *ums)
+{
+	for (u32 i = 0; i < ums->lun_cnt; i++)
+		if (ums->luns[i].prevent_medium_removal)
+			return true;
+
+	return false;
+}
+
 static int received_cbw(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 {
+	bool unmounted = _ums_luns_unmounted(ums);
+
 	// Was this a real packet?  Should it be ignored?
-	if (bulk_ctxt->bulk_out_status || bulk_ctxt->bulk_out_ignore || ums->lun.unmounted)
+	if (bulk_ctxt->bulk_out_status || bulk_ctxt->bulk_out_ignore || unmounted)
 	{
-		if (bulk_ctxt->bulk_out_status || ums->lun.unmounted)
+		if (bulk_ctxt->bulk_out_status || unmounted)
 		{
 			DPRINTF("USB: EP timeout (%d)\n", bulk_ctxt->bulk_out_status);
 			// In case we disconnected, exit UMS.
 			// Raise timeout if removable and didn't got a unit ready command inside 4s.
 			if (bulk_ctxt->bulk_out_status == USB2_ERROR_XFER_EP_DISABLED ||
-				(bulk_ctxt->bulk_out_status == USB_ERROR_TIMEOUT && ums->lun.removable && !ums->lun.prevent_medium_removal))
+				(bulk_ctxt->bulk_out_status == USB_ERROR_TIMEOUT && ums->lun->removable && !_ums_luns_removal_prevented(ums)))
 			{
 				if (bulk_ctxt->bulk_out_status == USB_ERROR_TIMEOUT)
 				{
@@ -1574,7 +1891,7 @@ static int received_cbw(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 				}
 			}
 
-			if (ums->lun.unmounted)
+			if (unmounted)
 			{
 				ums->set_text(ums->label, "#C7EA46 Status:# Medium unmounted");
 				ums->timeouts++;
@@ -1616,7 +1933,7 @@ static int received_cbw(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 	}
 
 	// Is the CBW meaningful?
-	if (cbw->Lun >= UMS_MAX_LUN || cbw->Flags & ~USB_BULK_IN_FLAG ||
+	if (cbw->Lun >= ums->lun_cnt || cbw->Flags & ~USB_BULK_IN_FLAG ||
 			cbw->Length == 0 || cbw->Length > SCSI_MAX_CMD_SZ)
 	{
 		gfx_printf("USB: non-meaningful CBW: lun = %X, flags = 0x%X, cmdlen %X\n",
@@ -1649,9 +1966,10 @@ static int received_cbw(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 		ums->data_dir = DATA_DIR_NONE;
 
 	ums->lun_idx = cbw->Lun;
+	ums->lun = &ums->luns[cbw->Lun];
 	ums->tag = cbw->Tag;
 
-	if (!ums->lun.unmounted)
+	if (!unmounted)
 		ums->timeouts = 0;
 
 	return UMS_RES_OK;
@@ -1703,7 +2021,7 @@ static int get_next_command(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 static void send_status(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 {
 	u8  status = USB_STATUS_PASS;
-	u32 sd = ums->lun.sense_data;
+	u32 sd = ums->lun->sense_data;
 
 	if (ums->phase_error)
 	{
@@ -1716,7 +2034,7 @@ static void send_status(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 		DPRINTF("USB: CMD fail\n");
 		status = USB_STATUS_FAIL;
 		DPRINTF("USB:   Sense: SK x%02X, ASC x%02X, ASCQ x%02X; info x%X\n",
-			SK(sd), ASC(sd), ASCQ(sd), ums->lun.sense_data_info);
+			SK(sd), ASC(sd), ASCQ(sd), ums->lun->sense_data_info);
 	}
 
 	// Store and send the Bulk-only CSW.
@@ -1749,11 +2067,16 @@ static void handle_exception(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 
 	if (old_state != UMS_STATE_ABORT_BULK_OUT)
 	{
-		ums->lun.prevent_medium_removal = 0;
-		ums->lun.sense_data = SS_NO_SENSE;
-		ums->lun.unit_attention_data = SS_NO_SENSE;
-		ums->lun.sense_data_info = 0;
-		ums->lun.info_valid = 0;
+		for (u32 i = 0; i < ums->lun_cnt; i++)
+		{
+			logical_unit_t *lun = &ums->luns[i];
+
+			lun->prevent_medium_removal = 0;
+			lun->sense_data = SS_NO_SENSE;
+			lun->unit_attention_data = SS_NO_SENSE;
+			lun->sense_data_info = 0;
+			lun->info_valid = 0;
+		}
 	}
 
 	ums->state = UMS_STATE_NORMAL;
@@ -1776,7 +2099,7 @@ static void handle_exception(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 			bulk_ctxt->bulk_out_ignore = 0;
 			ums_clear_stall(bulk_ctxt->bulk_in);
 		}
-		ums->lun.unit_attention_data = SS_RESET_OCCURRED;
+		ums->lun->unit_attention_data = SS_RESET_OCCURRED;
 		break;
 
 	case UMS_STATE_EXIT:
@@ -1788,6 +2111,54 @@ static void handle_exception(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 	}
 }
 
+static void _ums_set_text(void *label, const char *text)
+{
+	// Errors and warnings stay on the label until another status replaces them.
+	ums_label_error = !strncmp(text, "#FFDD00", 7) || !strncmp(text, "#FF8000", 7);
+	ums_label_set_text(label, text);
+}
+
+static void _ums_update_stats(usbd_gadget_ums_t *ums)
+{
+	static char txt_buf[128];
+
+	u32 time = get_tmr_ms();
+	u32 elapsed = time - ums->stats.timer;
+	if (elapsed < UMS_STATS_UPDATE_MS)
+		return;
+
+	// Show throughput only if there was disk activity and no error is shown.
+	if ((ums->stats.read_bytes || ums->stats.write_bytes) && !ums_label_error)
+	{
+		// Rates in KB/s.
+		u32 read_rate  = (u64)ums->stats.read_bytes  * 1000 / elapsed / 1024;
+		u32 write_rate = (u64)ums->stats.write_bytes * 1000 / elapsed / 1024;
+
+		s_printf(txt_buf, "#C7EA46 Status:# Read %d.%02d MB/s, Write %d.%02d MB/s",
+			read_rate / 1024, (read_rate % 1024) * 100 / 1024, write_rate / 1024, (write_rate % 1024) * 100 / 1024);
+		ums->set_text(ums->label, txt_buf);
+	}
+
+	ums->stats.read_bytes = 0;
+	ums->stats.write_bytes = 0;
+	ums->stats.timer = get_tmr_ms();
+}
+
+static void _ums_wcache_idle_flush(usbd_gadget_ums_t *ums)
+{
+	// Flush if host stopped writing, in case the cable gets pulled without ejecting.
+	if (ums->wcache.end && (get_tmr_ms() - ums->wcache.timer) >= UMS_WCACHE_IDLE_MS)
+	{
+		if (!_ums_wcache_flush(ums))
+		{
+			// Data stays cached. Let the host know and retry after another idle period.
+			ums->set_text(ums->label, "#FFDD00 Error:# SDMMC Write!");
+			ums->wcache.error = SS_WRITE_ERROR;
+			ums->wcache.timer = get_tmr_ms();
+		}
+	}
+}
+
 static inline void _system_maintainance(usbd_gadget_ums_t *ums)
 {
 	static u32 timer_dram = 0;
@@ -1839,35 +2210,60 @@ int usb_device_gadget_ums(usb_ctxt_t *usbs)
 	ums.bulk_ctxt.bulk_out_buf = (u8 *)USB_EP_BULK_OUT_BUF_ADDR;
 
 	// Set LUN parameters.
-	ums.lun.ro = usbs->ro;
-	ums.lun.type = usbs->type;
-	ums.lun.partition = usbs->partition;
-	ums.lun.offset = usbs->offset;
-	ums.lun.removable = 1; // Always removable to force OSes to use prevent media removal.
-	ums.lun.unit_attention_data = SS_RESET_OCCURRED;
+	ums.lun_cnt = MIN(MAX(usbs->lun_cnt, 1), UMS_MAX_LUN);
+	ums.lun = &ums.luns[0];
+	for (u32 i = 0; i < ums.lun_cnt; i++)
+	{
+		logical_unit_t *lun = &ums.luns[i];
+
+		lun->ro = usbs->luns[i].ro;
+		lun->type = usbs->luns[i].type;
+		lun->partition = usbs->luns[i].partition;
+		lun->offset = usbs->luns[i].offset;
+		lun->write_cache = usbs->luns[i].write_cache;
+		lun->removable = 1; // Always removable to force OSes to use prevent media removal.
+		lun->unit_attention_data = SS_RESET_OCCURRED;
+	}
 
 	// Set system functions
 	ums.label = usbs->label;
-	ums.set_text = usbs->set_text;
+	ums.set_text = _ums_set_text;
+	ums_label_set_text = usbs->set_text;
+	ums_label_error = false;
 	ums.system_maintenance = usbs->system_maintenance;
 
 	ums.set_text(ums.label, "#C7EA46 Status:# Mounting disk");
 
-	// Initialize sdmmc.
-	if (usbs->type == MMC_SD)
+	// Initialize sdmmc. Each storage is initialized once and shared by its luns.
+	bool sd_init = false;
+	bool emmc_init = false;
+	for (u32 i = 0; i < ums.lun_cnt; i++)
 	{
-		sd_end();
-		sd_mount();
-		sd_unmount();
-		ums.lun.sdmmc = &sd_sdmmc;
-		ums.lun.storage = &sd_storage;
-	}
-	else
-	{
-		ums.lun.sdmmc = &emmc_sdmmc;
-		ums.lun.storage = &emmc_storage;
-		emmc_initialize(false);
-		sdmmc_storage_set_mmc_partition(ums.lun.storage, ums.lun.partition - 1);
+		logical_unit_t *lun = &ums.luns[i];
+
+		if (lun->type == MMC_SD)
+		{
+			if (!sd_init)
+			{
+				sd_end();
+				sd_mount();
+				sd_unmount();
+				sd_init = true;
+			}
+			lun->sdmmc = &sd_sdmmc;
+			lun->storage = &sd_storage;
+		}
+		else
+		{
+			if (!emmc_init)
+			{
+				emmc_initialize(false);
+				emmc_init = true;
+			}
+			lun->sdmmc = &emmc_sdmmc;
+			lun->storage = &emmc_storage;
+			sdmmc_storage_set_mmc_partition(lun->storage, lun->partition - 1);
+		}
 	}
 
 	ums.set_text(ums.label, "#C7EA46 Status:# Waiting for connection");
@@ -1878,26 +2274,37 @@ int usb_device_gadget_ums(usb_ctxt_t *usbs)
 
 	ums.set_text(ums.label, "#C7EA46 Status:# Waiting for LUN");
 
-	if (usb_ops.usb_device_class_send_max_lun(0)) // One device for now.
+	if (usb_ops.usb_device_class_send_max_lun(ums.lun_cnt - 1))
 		goto error;
 
 	ums.set_text(ums.label, "#C7EA46 Status:# Started UMS");
 
-	if (usbs->sectors)
-		ums.lun.num_sectors = usbs->sectors;
-	else
-		ums.lun.num_sectors = ums.lun.storage->sec_cnt;
+	for (u32 i = 0; i < ums.lun_cnt; i++)
+	{
+		logical_unit_t *lun = &ums.luns[i];
+
+		if (usbs->luns[i].sectors)
+			lun->num_sectors = usbs->luns[i].sectors;
+		else
+			lun->num_sectors = lun->storage->sec_cnt;
+	}
+
+	_ums_wcache_init(&ums);
+
+	ums.stats.timer = get_tmr_ms();
 
 	do
 	{
 		// Do DRAM training and update system tasks.
 		_system_maintainance(&ums);
+		_ums_update_stats(&ums);
+		_ums_wcache_idle_flush(&ums);
 
 		// Check for force unmount button combo.
 		if (btn_read_vol() == (BTN_VOL_UP | BTN_VOL_DOWN))
 		{
 			// Check if we are allowed to unload the media.
-			if (ums.lun.prevent_medium_removal)
+			if (_ums_luns_removal_prevented(&ums))
 				ums.set_text(ums.label, "#C7EA46 Status:# Unload attempt prevented");
 			else
 				break;
@@ -1927,7 +2334,7 @@ int usb_device_gadget_ums(usb_ctxt_t *usbs)
 		send_status(&ums, &ums.bulk_ctxt);
 	} while (ums.state != UMS_STATE_TERMINATED);
 
-	if (ums.lun.prevent_medium_removal)
+	if (_ums_luns_removal_prevented(&ums))
 		ums.set_text(ums.label, "#FFDD00 Error:# Disk unsafely ejected");
 	else
 		ums.set_text(ums.label, "#C7EA46 Status:# Disk ejected");
@@ -1938,8 +2345,18 @@ error:
 	res = 1;
 
 exit:
-	if (ums.lun.type == MMC_EMMC)
-		sdmmc_storage_end(ums.lun.storage);
+	// Write out any cached data before storage gets powered off.
+	if (!_ums_wcache_flush(&ums))
+		ums.set_text(ums.label, "#FFDD00 Error:# SDMMC Write!");
+
+	for (u32 i = 0; i < ums.lun_cnt; i++)
+	{
+		if (ums.luns[i].type == MMC_EMMC)
+		{
+			sdmmc_storage_end(ums.luns[i].storage);
+			break;
+		}
+	}
 
 	usb_ops.usbd_end(true, false);
 
@@ -1548,6 +1548,11 @@ int usb_device_ep1_in_writing_finish(u32 *pending_bytes, u32 sync_timeout)
 	return USB_ERROR_XFER_ERROR;
 }
 
+bool usb_device_ep1_in_writing_busy()
+{
+	return _usbd_get_ep1_status(USB_DIR_IN) == USB_EP_STATUS_ACTIVE;
+}
+
 bool usb_device_get_suspended()
 {
 	bool suspended = (usbd_otg->regs->portsc1 & USB2D_PORTSC1_SUSP) == USB2D_PORTSC1_SUSP;
@@ -1611,5 +1616,6 @@ void usb_device_get_ops(usb_ops_t *ops)
 	ops->usb_device_ep1_out_reading_finish = usb_device_ep1_out_reading_finish;
 	ops->usb_device_ep1_in_write           = usb_device_ep1_in_write;
 	ops->usb_device_ep1_in_writing_finish  = usb_device_ep1_in_writing_finish;
+	ops->usb_device_ep1_in_writing_busy    = usb_device_ep1_in_writing_busy;
 }
 
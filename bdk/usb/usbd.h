@@ -37,6 +37,8 @@
 #define USB_XFER_SYNCED_CLASS 5000000
 #define USB_XFER_SYNCED       -1
 
+#define USB_UMS_MAX_LUN 4 // SD and eMMC GPP, BOOT0, BOOT1.
+
 typedef enum _usb_hid_type
 {
 	USB_HID_GAMEPAD,
@@ -179,17 +181,26 @@ typedef struct _usb_ops_t
 	int  (*usb_device_ep1_out_reading_finish)(u32 *, u32);
 	int  (*usb_device_ep1_in_write)(u8 *, u32, u32 *, u32);
 	int  (*usb_device_ep1_in_writing_finish)(u32 *, u32);
+	bool (*usb_device_ep1_in_writing_busy)();
 	bool (*usb_device_get_suspended)();
 	bool (*usb_device_get_port_in_sleep)();
 } usb_ops_t;
 
-typedef struct _usb_ctxt_t
+typedef struct _usb_lun_ctxt_t
 {
 	u32 type;
 	u32 partition;
 	u32 offset;
 	u32 sectors;
 	u32 ro;
+	u32 write_cache;
+} usb_lun_ctxt_t;
+
+typedef struct _usb_ctxt_t
+{
+	u32 type; // HID type.
+	u32 lun_cnt;
+	usb_lun_ctxt_t luns[USB_UMS_MAX_LUN];
 	void (*system_maintenance)(bool);
 	void *label;
 	void (*set_text)(void *, const char *);
@@ -2120,6 +2120,15 @@ int xusb_device_ep1_in_writing_finish(u32 *pending_bytes, u32 sync_tries)
 	return res;
 }
 
+bool xusb_device_ep1_in_writing_busy()
+{
+	// Process any pending event without waiting.
+	if (usbd_xotg->tx_count[USB_DIR_IN])
+		_xusb_ep_operation(1);
+
+	return usbd_xotg->tx_count[USB_DIR_IN];
+}
+
 bool xusb_device_get_port_in_sleep()
 {
 	// Ejection heuristic.
@@ -2184,4 +2193,5 @@ void xusb_device_get_ops(usb_ops_t *ops)
 	ops->usb_device_ep1_out_reading_finish = xusb_device_ep1_out_reading_finish;
 	ops->usb_device_ep1_in_write           = xusb_device_ep1_in_write;
 	ops->usb_device_ep1_in_writing_finish  = xusb_device_ep1_in_writing_finish;
+	ops->usb_device_ep1_in_writing_busy    = xusb_device_ep1_in_writing_busy;
 }
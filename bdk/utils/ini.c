@@ -23,6 +23,45 @@
 #include <utils/dirlist.h>
 #include <utils/util.h>
 
+#define INI_SNAP_MAGIC   0x494E4948 // HINI.
+#define INI_SNAP_VERSION 1
+#define INI_SNAP_MAX_SIZE SZ_1M
+#define INI_FNV_BASIS    0x811C9DC5
+#define INI_FNV_PRIME    0x01000193
+
+/*
+ * Compiled ini snapshot. One flat blob, loaded with a single read:
+ *   ini_snap_hdr_t
+ *   ini_sec_t[sec_cnt] - name as string offset, kvs.prev/next as kv index/count.
+ *   ini_kv_t[kv_cnt]   - key/val as string offsets.
+ *   u16[hash_mask + 1] - Open addressing name hash of choice sections (index + 1).
+ *   char[]             - String table.
+ */
+typedef struct _ini_snap_hdr_t
+{
+	u32 magic;
+	u32 version;
+	u32 src_sig;
+	u32 size;
+	u32 sec_cnt;
+	u32 kv_cnt;
+	u32 hash_mask;
+	u32 kv_off;
+	u32 hash_off;
+	u32 str_off;
+} ini_snap_hdr_t;
+
+typedef struct _ini_snap_t
+{
+	link_t link;
+	ini_snap_hdr_t *hdr;
+	ini_sec_t *secs;
+	u16 *hash;
+	bool release;
+} ini_snap_t;
+
+LIST_INIT_STATIC(ini_snaps);
+
 u32 _find_section_name(char *lbuf, u32 lblen, char schar)
 {
 	u32 i;
@@ -53,7 +92,7 @@ ini_sec_t *_ini_create_section(link_t *dst, ini_sec_t *csec, char *name, u8 type
 	return csec;
 }
 
-int ini_parse(link_t *dst, char *ini_path, bool is_dir)
+static int _ini_parse_text(link_t *dst, char *ini_path, bool is_dir)
 {
 	FIL fp;
 	u32 lblen;
@@ -173,6 +212,476 @@ int ini_parse(link_t *dst, char *ini_path, bool is_dir)
 	return 1;
 }
 
+static u32 _ini_hash(u32 hash, const void *data, u32 size)
+{
+	const u8 *buf = (const u8 *)data;
+
+	// FNV-1a.
+	for (u32 i = 0; i < size; i++)
+	{
+		hash ^= buf[i];
+		hash *= INI_FNV_PRIME;
+	}
+
+	return hash;
+}
+
+static u32 _ini_hash_fno(u32 hash, FILINFO *fno)
+{
+	u32 size = fno->fsize;
+
+	hash = _ini_hash(hash, fno->fname, strlen(fno->fname));
+	hash = _ini_hash(hash, &size, sizeof(u32));
+	hash = _ini_hash(hash, &fno->fdate, sizeof(u16));
+	hash = _ini_hash(hash, &fno->ftime, sizeof(u16));
+
+	return hash;
+}
+
+static u32 _ini_src_sig(char *ini_path, bool is_dir)
+{
+	DIR dir;
+	FILINFO fno;
+	u32 files = 0;
+	u32 sig = _ini_hash(INI_FNV_BASIS, ini_path, strlen(ini_path));
+
+	if (!is_dir)
+	{
+		if (f_stat(ini_path, &fno))
+			return 0;
+
+		return _ini_hash_fno(sig, &fno);
+	}
+
+	// Use the same filter as the text parser's file list.
+	if (f_findfirst(&dir, &fno, ini_path, "*.ini") || !fno.fname[0])
+		return 0;
+
+	do
+	{
+		if (!(fno.fattrib & AM_DIR) && (fno.fname[0] != '.') && !(fno.fattrib & AM_HID))
+		{
+			sig = _ini_hash_fno(sig, &fno);
+			files++;
+		}
+	} while (!f_findnext(&dir, &fno) && fno.fname[0]);
+	f_closedir(&dir);
+
+	return files ? sig : 0;
+}
+
+static void _ini_snap_path(char *path, const char *ini_path)
+{
+	u32 hash = _ini_hash(INI_FNV_BASIS, ini_path, strlen(ini_path));
+
+	strcpy(path, INI_CACHE_DIR "/");
+	path += strlen(path);
+
+	for (int i = 28; i >= 0; i -= 4)
+	{
+		u32 nibble = (hash >> i) & 0xF;
+		*path++ = nibble < 10 ? '0' + nibble : 'A' + nibble - 10;
+	}
+
+	strcpy(path, ".bin");
+}
+
+static ini_snap_t *_ini_snap_build(link_t *src, u32 sig)
+{
+	u32 sec_cnt = 0;
+	u32 kv_cnt = 0;
+	u32 str_size = 0;
+
+	// Calculate blob size.
+	LIST_FOREACH_ENTRY(ini_sec_t, ini_sec, src, link)
+	{
+		sec_cnt++;
+		if (ini_sec->name)
+			str_size += strlen(ini_sec->name) + 1;
+
+		LIST_FOREACH_ENTRY(ini_kv_t, kv, &ini_sec->kvs, link)
+		{
+			kv_cnt++;
+			str_size += strlen(kv->key) + 1 + strlen(kv->val) + 1;
+		}
+	}
+
+	// Hash entries are 16-bit.
+	if (sec_cnt >= 0xFFFF)
+		return NULL;
+
+	// Keep hash table at most half full.
+	u32 hash_cnt = 8;
+	while (hash_cnt < sec_cnt * 2)
+		hash_cnt <<= 1;
+
+	u32 kv_off   = sizeof(ini_snap_hdr_t) + sec_cnt * sizeof(ini_sec_t);
+	u32 hash_off = kv_off + kv_cnt * sizeof(ini_kv_t);
+	u32 str_off  = hash_off + hash_cnt * sizeof(u16);
+	u32 size     = ALIGN(str_off + str_size, 4);
+
+	ini_snap_t *snap = (ini_snap_t *)calloc(sizeof(ini_snap_t) + size, 1);
+	ini_snap_hdr_t *hdr = (ini_snap_hdr_t *)(snap + 1);
+	u8 *base = (u8 *)hdr;
+
+	snap->hdr = hdr;
+
+	hdr->magic     = INI_SNAP_MAGIC;
+	hdr->version   = INI_SNAP_VERSION;
+	hdr->src_sig   = sig;
+	hdr->size      = size;
+	hdr->sec_cnt   = sec_cnt;
+	hdr->kv_cnt    = kv_cnt;
+	hdr->hash_mask = hash_cnt - 1;
+	hdr->kv_off    = kv_off;
+	hdr->hash_off  = hash_off;
+	hdr->str_off   = str_off;
+
+	ini_sec_t *secs = (ini_sec_t *)(hdr + 1);
+	ini_kv_t  *kvs  = (ini_kv_t *)(base + kv_off);
+	u16       *hash = (u16 *)(base + hash_off);
+	u32 str_pos = str_off;
+	u32 sec_idx = 0;
+	u32 kv_idx = 0;
+
+	LIST_FOREACH_ENTRY(ini_sec_t, ini_sec, src, link)
+	{
+		ini_sec_t *sec = &secs[sec_idx];
+
+		sec->type  = ini_sec->type;
+		sec->color = ini_sec->color;
+		sec->kvs.prev = (link_t *)kv_idx;
+
+		if (ini_sec->name)
+		{
+			sec->name = (char *)str_pos;
+			strcpy((char *)base + str_pos, ini_sec->name);
+			str_pos += strlen(ini_sec->name) + 1;
+
+			// Index choice sections by name. First one wins, same as a list walk.
+			if (sec->type == INI_CHOICE)
+			{
+				u32 h = _ini_hash(INI_FNV_BASIS, ini_sec->name, strlen(ini_sec->name)) & hdr->hash_mask;
+				while (hash[h] && strcmp((char *)base + (u32)secs[hash[h] - 1].name, ini_sec->name))
+					h = (h + 1) & hdr->hash_mask;
+
+				if (!hash[h])
+					hash[h] = sec_idx + 1;
+			}
+		}
+
+		LIST_FOREACH_ENTRY(ini_kv_t, kv, &ini_sec->kvs, link)
+		{
+			kvs[kv_idx].key = (char *)str_pos;
+			strcpy((char *)base + str_pos, kv->key);
+			str_pos += strlen(kv->key) + 1;
+
+			kvs[kv_idx].val = (char *)str_pos;
+			strcpy((char *)base + str_pos, kv->val);
+			str_pos += strlen(kv->val) + 1;
+
+			kv_idx++;
+		}
+
+		sec->kvs.next = (link_t *)(kv_idx - (u32)sec->kvs.prev);
+		sec_idx++;
+	}
+
+	return snap;
+}
+
+static void _ini_snap_save(const char *snap_path, ini_snap_t *snap)
+{
+	FIL fp;
+
+	f_mkdir(INI_CACHE_DIR);
+	if (f_open(&fp, snap_path, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+		return;
+
+	if (f_write(&fp, snap->hdr, snap->hdr->size, NULL) != FR_OK)
+	{
+		f_close(&fp);
+		f_unlink(snap_path);
+
+		return;
+	}
+
+	f_close(&fp);
+}
+
+static bool _ini_snap_str_valid(const ini_snap_hdr_t *hdr, u32 str)
+{
+	// String table ends with a NUL, so any offset inside it is terminated.
+	return str >= hdr->str_off && str < hdr->size;
+}
+
+static bool _ini_snap_valid(const ini_snap_hdr_t *hdr, u32 size, u32 sig)
+{
+	const u8 *base = (const u8 *)hdr;
+
+	// Check header. Counts are bounded by size first, so the layout math can't overflow.
+	if (hdr->magic   != INI_SNAP_MAGIC   ||
+		hdr->version != INI_SNAP_VERSION ||
+		hdr->src_sig != sig              ||
+		hdr->size    != size             ||
+		hdr->sec_cnt >= 0xFFFF           ||
+		hdr->kv_cnt  > size / sizeof(ini_kv_t) ||
+		hdr->hash_mask >= size / sizeof(u16)  ||
+		hdr->hash_mask < hdr->sec_cnt          ||
+		(hdr->hash_mask & (hdr->hash_mask + 1)))
+		return false;
+
+	if (hdr->kv_off   != sizeof(ini_snap_hdr_t) + hdr->sec_cnt * sizeof(ini_sec_t) ||
+		hdr->hash_off != hdr->kv_off + hdr->kv_cnt * sizeof(ini_kv_t) ||
+		hdr->str_off  != hdr->hash_off + (hdr->hash_mask + 1) * sizeof(u16) ||
+		hdr->str_off  > size ||
+		(hdr->str_off < size && base[size - 1]))
+		return false;
+
+	// Sections must own consecutive key/value ranges that cover the whole kv table.
+	const ini_sec_t *secs = (const ini_sec_t *)(hdr + 1);
+	const ini_kv_t  *kvs  = (const ini_kv_t *)(base + hdr->kv_off);
+	u32 kv_idx = 0;
+	for (u32 i = 0; i < hdr->sec_cnt; i++)
+	{
+		const ini_sec_t *sec = &secs[i];
+		u32 kv_cnt = (u32)sec->kvs.next;
+
+		if ((u32)sec->kvs.prev != kv_idx || kv_cnt > hdr->kv_cnt - kv_idx)
+			return false;
+
+		if (sec->name && !_ini_snap_str_valid(hdr, (u32)sec->name))
+			return false;
+
+		kv_idx += kv_cnt;
+	}
+
+	if (kv_idx != hdr->kv_cnt)
+		return false;
+
+	for (u32 i = 0; i < hdr->kv_cnt; i++)
+	{
+		if (!_ini_snap_str_valid(hdr, (u32)kvs[i].key) || !_ini_snap_str_valid(hdr, (u32)kvs[i].val))
+			return false;
+	}
+
+	// Hash must point to named sections and keep a free slot, so probing ends.
+	const u16 *hash = (const u16 *)(base + hdr->hash_off);
+	u32 used = 0;
+	for (u32 i = 0; i <= hdr->hash_mask; i++)
+	{
+		if (!hash[i])
+			continue;
+
+		if (hash[i] > hdr->sec_cnt || !secs[hash[i] - 1].name)
+			return false;
+
+		used++;
+	}
+
+	return used <= hdr->hash_mask;
+}
+
+static ini_snap_t *_ini_snap_load(const char *snap_path, u32 sig)
+{
+	FIL fp;
+
+	if (f_open(&fp, snap_path, FA_READ) != FR_OK)
+		return NULL;
+
+	u32 size = f_size(&fp);
+	if (size < sizeof(ini_snap_hdr_t) || size > INI_SNAP_MAX_SIZE)
+	{
+		f_close(&fp);
+
+		return NULL;
+	}
+
+	ini_snap_t *snap = (ini_snap_t *)malloc(sizeof(ini_snap_t) + size);
+	ini_snap_hdr_t *hdr = (ini_snap_hdr_t *)(snap + 1);
+
+	int res = f_read(&fp, hdr, size, NULL);
+	f_close(&fp);
+
+	// Validate snapshot and check that it matches the source files. Caller parses the ini on failure.
+	if (res != FR_OK || !_ini_snap_valid(hdr, size, sig))
+	{
+		free(snap);
+
+		return NULL;
+	}
+
+	snap->hdr = hdr;
+
+	return snap;
+}
+
+static void _ini_snap_attach(link_t *dst, ini_snap_t *snap)
+{
+	ini_snap_hdr_t *hdr = (ini_snap_hdr_t *)(snap + 1);
+	u8 *base = (u8 *)hdr;
+	ini_kv_t *kvs = (ini_kv_t *)(base + hdr->kv_off);
+
+	snap->hdr  = hdr;
+	snap->secs = (ini_sec_t *)(hdr + 1);
+	snap->hash = (u16 *)(base + hdr->hash_off);
+	snap->release = false;
+
+	// Relocate offsets and link sections and keys.
+	for (u32 i = 0; i < hdr->sec_cnt; i++)
+	{
+		ini_sec_t *sec = &snap->secs[i];
+		u32 kv_idx = (u32)sec->kvs.prev;
+		u32 kv_cnt = (u32)sec->kvs.next;
+
+		sec->name = sec->name ? (char *)base + (u32)sec->name : NULL;
+
+		list_init(&sec->kvs);
+		for (u32 j = 0; j < kv_cnt; j++)
+		{
+			ini_kv_t *kv = &kvs[kv_idx + j];
+			kv->key = (char *)base + (u32)kv->key;
+			kv->val = (char *)base + (u32)kv->val;
+			list_append(&sec->kvs, &kv->link);
+		}
+
+		list_append(dst, &sec->link);
+	}
+
+	list_append(&ini_snaps, &snap->link);
+}
+
+static ini_snap_t *_ini_snap_find(void *ptr)
+{
+	LIST_FOREACH_ENTRY(ini_snap_t, snap, &ini_snaps, link)
+	{
+		if ((u8 *)ptr >= (u8 *)snap->hdr && (u8 *)ptr < (u8 *)snap->hdr + snap->hdr->size)
+			return snap;
+	}
+
+	return NULL;
+}
+
+static ini_snap_t *_ini_snap_get(link_t *src)
+{
+	if (list_empty(src))
+		return NULL;
+
+	ini_sec_t *first = CONTAINER_OF(src->next, ini_sec_t, link);
+	ini_sec_t *last  = CONTAINER_OF(src->prev, ini_sec_t, link);
+	ini_snap_t *snap = _ini_snap_find(first);
+
+	// Index can only be used if the list is exactly one snapshot.
+	if (snap && first == &snap->secs[0] && last == &snap->secs[snap->hdr->sec_cnt - 1])
+		return snap;
+
+	return NULL;
+}
+
+int ini_parse(link_t *dst, char *ini_path, bool is_dir)
+{
+	char snap_path[64];
+
+	// Parse as text if source can't be identified.
+	u32 sig = _ini_src_sig(ini_path, is_dir);
+	if (!sig)
+		return _ini_parse_text(dst, ini_path, is_dir);
+
+	// Load snapshot or compile a new one if source changed.
+	_ini_snap_path(snap_path, ini_path);
+	ini_snap_t *snap = _ini_snap_load(snap_path, sig);
+	if (!snap)
+	{
+		LIST_INIT(ini_text);
+		if (!_ini_parse_text(&ini_text, ini_path, is_dir))
+		{
+			ini_free(&ini_text);
+
+			return 0;
+		}
+
+		snap = _ini_snap_build(&ini_text, sig);
+		if (!snap)
+		{
+			// Too big for a snapshot. Hand over the parsed list.
+			LIST_FOREACH_SAFE(iter, &ini_text)
+			{
+				list_remove(iter);
+				list_append(dst, iter);
+			}
+
+			return 1;
+		}
+
+		ini_free(&ini_text);
+		_ini_snap_save(snap_path, snap);
+	}
+
+	// Nothing to attach.
+	if (!snap->hdr->sec_cnt)
+	{
+		free(snap);
+
+		return 1;
+	}
+
+	_ini_snap_attach(dst, snap);
+
+	return 1;
+}
+
+void ini_invalidate(const char *ini_path)
+{
+	char snap_path[64];
+
+	_ini_snap_path(snap_path, ini_path);
+	f_unlink(snap_path);
+}
+
+ini_sec_t *ini_get_section(link_t *src, u32 idx)
+{
+	ini_snap_t *snap = _ini_snap_get(src);
+	if (snap)
+		return idx < snap->hdr->sec_cnt ? &snap->secs[idx] : NULL;
+
+	u32 i = 0;
+	LIST_FOREACH_ENTRY(ini_sec_t, ini_sec, src, link)
+	{
+		if (i == idx)
+			return ini_sec;
+		i++;
+	}
+
+	return NULL;
+}
+
+ini_sec_t *ini_find_section(link_t *src, const char *name)
+{
+	ini_snap_t *snap = _ini_snap_get(src);
+	if (snap)
+	{
+		u32 mask = snap->hdr->hash_mask;
+		u32 h = _ini_hash(INI_FNV_BASIS, name, strlen(name)) & mask;
+
+		for (; snap->hash[h]; h = (h + 1) & mask)
+		{
+			ini_sec_t *ini_sec = &snap->secs[snap->hash[h] - 1];
+			if (!strcmp(ini_sec->name, name))
+				return ini_sec;
+		}
+
+		return NULL;
+	}
+
+	LIST_FOREACH_ENTRY(ini_sec_t, ini_sec, src, link)
+	{
+		if (ini_sec->type == INI_CHOICE && !strcmp(ini_sec->name, name))
+			return ini_sec;
+	}
+
+	return NULL;
+}
+
 char *ini_check_payload_section(ini_sec_t *cfg)
 {
 	if (cfg == NULL)
@@ -196,6 +705,14 @@ void ini_free(link_t *src)
 	{
 		ini_kv_t *prev_kv  = NULL;
 
+		// Snapshot sections are freed with their blob.
+		ini_snap_t *snap = _ini_snap_find(ini_sec);
+		if (snap)
+		{
+			snap->release = true;
+			continue;
+		}
+
 		// Free all ini key allocations if they exist.
 		LIST_FOREACH_ENTRY(ini_kv_t, kv, &ini_sec->kvs, link)
 		{
@@ -222,4 +739,15 @@ void ini_free(link_t *src)
 	// Free last section.
 	if (prev_sec)
 		free(prev_sec);
+
+	// Free released snapshots.
+	LIST_FOREACH_SAFE(iter, &ini_snaps)
+	{
+		ini_snap_t *snap = CONTAINER_OF(iter, ini_snap_t, link);
+		if (snap->release)
+		{
+			list_remove(iter);
+			free(snap);
+		}
+	}
 }
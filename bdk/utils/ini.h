@@ -27,6 +27,8 @@
 #define INI_NEWLINE 0xFE
 #define INI_COMMENT 0xFF
 
+#define INI_CACHE_DIR "bootloader/sys/inicache"
+
 typedef struct _ini_kv_t
 {
 	char *key;
@@ -44,6 +46,9 @@ typedef struct _ini_sec_t
 } ini_sec_t;
 
 int   ini_parse(link_t *dst, char *ini_path, bool is_dir);
+void  ini_invalidate(const char *ini_path);
+ini_sec_t *ini_get_section(link_t *src, u32 idx);
+ini_sec_t *ini_find_section(link_t *src, const char *name);
 char *ini_check_payload_section(ini_sec_t *cfg);
 void  ini_free(link_t *src);
 
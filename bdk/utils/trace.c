@@ -0,0 +1,180 @@
+/*
+ * Boot phase tracing.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+
+#include <mem/heap.h>
+#include <soc/timer.h>
+#include <storage/sd.h>
+#include <utils/trace.h>
+
+#define TRACE_DUMP_EVENT_SZ 128
+
+typedef struct _trace_buf_t
+{
+	trace_hdr_t hdr;
+	trace_event_t events[];
+} trace_buf_t;
+
+static trace_buf_t *trace = (trace_buf_t *)BOOT_TRACE_ADDR;
+
+void trace_init()
+{
+	u32 now = get_tmr_us();
+
+	// Reset ring if invalid or left over from a previous power on.
+	if (trace->hdr.magic != TRACE_MAGIC || trace->hdr.last_us > now)
+	{
+		memset(trace, 0, BOOT_TRACE_SZ);
+		trace->hdr.magic = TRACE_MAGIC;
+	}
+
+	trace->hdr.last_us = now;
+	trace->hdr.runs++;
+}
+
+static trace_event_t *_trace_new_event(const char *name, u32 now)
+{
+	u32 seq = trace->hdr.seq++;
+	trace_event_t *ev = &trace->events[seq % TRACE_MAX_EVENTS];
+
+	strncpy(ev->name, name, TRACE_NAME_LEN - 1);
+	ev->name[TRACE_NAME_LEN - 1] = 0;
+	ev->seq   = seq;
+	ev->start = now;
+	ev->dur   = TRACE_DUR_OPEN;
+
+	trace->hdr.last_us = now;
+
+	return ev;
+}
+
+u32 trace_begin(const char *name)
+{
+	if (trace->hdr.magic != TRACE_MAGIC)
+		return 0;
+
+	return _trace_new_event(name, get_tmr_us())->seq;
+}
+
+void trace_end(u32 id)
+{
+	if (trace->hdr.magic != TRACE_MAGIC)
+		return;
+
+	u32 now = get_tmr_us();
+	trace_event_t *ev = &trace->events[id % TRACE_MAX_EVENTS];
+
+	// Check that span was not overwritten.
+	if (ev->seq != id || ev->dur != TRACE_DUR_OPEN)
+		return;
+
+	ev->dur = now - ev->start;
+	trace->hdr.last_us = now;
+}
+
+void trace_mark(const char *name)
+{
+	if (trace->hdr.magic != TRACE_MAGIC)
+		return;
+
+	_trace_new_event(name, get_tmr_us());
+}
+
+// Record an already finished span, e.g. one that started before DRAM was up.
+void trace_span(const char *name, u32 start)
+{
+	if (trace->hdr.magic != TRACE_MAGIC)
+		return;
+
+	u32 now = get_tmr_us();
+	_trace_new_event(name, start)->dur = now - start;
+	trace->hdr.last_us = now;
+}
+
+u32 trace_get_count()
+{
+	if (trace->hdr.magic != TRACE_MAGIC)
+		return 0;
+
+	return MIN(trace->hdr.seq, TRACE_MAX_EVENTS);
+}
+
+trace_event_t *trace_get_event(u32 idx)
+{
+	u32 count = trace_get_count();
+	if (idx >= count)
+		return NULL;
+
+	// Oldest event first.
+	u32 seq = trace->hdr.seq - count + idx;
+
+	return &trace->events[seq % TRACE_MAX_EVENTS];
+}
+
+static char *_trace_puts(char *pos, const char *str)
+{
+	strcpy(pos, str);
+
+	return pos + strlen(pos);
+}
+
+static char *_trace_putn(char *pos, u32 val)
+{
+	utoa(val, pos, 10);
+
+	return pos + strlen(pos);
+}
+
+int trace_dump(const char *path)
+{
+	u32 count = trace_get_count();
+	if (!count)
+		return 1;
+
+	char *buf = (char *)malloc(count * TRACE_DUMP_EVENT_SZ + 64);
+	char *pos = buf;
+
+	// Export as Chrome trace event format. Ended spans are complete events, the rest instant ones.
+	pos = _trace_puts(pos, "{\"traceEvents\":[\n");
+	for (u32 i = 0; i < count; i++)
+	{
+		trace_event_t *ev = trace_get_event(i);
+
+		pos = _trace_puts(pos, "{\"name\":\"");
+		pos = _trace_puts(pos, ev->name);
+		pos = _trace_puts(pos, "\",\"ts\":");
+		pos = _trace_putn(pos, ev->start);
+		if (ev->dur != TRACE_DUR_OPEN)
+		{
+			pos = _trace_puts(pos, ",\"dur\":");
+			pos = _trace_putn(pos, ev->dur);
+			pos = _trace_puts(pos, ",\"ph\":\"X\"");
+		}
+		else
+			pos = _trace_puts(pos, ",\"ph\":\"i\",\"s\":\"g\"");
+		pos = _trace_puts(pos, ",\"pid\":1,\"tid\":1}");
+		pos = _trace_puts(pos, (i + 1) < count ? ",\n" : "\n");
+	}
+	pos = _trace_puts(pos, "],\"displayTimeUnit\":\"ms\"}\n");
+
+	int res = sd_save_to_file(buf, pos - buf, path);
+
+	free(buf);
+
+	return res;
+}
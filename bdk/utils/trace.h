@@ -0,0 +1,55 @@
+/*
+ * Boot phase tracing.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <memory_map.h>
+#include <utils/types.h>
+
+#define TRACE_MAGIC      0x43525442 // "BTRC".
+#define TRACE_NAME_LEN   20
+#define TRACE_DUR_OPEN   0xFFFFFFFF // Span not ended yet or instant event.
+#define TRACE_MAX_EVENTS ((BOOT_TRACE_SZ - sizeof(trace_hdr_t)) / sizeof(trace_event_t))
+#define TRACE_DUMP_PATH  "bootloader/boot_trace.json"
+
+typedef struct _trace_event_t
+{
+	char name[TRACE_NAME_LEN];
+	u32  seq;
+	u32  start; // us.
+	u32  dur;   // us.
+} trace_event_t;
+
+typedef struct _trace_hdr_t
+{
+	u32 magic;
+	u32 seq;     // Next event sequence.
+	u32 last_us; // Last recorded timestamp. Used to detect a stale ring from a previous power on.
+	u32 runs;    // Number of payload instances that recorded into this ring.
+	u32 rsvd[4];
+} trace_hdr_t;
+
+void trace_init();
+u32  trace_begin(const char *name);
+void trace_end(u32 id);
+void trace_mark(const char *name);
+void trace_span(const char *name, u32 start);
+u32  trace_get_count();
+trace_event_t *trace_get_event(u32 idx);
+int  trace_dump(const char *path);
+
+#endif
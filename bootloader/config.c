@@ -35,6 +35,7 @@ void set_default_configuration()
 	h_cfg.autonogc = 1;
 	h_cfg.updater2p = 0;
 	h_cfg.bootprotect = 0;
+	h_cfg.boottrace = 0;
 	h_cfg.errors = 0;
 	h_cfg.eks = NULL;
 	h_cfg.rcm_patched = fuse_check_patched_rcm();
@@ -105,6 +106,10 @@ int create_config_entry()
 	f_puts("\nbootprotect=", &fp);
 	itoa(h_cfg.bootprotect, lbuf, 10);
 	f_puts(lbuf, &fp);
+
+	f_puts("\nboottrace=", &fp);
+	itoa(h_cfg.boottrace, lbuf, 10);
+	f_puts(lbuf, &fp);
 	f_puts("\n", &fp);
 
 	if (mainIniFound)
@@ -148,6 +153,7 @@ int create_config_entry()
 	}
 
 	f_close(&fp);
+	ini_invalidate("bootloader/hekate_ipl.ini");
 
 	return 0;
 }
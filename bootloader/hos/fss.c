@@ -36,6 +36,9 @@ extern bool is_ipl_updated(void *buf, char *path, bool force);
 // FSS0 Magic and Meta header offset.
 #define FSS0_MAGIC 0x30535346
 #define FSS0_META_OFFSET 0x4
+#define FSS0_HDR_SIZE 0x400
+#define FSS0_MAX_CNT_COUNT 0x40
+#define FSS0_CLMT_SIZE 0x400
 #define FSS0_VERSION_0_17_0 0x110000
 
 // FSS0 Content Types.
@@ -84,7 +87,7 @@ typedef struct _fss_content_t
 
 static void _set_fss_path_and_update_r2p(launch_ctxt_t *ctxt, const char *path)
 {
-	char *r2p_path = malloc(256);
+	char *r2p_path = arena_alloc(ctxt->arena, 256);
 	u32 path_len = strlen(path);
 
 	strcpy(r2p_path, path);
@@ -108,13 +111,23 @@ static void _set_fss_path_and_update_r2p(launch_ctxt_t *ctxt, const char *path)
 		}
 		path_len--;
 	}
+}
+
+static void *_fss_read_content(FIL *fp, const fss_content_t *fss_cnt, arena_t *arena)
+{
+	void *content = arena_alloc(arena, fss_cnt->size);
+
+	// Read content straight into its own buffer.
+	if (f_lseek(fp, fss_cnt->offset) || f_read(fp, content, fss_cnt->size, NULL))
+		return NULL;
 
-	free(r2p_path);
+	return content;
 }
 
 int parse_fss(launch_ctxt_t *ctxt, const char *path)
 {
 	FIL fp;
+	int res = 0;
 
 	bool stock = false;
 	bool experimental = false;
@@ -146,98 +159,130 @@ int parse_fss(launch_ctxt_t *ctxt, const char *path)
 	if (f_open(&fp, path, FA_READ) != FR_OK)
 		return 0;
 
-	void *fss = malloc(f_size(&fp));
-
 	// Read first 1024 bytes of the FSS0 file.
-	f_read(&fp, fss, 1024, NULL);
+	u8 *fss = arena_alloc(ctxt->arena, FSS0_HDR_SIZE);
+	fss_content_t *fss_cnt;
+	if (f_read(&fp, fss, FSS0_HDR_SIZE, NULL) != FR_OK)
+		goto out;
 
 	// Get FSS0 Meta header offset.
 	u32 fss_meta_addr = *(u32 *)(fss + FSS0_META_OFFSET);
+	if (fss_meta_addr > (FSS0_HDR_SIZE - sizeof(fss_meta_t)))
+		goto out;
 	fss_meta_t *fss_meta = (fss_meta_t *)(fss + fss_meta_addr);
 
 	// Check if valid FSS0 and parse it.
-	if (fss_meta->magic == FSS0_MAGIC)
+	if (fss_meta->magic != FSS0_MAGIC || fss_meta->cnt_count > FSS0_MAX_CNT_COUNT)
+		goto out;
+
+	// Read content headers.
+	u32 cnt_table_size = fss_meta->cnt_count * sizeof(fss_content_t);
+	fss_cnt = (fss_content_t *)arena_alloc(ctxt->arena, cnt_table_size);
+	if (f_lseek(&fp, fss_meta->cnt_off) || f_read(&fp, fss_cnt, cnt_table_size, NULL))
+		goto out;
+
+	gfx_printf("Found FSS/PK3, Atmosphere %d.%d.%d-%08x\n"
+		"Max HOS: %d.%d.%d\n"
+		"Unpacking..  ",
+		fss_meta->version >> 24, (fss_meta->version >> 16) & 0xFF, (fss_meta->version >> 8) & 0xFF, fss_meta->git_rev,
+		fss_meta->hos_ver >> 24, (fss_meta->hos_ver >> 16) & 0xFF, (fss_meta->hos_ver >> 8) & 0xFF);
+
+	ctxt->atmosphere = true;
+	ctxt->fss0_hosver = fss_meta->hos_ver;
+
+	u32 trace_id = trace_begin("parse_fss");
+
+	/*
+	 * Map file clusters so seeking to each content does not walk the FAT chain.
+	 * Done directly instead of f_expand_cltbl, so a too fragmented file silently falls back to walking it.
+	 */
+	DWORD clmt[FSS0_CLMT_SIZE / sizeof(DWORD)];
+	clmt[0] = FSS0_CLMT_SIZE / sizeof(DWORD);
+	fp.cltbl = clmt;
+	if (f_lseek(&fp, CREATE_LINKMAP) != FR_OK)
+		fp.cltbl = NULL;
+
+	// Parse FSS0 contents and only load the needed ones.
+	void *content;
+	for (u32 i = 0; i < fss_meta->cnt_count; i++)
 	{
-		gfx_printf("Found FSS/PK3, Atmosphere %d.%d.%d-%08x\n"
-			"Max HOS: %d.%d.%d\n"
-			"Unpacking..  ",
-			fss_meta->version >> 24, (fss_meta->version >> 16) & 0xFF, (fss_meta->version >> 8) & 0xFF, fss_meta->git_rev,
-			fss_meta->hos_ver >> 24, (fss_meta->hos_ver >> 16) & 0xFF, (fss_meta->hos_ver >> 8) & 0xFF);
-
-		ctxt->atmosphere = true;
-		ctxt->fss0_hosver = fss_meta->hos_ver;
-
-		// Parse FSS0 contents.
-		fss_content_t *curr_fss_cnt = (fss_content_t *)(fss + fss_meta->cnt_off);
-		void *content;
-		for (u32 i = 0; i < fss_meta->cnt_count; i++)
-		{
-			content = (void *)(fss + curr_fss_cnt[i].offset);
+		// Check if offset is inside limits.
+		if ((fss_cnt[i].offset + fss_cnt[i].size) > fss_meta->size)
+			continue;
 
-			// Check if offset is inside limits.
-			if ((curr_fss_cnt[i].offset + curr_fss_cnt[i].size) > fss_meta->size)
-				continue;
+		// If content is experimental and experimental config is not enabled, skip it.
+		if ((fss_cnt[i].flags0 & CNT_FLAG0_EXPERIMENTAL) && !experimental)
+			continue;
 
-			// If content is experimental and experimental config is not enabled, skip it.
-			if ((curr_fss_cnt[i].flags0 & CNT_FLAG0_EXPERIMENTAL) && !experimental)
+		// Check if content is needed.
+		switch (fss_cnt[i].type)
+		{
+		case CNT_TYPE_KIP:
+		case CNT_TYPE_KRN:
+			if (stock)
 				continue;
+			break;
 
-			// Prepare content.
-			switch (curr_fss_cnt[i].type)
-			{
-			case CNT_TYPE_KIP:
-				if (stock)
-					continue;
-				merge_kip_t *mkip1 = (merge_kip_t *)malloc(sizeof(merge_kip_t));
-				mkip1->kip1 = content;
-				list_append(&ctxt->kip1_list, &mkip1->link);
-				DPRINTF("Loaded %s.kip1 from FSS0 (size %08X)\n", curr_fss_cnt[i].name, curr_fss_cnt[i].size);
-				break;
-
-			case CNT_TYPE_KRN:
-				if (stock)
-					continue;
-				ctxt->kernel_size = curr_fss_cnt[i].size;
-				ctxt->kernel = content;
-				break;
-
-			case CNT_TYPE_EXO:
-				ctxt->secmon_size = curr_fss_cnt[i].size;
-				ctxt->secmon = content;
-				break;
-
-			case CNT_TYPE_EXF:
-				ctxt->exofatal_size = curr_fss_cnt[i].size;
-				ctxt->exofatal = content;
-				break;
-
-			case CNT_TYPE_WBT:
-				if (h_cfg.t210b01)
-					continue;
-				ctxt->warmboot_size = curr_fss_cnt[i].size;
-				ctxt->warmboot = content;
-				break;
-
-			default:
+		case CNT_TYPE_WBT:
+			if (h_cfg.t210b01)
 				continue;
-			}
+			break;
 
-			// Load content to launch context.
-			f_lseek(&fp, curr_fss_cnt[i].offset);
-			f_read(&fp, content, curr_fss_cnt[i].size, NULL);
-		}
+		case CNT_TYPE_EXO:
+		case CNT_TYPE_EXF:
+			break;
 
-		gfx_printf("Done!\n");
-		f_close(&fp);
+		default:
+			continue;
+		}
 
-		// Set FSS0 path and update r2p if needed.
-		_set_fss_path_and_update_r2p(ctxt, path);
+		// Load content.
+		content = _fss_read_content(&fp, &fss_cnt[i], ctxt->arena);
+		if (!content)
+			continue;
 
-		return 1;
+		// Add content to launch context.
+		switch (fss_cnt[i].type)
+		{
+		case CNT_TYPE_KIP:;
+			merge_kip_t *mkip1 = (merge_kip_t *)arena_alloc(ctxt->arena, sizeof(merge_kip_t));
+			mkip1->kip1 = content;
+			list_append(&ctxt->kip1_list, &mkip1->link);
+			DPRINTF("Loaded %s.kip1 from FSS0 (size %08X)\n", fss_cnt[i].name, fss_cnt[i].size);
+			break;
+
+		case CNT_TYPE_KRN:
+			ctxt->kernel_size = fss_cnt[i].size;
+			ctxt->kernel = content;
+			break;
+
+		case CNT_TYPE_EXO:
+			ctxt->secmon_size = fss_cnt[i].size;
+			ctxt->secmon = content;
+			break;
+
+		case CNT_TYPE_EXF:
+			ctxt->exofatal_size = fss_cnt[i].size;
+			ctxt->exofatal = content;
+			break;
+
+		case CNT_TYPE_WBT:
+			ctxt->warmboot_size = fss_cnt[i].size;
+			ctxt->warmboot = content;
+			break;
+		}
 	}
 
+	gfx_printf("Done!\n");
+	trace_end(trace_id);
+
+	// Set FSS0 path and update r2p if needed.
+	_set_fss_path_and_update_r2p(ctxt, path);
+
+	res = 1;
+
+out:
 	f_close(&fp);
-	free(fss);
 
-	return 0;
+	return res;
 }
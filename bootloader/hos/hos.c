@@ -19,6 +19,7 @@
  */
 
 #include <string.h>
+#include <stdlib.h>
 
 #include <bdk.h>
 
@@ -591,7 +592,7 @@ static int _read_emmc_pkg1(launch_ctxt_t *ctxt)
 {
 	const u32 pk1_offset = h_cfg.t210b01 ? sizeof(bl_hdr_t210b01_t) : 0; // Skip T210B01 OEM header.
 	u32 bootloader_offset = PKG1_BOOTLOADER_MAIN_OFFSET;
-	ctxt->pkg1 = (void *)malloc(PKG1_BOOTLOADER_SIZE);
+	ctxt->pkg1 = (void *)arena_alloc(ctxt->arena, PKG1_BOOTLOADER_SIZE);
 
 try_load:
 	// Read package1.
@@ -640,7 +641,7 @@ try_load:
 	// Read the correct keyblob for older HOS versions.
 	if (ctxt->pkg1_id->kb <= KB_FIRMWARE_VERSION_600)
 	{
-		ctxt->keyblob = (u8 *)calloc(EMMC_BLOCKSIZE, 1);
+		ctxt->keyblob = (u8 *)arena_calloc(ctxt->arena, EMMC_BLOCKSIZE, 1);
 		emummc_storage_read(PKG1_HOS_KEYBLOBS_OFFSET / EMMC_BLOCKSIZE + ctxt->pkg1_id->kb, 1, ctxt->keyblob);
 	}
 
@@ -664,7 +665,7 @@ DPRINTF("Parsed GPT\n");
 
 	// Read in package2 header and get package2 real size.
 	const u32 BCT_SIZE = SZ_16K;
-	bctBuf = (u8 *)malloc(BCT_SIZE);
+	bctBuf = (u8 *)arena_alloc(ctxt->arena, BCT_SIZE);
 	emmc_part_read(pkg2_part, BCT_SIZE / EMMC_BLOCKSIZE, 1, bctBuf);
 	u32 *hdr = (u32 *)(bctBuf + 0x100);
 	u32 pkg2_size = hdr[0] ^ hdr[2] ^ hdr[3];
@@ -677,7 +678,7 @@ DPRINTF("pkg2 size on emmc is %08X\n", pkg2_size);
 	// Read in package2.
 	u32 pkg2_size_aligned = ALIGN(pkg2_size, EMMC_BLOCKSIZE);
 DPRINTF("pkg2 size aligned is %08X\n", pkg2_size_aligned);
-	ctxt->pkg2 = malloc(pkg2_size_aligned);
+	ctxt->pkg2 = arena_alloc(ctxt->arena, pkg2_size_aligned);
 	ctxt->pkg2_size = pkg2_size;
 	emmc_part_read(pkg2_part, BCT_SIZE / EMMC_BLOCKSIZE,
 		pkg2_size_aligned / EMMC_BLOCKSIZE, ctxt->pkg2);
@@ -689,13 +690,8 @@ out:
 
 static void _free_launch_components(launch_ctxt_t *ctxt)
 {
-	free(ctxt->keyblob);
-	free(ctxt->pkg1);
-	free(ctxt->pkg2);
-	free(ctxt->warmboot);
-	free(ctxt->secmon);
-	free(ctxt->kernel);
-	free(ctxt->kip1_patches);
+	// Drop all launch buffers at once and give the blocks back to the heap.
+	arena_free(ctxt->arena);
 }
 
 static bool _get_fs_exfat_compatible(link_t *info, u32 *hos_revision)
@@ -749,6 +745,13 @@ int hos_launch(ini_sec_t *cfg)
 	launch_ctxt_t ctxt = {0};
 	tsec_ctxt_t tsec_ctxt = {0};
 	volatile secmon_mailbox_t *secmon_mailbox;
+	u32 trace_hos = trace_begin("hos_launch");
+	u32 trace_id = trace_hos; // Current phase span. Also ended on error.
+
+	// All launch buffers come from one arena that is freed on failure.
+	arena_t launch_arena;
+	arena_init(&launch_arena, SZ_16M);
+	ctxt.arena = &launch_arena;
 
 	minerva_change_freq(FREQ_1600);
 	list_init(&ctxt.kip1_list);
@@ -781,17 +784,21 @@ int hos_launch(ini_sec_t *cfg)
 	}
 
 	// Read package1 and the correct keyblob.
+	trace_id = trace_begin("pkg1_read");
 	if (!_read_emmc_pkg1(&ctxt))
 		goto error;
+	trace_end(trace_id);
 
 	kb = ctxt.pkg1_id->kb;
 
 	// Try to parse config if present.
+	trace_id = trace_begin("boot_config");
 	if (ctxt.cfg && !parse_boot_config(&ctxt))
 	{
 		_hos_crit_error("Wrong ini cfg or missing/corrupt files!");
 		goto error;
 	}
+	trace_end(trace_id);
 
 	bool emummc_enabled = emu_cfg.enabled && !h_cfg.emummc_force_disable;
 
@@ -854,8 +861,10 @@ int hos_launch(ini_sec_t *cfg)
 	tsec_ctxt.pkg11_off = ctxt.pkg1_id->pkg11_off;
 	tsec_ctxt.secmon_base = secmon_base;
 
+	trace_id = trace_begin("keygen");
 	if (!hos_keygen(ctxt.keyblob, kb, &tsec_ctxt, ctxt.stock, is_exo))
 		goto error;
+	trace_end(trace_id);
 	gfx_puts("Generated keys\n");
 
 	// Decrypt and unpack package1 if we require parts of it.
@@ -940,12 +949,14 @@ int hos_launch(ini_sec_t *cfg)
 	gfx_puts("Loaded warmboot and secmon\n");
 
 	// Read package2.
+	trace_id = trace_begin("pkg2_read");
 	u8 *bootConfigBuf = _read_emmc_pkg2(&ctxt);
 	if (!bootConfigBuf)
 	{
 		_hos_crit_error("Pkg2 read failed!");
 		goto error;
 	}
+	trace_end(trace_id);
 
 	gfx_puts("Read pkg2\n");
 
@@ -961,7 +972,7 @@ int hos_launch(ini_sec_t *cfg)
 	}
 
 	LIST_INIT(kip1_info);
-	if (!pkg2_parse_kips(&kip1_info, pkg2_hdr, &ctxt.new_pkg2))
+	if (!pkg2_parse_kips(&kip1_info, pkg2_hdr, &ctxt.new_pkg2, ctxt.arena))
 	{
 		_hos_crit_error("INI1 parsing failed!");
 		goto error;
@@ -1020,7 +1031,7 @@ int hos_launch(ini_sec_t *cfg)
 
 	// Merge extra KIP1s into loaded ones.
 	LIST_FOREACH_ENTRY(merge_kip_t, mki, &ctxt.kip1_list, link)
-		pkg2_merge_kip(&kip1_info, (pkg2_kip1_t *)mki->kip1);
+		pkg2_merge_kip(&kip1_info, (pkg2_kip1_t *)mki->kip1, ctxt.arena);
 
 	// Check if FS is compatible with exFAT and if 5.1.0.
 	if (!ctxt.stock && (sd_fs.fs_type == FS_EXFAT || kb == KB_FIRMWARE_VERSION_500))
@@ -1031,7 +1042,6 @@ int hos_launch(ini_sec_t *cfg)
 		{
 			_hos_crit_error("SD Card is exFAT but installed HOS driver\nonly supports FAT32!");
 
-			_free_launch_components(&ctxt);
 			goto error;
 		}
 	}
@@ -1039,7 +1049,9 @@ int hos_launch(ini_sec_t *cfg)
 	// Patch kip1s in memory if needed.
 	if (ctxt.kip1_patches)
 		gfx_printf("%kPatching kips%k\n", TXT_CLR_ORANGE, TXT_CLR_DEFAULT);
-	const char* unappliedPatch = pkg2_patch_kips(&kip1_info, ctxt.kip1_patches);
+	trace_id = trace_begin("pkg2_patch_kips");
+	const char* unappliedPatch = pkg2_patch_kips(&kip1_info, ctxt.kip1_patches, ctxt.arena);
+	trace_end(trace_id);
 	if (unappliedPatch != NULL)
 	{
 		EHPRINTFARGS("Failed to apply '%s'!", unappliedPatch);
@@ -1053,18 +1065,33 @@ int hos_launch(ini_sec_t *cfg)
 
 		if (emmc_patch_failed || !(btn_wait() & BTN_POWER))
 		{
-			_free_launch_components(&ctxt);
 			goto error; // MUST stop here, because if user requests 'nogc' but it's not applied, their GC controller gets updated!
 		}
 	}
 
 	// Rebuild and encrypt package2.
+	trace_id = trace_begin("pkg2_build_encrypt");
 	pkg2_build_encrypt((void *)PKG2_LOAD_ADDR, &ctxt, &kip1_info, is_exo);
+	trace_end(trace_id);
 
 	// Configure Exosphere if secmon is replaced.
 	if (is_exo)
 		config_exosphere(&ctxt, warmboot_base);
 
+	// Save boot trace. The handover mark is the last event that can reach SD.
+	trace_end(trace_hos);
+	trace_mark("handover");
+	if (h_cfg.boottrace)
+	{
+		// Record arena high-water mark in KiB.
+		char arena_peak[TRACE_NAME_LEN];
+		strcpy(arena_peak, "arena_kb ");
+		itoa(ctxt.arena->peak / SZ_1K, arena_peak + 9, 10);
+		trace_mark(arena_peak);
+
+		trace_dump(TRACE_DUMP_PATH);
+	}
+
 	// Unmount SD card and eMMC.
 	sd_end();
 	sdmmc_storage_end(&emmc_storage);
@@ -1169,13 +1196,22 @@ int hos_launch(ini_sec_t *cfg)
 	if (smmu_is_used())
 		smmu_exit();
 	else
+	{
+		// Power cycle CPU0 if it ran the offload worker, so secmon starts from a clean reset.
+		ccplex_job_stop();
 		ccplex_boot_cpu0(secmon_base);
+	}
 
 	// Halt ourselves in waitevent state and resume if there's JTAG activity.
 	while (true)
 		bpmp_halt();
 
 error:
+	// Worker must not run on while IPL memory is reused.
+	ccplex_job_stop();
+	_free_launch_components(&ctxt);
+	trace_end(trace_id);
+	trace_end(trace_hos);
 	sdmmc_storage_end(&emmc_storage);
 
 	return 0;
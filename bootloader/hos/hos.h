@@ -75,6 +75,8 @@ static_assert(sizeof(hos_eks_mbr_t) == 64, "HOS EKS size is wrong!");
 
 typedef struct _launch_ctxt_t
 {
+	arena_t *arena;
+
 	void *keyblob;
 
 	void *pkg1;
@@ -29,7 +29,7 @@
 
 static int _config_warmboot(launch_ctxt_t *ctxt, const char *value)
 {
-	ctxt->warmboot = sd_file_read(value, &ctxt->warmboot_size);
+	ctxt->warmboot = sd_file_read_arena(value, &ctxt->warmboot_size, ctxt->arena);
 	if (!ctxt->warmboot)
 		return 0;
 
@@ -38,7 +38,7 @@ static int _config_warmboot(launch_ctxt_t *ctxt, const char *value)
 
 static int _config_secmon(launch_ctxt_t *ctxt, const char *value)
 {
-	ctxt->secmon = sd_file_read(value, &ctxt->secmon_size);
+	ctxt->secmon = sd_file_read_arena(value, &ctxt->secmon_size, ctxt->arena);
 	if (!ctxt->secmon)
 		return 0;
 
@@ -47,7 +47,7 @@ static int _config_secmon(launch_ctxt_t *ctxt, const char *value)
 
 static int _config_kernel(launch_ctxt_t *ctxt, const char *value)
 {
-	ctxt->kernel = sd_file_read(value, &ctxt->kernel_size);
+	ctxt->kernel = sd_file_read_arena(value, &ctxt->kernel_size, ctxt->arena);
 	if (!ctxt->kernel)
 		return 0;
 
@@ -60,7 +60,7 @@ static int _config_kip1(launch_ctxt_t *ctxt, const char *value)
 
 	if (!memcmp(value + strlen(value) - 1, "*", 1))
 	{
-		char *dir = (char *)malloc(256);
+		char *dir = (char *)arena_alloc(ctxt->arena, 256);
 		strcpy(dir, value);
 
 		u32 dirlen = 0;
@@ -80,12 +80,10 @@ static int _config_kip1(launch_ctxt_t *ctxt, const char *value)
 
 				strcpy(dir + dirlen, &filelist[i * 256]);
 
-				merge_kip_t *mkip1 = (merge_kip_t *)malloc(sizeof(merge_kip_t));
-				mkip1->kip1 = sd_file_read(dir, &size);
+				merge_kip_t *mkip1 = (merge_kip_t *)arena_alloc(ctxt->arena, sizeof(merge_kip_t));
+				mkip1->kip1 = sd_file_read_arena(dir, &size, ctxt->arena);
 				if (!mkip1->kip1)
 				{
-					free(mkip1);
-					free(dir);
 					free(filelist);
 
 					return 0;
@@ -97,19 +95,14 @@ static int _config_kip1(launch_ctxt_t *ctxt, const char *value)
 			}
 		}
 
-		free(dir);
 		free(filelist);
 	}
 	else
 	{
-		merge_kip_t *mkip1 = (merge_kip_t *)malloc(sizeof(merge_kip_t));
-		mkip1->kip1 = sd_file_read(value, &size);
+		merge_kip_t *mkip1 = (merge_kip_t *)arena_alloc(ctxt->arena, sizeof(merge_kip_t));
+		mkip1->kip1 = sd_file_read_arena(value, &size, ctxt->arena);
 		if (!mkip1->kip1)
-		{
-			free(mkip1);
-
 			return 0;
-		}
 		DPRINTF("Loaded kip1 from SD (size %08X)\n", size);
 		list_append(&ctxt->kip1_list, &mkip1->link);
 	}
@@ -128,7 +121,7 @@ int config_kip1patch(launch_ctxt_t *ctxt, const char *value)
 
 	if (ctxt->kip1_patches == NULL)
 	{
-		ctxt->kip1_patches = malloc(valueLen + 1);
+		ctxt->kip1_patches = arena_alloc(ctxt->arena, valueLen + 1);
 		memcpy(ctxt->kip1_patches, value, valueLen);
 		ctxt->kip1_patches[valueLen] = 0;
 	}
@@ -136,10 +129,8 @@ int config_kip1patch(launch_ctxt_t *ctxt, const char *value)
 	{
 		char *oldAlloc = ctxt->kip1_patches;
 		int oldSize = strlen(oldAlloc);
-		ctxt->kip1_patches = malloc(oldSize + 1 + valueLen + 1);
+		ctxt->kip1_patches = arena_alloc(ctxt->arena, oldSize + 1 + valueLen + 1);
 		memcpy(ctxt->kip1_patches, oldAlloc, oldSize);
-		free(oldAlloc);
-		oldAlloc = NULL;
 		ctxt->kip1_patches[oldSize++] = ',';
 		memcpy(&ctxt->kip1_patches[oldSize], value, valueLen);
 		ctxt->kip1_patches[oldSize + valueLen] = 0;
@@ -220,7 +211,7 @@ static int _config_exo_user_pmu_access(launch_ctxt_t *ctxt, const char *value)
 static int _config_exo_usb3_force(launch_ctxt_t *ctxt, const char *value)
 {
 	// Override key found.
-	ctxt->exo_ctx.usb3_force = calloc(sizeof(bool), 1);
+	ctxt->exo_ctx.usb3_force = arena_calloc(ctxt->arena, sizeof(bool), 1);
 
 	if (*value == '1')
 	{
@@ -233,7 +224,7 @@ static int _config_exo_usb3_force(launch_ctxt_t *ctxt, const char *value)
 static int _config_exo_cal0_blanking(launch_ctxt_t *ctxt, const char *value)
 {
 	// Override key found.
-	ctxt->exo_ctx.cal0_blank = calloc(sizeof(bool), 1);
+	ctxt->exo_ctx.cal0_blank = arena_calloc(ctxt->arena, sizeof(bool), 1);
 
 	if (*value == '1')
 	{
@@ -246,7 +237,7 @@ static int _config_exo_cal0_blanking(launch_ctxt_t *ctxt, const char *value)
 static int _config_exo_cal0_writes_enable(launch_ctxt_t *ctxt, const char *value)
 {
 	// Override key found.
-	ctxt->exo_ctx.cal0_allow_writes_sys = calloc(sizeof(bool), 1);
+	ctxt->exo_ctx.cal0_allow_writes_sys = arena_calloc(ctxt->arena, sizeof(bool), 1);
 
 	if (*value == '1')
 	{
@@ -264,7 +255,7 @@ static int _config_fss(launch_ctxt_t *ctxt, const char *value)
 
 static int _config_exo_fatal_payload(launch_ctxt_t *ctxt, const char *value)
 {
-	ctxt->exofatal = sd_file_read(value, &ctxt->exofatal_size);
+	ctxt->exofatal = sd_file_read_arena(value, &ctxt->exofatal_size, ctxt->arena);
 	if (!ctxt->exofatal)
 		return 0;
 
@@ -377,7 +377,7 @@ int pkg1_warmboot_config(void *hos_ctxt, u32 warmboot_base)
 					_warmboot_filename(path, burnt_fuses);
 					if (!f_stat(path, NULL))
 					{
-						ctxt->warmboot = sd_file_read(path, &ctxt->warmboot_size);
+						ctxt->warmboot = sd_file_read_arena(path, &ctxt->warmboot_size, ctxt->arena);
 						burnt_fuses = tmp_fuses;
 						break;
 					}
@@ -55,6 +55,19 @@ enum kip_offset_section
 #define GET_KIP_PATCH_OFFSET(x)  ((x) & KIP_PATCH_OFFSET_MASK)
 #define KPS(x)                   ((u32)(x) << KIP_PATCH_SECTION_SHIFT)
 
+#define KIP_CACHE_DIR       "bootloader/cache"
+#define KIP_CACHE_MAGIC     0x3143504B // "KPC1".
+#define KIP_CACHE_VERSION   1 // Bump on decompression or patching changes.
+#define KIP_CACHE_KEY_CHUNK 512
+
+typedef struct _kip_cache_hdr_t
+{
+	u32 magic;
+	u32 size;
+	u8  key[SE_SHA_256_SIZE];
+	u8  hash[SE_SHA_256_SIZE]; // Of the cached KIP.
+} kip_cache_hdr_t;
+
 #include "pkg2_patches.inl"
 
 static kip1_id_t *_kip_id_sets = _kip_ids;
@@ -217,7 +230,7 @@ void pkg2_get_newkern_info(u8 *kern_data)
 	pkg2_newkern_ini1_end   = *(u32 *)(kern_data + pkg2_newkern_ini1_val + 0x8);
 }
 
-bool pkg2_parse_kips(link_t *info, pkg2_hdr_t *pkg2, bool *new_pkg2)
+bool pkg2_parse_kips(link_t *info, pkg2_hdr_t *pkg2, bool *new_pkg2, arena_t *arena)
 {
 	u8 *ptr;
 	// Check for new pkg2 type.
@@ -240,7 +253,7 @@ bool pkg2_parse_kips(link_t *info, pkg2_hdr_t *pkg2, bool *new_pkg2)
 	for (u32 i = 0; i < ini1->num_procs; i++)
 	{
 		pkg2_kip1_t *kip1 = (pkg2_kip1_t *)ptr;
-		pkg2_kip1_info_t *ki = (pkg2_kip1_info_t *)malloc(sizeof(pkg2_kip1_info_t));
+		pkg2_kip1_info_t *ki = (pkg2_kip1_info_t *)arena_alloc(arena, sizeof(pkg2_kip1_info_t));
 		ki->kip1 = kip1;
 		ki->size = _pkg2_calc_kip1_size(kip1);
 		list_append(info, &ki->link);
@@ -273,24 +286,24 @@ DPRINTF("replaced kip %s (new size %08X)\n", kip1->name, ki->size);
 	}
 }
 
-void pkg2_add_kip(link_t *info, pkg2_kip1_t *kip1)
+void pkg2_add_kip(link_t *info, pkg2_kip1_t *kip1, arena_t *arena)
 {
-	pkg2_kip1_info_t *ki = (pkg2_kip1_info_t *)malloc(sizeof(pkg2_kip1_info_t));
+	pkg2_kip1_info_t *ki = (pkg2_kip1_info_t *)arena_alloc(arena, sizeof(pkg2_kip1_info_t));
 	ki->kip1 = kip1;
 	ki->size = _pkg2_calc_kip1_size(kip1);
 DPRINTF("added kip %s (size %08X)\n", kip1->name, ki->size);
 	list_append(info, &ki->link);
 }
 
-void pkg2_merge_kip(link_t *info, pkg2_kip1_t *kip1)
+void pkg2_merge_kip(link_t *info, pkg2_kip1_t *kip1, arena_t *arena)
 {
 	if (pkg2_has_kip(info, kip1->tid))
 		pkg2_replace_kip(info, kip1->tid, kip1);
 	else
-		pkg2_add_kip(info, kip1);
+		pkg2_add_kip(info, kip1, arena);
 }
 
-int pkg2_decompress_kip(pkg2_kip1_info_t* ki, u32 sectsToDecomp)
+int pkg2_decompress_kip(pkg2_kip1_info_t* ki, u32 sectsToDecomp, arena_t *arena)
 {
 	u32 compClearMask = ~sectsToDecomp;
 	if ((ki->kip1->flags & compClearMask) == ki->kip1->flags)
@@ -300,17 +313,31 @@ int pkg2_decompress_kip(pkg2_kip1_info_t* ki, u32 sectsToDecomp)
 	memcpy(&hdr, ki->kip1, sizeof(hdr));
 
 	unsigned int newKipSize = sizeof(hdr);
+	u32 sectsDecompCnt = 0;
+	int offloadSect = -1;
 	for (u32 sectIdx = 0; sectIdx < KIP1_NUM_SECTIONS; sectIdx++)
 	{
 		u32 sectCompBit = BIT(sectIdx);
 		// For compressed, cant get actual decompressed size without doing it, so use safe "output size".
 		if (sectIdx < 3 && (sectsToDecomp & sectCompBit) && (hdr.flags & sectCompBit))
+		{
 			newKipSize += hdr.sections[sectIdx].size_decomp;
+			sectsDecompCnt++;
+
+			if (offloadSect < 0 || hdr.sections[sectIdx].size_decomp > hdr.sections[offloadSect].size_decomp)
+				offloadSect = sectIdx;
+		}
 		else
 			newKipSize += hdr.sections[sectIdx].size_comp;
 	}
 
-	pkg2_kip1_t* newKip = malloc(newKipSize);
+	// Offload the biggest section to CCPLEX, if there are more for BPMP to do in parallel.
+	if (sectsDecompCnt < 2 || !ccplex_job_start())
+		offloadSect = -1;
+
+	pkg2_kip1_t* newKip = arena_alloc(arena, newKipSize);
+	u8 *offloadBuf = NULL;
+	unsigned char *offloadDst = NULL;
 	unsigned char* dstDataPtr = newKip->data;
 	const unsigned char* srcDataPtr = ki->kip1->data;
 	for (u32 sectIdx = 0; sectIdx < KIP1_NUM_SECTIONS; sectIdx++)
@@ -332,11 +359,27 @@ int pkg2_decompress_kip(pkg2_kip1_info_t* ki, u32 sectsToDecomp)
 		unsigned int compSize = hdr.sections[sectIdx].size_comp;
 		unsigned int outputSize = hdr.sections[sectIdx].size_decomp;
 		gfx_printf("Decomping '%s', sect %d, size %d..\n", (const char*)hdr.name, sectIdx, compSize);
-		if (blz_uncompress_srcdest(srcDataPtr, compSize, dstDataPtr, outputSize) == 0)
+
+		// CCPLEX decompresses into its own cache line aligned buffer, so its write-backs can't touch other sections.
+		if (offloadSect == (int)sectIdx)
 		{
+			blz_footer footer;
+			offloadBuf = (u8 *)ALIGN((u32)arena_alloc(arena, outputSize + CCPLEX_JOB_CACHE_LINE_SZ * 2), CCPLEX_JOB_CACHE_LINE_SZ);
+			if (blz_srcdest_prepare(srcDataPtr, compSize, offloadBuf, outputSize, &footer) &&
+				ccplex_job_blz_submit(offloadBuf, compSize, &footer))
+				offloadDst = dstDataPtr;
+			else
+				offloadSect = -1;
+		}
+
+		if (offloadSect != (int)sectIdx && blz_uncompress_srcdest(srcDataPtr, compSize, dstDataPtr, outputSize) == 0)
+		{
+			// Wait for CCPLEX to stop writing to the buffer.
+			if (offloadSect >= 0)
+				ccplex_job_wait();
+
 			gfx_con.mute = false;
 			gfx_printf("%kERROR decomping sect %d of '%s'!%k\n", TXT_CLR_ERROR, sectIdx, (char*)hdr.name, TXT_CLR_DEFAULT);
-			free(newKip);
 
 			return 1;
 		}
@@ -349,28 +392,40 @@ int pkg2_decompress_kip(pkg2_kip1_info_t* ki, u32 sectsToDecomp)
 		dstDataPtr += outputSize;
 	}
 
+	if (offloadSect >= 0)
+	{
+		if (!ccplex_job_wait())
+		{
+			gfx_con.mute = false;
+			gfx_printf("%kERROR decomping sect %d of '%s'!%k\n", TXT_CLR_ERROR, offloadSect, (char*)hdr.name, TXT_CLR_DEFAULT);
+
+			return 1;
+		}
+
+		memcpy(offloadDst, offloadBuf, hdr.sections[offloadSect].size_comp);
+	}
+
 	hdr.flags &= compClearMask;
 	memcpy(newKip, &hdr, sizeof(hdr));
 	newKipSize = dstDataPtr-(unsigned char*)(newKip);
 
-	free(ki->kip1);
 	ki->kip1 = newKip;
 	ki->size = newKipSize;
 
 	return 0;
 }
 
-static int _kipm_inject(const char *kipm_path, char *target_name, pkg2_kip1_info_t* ki)
+static int _kipm_inject(const char *kipm_path, char *target_name, pkg2_kip1_info_t* ki, arena_t *arena)
 {
 	if (!strncmp((const char *)ki->kip1->name, target_name, sizeof(ki->kip1->name)))
 	{
 		u32 size = 0;
-		u8 *kipm_data = (u8 *)sd_file_read(kipm_path, &size);
+		u8 *kipm_data = (u8 *)sd_file_read_arena(kipm_path, &size, arena);
 		if (!kipm_data)
 			return 1;
 
 		u32 inject_size = size - sizeof(ki->kip1->caps);
-		u8 *kip_patched_data = (u8 *)malloc(ki->size + inject_size);
+		u8 *kip_patched_data = (u8 *)arena_alloc(arena, ki->size + inject_size);
 
 		// Copy headers.
 		memcpy(kip_patched_data, ki->kip1, sizeof(pkg2_kip1_t));
@@ -416,14 +471,128 @@ static int _kipm_inject(const char *kipm_path, char *target_name, pkg2_kip1_info
 			}
 		}
 
-		free(kipm_data);
 		return 0;
 	}
 
 	return 1;
 }
 
-const char* pkg2_patch_kips(link_t *info, char* patchNames)
+static void _kip_cache_key_update(u8 *key, const void *data, u32 size)
+{
+	u8 buf[SE_SHA_256_SIZE + KIP_CACHE_KEY_CHUNK] __attribute__((aligned(4)));
+	const u8 *src = (const u8 *)data;
+
+	// Chain previous key with new data. Big data is chained per chunk.
+	do
+	{
+		u32 chunk = MIN(size, KIP_CACHE_KEY_CHUNK);
+
+		memcpy(buf, key, SE_SHA_256_SIZE);
+		memcpy(buf + SE_SHA_256_SIZE, src, chunk);
+		se_calc_sha256_oneshot(key, buf, SE_SHA_256_SIZE + chunk);
+
+		src  += chunk;
+		size -= chunk;
+	} while (size);
+}
+
+static void _kip_cache_key(u8 *key, const u32 *kip_hash, kip1_patchset_t *patchset, char **patches, u32 numPatches, u32 sects)
+{
+	static const u32 version[] = { KIP_CACHE_VERSION, BL_VER_MJ, BL_VER_MN, BL_VER_HF };
+
+	// Key covers the cache and hekate version, the original KIP, the decompressed sections and the contents of all enabled patches.
+	memcpy(key, kip_hash, SE_SHA_256_SIZE);
+	_kip_cache_key_update(key, version, sizeof(version));
+	_kip_cache_key_update(key, &sects, sizeof(sects));
+
+	for (; patchset != NULL && patchset->name != NULL; patchset++)
+	{
+		for (u32 i = 0; i < numPatches; i++)
+		{
+			if (strcmp(patchset->name, patches[i]))
+				continue;
+
+			_kip_cache_key_update(key, patchset->name, strlen(patchset->name) + 1);
+			for (const kip1_patch_t *patch = patchset->patches; patch != NULL && patch->srcData != NULL; patch++)
+			{
+				_kip_cache_key_update(key, patch, sizeof(patch->offset) + sizeof(patch->length));
+				_kip_cache_key_update(key, patch->dstData, patch->length);
+			}
+		}
+	}
+}
+
+static void _kip_cache_path(char *path, pkg2_kip1_info_t *ki)
+{
+	char name[sizeof(ki->kip1->name) + 1];
+
+	memcpy(name, ki->kip1->name, sizeof(ki->kip1->name));
+	name[sizeof(ki->kip1->name)] = 0;
+
+	strcpy(path, KIP_CACHE_DIR "/");
+	strcat(path, name);
+	strcat(path, ".kip");
+}
+
+static bool _kip_cache_load(pkg2_kip1_info_t *ki, const u8 *key, arena_t *arena)
+{
+	char path[64];
+	u32 fsize = 0;
+	kip_cache_hdr_t hdr;
+	u8 hash[SE_SHA_256_SIZE];
+
+	_kip_cache_path(path, ki);
+	u8 *kip = (u8 *)sd_file_read_arena(path, &fsize, arena);
+	if (!kip)
+		return false;
+
+	// Header is stored at the end, so the KIP can be used in place.
+	if (fsize < sizeof(pkg2_kip1_t) + sizeof(kip_cache_hdr_t))
+		return false;
+
+	memcpy(&hdr, kip + fsize - sizeof(kip_cache_hdr_t), sizeof(kip_cache_hdr_t));
+	if (hdr.magic != KIP_CACHE_MAGIC || hdr.size != fsize - sizeof(kip_cache_hdr_t) || memcmp(hdr.key, key, SE_SHA_256_SIZE))
+		return false;
+
+	// Corrupted entries are rebuilt.
+	se_calc_sha256_oneshot(hash, kip, hdr.size);
+	if (memcmp(hdr.hash, hash, SE_SHA_256_SIZE))
+		return false;
+
+	ki->kip1 = (pkg2_kip1_t *)kip;
+	ki->size = hdr.size;
+
+	return true;
+}
+
+static void _kip_cache_save(pkg2_kip1_info_t *ki, const u8 *key)
+{
+	FIL fp;
+	char path[64];
+	kip_cache_hdr_t hdr;
+
+	hdr.magic = KIP_CACHE_MAGIC;
+	hdr.size = ki->size;
+	memcpy(hdr.key, key, SE_SHA_256_SIZE);
+	se_calc_sha256_oneshot(hdr.hash, ki->kip1, ki->size);
+
+	f_mkdir(KIP_CACHE_DIR);
+	_kip_cache_path(path, ki);
+	if (f_open(&fp, path, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+		return;
+
+	// Remove partially written entries.
+	if (f_write(&fp, ki->kip1, ki->size, NULL) != FR_OK || f_write(&fp, &hdr, sizeof(hdr), NULL) != FR_OK)
+	{
+		f_close(&fp);
+		f_unlink(path);
+		return;
+	}
+
+	f_close(&fp);
+}
+
+const char* pkg2_patch_kips(link_t *info, char* patchNames, arena_t *arena)
 {
 	if (patchNames == NULL || patchNames[0] == 0)
 		return NULL;
@@ -547,8 +716,16 @@ const char* pkg2_patch_kips(link_t *info, char* patchNames)
 				currPatchset++;
 			}
 
+			// Check if this kip was already decompressed and patched with the same inputs.
+			u8 cacheKey[SE_SHA_256_SIZE];
+			u32 cacheTime = get_tmr_ms();
+			_kip_cache_key(cacheKey, shaBuf, _kip_id_sets[currKipIdx].patchset, patches, numPatches, bitsAffected);
+			bool cached = _kip_cache_load(ki, cacheKey, arena);
+			if (cached)
+				gfx_printf("Loaded %s from cache in %d ms\n", (const char*)ki->kip1->name, get_tmr_ms() - cacheTime);
+
 			// Got patches to apply to this kip, have to decompress it.
-			if (pkg2_decompress_kip(ki, bitsAffected))
+			if (!cached && pkg2_decompress_kip(ki, bitsAffected, arena))
 				return (const char*)ki->kip1->name; // Failed to decompress.
 
 			currPatchset = _kip_id_sets[currKipIdx].patchset;
@@ -570,6 +747,14 @@ const char* pkg2_patch_kips(link_t *info, char* patchNames)
 						continue; // Patching is done later.
 					}
 
+					// Already applied in cached kip.
+					if (cached)
+					{
+						patchesApplied |= appliedMask;
+
+						continue;
+					}
+
 					if (currPatchset->patches == NULL)
 					{
 						DPRINTF("Patch '%s' not necessary for %s\n", currPatchset->name, (const char*)ki->kip1->name);
@@ -621,6 +806,10 @@ const char* pkg2_patch_kips(link_t *info, char* patchNames)
 				currPatchset++;
 			}
 
+			// Save patched kip before injecting emuMMC, which is always done at boot.
+			if (!cached)
+				_kip_cache_save(ki, cacheKey);
+
 			if (emummc_patch_selected && !strncmp(_kip_id_sets[currKipIdx].name, "FS", sizeof(ki->kip1->name)))
 			{
 				emummc_patch_selected = false;
@@ -631,7 +820,7 @@ const char* pkg2_patch_kips(link_t *info, char* patchNames)
 					emu_cfg.fs_ver -= 2;
 
 				gfx_printf("Injecting emuMMC. FS ID: %d\n", emu_cfg.fs_ver);
-				if (_kipm_inject("/bootloader/sys/emummc.kipm", "FS", ki))
+				if (_kipm_inject("/bootloader/sys/emummc.kipm", "FS", ki, arena))
 					return "emummc";
 			}
 		}
@@ -146,13 +146,13 @@ typedef struct _kip1_id_t
 } kip1_id_t;
 
 void pkg2_get_newkern_info(u8 *kern_data);
-bool pkg2_parse_kips(link_t *info, pkg2_hdr_t *pkg2, bool *new_pkg2);
+bool pkg2_parse_kips(link_t *info, pkg2_hdr_t *pkg2, bool *new_pkg2, arena_t *arena);
 int  pkg2_has_kip(link_t *info, u64 tid);
 void pkg2_replace_kip(link_t *info, u64 tid, pkg2_kip1_t *kip1);
-void pkg2_add_kip(link_t *info, pkg2_kip1_t *kip1);
-void pkg2_merge_kip(link_t *info, pkg2_kip1_t *kip1);
+void pkg2_add_kip(link_t *info, pkg2_kip1_t *kip1, arena_t *arena);
+void pkg2_merge_kip(link_t *info, pkg2_kip1_t *kip1, arena_t *arena);
 void pkg2_get_ids(kip1_id_t **ids, u32 *entries);
-const char* pkg2_patch_kips(link_t *info, char* patchNames);
+const char* pkg2_patch_kips(link_t *info, char* patchNames, arena_t *arena);
 
 const pkg2_kernel_id_t *pkg2_identify(u8 *hash);
 pkg2_hdr_t *pkg2_decrypt(void *data, u8 kb, bool is_exo);
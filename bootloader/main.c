@@ -232,7 +232,12 @@ int launch_payload(char *path, bool update, bool clear_screen)
 	if (update && is_ipl_updated(buf, path, false))
 		goto out;
 
+	trace_mark("payload");
+	if (h_cfg.boottrace)
+		trace_dump(TRACE_DUMP_PATH);
+
 	sd_end();
+	ccplex_job_stop();
 
 	if (size < 0x30000)
 	{
@@ -508,11 +513,14 @@ void launch_firmware()
 	emummc_load_cfg();
 
 	// Check that main configuration exists and parse it.
+	u32 trace_id = trace_begin("ini_parse");
 	if (!ini_parse(&ini_sections, "bootloader/hekate_ipl.ini", false))
 	{
+		trace_end(trace_id);
 		EPRINTF("Could not open 'bootloader/hekate_ipl.ini'!");
 		goto parse_failed;
 	}
+	trace_end(trace_id);
 
 	// Build configuration menu.
 	ment_t *ments = (ment_t *)malloc(sizeof(ment_t) * (max_entries + 6));
@@ -650,7 +658,10 @@ void nyx_load_run()
 	if (!nyx)
 		return;
 
+	trace_mark("nyx");
+
 	sd_end();
+	ccplex_job_stop();
 
 	render_default_bootlogo();
 	display_backlight_brightness(h_cfg.backlight, 1000);
@@ -810,7 +821,10 @@ static void _auto_launch_firmware()
 		create_config_entry();
 
 	// Parse hekate main configuration.
-	if (!ini_parse(&ini_sections, "bootloader/hekate_ipl.ini", false))
+	u32 trace_id = trace_begin("ini_parse");
+	bool ini_loaded = ini_parse(&ini_sections, "bootloader/hekate_ipl.ini", false);
+	trace_end(trace_id);
+	if (!ini_loaded)
 		goto out; // Can't load hekate_ipl.ini.
 
 	// Load configuration.
@@ -850,6 +864,8 @@ static void _auto_launch_firmware()
 						h_cfg.updater2p = atoi(kv->val);
 					else if (!strcmp("bootprotect", kv->key))
 						h_cfg.bootprotect = atoi(kv->val);
+					else if (!strcmp("boottrace", kv->key))
+						h_cfg.boottrace = atoi(kv->val);
 				}
 				boot_entry_id++;
 
@@ -1324,6 +1340,7 @@ out:
 
 void ipl_reload()
 {
+	ccplex_job_stop();
 	hw_reinit_workaround(false, 0);
 
 	// Reload hekate.
@@ -1474,9 +1491,15 @@ extern void pivot_stack(u32 stack_top);
 
 void ipl_main()
 {
+	u32 hw_init_start = get_tmr_us();
+
 	// Do initial HW configuration. This is compatible with consecutive reruns without a reset.
 	hw_init();
 
+	// Start boot tracing. The ring is in DRAM, so previous spans are kept if this is a reload.
+	trace_init();
+	trace_span("hw_init", hw_init_start);
+
 	// Pivot the stack so we have enough space.
 	pivot_stack(IPL_STACK_TOP);
 
@@ -1498,23 +1521,30 @@ void ipl_main()
 	display_init();
 
 	// Mount SD Card.
+	u32 trace_id = trace_begin("sd_mount");
 	h_cfg.errors |= !sd_mount() ? ERR_SD_BOOT_EN : 0;
+	trace_end(trace_id);
 
-	// Check if watchdog was fired previously.
+	// Check if watchdog was fired previously. Drop trained DRAM tables in case they caused it.
 	if (watchdog_fired())
+	{
+		minerva_cache_invalidate();
 		goto skip_lp0_minerva_config;
+	}
 
 	// Enable watchdog protection to avoid SD corruption based hanging in LP0/Minerva config.
 	watchdog_start(5000000 / 2, TIMER_FIQENABL_EN); // 5 seconds.
 
 	// Save sdram lp0 config.
 	void *sdram_params = h_cfg.t210b01 ? sdram_get_params_t210b01() : sdram_get_params_patched();
-	if (!ianos_loader("bootloader/sys/libsys_lp0.bso", DRAM_LIB, sdram_params))
+	if (!ianos_loader("bootloader/sys/libsys_lp0.bso", DRAM_LIB, sdram_params, NULL))
 		h_cfg.errors |= ERR_LIBSYS_LP0;
 
 	// Train DRAM and switch to max frequency.
+	trace_id = trace_begin("minerva_init");
 	if (minerva_init()) //!TODO: Add Tegra210B01 support to minerva.
 		h_cfg.errors |= ERR_LIBSYS_MTC;
+	trace_end(trace_id);
 
 	// Disable watchdog protection.
 	watchdog_end();
@@ -23,6 +23,8 @@
 #include "../config.h"
 #include <libs/fatfs/ff.h>
 
+#define EMUMMC_EXTENTS_MAX 1024
+
 extern hekate_config h_cfg;
 emummc_cfg_t emu_cfg = { 0 };
 
@@ -46,27 +48,21 @@ void emummc_load_cfg()
 	LIST_INIT(ini_sections);
 	if (ini_parse(&ini_sections, "emuMMC/emummc.ini", false))
 	{
-		LIST_FOREACH_ENTRY(ini_sec_t, ini_sec, &ini_sections, link)
+		ini_sec_t *ini_sec = ini_find_section(&ini_sections, "emummc");
+		if (ini_sec)
 		{
-			if (ini_sec->type == INI_CHOICE)
+			LIST_FOREACH_ENTRY(ini_kv_t, kv, &ini_sec->kvs, link)
 			{
-				if (strcmp(ini_sec->name, "emummc"))
-					continue;
-
-				LIST_FOREACH_ENTRY(ini_kv_t, kv, &ini_sec->kvs, link)
-				{
-					if (!strcmp("enabled", kv->key))
-						emu_cfg.enabled = atoi(kv->val);
-					else if (!strcmp("sector", kv->key))
-						emu_cfg.sector = strtol(kv->val, NULL, 16);
-					else if (!strcmp("id", kv->key))
-						emu_cfg.id = strtol(kv->val, NULL, 16);
-					else if (!strcmp("path", kv->key))
-						emu_cfg.path = kv->val;
-					else if (!strcmp("nintendo_path", kv->key))
-						strcpy(emu_cfg.nintendo_path, kv->val);
-				}
-				break;
+				if (!strcmp("enabled", kv->key))
+					emu_cfg.enabled = atoi(kv->val);
+				else if (!strcmp("sector", kv->key))
+					emu_cfg.sector = strtol(kv->val, NULL, 16);
+				else if (!strcmp("id", kv->key))
+					emu_cfg.id = strtol(kv->val, NULL, 16);
+				else if (!strcmp("path", kv->key))
+					emu_cfg.path = kv->val;
+				else if (!strcmp("nintendo_path", kv->key))
+					strcpy(emu_cfg.nintendo_path, kv->val);
 			}
 		}
 	}
@@ -132,11 +128,82 @@ static int emummc_raw_get_part_off(int part_idx)
 	return 2;
 }
 
+static void _emummc_extents_free()
+{
+	for (u32 i = 0; i < 3; i++)
+	{
+		free(emu_cfg.extents[i]);
+		emu_cfg.extents[i] = NULL;
+		emu_cfg.extents_cnt[i] = 0;
+	}
+}
+
+static int _emummc_extents_build(u32 part, const char *path)
+{
+	char *file_path = (char *)malloc(0x200);
+	emummc_extent_t *extents = (emummc_extent_t *)malloc(EMUMMC_EXTENTS_MAX * sizeof(emummc_extent_t));
+	u32 cnt = 0;
+	u32 files = 0;
+	int res = 1;
+
+	strcpy(file_path, path);
+	if (!part)
+	{
+		// Map all parts of the user partition.
+		u32 path_len = strlen(file_path);
+		while (true)
+		{
+			file_path[path_len] = '/';
+			if (files >= 10)
+				itoa(files, file_path + path_len + 1, 10);
+			else
+			{
+				file_path[path_len + 1] = '0';
+				itoa(files, file_path + path_len + 2, 10);
+			}
+			if (f_stat(file_path, NULL))
+				break;
+
+			if (!emummc_extents_add_file(extents, &cnt, EMUMMC_EXTENTS_MAX, file_path, files * emu_cfg.file_based_part_size))
+			{
+				res = 0;
+				break;
+			}
+			files++;
+		}
+	}
+	else
+	{
+		strcat(file_path, part == 1 ? "/BOOT0" : "/BOOT1");
+		res = emummc_extents_add_file(extents, &cnt, EMUMMC_EXTENTS_MAX, file_path, 0);
+		files = 1;
+	}
+
+	free(file_path);
+
+	if (!res || !cnt)
+	{
+		free(extents);
+		return 0;
+	}
+
+	if (cnt > files)
+		gfx_printf("%kemuMMC %s is fragmented (%d extents)%k\n", TXT_CLR_ORANGE,
+			!part ? "rawnand" : (part == 1 ? "BOOT0" : "BOOT1"), cnt, TXT_CLR_DEFAULT);
+
+	emu_cfg.extents[part] = extents;
+	emu_cfg.extents_cnt[part] = cnt;
+
+	return 1;
+}
+
 int emummc_storage_init_mmc()
 {
 	FILINFO fno;
 	emu_cfg.active_part = 0;
 
+	_emummc_extents_free();
+
 	// Always init eMMC even when in emuMMC. eMMC is needed from the emuMMC driver anyway.
 	if (!emmc_initialize(false))
 		return 2;
@@ -166,6 +233,12 @@ int emummc_storage_init_mmc()
 			goto out;
 		}
 		emu_cfg.file_based_part_size = fno.fsize >> 9;
+
+		// Resolve files to SD sectors. If that fails, access goes through FatFs.
+		emu_cfg.emummc_file_based_path[strlen(emu_cfg.emummc_file_based_path) - 3] = 0;
+		for (u32 part = 0; part < 3; part++)
+			_emummc_extents_build(part, emu_cfg.emummc_file_based_path);
+		strcat(emu_cfg.emummc_file_based_path, "/00");
 	}
 
 	return 0;
@@ -195,6 +268,9 @@ int emummc_storage_read(u32 sector, u32 num_sectors, void *buf)
 		sector += emummc_raw_get_part_off(emu_cfg.active_part) * 0x2000;
 		return sdmmc_storage_read(&sd_storage, sector, num_sectors, buf);
 	}
+	else if (emu_cfg.extents[emu_cfg.active_part])
+		return emummc_extents_rw(emu_cfg.extents[emu_cfg.active_part], emu_cfg.extents_cnt[emu_cfg.active_part],
+			sector, num_sectors, buf, false);
 	else
 	{
 		if (!emu_cfg.active_part)
@@ -240,6 +316,9 @@ int emummc_storage_write(u32 sector, u32 num_sectors, void *buf)
 		sector += emummc_raw_get_part_off(emu_cfg.active_part) * 0x2000;
 		return sdmmc_storage_write(&sd_storage, sector, num_sectors, buf);
 	}
+	else if (emu_cfg.extents[emu_cfg.active_part])
+		return emummc_extents_rw(emu_cfg.extents[emu_cfg.active_part], emu_cfg.extents_cnt[emu_cfg.active_part],
+			sector, num_sectors, buf, true);
 	else
 	{
 		if (!emu_cfg.active_part)
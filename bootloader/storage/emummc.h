@@ -19,6 +19,8 @@
 
 #include <bdk.h>
 
+#include "emummc_extents.h"
+
 typedef enum
 {
 	EMUMMC_TYPE_NONE      = 0,
@@ -44,6 +46,8 @@ typedef struct _emummc_cfg_t
 	u32 file_based_part_size;
 	u32 active_part;
 	int fs_ver;
+	emummc_extent_t *extents[3]; // File based physical map per eMMC partition.
+	u32 extents_cnt[3];
 } emummc_cfg_t;
 
 extern emummc_cfg_t emu_cfg;
@@ -0,0 +1,125 @@
+/*
+ * File based emuMMC to SD sector mapping.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <libs/fatfs/ff.h>
+#include <mem/heap.h>
+#include <storage/sd.h>
+#include "emummc_extents.h"
+
+#define EMUMMC_CLMT_RUNS 2047
+#define EMUMMC_CLMT_SIZE ((EMUMMC_CLMT_RUNS * 2 + 2) * sizeof(DWORD)) // 16KB.
+
+int emummc_extents_add_file(emummc_extent_t *extents, u32 *cnt, u32 max_cnt, const char *path, u32 sector)
+{
+	FIL fp;
+	int res = 0;
+
+	if (f_open(&fp, path, FA_READ))
+		return 0;
+
+	/*
+	 * Get cluster runs of the file. Done directly instead of f_expand_cltbl, so a too fragmented file is not an error.
+	 * FatFs counts the runs first and only fills the table if they fit. Otherwise the file silently falls back to FatFs access.
+	 */
+	DWORD *clmt = (DWORD *)malloc(EMUMMC_CLMT_SIZE);
+	clmt[0] = EMUMMC_CLMT_SIZE / sizeof(DWORD);
+	fp.cltbl = clmt;
+	if (f_lseek(&fp, CREATE_LINKMAP) != FR_OK)
+		goto out;
+
+	FATFS *fs = fp.obj.fs;
+	u32 sectors_left = f_size(&fp) >> 9;
+	for (DWORD *run = clmt + 1; *run && sectors_left; run += 2)
+	{
+		u32 num_sectors = MIN(run[0] * fs->csize, sectors_left);
+		u32 sd_sector = fs->database + (run[1] - 2) * fs->csize;
+
+		// Merge with previous extent if contiguous.
+		emummc_extent_t *prev = *cnt ? &extents[*cnt - 1] : NULL;
+		if (prev && (prev->sector + prev->num_sectors) == sector && (prev->sd_sector + prev->num_sectors) == sd_sector)
+			prev->num_sectors += num_sectors;
+		else
+		{
+			if (*cnt >= max_cnt)
+				goto out;
+
+			extents[*cnt].sector = sector;
+			extents[*cnt].sd_sector = sd_sector;
+			extents[*cnt].num_sectors = num_sectors;
+			(*cnt)++;
+		}
+
+		sector += num_sectors;
+		sectors_left -= num_sectors;
+	}
+
+	res = !sectors_left;
+
+out:
+	fp.cltbl = NULL;
+	f_close(&fp);
+	free(clmt);
+
+	return res;
+}
+
+u32 emummc_extents_find(const emummc_extent_t *extents, u32 cnt, u32 sector)
+{
+	// Binary search for the last extent that starts at or before sector.
+	u32 lo = 0;
+	u32 hi = cnt;
+	while ((hi - lo) > 1)
+	{
+		u32 mid = (lo + hi) / 2;
+		if (extents[mid].sector <= sector)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+int emummc_extents_rw(const emummc_extent_t *extents, u32 cnt, u32 sector, u32 num_sectors, void *buf, bool is_write)
+{
+	u8 *pbuf = (u8 *)buf;
+
+	// Find the extent that holds the first sector.
+	for (u32 i = emummc_extents_find(extents, cnt, sector); num_sectors; i++)
+	{
+		if (i >= cnt || sector < extents[i].sector)
+			return 0;
+
+		u32 offset = sector - extents[i].sector;
+		if (offset >= extents[i].num_sectors)
+			return 0;
+
+		u32 sct_cnt = MIN(num_sectors, extents[i].num_sectors - offset);
+		int res;
+		if (is_write)
+			res = sdmmc_storage_write(&sd_storage, extents[i].sd_sector + offset, sct_cnt, pbuf);
+		else
+			res = sdmmc_storage_read(&sd_storage, extents[i].sd_sector + offset, sct_cnt, pbuf);
+		if (!res)
+			return 0;
+
+		sector += sct_cnt;
+		num_sectors -= sct_cnt;
+		pbuf += sct_cnt << 9;
+	}
+
+	return 1;
+}
@@ -0,0 +1,33 @@
+/*
+ * File based emuMMC to SD sector mapping.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMUMMC_EXTENTS_H
+#define EMUMMC_EXTENTS_H
+
+#include <utils/types.h>
+
+typedef struct _emummc_extent_t
+{
+	u32 sector;      // emuMMC sector.
+	u32 sd_sector;   // SD sector.
+	u32 num_sectors;
+} emummc_extent_t;
+
+int emummc_extents_add_file(emummc_extent_t *extents, u32 *cnt, u32 max_cnt, const char *path, u32 sector);
+u32 emummc_extents_find(const emummc_extent_t *extents, u32 cnt, u32 sector);
+int emummc_extents_rw(const emummc_extent_t *extents, u32 cnt, u32 sector, u32 num_sectors, void *buf, bool is_write);
+
+#endif
@@ -35,6 +35,7 @@ void set_default_configuration()
 	h_cfg.autonogc = 1;
 	h_cfg.updater2p = 0;
 	h_cfg.bootprotect = 0;
+	h_cfg.boottrace = 0;
 	h_cfg.errors = 0;
 	h_cfg.eks = NULL;
 	h_cfg.rcm_patched = fuse_check_patched_rcm();
@@ -52,6 +53,7 @@ void set_nyx_default_configuration()
 	n_cfg.home_screen = 0;
 	n_cfg.verification = 1;
 	n_cfg.ums_emmc_rw = 0;
+	n_cfg.ums_write_cache = 0;
 	n_cfg.jc_disable = 0;
 	n_cfg.jc_force_right = 0;
 	n_cfg.bpmp_clock = 0;
@@ -129,6 +131,10 @@ int create_config_entry()
 	f_puts("\nbootprotect=", &fp);
 	itoa(h_cfg.bootprotect, lbuf, 10);
 	f_puts(lbuf, &fp);
+
+	f_puts("\nboottrace=", &fp);
+	itoa(h_cfg.boottrace, lbuf, 10);
+	f_puts(lbuf, &fp);
 	f_puts("\n", &fp);
 
 	if (mainIniFound)
@@ -174,6 +180,7 @@ int create_config_entry()
 	}
 
 	f_close(&fp);
+	ini_invalidate("bootloader/hekate_ipl.ini");
 	sd_unmount();
 
 	return 0;
@@ -214,6 +221,9 @@ int create_nyx_config_entry(bool force_unmount)
 	f_puts("\numsemmcrw=", &fp);
 	itoa(n_cfg.ums_emmc_rw, lbuf, 10);
 	f_puts(lbuf, &fp);
+	f_puts("\numswcache=", &fp);
+	itoa(n_cfg.ums_write_cache, lbuf, 10);
+	f_puts(lbuf, &fp);
 	f_puts("\njcdisable=", &fp);
 	itoa(n_cfg.jc_disable, lbuf, 10);
 	f_puts(lbuf, &fp);
@@ -226,6 +236,7 @@ int create_nyx_config_entry(bool force_unmount)
 	f_puts("\n", &fp);
 
 	f_close(&fp);
+	ini_invalidate("bootloader/nyx.ini");
 
 	if (force_unmount || !sd_mounted)
 		sd_unmount();
@@ -32,6 +32,7 @@ typedef struct _hekate_config
 	u32 autonogc;
 	u32 updater2p;
 	u32 bootprotect;
+	u32 boottrace;
 	// Global temporary config.
 	bool t210b01;
 	bool emummc_force_disable;
@@ -48,6 +49,7 @@ typedef struct _nyx_config
 	u32 home_screen;
 	u32 verification;
 	u32 ums_emmc_rw;
+	u32 ums_write_cache;
 	u32 jc_disable;
 	u32 jc_force_right;
 	u32 bpmp_clock;
@@ -0,0 +1,273 @@
+/*
+ * Copy engine for partition manager backup and restore.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <memory_map.h>
+#include <mem/heap.h>
+#include <soc/timer.h>
+#include <storage/ramdisk.h>
+#include <utils/sprintf.h>
+#include <utils/types.h>
+
+#include "gui.h"
+#include "fe_copy_files.h"
+#include <libs/fatfs/ff.h>
+
+#define COPY_MAX_DEPTH 64
+#define COPY_STATS_MS  500
+
+typedef struct _copy_ctxt_t
+{
+	const char *src;
+	const char *dst;
+	lv_obj_t *label;
+	u8  *buf;
+
+	u32 files_done;
+	u64 bytes_done;
+	u32 timer_start;
+	u32 timer_stats;
+} copy_ctxt_t;
+
+static copy_ctxt_t *copy_ctxt;
+
+static void _copy_stats_update(bool force)
+{
+	char txt_buf[64];
+
+	u32 time = get_tmr_ms();
+	if (!force && (time - copy_ctxt->timer_stats) < COPY_STATS_MS)
+		return;
+
+	copy_ctxt->timer_stats = time;
+
+	u32 elapsed = MAX(time - copy_ctxt->timer_start, 1);
+	u32 files_rate = (u64)copy_ctxt->files_done * 1000 / elapsed;
+	u32 rate = copy_ctxt->bytes_done * 1000 / elapsed / 1024; // KB/s.
+
+	if (copy_ctxt->label)
+	{
+		s_printf(txt_buf, "%d files, %d files/s, %d.%02d MB/s",
+			copy_ctxt->files_done, files_rate, rate / 1024, (rate % 1024) * 100 / 1024);
+		lv_label_set_text(copy_ctxt->label, txt_buf);
+	}
+
+	manual_system_maintenance(true);
+}
+
+static int _copy_file(const char *path, const FILINFO *fno)
+{
+	static FIL fp_src;
+	static FIL fp_dst;
+
+	int res;
+	UINT bytes;
+	u32 size = fno->fsize;
+
+	f_chdrive(copy_ctxt->dst);
+	res = f_open(&fp_dst, path, FA_CREATE_ALWAYS | FA_WRITE);
+	if (res != FR_OK)
+		goto out;
+
+	// Allocate a contiguous cluster block if possible. Otherwise preallocate the chain.
+	if (size && f_expand(&fp_dst, size, 1) != FR_OK)
+	{
+		f_lseek(&fp_dst, size);
+		f_lseek(&fp_dst, 0);
+	}
+
+	f_chdrive(copy_ctxt->src);
+	res = f_open(&fp_src, path, FA_READ);
+	if (res != FR_OK)
+	{
+		f_close(&fp_dst);
+		goto out;
+	}
+
+	while (size)
+	{
+		u32 chunk_size = MIN(size, COPY_BUF_SZ);
+		size -= chunk_size;
+
+		res = f_read(&fp_src, copy_ctxt->buf, chunk_size, &bytes);
+		if (res == FR_OK && bytes != chunk_size)
+			res = FR_DISK_ERR;
+		if (res == FR_OK)
+			res = f_write(&fp_dst, copy_ctxt->buf, chunk_size, &bytes);
+		if (res == FR_OK && bytes != chunk_size)
+			res = FR_DENIED; // Destination is full.
+		if (res != FR_OK)
+			break;
+
+		copy_ctxt->bytes_done += chunk_size;
+		_copy_stats_update(false);
+	}
+	f_close(&fp_src);
+
+	// Close also writes the directory entry.
+	if (f_close(&fp_dst) != FR_OK && res == FR_OK)
+		res = FR_DISK_ERR;
+
+	if (res == FR_OK)
+	{
+		f_chdrive(copy_ctxt->dst);
+		res = f_chmod(path, fno->fattrib, 0xFF);
+	}
+
+	copy_ctxt->files_done++;
+	_copy_stats_update(false);
+
+out:
+	f_chdrive(copy_ctxt->src);
+
+	return res;
+}
+
+static int _copy_files_stat(const char *src, const char *dst, char *path, u32 *total_files, u32 *total_size, lv_obj_t **labels, u32 depth)
+{
+	FRESULT res;
+	DIR dir;
+	u32 dirLength = 0;
+	static FILINFO fno;
+
+	// Folders are entered recursively. Fail on too deep trees instead of skipping them.
+	if (depth > COPY_MAX_DEPTH)
+		return FR_DENIED;
+
+	f_chdrive(src);
+
+	// Open directory.
+	res = f_opendir(&dir, path);
+	if (res != FR_OK)
+		return res;
+
+	if (labels)
+		lv_label_set_text(labels[0], path);
+
+	dirLength = strlen(path);
+
+	// Hard limit path to 1024 characters. Do not result to error.
+	if (dirLength > 1024)
+		goto out;
+
+	for (;;)
+	{
+		// Clear file path.
+		path[dirLength] = 0;
+
+		// Read a directory item.
+		res = f_readdir(&dir, &fno);
+
+		// Break on error or end of dir.
+		if (res != FR_OK || fno.fname[0] == 0)
+			break;
+
+		// Set new directory or file.
+		memcpy(&path[dirLength], "/", 1);
+		strcpy(&path[dirLength + 1], fno.fname);
+
+		// Copy file to destination disk.
+		if (!(fno.fattrib & AM_DIR))
+		{
+			u32 file_size = fno.fsize > RAMDISK_CLUSTER_SZ ? fno.fsize : RAMDISK_CLUSTER_SZ; // Ramdisk cluster size.
+
+			// Check for overflow.
+			if ((file_size + *total_size) < *total_size)
+			{
+				// Set size to > 1GB, skip next folders and return.
+				*total_size = SZ_2G;
+				res = -1;
+				break;
+			}
+
+			*total_size += file_size;
+			*total_files += 1;
+
+			if (dst)
+			{
+				res = _copy_file(path, &fno);
+				if (res != FR_OK)
+					break;
+			}
+
+			// If total is > 1GB exit.
+			if (*total_size > (RAM_DISK_SZ - SZ_16M)) // 0x2400000.
+			{
+				// Skip next folders and return.
+				res = -1;
+				break;
+			}
+		}
+		else // It's a directory.
+		{
+			if (!memcmp("System Volume Information", fno.fname, 25))
+				continue;
+
+			// Create folder to destination.
+			if (dst)
+			{
+				f_chdrive(dst);
+				res = f_mkdir(path);
+				if (res == FR_OK || res == FR_EXIST)
+					res = f_chmod(path, fno.fattrib, 0xFF);
+				f_chdrive(src);
+				if (res != FR_OK)
+					break;
+			}
+
+			// Enter the directory.
+			res = _copy_files_stat(src, dst, path, total_files, total_size, labels, depth + 1);
+			if (res != FR_OK)
+				break;
+
+			if (labels)
+			{
+				// Clear folder path.
+				path[dirLength] = 0;
+				lv_label_set_text(labels[0], path);
+			}
+		}
+	}
+
+out:
+	f_closedir(&dir);
+
+	return res;
+}
+
+int copy_files_stat(const char *src, const char *dst, char *path, u32 *total_files, u32 *total_size, lv_obj_t **labels)
+{
+	return _copy_files_stat(src, dst, path, total_files, total_size, labels, 0);
+}
+
+void copy_files_init(const char *src, const char *dst, u8 *buf, lv_obj_t *label)
+{
+	copy_ctxt = calloc(1, sizeof(copy_ctxt_t));
+	copy_ctxt->src = src;
+	copy_ctxt->dst = dst;
+	copy_ctxt->label = label;
+	copy_ctxt->buf = buf;
+	copy_ctxt->timer_start = get_tmr_ms();
+}
+
+void copy_files_end()
+{
+	_copy_stats_update(true);
+
+	free(copy_ctxt);
+	copy_ctxt = NULL;
+}
@@ -0,0 +1,31 @@
+/*
+ * Copy engine for partition manager backup and restore.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _FE_COPY_FILES_H_
+#define _FE_COPY_FILES_H_
+
+#include "gui.h"
+
+#define COPY_BUF_SZ SZ_4M // Minimum copy buffer size.
+
+// Buffer must hold COPY_BUF_SZ. Stats are shown in label if not NULL.
+void copy_files_init(const char *src, const char *dst, u8 *buf, lv_obj_t *label);
+// Walks path in src and sums files and sizes. Also copies them to dst if not NULL. Needs copy_files_init() then.
+int  copy_files_stat(const char *src, const char *dst, char *path, u32 *total_files, u32 *total_size, lv_obj_t **labels);
+// Shows final stats.
+void copy_files_end();
+
+#endif
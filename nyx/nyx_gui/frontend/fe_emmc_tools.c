@@ -137,13 +137,14 @@ static void _update_filename(char *outFilename, u32 sdPathLen, u32 currPartIdx)
 		itoa(currPartIdx, &outFilename[sdPathLen], 10);
 }
 
-static int _dump_emmc_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage, u32 lba_curr, char *outFilename, emmc_part_t *part)
+int dump_emmc_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage, u32 lba_curr, char *outFilename, emmc_part_t *part, const u8 *hashes)
 {
 	FIL fp;
 	FIL hashFp;
 	u8 sparseShouldVerify = 4;
 	u32 prevPct = 200;
 	u32 sdFileSector = 0;
+	u32 chunkIdx = 0;
 	int res = 0;
 	const char hexa[] = "0123456789abcdef";
 	DWORD *clmt = NULL;
@@ -205,26 +206,32 @@ static int _dump_emmc_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage, u32
 			// Check every time or every 4.
 			// Every 4 protects from fake sd, sector corruption and frequent I/O corruption.
 			// Full provides all that, plus protection from extremely rare I/O corruption.
+			// If eMMC side was hashed while dumping, only the SD card is read back.
 			if ((n_cfg.verification >= 2) || !(sparseShouldVerify % 4))
 			{
-				if (!sdmmc_storage_read(storage, lba_curr, num, bufEm))
+				if (hashes)
+					memcpy(hashEm, hashes + chunkIdx * SE_SHA_256_SIZE, SE_SHA_256_SIZE);
+				else
 				{
-					s_printf(gui->txt_buf,
-						"\n#FF0000 Failed to read %d blocks (@LBA %08X),#\n"
-						"#FF0000 from eMMC! Verification failed..#\n",
-						num, lba_curr);
-					lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
-					manual_system_maintenance(true);
-
-					free(clmt);
-					f_close(&fp);
-					if (n_cfg.verification == 3)
-						f_close(&hashFp);
-
-					return 1;
+					if (!sdmmc_storage_read(storage, lba_curr, num, bufEm))
+					{
+						s_printf(gui->txt_buf,
+							"\n#FF0000 Failed to read %d blocks (@LBA %08X),#\n"
+							"#FF0000 from eMMC! Verification failed..#\n",
+							num, lba_curr);
+						lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+						manual_system_maintenance(true);
+
+						free(clmt);
+						f_close(&fp);
+						if (n_cfg.verification == 3)
+							f_close(&hashFp);
+
+						return 1;
+					}
+					manual_system_maintenance(false);
+					se_calc_sha256(hashEm, NULL, bufEm, num << 9, 0, SHA_INIT_HASH, false);
 				}
-				manual_system_maintenance(false);
-				se_calc_sha256(hashEm, NULL, bufEm, num << 9, 0, SHA_INIT_HASH, false);
 
 				f_lseek(&fp, (u64)sdFileSector << (u64)9);
 				if (f_read_fast(&fp, bufSd, num << 9))
@@ -244,7 +251,8 @@ static int _dump_emmc_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage, u32
 					return 1;
 				}
 				manual_system_maintenance(false);
-				se_calc_sha256_finalize(hashEm, NULL);
+				if (!hashes)
+					se_calc_sha256_finalize(hashEm, NULL);
 				se_calc_sha256_oneshot(hashSd, bufSd, num << 9);
 				res = memcmp(hashEm, hashSd, SE_SHA_256_SIZE / 2);
 
@@ -298,6 +306,7 @@ static int _dump_emmc_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage, u32
 			totalSectorsVer -= num;
 			sdFileSector += num;
 			sparseShouldVerify++;
+			chunkIdx++;
 
 			// Check for cancellation combo.
 			if (btn_read_vol() == (BTN_VOL_UP | BTN_VOL_DOWN))
@@ -338,7 +347,7 @@ static int _dump_emmc_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage, u32
 
 bool partial_sd_full_unmount = false;
 
-static int _dump_emmc_part(emmc_tool_gui_t *gui, char *sd_path, int active_part, sdmmc_storage_t *storage, emmc_part_t *part)
+static int _dump_emmc_part_inner(emmc_tool_gui_t *gui, char *sd_path, int active_part, sdmmc_storage_t *storage, emmc_part_t *part, u8 *hashes)
 {
 	const u32 FAT32_FILESIZE_LIMIT = 0xFFFFFFFF;
 	const u32 SECTORS_TO_MIB_COEFF = 11;
@@ -500,6 +509,14 @@ static int _dump_emmc_part(emmc_tool_gui_t *gui, char *sd_path, int active_part,
 	}
 
 	u8 *buf = (u8 *)MIXD_BUF_ALIGNED;
+	u8 *bufNext = (u8 *)MIXD_BUF_ALIGNED + NUM_SECTORS_PER_ITER * EMMC_BLOCKSIZE;
+
+	// Pipeline eMMC reads with SD writes, if source is not the SD card.
+	bool pipelineReads = !gui->raw_emummc && storage->sdmmc != sd_storage.sdmmc;
+	bool chunkQueued = false;
+
+	// Hash chunks while dumping, so verification only reads back the SD card.
+	u32 hashIdx = 0;
 
 	u32 lba_curr = part->lba_start;
 	u32 lbaStartPart = part->lba_start;
@@ -535,10 +552,10 @@ static int _dump_emmc_part(emmc_tool_gui_t *gui, char *sd_path, int active_part,
 			memset(&fp, 0, sizeof(fp));
 			currPartIdx++;
 
-			if (n_cfg.verification && !gui->raw_emummc)
+			if (hashes)
 			{
 				// Verify part.
-				if (_dump_emmc_verify(gui, storage, lbaStartPart, outFilename, part))
+				if (dump_emmc_verify(gui, storage, lbaStartPart, outFilename, part, hashes))
 				{
 					s_printf(gui->txt_buf, "#FFDD00 Please try again...#\n");
 					lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
@@ -548,6 +565,8 @@ static int _dump_emmc_part(emmc_tool_gui_t *gui, char *sd_path, int active_part,
 				}
 				lv_bar_set_style(gui->bar, LV_BAR_STYLE_BG, lv_theme_get_current()->bar.bg);
 				lv_bar_set_style(gui->bar, LV_BAR_STYLE_INDIC, gui->bar_white_ind);
+
+				hashIdx = 0;
 			}
 
 			_update_filename(outFilename, sdPathLen, currPartIdx);
@@ -615,10 +634,13 @@ static int _dump_emmc_part(emmc_tool_gui_t *gui, char *sd_path, int active_part,
 		num = MIN(totalSectors, NUM_SECTORS_PER_ITER);
 
 		int res_read;
-		if (!gui->raw_emummc)
+		if (chunkQueued)
+			res_read = !sdmmc_storage_async_wait(storage);
+		else if (!gui->raw_emummc)
 			res_read = !sdmmc_storage_read(storage, lba_curr, num, buf);
 		else
 			res_read = !sdmmc_storage_read(&sd_storage, lba_curr + sd_sector_off, num, buf);
+		chunkQueued = false;
 
 		while (res_read)
 		{
@@ -651,14 +673,32 @@ static int _dump_emmc_part(emmc_tool_gui_t *gui, char *sd_path, int active_part,
 		}
 		manual_system_maintenance(false);
 
+		// Queue next chunk so it gets read while this one is written. Never cross a part.
+		u32 numNext = MIN(totalSectors - num, NUM_SECTORS_PER_ITER);
+		if (pipelineReads && numNext && (numSplitParts == 0 || (bytesWritten + num * EMMC_BLOCKSIZE) < multipartSplitSize))
+			chunkQueued = sdmmc_storage_read_async(storage, lba_curr + num, numNext, bufNext);
+
+		// Hash chunk in background while it gets written.
+		if (hashes)
+			se_calc_sha256(hashes + hashIdx * SE_SHA_256_SIZE, NULL, buf, num << 9, 0, SHA_INIT_HASH, false);
+
 		res = f_write_fast(&fp, buf, EMMC_BLOCKSIZE * num);
 
+		if (hashes)
+		{
+			se_calc_sha256_finalize(hashes + hashIdx * SE_SHA_256_SIZE, NULL);
+			hashIdx++;
+		}
+
 		if (res)
 		{
 			s_printf(gui->txt_buf, "\n#FF0000 Fatal error (%d) when writing to SD Card#\nPlease try again...\n", res);
 			lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
 			manual_system_maintenance(true);
 
+			if (chunkQueued)
+				sdmmc_storage_async_wait(storage);
+
 			f_close(&fp);
 			free(clmt);
 			f_unlink(outFilename);
@@ -683,6 +723,14 @@ static int _dump_emmc_part(emmc_tool_gui_t *gui, char *sd_path, int active_part,
 		totalSectors -= num;
 		bytesWritten += num * EMMC_BLOCKSIZE;
 
+		// Swap buffers. Queued chunk becomes the current one.
+		if (pipelineReads)
+		{
+			u8 *bufTmp = buf;
+			buf = bufNext;
+			bufNext = bufTmp;
+		}
+
 		// Force a flush after a lot of data if not splitting.
 		if (numSplitParts == 0 && bytesWritten >= multipartSplitSize)
 		{
@@ -697,6 +745,9 @@ static int _dump_emmc_part(emmc_tool_gui_t *gui, char *sd_path, int active_part,
 			lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
 			manual_system_maintenance(true);
 
+			if (chunkQueued)
+				sdmmc_storage_async_wait(storage);
+
 			msleep(1500);
 
 			f_close(&fp);
@@ -714,10 +765,10 @@ static int _dump_emmc_part(emmc_tool_gui_t *gui, char *sd_path, int active_part,
 	f_close(&fp);
 	free(clmt);
 
-	if (n_cfg.verification && !gui->raw_emummc)
+	if (hashes)
 	{
 		// Verify last part or single file backup.
-		if (_dump_emmc_verify(gui, storage, lbaStartPart, outFilename, part))
+		if (dump_emmc_verify(gui, storage, lbaStartPart, outFilename, part, hashes))
 		{
 			s_printf(gui->txt_buf, "\n#FFDD00 Please try again...#\n");
 			lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
@@ -745,6 +796,24 @@ static int _dump_emmc_part(emmc_tool_gui_t *gui, char *sd_path, int active_part,
 	return 1;
 }
 
+static int _dump_emmc_part(emmc_tool_gui_t *gui, char *sd_path, int active_part, sdmmc_storage_t *storage, emmc_part_t *part)
+{
+	u8 *hashes = NULL;
+
+	// Allocate per chunk hashes for verification.
+	if (n_cfg.verification && !gui->raw_emummc)
+	{
+		u32 totalChunks = (part->lba_end - part->lba_start + NUM_SECTORS_PER_ITER) / NUM_SECTORS_PER_ITER;
+		hashes = (u8 *)malloc(totalChunks * SE_SHA_256_SIZE);
+	}
+
+	int res = _dump_emmc_part_inner(gui, sd_path, active_part, storage, part, hashes);
+
+	free(hashes);
+
+	return res;
+}
+
 void dump_emmc_selected(emmcPartType_t dumpType, emmc_tool_gui_t *gui)
 {
 	int res = 0;
@@ -1162,6 +1231,12 @@ multipart_not_allowed:
 	}
 
 	u8 *buf = (u8 *)MIXD_BUF_ALIGNED;
+	u8 *bufNext = (u8 *)MIXD_BUF_ALIGNED + NUM_SECTORS_PER_ITER * EMMC_BLOCKSIZE;
+
+	// Pipeline SD reads with eMMC writes, if destination is not the SD card.
+	bool pipelineWrites = !gui->raw_emummc && storage->sdmmc != sd_storage.sdmmc;
+	bool chunkPrefetched = false;
+	int resPrefetch = 0;
 
 	u32 lba_curr = part->lba_start;
 	u32 bytesWritten = 0;
@@ -1207,7 +1282,7 @@ multipart_not_allowed:
 			if (n_cfg.verification && !gui->raw_emummc)
 			{
 				// Verify part.
-				if (_dump_emmc_verify(gui, storage, lbaStartPart, outFilename, part))
+				if (dump_emmc_verify(gui, storage, lbaStartPart, outFilename, part, NULL))
 				{
 					s_printf(gui->txt_buf, "\n#FFDD00 Please try again...#\n");
 					lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
@@ -1247,7 +1322,11 @@ multipart_not_allowed:
 		retryCount = 0;
 		num = MIN(totalSectors, NUM_SECTORS_PER_ITER);
 
-		res = f_read_fast(&fp, buf, num << 9);
+		if (chunkPrefetched)
+			res = resPrefetch;
+		else
+			res = f_read_fast(&fp, buf, num << 9);
+		chunkPrefetched = false;
 		manual_system_maintenance(false);
 
 		if (res)
@@ -1263,7 +1342,22 @@ multipart_not_allowed:
 			free(clmt);
 			return 0;
 		}
-		if (!gui->raw_emummc)
+
+		bool chunkQueued = false;
+		if (pipelineWrites)
+			chunkQueued = sdmmc_storage_write_async(storage, lba_curr, num, buf);
+
+		// Read next chunk while the current one is written. Never cross a part.
+		u32 numNext = MIN(totalSectors - num, NUM_SECTORS_PER_ITER);
+		if (chunkQueued && numNext && (bytesWritten + num * EMMC_BLOCKSIZE) < fileSize)
+		{
+			resPrefetch = f_read_fast(&fp, bufNext, numNext << 9);
+			chunkPrefetched = true;
+		}
+
+		if (chunkQueued)
+			res = !sdmmc_storage_async_wait(storage);
+		else if (!gui->raw_emummc)
 			res = !sdmmc_storage_write(storage, lba_curr, num, buf);
 		else
 			res = !sdmmc_storage_write(&sd_storage, lba_curr + sd_sector_off, num, buf);
@@ -1317,6 +1411,14 @@ multipart_not_allowed:
 		lba_curr += num;
 		totalSectors -= num;
 		bytesWritten += num * EMMC_BLOCKSIZE;
+
+		// Swap buffers. Prefetched chunk becomes the current one.
+		if (pipelineWrites)
+		{
+			u8 *bufTmp = buf;
+			buf = bufNext;
+			bufNext = bufTmp;
+		}
 	}
 	lv_bar_set_value(gui->bar, 100);
 	lv_label_set_text(gui->label_pct, " "SYMBOL_DOT" 100%");
@@ -1329,7 +1431,7 @@ multipart_not_allowed:
 	if (n_cfg.verification && !gui->raw_emummc)
 	{
 		// Verify restored data.
-		if (_dump_emmc_verify(gui, storage, lbaStartPart, outFilename, part))
+		if (dump_emmc_verify(gui, storage, lbaStartPart, outFilename, part, NULL))
 		{
 			s_printf(gui->txt_buf, "#FFDD00 Please try again...#\n");
 			lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
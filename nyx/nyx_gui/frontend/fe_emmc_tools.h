@@ -29,6 +29,7 @@ typedef enum
 	PART_GP_ALL = BIT(7)
 } emmcPartType_t;
 
+int  dump_emmc_verify(emmc_tool_gui_t *gui, sdmmc_storage_t *storage, u32 lba_curr, char *outFilename, emmc_part_t *part, const u8 *hashes);
 void dump_emmc_selected(emmcPartType_t dumpType, emmc_tool_gui_t *gui);
 void restore_emmc_selected(emmcPartType_t restoreType, emmc_tool_gui_t *gui);
 
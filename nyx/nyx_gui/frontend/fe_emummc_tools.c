@@ -24,6 +24,7 @@
 #include <bdk.h>
 
 #include "gui.h"
+#include "fe_emmc_tools.h"
 #include "fe_emummc_tools.h"
 #include "../config.h"
 #include <libs/fatfs/diskio.h>
@@ -34,6 +35,7 @@
 #define NUM_SECTORS_PER_ITER 8192 // 4MB Cache.
 
 extern hekate_config h_cfg;
+extern nyx_config n_cfg;
 extern volatile boot_cfg_t *b_cfg;
 
 void load_emummc_cfg(emummc_cfg_t *emu_info)
@@ -124,6 +126,7 @@ void save_emummc_cfg(u32 part_idx, u32 sector_start, const char *path)
 		f_puts("\n", &fp);
 
 	f_close(&fp);
+	ini_invalidate("emuMMC/emummc.ini");
 }
 
 void update_emummc_base_folder(char *outFilename, u32 sdPathLen, u32 currPartIdx)
@@ -137,7 +140,7 @@ void update_emummc_base_folder(char *outFilename, u32 sdPathLen, u32 currPartIdx
 		itoa(currPartIdx, &outFilename[sdPathLen], 10);
 }
 
-static int _dump_emummc_file_part(emmc_tool_gui_t *gui, char *sd_path, sdmmc_storage_t *storage, emmc_part_t *part)
+static int _dump_emummc_file_part_inner(emmc_tool_gui_t *gui, char *sd_path, sdmmc_storage_t *storage, emmc_part_t *part, u8 *hashes)
 {
 	static const u32 FAT32_FILESIZE_LIMIT = 0xFFFFFFFF;
 	static const u32 SECTORS_TO_MIB_COEFF = 11;
@@ -199,9 +202,11 @@ static int _dump_emummc_file_part(emmc_tool_gui_t *gui, char *sd_path, sdmmc_sto
 	u8 *buf = (u8 *)MIXD_BUF_ALIGNED;
 
 	u32 lba_curr = part->lba_start;
+	u32 lbaStartPart = part->lba_start;
 	u32 bytesWritten = 0;
 	u32 prevPct = 200;
 	int retryCount = 0;
+	u32 hashIdx = 0;
 	DWORD *clmt = NULL;
 
 	u64 totalSize = (u64)((u64)totalSectors << 9);
@@ -224,6 +229,23 @@ static int _dump_emummc_file_part(emmc_tool_gui_t *gui, char *sd_path, sdmmc_sto
 			memset(&fp, 0, sizeof(fp));
 			currPartIdx++;
 
+			if (hashes)
+			{
+				// Verify part.
+				if (dump_emmc_verify(gui, storage, lbaStartPart, outFilename, part, hashes))
+				{
+					s_printf(gui->txt_buf, "#FFDD00 Please try again...#\n");
+					lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+					manual_system_maintenance(true);
+
+					return 0;
+				}
+				lv_bar_set_style(gui->bar, LV_BAR_STYLE_BG, lv_theme_get_current()->bar.bg);
+				lv_bar_set_style(gui->bar, LV_BAR_STYLE_INDIC, gui->bar_white_ind);
+
+				hashIdx = 0;
+			}
+
 			update_emummc_base_folder(outFilename, sdPathLen, currPartIdx);
 
 			// Create next part.
@@ -232,6 +254,7 @@ static int _dump_emummc_file_part(emmc_tool_gui_t *gui, char *sd_path, sdmmc_sto
 			lv_label_ins_text(gui->label_info, LV_LABEL_POS_LAST, gui->txt_buf);
 			manual_system_maintenance(true);
 
+			lbaStartPart = lba_curr;
 			res = f_open(&fp, outFilename, FA_CREATE_ALWAYS | FA_WRITE);
 			if (res)
 			{
@@ -299,8 +322,18 @@ static int _dump_emummc_file_part(emmc_tool_gui_t *gui, char *sd_path, sdmmc_sto
 
 		manual_system_maintenance(false);
 
+		// Hash chunk in background while it gets written.
+		if (hashes)
+			se_calc_sha256(hashes + hashIdx * SE_SHA_256_SIZE, NULL, buf, num << 9, 0, SHA_INIT_HASH, false);
+
 		res = f_write_fast(&fp, buf, EMMC_BLOCKSIZE * num);
 
+		if (hashes)
+		{
+			se_calc_sha256_finalize(hashes + hashIdx * SE_SHA_256_SIZE, NULL);
+			hashIdx++;
+		}
+
 		manual_system_maintenance(false);
 
 		if (res)
@@ -347,9 +380,43 @@ static int _dump_emummc_file_part(emmc_tool_gui_t *gui, char *sd_path, sdmmc_sto
 	f_close(&fp);
 	free(clmt);
 
+	if (hashes)
+	{
+		// Verify last part or single file backup.
+		if (dump_emmc_verify(gui, storage, lbaStartPart, outFilename, part, hashes))
+		{
+			s_printf(gui->txt_buf, "\n#FFDD00 Please try again...#\n");
+			lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+			manual_system_maintenance(true);
+
+			return 0;
+		}
+		lv_bar_set_value(gui->bar, 100);
+		lv_label_set_text(gui->label_pct, " "SYMBOL_DOT" 100%");
+		manual_system_maintenance(true);
+	}
+
 	return 1;
 }
 
+static int _dump_emummc_file_part(emmc_tool_gui_t *gui, char *sd_path, sdmmc_storage_t *storage, emmc_part_t *part)
+{
+	u8 *hashes = NULL;
+
+	// Allocate per chunk hashes for verification.
+	if (n_cfg.verification)
+	{
+		u32 totalChunks = (part->lba_end - part->lba_start + NUM_SECTORS_PER_ITER) / NUM_SECTORS_PER_ITER;
+		hashes = (u8 *)malloc(totalChunks * SE_SHA_256_SIZE);
+	}
+
+	int res = _dump_emummc_file_part_inner(gui, sd_path, storage, part, hashes);
+
+	free(hashes);
+
+	return res;
+}
+
 void dump_emummc_file(emmc_tool_gui_t *gui)
 {
 	int res = 0;
@@ -20,6 +20,7 @@
 
 #include "gui.h"
 #include "gui_emummc_tools.h"
+#include "gui_img_cache.h"
 #include "gui_tools.h"
 #include "gui_info.h"
 #include "gui_options.h"
@@ -624,7 +625,7 @@ void manual_system_maintenance(bool refresh)
 		lv_refr_now();
 }
 
-lv_img_dsc_t *bmp_to_lvimg_obj(const char *path)
+static lv_img_dsc_t *_bmp_to_lvimg_obj(const char *path)
 {
 	u32 fsize;
 	u8 *bitmap = sd_file_read(path, &fsize);
@@ -709,6 +710,24 @@ lv_img_dsc_t *bmp_to_lvimg_obj(const char *path)
 	return (lv_img_dsc_t *)bitmap;
 }
 
+lv_img_dsc_t *bmp_to_lvimg_obj(const char *path)
+{
+	FILINFO fno;
+	if (f_stat(path, &fno) != FR_OK)
+		return _bmp_to_lvimg_obj(path);
+
+	// Try the pre-decoded image first.
+	lv_img_dsc_t *img_desc = img_cache_load(path, &fno);
+	if (img_desc)
+		return img_desc;
+
+	img_desc = _bmp_to_lvimg_obj(path);
+	if (img_desc)
+		img_cache_save(path, &fno, img_desc);
+
+	return img_desc;
+}
+
 lv_res_t nyx_generic_onoff_toggle(lv_obj_t *btn)
 {
 	lv_obj_t *label_btn = lv_obj_get_child(btn, NULL);
@@ -1273,6 +1292,17 @@ static void _create_tab_about(lv_theme_t * th, lv_obj_t * parent)
 	lv_label_set_text(lbl_ver, version);
 }
 
+static bool _update_status_bar_label(lv_obj_t *label, const char *text)
+{
+	// Skip unchanged text, so the label area is not redrawn every update.
+	if (!strcmp(lv_label_get_text(label), text))
+		return false;
+
+	lv_label_set_text(label, text);
+
+	return true;
+}
+
 static void _update_status_bar(void *params)
 {
 	static char *label = NULL;
@@ -1313,10 +1343,11 @@ static void _update_status_bar(void *params)
 	s_printf(label, "%02d:%02d "SYMBOL_DOT" "SYMBOL_TEMPERATURE" %02d.%d",
 		time.hour, time.min, soc_temp_dec, (soc_temp & 0xFF) / 10);
 
-	lv_label_set_text(status_bar.time_temp, label);
-
-	lv_obj_realign(status_bar.temp_symbol);
-	lv_obj_realign(status_bar.temp_degrees);
+	if (_update_status_bar_label(status_bar.time_temp, label))
+	{
+		lv_obj_realign(status_bar.temp_symbol);
+		lv_obj_realign(status_bar.temp_degrees);
+	}
 
 	// Set battery percent and charging symbol.
 	s_printf(label, " "SYMBOL_DOT" %d.%d%% ", (batt_percent >> 8) & 0xFF, (batt_percent & 0xFF) / 26);
@@ -1337,8 +1368,8 @@ static void _update_status_bar(void *params)
 	if (charge_status)
 		strcat(label, " #FFDD00 "SYMBOL_CHARGE"#");
 
-	lv_label_set_text(status_bar.battery, label);
-	lv_obj_realign(status_bar.battery);
+	if (_update_status_bar_label(status_bar.battery, label))
+		lv_obj_realign(status_bar.battery);
 
 	// Set battery current draw and voltage.
 	s_printf(label, "#%s%d", batt_curr >= 0 ? "96FF00 +" : "FF3C28 ", batt_curr / 1000);
@@ -1347,8 +1378,8 @@ static void _update_status_bar(void *params)
 	s_printf(label + strlen(label), " mA# (%s%d mV%s)",
 		voltage_empty ? "#FF8000 " : "", batt_volt,  voltage_empty ? " "SYMBOL_WARNING"#" : "");
 
-	lv_label_set_text(status_bar.battery_more, label);
-	lv_obj_realign(status_bar.battery_more);
+	if (_update_status_bar_label(status_bar.battery_more, label))
+		lv_obj_realign(status_bar.battery_more);
 }
 
 static lv_res_t _create_mbox_payloads(lv_obj_t *btn)
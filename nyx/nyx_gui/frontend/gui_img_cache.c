@@ -0,0 +1,133 @@
+/*
+ * Cache of pre-decoded Nyx images, stored LZ4 compressed on SD.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <libs/compr/lz4.h>
+#include <mem/heap.h>
+#include <storage/sd.h>
+#include <utils/sprintf.h>
+#include <utils/types.h>
+
+#include "gui_img_cache.h"
+
+#define IMG_CACHE_MAGIC 0x43494E48 // "HNIC".
+
+typedef struct _img_cache_t
+{
+	u32 magic;
+	u32 bmp_size;
+	u32 bmp_mtime;
+	u32 data_size;
+	u32 compr_size;
+	lv_img_header_t header;
+	char path[104];
+} img_cache_t;
+
+static bool _img_cache_path(char *cache_path, const char *path)
+{
+	if (strlen(path) >= sizeof(((img_cache_t *)0)->path))
+		return false;
+
+	// FNV-1a hash of the BMP path.
+	u32 hash = 0x811C9DC5;
+	for (u32 i = 0; path[i]; i++)
+		hash = (hash ^ (u8)path[i]) * 0x01000193;
+
+	s_printf(cache_path, IMG_CACHE_DIR"/%08X.bin", hash);
+
+	return true;
+}
+
+lv_img_dsc_t *img_cache_load(const char *path, const FILINFO *fno)
+{
+	u32 fsize;
+	char cache_path[48];
+
+	if (!_img_cache_path(cache_path, path))
+		return NULL;
+
+	img_cache_t *cache = sd_file_read(cache_path, &fsize);
+	if (!cache)
+		return NULL;
+
+	lv_img_dsc_t *img_desc = NULL;
+
+	// Use the cache only if the BMP is unchanged.
+	if (fsize >= sizeof(img_cache_t) &&
+		cache->magic == IMG_CACHE_MAGIC &&
+		cache->bmp_size == fno->fsize &&
+		cache->bmp_mtime == (((u32)fno->fdate << 16) | fno->ftime) &&
+		fsize == sizeof(img_cache_t) + cache->compr_size &&
+		!strcmp(cache->path, path))
+	{
+		img_desc = malloc(sizeof(lv_img_dsc_t) + 0x10 + cache->data_size);
+		u8 *data = (u8 *)ALIGN((uptr)img_desc + sizeof(lv_img_dsc_t), 0x10);
+
+		int size = LZ4_decompress_safe((const char *)cache + sizeof(img_cache_t), (char *)data,
+			cache->compr_size, cache->data_size);
+
+		if (size == (int)cache->data_size)
+		{
+			img_desc->header = cache->header;
+			img_desc->data_size = cache->data_size;
+			img_desc->data = data;
+		}
+		else
+		{
+			free(img_desc);
+			img_desc = NULL;
+		}
+	}
+
+	free(cache);
+
+	return img_desc;
+}
+
+void img_cache_save(const char *path, const FILINFO *fno, const lv_img_dsc_t *img_desc)
+{
+	char cache_path[48];
+
+	if (!_img_cache_path(cache_path, path))
+		return;
+
+	int bound = LZ4_compressBound(img_desc->data_size);
+	img_cache_t *cache = malloc(sizeof(img_cache_t) + bound);
+	void *state = malloc(LZ4_sizeofState());
+
+	int compr_size = LZ4_compress_fast_extState(state, (const char *)img_desc->data,
+		(char *)cache + sizeof(img_cache_t), img_desc->data_size, bound, 1);
+
+	if (compr_size > 0)
+	{
+		memset(cache, 0, sizeof(img_cache_t));
+		cache->magic = IMG_CACHE_MAGIC;
+		cache->bmp_size = fno->fsize;
+		cache->bmp_mtime = ((u32)fno->fdate << 16) | fno->ftime;
+		cache->data_size = img_desc->data_size;
+		cache->compr_size = compr_size;
+		cache->header = img_desc->header;
+		strcpy(cache->path, path);
+
+		f_mkdir("bootloader/sys");
+		f_mkdir(IMG_CACHE_DIR);
+		sd_save_to_file(cache, sizeof(img_cache_t) + compr_size, cache_path);
+	}
+
+	free(state);
+	free(cache);
+}
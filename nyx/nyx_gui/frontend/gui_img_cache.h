@@ -0,0 +1,30 @@
+/*
+ * Cache of pre-decoded Nyx images, stored LZ4 compressed on SD.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GUI_IMG_CACHE_H_
+#define _GUI_IMG_CACHE_H_
+
+#include "gui.h"
+#include <libs/fatfs/ff.h>
+
+#define IMG_CACHE_DIR "bootloader/sys/imgcache"
+
+// Returns the cached image of the BMP in path, if its size and timestamp in fno still match.
+lv_img_dsc_t *img_cache_load(const char *path, const FILINFO *fno);
+// Saves a decoded BMP image, so next load can skip decoding.
+void img_cache_save(const char *path, const FILINFO *fno, const lv_img_dsc_t *img_desc);
+
+#endif
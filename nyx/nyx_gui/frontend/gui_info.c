@@ -1047,6 +1047,94 @@ static lv_res_t _create_window_bootrom_info_status(lv_obj_t *btn)
 	return LV_RES_OK;
 }
 
+static lv_res_t _boot_trace_dump_window_action(lv_obj_t * btn)
+{
+	int error = !trace_get_count();
+
+	if (!error)
+		error = !sd_mount();
+
+	if (!error)
+	{
+		char path[64];
+		emmcsn_path_impl(path, "/dumps", "boot_trace.json", NULL);
+		error = trace_dump(path);
+
+		sd_unmount();
+	}
+
+	_create_window_dump_done(error, "boot_trace.json");
+
+	return LV_RES_OK;
+}
+
+#define BOOT_TRACE_MAX_DEPTH 8
+
+static lv_res_t _create_window_boot_trace_status(lv_obj_t *btn)
+{
+	lv_obj_t *win = nyx_create_standard_window(SYMBOL_CLOCK" Boot Trace");
+	lv_win_add_btn(win, NULL, SYMBOL_DOWNLOAD" Dump Trace", _boot_trace_dump_window_action);
+
+	lv_obj_t *desc = lv_cont_create(win, NULL);
+	lv_obj_set_size(desc, LV_HOR_RES / 9 * 7, LV_VER_RES - (LV_DPI * 11 / 7) - 5);
+
+	lv_obj_t * lb_desc = lv_label_create(desc, NULL);
+	lv_label_set_long_mode(lb_desc, LV_LABEL_LONG_BREAK);
+	lv_label_set_recolor(lb_desc, true);
+	lv_label_set_style(lb_desc, &monospace_text);
+
+	u32 count = trace_get_count();
+	char *txt_buf = (char *)malloc(count * 96 + SZ_1K);
+	s_printf(txt_buf, "#00DDFF Boot phases:#\n#FF8000 Start (ms)  "SYMBOL_DOT"  Duration (ms)  "SYMBOL_DOT"  Phase#\n");
+
+	if (!count)
+		strcat(txt_buf, "#FFDD00 No boot trace found!#");
+
+	// Indent spans that are nested inside other spans.
+	u32 span_end[BOOT_TRACE_MAX_DEPTH];
+	u32 depth = 0;
+	u32 first_us = count ? trace_get_event(0)->start : 0;
+	for (u32 i = 0; i < count; i++)
+	{
+		trace_event_t *ev = trace_get_event(i);
+
+		while (depth && ev->start >= span_end[depth - 1])
+			depth--;
+
+		u32 start_us = ev->start - first_us;
+		char *pos = txt_buf + strlen(txt_buf);
+		s_printf(pos, "%6d.%03d  ", start_us / 1000, start_us % 1000);
+		pos += strlen(pos);
+
+		// Instant events have no duration.
+		if (ev->dur != TRACE_DUR_OPEN)
+			s_printf(pos, "%9d.%03d  ", ev->dur / 1000, ev->dur % 1000);
+		else
+			strcpy(pos, "            -  ");
+		pos += strlen(pos);
+
+		for (u32 j = 0; j < depth; j++)
+			strcat(pos, "  ");
+
+		pos += strlen(pos);
+		if (ev->dur != TRACE_DUR_OPEN)
+			s_printf(pos, "%s\n", ev->name);
+		else
+			s_printf(pos, "#C7EA46 %s#\n", ev->name);
+
+		if (ev->dur != TRACE_DUR_OPEN && depth < BOOT_TRACE_MAX_DEPTH)
+			span_end[depth++] = ev->start + ev->dur;
+	}
+
+	lv_label_set_text(lb_desc, txt_buf);
+
+	free(txt_buf);
+
+	lv_obj_set_width(lb_desc, lv_obj_get_width(desc));
+
+	return LV_RES_OK;
+}
+
 static lv_res_t _launch_lockpick_action(lv_obj_t *btns, const char * txt)
 {
 	int btn_idx = lv_btnm_get_pressed(btns);
@@ -2576,11 +2664,19 @@ void create_tab_info(lv_theme_t *th, lv_obj_t *parent)
 	lv_obj_align(btn7, line_sep, LV_ALIGN_OUT_BOTTOM_LEFT, LV_DPI / 4, LV_DPI / 2);
 	lv_btn_set_action(btn7, LV_BTN_ACTION_CLICK, _create_window_battery_status);
 
+	// Create Boot Trace button.
+	lv_obj_t *btn8 = lv_btn_create(h2, btn);
+	label_btn = lv_label_create(btn8, NULL);
+	lv_label_set_static_text(label_btn, SYMBOL_CLOCK"  Boot Trace");
+	lv_obj_align(btn8, btn7, LV_ALIGN_OUT_RIGHT_TOP, LV_DPI * 3 / 4, 0);
+	lv_btn_set_action(btn8, LV_BTN_ACTION_CLICK, _create_window_boot_trace_status);
+
 	lv_obj_t *label_txt6 = lv_label_create(h2, NULL);
 	lv_label_set_recolor(label_txt6, true);
 	lv_label_set_static_text(label_txt6,
 		"View battery and battery charger related info.\n"
-		"Additionally you can dump battery charger's registers.\n");
+		"Additionally you can dump battery charger's registers\n"
+		"or view and dump the #C7EA46 boot phase# timeline.");
 	lv_obj_set_style(label_txt6, &hint_small_style);
 	lv_obj_align(label_txt6, btn7, LV_ALIGN_OUT_BOTTOM_LEFT, 0, LV_DPI / 3);
 }
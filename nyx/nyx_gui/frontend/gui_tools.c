@@ -229,37 +229,49 @@ static lv_res_t _create_mbox_ums(usb_ctxt_t *usbs)
 
 	s_printf(txt_buf, "#FF8000 USB Mass Storage#\n\n#C7EA46 Device:# ");
 
-	if (usbs->type == MMC_SD)
+	bool read_only = true;
+	for (u32 i = 0; i < usbs->lun_cnt; i++)
 	{
-		switch (usbs->partition)
+		usb_lun_ctxt_t *lun = &usbs->luns[i];
+
+		if (!lun->ro)
+			read_only = false;
+
+		if (i)
+			strcat(txt_buf, ", ");
+
+		if (lun->type == MMC_SD)
 		{
-		case 0:
-			strcat(txt_buf, "SD Card");
-			break;
-		case EMMC_GPP + 1:
-			strcat(txt_buf, "emuMMC GPP");
-			break;
-		case EMMC_BOOT0 + 1:
-			strcat(txt_buf, "emuMMC BOOT0");
-			break;
-		case EMMC_BOOT1 + 1:
-			strcat(txt_buf, "emuMMC BOOT1");
-			break;
+			switch (lun->partition)
+			{
+			case 0:
+				strcat(txt_buf, "SD Card");
+				break;
+			case EMMC_GPP + 1:
+				strcat(txt_buf, "emuMMC GPP");
+				break;
+			case EMMC_BOOT0 + 1:
+				strcat(txt_buf, "emuMMC BOOT0");
+				break;
+			case EMMC_BOOT1 + 1:
+				strcat(txt_buf, "emuMMC BOOT1");
+				break;
+			}
 		}
-	}
-	else
-	{
-		switch (usbs->partition)
+		else
 		{
-		case EMMC_GPP + 1:
-			strcat(txt_buf, "eMMC GPP");
-			break;
-		case EMMC_BOOT0 + 1:
-			strcat(txt_buf, "eMMC BOOT0");
-			break;
-		case EMMC_BOOT1 + 1:
-			strcat(txt_buf, "eMMC BOOT1");
-			break;
+			switch (lun->partition)
+			{
+			case EMMC_GPP + 1:
+				strcat(txt_buf, "eMMC GPP");
+				break;
+			case EMMC_BOOT0 + 1:
+				strcat(txt_buf, "eMMC BOOT0");
+				break;
+			case EMMC_BOOT1 + 1:
+				strcat(txt_buf, "eMMC BOOT1");
+				break;
+			}
 		}
 	}
 
@@ -273,9 +285,9 @@ static lv_res_t _create_mbox_ums(usb_ctxt_t *usbs)
 
 	lv_obj_t *lbl_tip = lv_label_create(mbox, NULL);
 	lv_label_set_recolor(lbl_tip, true);
-	if (!usbs->ro)
+	if (!read_only)
 	{
-		if (usbs->type == MMC_SD)
+		if (usbs->luns[0].type == MMC_SD)
 		{
 			lv_label_set_static_text(lbl_tip,
 				"Note: To end it, #C7EA46 safely eject# from inside the OS.\n"
@@ -405,11 +417,13 @@ static bool usb_msc_emmc_read_only;
 lv_res_t action_ums_sd(lv_obj_t *btn)
 {
 	usb_ctxt_t usbs;
-	usbs.type = MMC_SD;
-	usbs.partition = 0;
-	usbs.offset = 0;
-	usbs.sectors = 0;
-	usbs.ro = 0;
+	usbs.lun_cnt = 1;
+	usbs.luns[0].type = MMC_SD;
+	usbs.luns[0].partition = 0;
+	usbs.luns[0].offset = 0;
+	usbs.luns[0].sectors = 0;
+	usbs.luns[0].ro = 0;
+	usbs.luns[0].write_cache = n_cfg.ums_write_cache;
 	usbs.system_maintenance = &manual_system_maintenance;
 	usbs.set_text = &usb_gadget_set_text;
 
@@ -418,17 +432,24 @@ lv_res_t action_ums_sd(lv_obj_t *btn)
 	return LV_RES_OK;
 }
 
-static lv_res_t _action_ums_emmc_boot0(lv_obj_t *btn)
+static lv_res_t _action_ums_emmc(const u8 *partitions, u32 count)
 {
 	if (!nyx_emmc_check_battery_enough())
 		return LV_RES_OK;
 
 	usb_ctxt_t usbs;
-	usbs.type = MMC_EMMC;
-	usbs.partition = EMMC_BOOT0 + 1;
-	usbs.offset = 0;
-	usbs.sectors = 0x2000;
-	usbs.ro = usb_msc_emmc_read_only;
+	usbs.lun_cnt = count;
+	for (u32 i = 0; i < count; i++)
+	{
+		usb_lun_ctxt_t *lun = &usbs.luns[i];
+
+		lun->type = MMC_EMMC;
+		lun->partition = partitions[i];
+		lun->offset = 0;
+		lun->sectors = (partitions[i] == EMMC_GPP + 1) ? 0 : 0x2000;
+		lun->ro = usb_msc_emmc_read_only;
+		lun->write_cache = 0;
+	}
 	usbs.system_maintenance = &manual_system_maintenance;
 	usbs.set_text = &usb_gadget_set_text;
 
@@ -437,92 +458,79 @@ static lv_res_t _action_ums_emmc_boot0(lv_obj_t *btn)
 	return LV_RES_OK;
 }
 
-static lv_res_t _action_ums_emmc_boot1(lv_obj_t *btn)
+static lv_res_t _action_ums_emmc_boot0(lv_obj_t *btn)
 {
-	if (!nyx_emmc_check_battery_enough())
-		return LV_RES_OK;
+	static const u8 partitions[] = { EMMC_BOOT0 + 1 };
 
-	usb_ctxt_t usbs;
-	usbs.type = MMC_EMMC;
-	usbs.partition = EMMC_BOOT1 + 1;
-	usbs.offset = 0;
-	usbs.sectors = 0x2000;
-	usbs.ro = usb_msc_emmc_read_only;
-	usbs.system_maintenance = &manual_system_maintenance;
-	usbs.set_text = &usb_gadget_set_text;
+	return _action_ums_emmc(partitions, 1);
+}
 
-	_create_mbox_ums(&usbs);
+static lv_res_t _action_ums_emmc_boot1(lv_obj_t *btn)
+{
+	static const u8 partitions[] = { EMMC_BOOT1 + 1 };
 
-	return LV_RES_OK;
+	return _action_ums_emmc(partitions, 1);
 }
 
 static lv_res_t _action_ums_emmc_gpp(lv_obj_t *btn)
 {
-	if (!nyx_emmc_check_battery_enough())
-		return LV_RES_OK;
+	static const u8 partitions[] = { EMMC_GPP + 1 };
 
-	usb_ctxt_t usbs;
-	usbs.type = MMC_EMMC;
-	usbs.partition = EMMC_GPP + 1;
-	usbs.offset = 0;
-	usbs.sectors = 0;
-	usbs.ro = usb_msc_emmc_read_only;
-	usbs.system_maintenance = &manual_system_maintenance;
-	usbs.set_text = &usb_gadget_set_text;
+	return _action_ums_emmc(partitions, 1);
+}
 
-	_create_mbox_ums(&usbs);
+static lv_res_t _action_ums_emmc_all(lv_obj_t *btn)
+{
+	static const u8 partitions[] = { EMMC_GPP + 1, EMMC_BOOT0 + 1, EMMC_BOOT1 + 1 };
 
-	return LV_RES_OK;
+	return _action_ums_emmc(partitions, ARRAY_SIZE(partitions));
 }
 
-static lv_res_t _action_ums_emuemmc_boot0(lv_obj_t *btn)
+static int _ums_emuemmc_lun_set(usb_lun_ctxt_t *lun, u32 emu_sector, u32 partition)
 {
-	if (!nyx_emmc_check_battery_enough())
-		return LV_RES_OK;
+	lun->type = MMC_SD;
+	lun->partition = partition;
+	lun->ro = usb_msc_emmc_read_only;
+	lun->write_cache = n_cfg.ums_write_cache;
 
-	usb_ctxt_t usbs;
-
-	int error = !sd_mount();
-	if (!error)
+	switch (partition)
 	{
-		emummc_cfg_t emu_info;
-		load_emummc_cfg(&emu_info);
+	case EMMC_BOOT0 + 1:
+		lun->offset = emu_sector;
+		lun->sectors = 0x2000;
+		break;
+	case EMMC_BOOT1 + 1:
+		lun->offset = emu_sector + 0x2000;
+		lun->sectors = 0x2000;
+		break;
+	case EMMC_GPP + 1:
+		lun->offset = emu_sector + 0x4000;
 
-		error = 2;
-		if (emu_info.enabled)
+		int error = 1;
+		u8 *gpt = malloc(512);
+		if (sdmmc_storage_read(&sd_storage, lun->offset + 1, 1, gpt))
 		{
-			error = 3;
-			if (emu_info.sector)
+			if (!memcmp(gpt, "EFI PART", 8))
 			{
 				error = 0;
-				usbs.offset = emu_info.sector;
+				lun->sectors = *(u32 *)(gpt + 0x20) + 1; // Backup LBA + 1.
 			}
 		}
-	}
-	sd_unmount();
+		free(gpt);
 
-	if (error)
-		_create_mbox_ums_error(error);
-	else
-	{
-		usbs.type = MMC_SD;
-		usbs.partition = EMMC_BOOT0 + 1;
-		usbs.sectors = 0x2000;
-		usbs.ro = usb_msc_emmc_read_only;
-		usbs.system_maintenance = &manual_system_maintenance;
-		usbs.set_text = &usb_gadget_set_text;
-		_create_mbox_ums(&usbs);
+		return error;
 	}
 
-	return LV_RES_OK;
+	return 0;
 }
 
-static lv_res_t _action_ums_emuemmc_boot1(lv_obj_t *btn)
+static lv_res_t _action_ums_emuemmc(const u8 *partitions, u32 count)
 {
 	if (!nyx_emmc_check_battery_enough())
 		return LV_RES_OK;
 
 	usb_ctxt_t usbs;
+	usbs.lun_cnt = count;
 
 	int error = !sd_mount();
 	if (!error)
@@ -537,7 +545,8 @@ static lv_res_t _action_ums_emuemmc_boot1(lv_obj_t *btn)
 			if (emu_info.sector)
 			{
 				error = 0;
-				usbs.offset = emu_info.sector + 0x2000;
+				for (u32 i = 0; i < count && !error; i++)
+					error = _ums_emuemmc_lun_set(&usbs.luns[i], emu_info.sector, partitions[i]);
 			}
 		}
 	}
@@ -547,10 +556,6 @@ static lv_res_t _action_ums_emuemmc_boot1(lv_obj_t *btn)
 		_create_mbox_ums_error(error);
 	else
 	{
-		usbs.type = MMC_SD;
-		usbs.partition = EMMC_BOOT1 + 1;
-		usbs.sectors = 0x2000;
-		usbs.ro = usb_msc_emmc_read_only;
 		usbs.system_maintenance = &manual_system_maintenance;
 		usbs.set_text = &usb_gadget_set_text;
 		_create_mbox_ums(&usbs);
@@ -559,55 +564,32 @@ static lv_res_t _action_ums_emuemmc_boot1(lv_obj_t *btn)
 	return LV_RES_OK;
 }
 
-static lv_res_t _action_ums_emuemmc_gpp(lv_obj_t *btn)
+static lv_res_t _action_ums_emuemmc_boot0(lv_obj_t *btn)
 {
-	if (!nyx_emmc_check_battery_enough())
-		return LV_RES_OK;
+	static const u8 partitions[] = { EMMC_BOOT0 + 1 };
 
-	usb_ctxt_t usbs;
+	return _action_ums_emuemmc(partitions, 1);
+}
 
-	int error = !sd_mount();
-	if (!error)
-	{
-		emummc_cfg_t emu_info;
-		load_emummc_cfg(&emu_info);
+static lv_res_t _action_ums_emuemmc_boot1(lv_obj_t *btn)
+{
+	static const u8 partitions[] = { EMMC_BOOT1 + 1 };
 
-		error = 2;
-		if (emu_info.enabled)
-		{
-			error = 3;
-			if (emu_info.sector)
-			{
-				error = 1;
-				usbs.offset = emu_info.sector + 0x4000;
+	return _action_ums_emuemmc(partitions, 1);
+}
 
-				u8 *gpt = malloc(512);
-				if (sdmmc_storage_read(&sd_storage, usbs.offset + 1, 1, gpt))
-				{
-					if (!memcmp(gpt, "EFI PART", 8))
-					{
-						error = 0;
-						usbs.sectors = *(u32 *)(gpt + 0x20) + 1; // Backup LBA + 1.
-					}
-				}
-			}
-		}
-	}
-	sd_unmount();
+static lv_res_t _action_ums_emuemmc_gpp(lv_obj_t *btn)
+{
+	static const u8 partitions[] = { EMMC_GPP + 1 };
 
-	if (error)
-		_create_mbox_ums_error(error);
-	else
-	{
-		usbs.type = MMC_SD;
-		usbs.partition = EMMC_GPP + 1;
-		usbs.ro = usb_msc_emmc_read_only;
-		usbs.system_maintenance = &manual_system_maintenance;
-		usbs.set_text = &usb_gadget_set_text;
-		_create_mbox_ums(&usbs);
-	}
+	return _action_ums_emuemmc(partitions, 1);
+}
 
-	return LV_RES_OK;
+static lv_res_t _action_ums_emuemmc_all(lv_obj_t *btn)
+{
+	static const u8 partitions[] = { EMMC_GPP + 1, EMMC_BOOT0 + 1, EMMC_BOOT1 + 1 };
+
+	return _action_ums_emuemmc(partitions, ARRAY_SIZE(partitions));
 }
 
 void nyx_run_ums(void *param)
@@ -726,6 +708,13 @@ static lv_res_t _create_window_usb_tools(lv_obj_t *parent)
 	lv_obj_align(btn_boot1, btn_boot0, LV_ALIGN_OUT_RIGHT_MID, LV_DPI / 10, 0);
 	lv_btn_set_action(btn_boot1, LV_BTN_ACTION_CLICK, _action_ums_emmc_boot1);
 
+	// Create eMMC all partitions button.
+	lv_obj_t *btn_all = lv_btn_create(h1, btn1);
+	label_btn = lv_label_create(btn_all, NULL);
+	lv_label_set_static_text(label_btn, "ALL");
+	lv_obj_align(btn_all, btn_boot1, LV_ALIGN_OUT_RIGHT_MID, LV_DPI / 10, 0);
+	lv_btn_set_action(btn_all, LV_BTN_ACTION_CLICK, _action_ums_emmc_all);
+
 	// Create emuMMC RAW GPP button.
 	lv_obj_t *btn_emu_gpp = lv_btn_create(h1, btn1);
 	label_btn = lv_label_create(btn_emu_gpp, NULL);
@@ -747,10 +736,17 @@ static lv_res_t _create_window_usb_tools(lv_obj_t *parent)
 	lv_obj_align(btn_emu_boot1, btn_boot1, LV_ALIGN_OUT_BOTTOM_LEFT, 0, LV_DPI / 2);
 	lv_btn_set_action(btn_emu_boot1, LV_BTN_ACTION_CLICK, _action_ums_emuemmc_boot1);
 
+	// Create emuMMC all partitions button.
+	lv_obj_t *btn_emu_all = lv_btn_create(h1, btn1);
+	label_btn = lv_label_create(btn_emu_all, NULL);
+	lv_label_set_static_text(label_btn, "ALL");
+	lv_obj_align(btn_emu_all, btn_all, LV_ALIGN_OUT_BOTTOM_LEFT, 0, LV_DPI / 2);
+	lv_btn_set_action(btn_emu_all, LV_BTN_ACTION_CLICK, _action_ums_emuemmc_all);
+
 	label_txt2 = lv_label_create(h1, NULL);
 	lv_label_set_recolor(label_txt2, true);
 	lv_label_set_static_text(label_txt2,
-		"Allows you to mount the eMMC/emuMMC.\n"
+		"Allows you to mount the eMMC/emuMMC. #C7EA46 ALL mounts every partition.#\n"
 		"#C7EA46 Default access is# #FF8000 read-only.#");
 	lv_obj_set_style(label_txt2, &hint_small_style);
 	lv_obj_align(label_txt2, btn_emu_gpp, LV_ALIGN_OUT_BOTTOM_LEFT, 0, LV_DPI / 3);
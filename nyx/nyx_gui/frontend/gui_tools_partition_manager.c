@@ -21,6 +21,7 @@
 #include "gui.h"
 #include "gui_tools.h"
 #include "gui_tools_partition_manager.h"
+#include "fe_copy_files.h"
 #include <libs/fatfs/diskio.h>
 #include <libs/lvgl/lvgl.h>
 
@@ -83,147 +84,6 @@ l4t_flasher_ctxt_t l4t_flash_ctxt;
 lv_obj_t *btn_flash_l4t;
 lv_obj_t *btn_flash_android;
 
-static int _stat_and_copy_files(const char *src, const char *dst, char *path, u32 *total_files, u32 *total_size, lv_obj_t **labels)
-{
-	FRESULT res;
-	FIL fp_src;
-	FIL fp_dst;
-	DIR dir;
-	u32 dirLength = 0;
-	static FILINFO fno;
-
-	f_chdrive(src);
-
-	// Open directory.
-	res = f_opendir(&dir, path);
-	if (res != FR_OK)
-		return res;
-
-	if (labels)
-		lv_label_set_text(labels[0], path);
-
-	dirLength = strlen(path);
-
-	// Hard limit path to 1024 characters. Do not result to error.
-	if (dirLength > 1024)
-		goto out;
-
-	for (;;)
-	{
-		// Clear file path.
-		path[dirLength] = 0;
-
-		// Read a directory item.
-		res = f_readdir(&dir, &fno);
-
-		// Break on error or end of dir.
-		if (res != FR_OK || fno.fname[0] == 0)
-			break;
-
-		// Set new directory or file.
-		memcpy(&path[dirLength], "/", 1);
-		strcpy(&path[dirLength + 1], fno.fname);
-
-		if (labels)
-		{
-			lv_label_set_text(labels[1], fno.fname);
-			manual_system_maintenance(true);
-		}
-
-		// Copy file to destination disk.
-		if (!(fno.fattrib & AM_DIR))
-		{
-			u32 file_size = fno.fsize > RAMDISK_CLUSTER_SZ ? fno.fsize : RAMDISK_CLUSTER_SZ; // Ramdisk cluster size.
-
-			// Check for overflow.
-			if ((file_size + *total_size) < *total_size)
-			{
-				// Set size to > 1GB, skip next folders and return.
-				*total_size = SZ_2G;
-				res = -1;
-				break;
-			}
-
-			*total_size += file_size;
-			*total_files += 1;
-
-			if (dst)
-			{
-				u32 file_size = fno.fsize;
-
-				// Open file for writing.
-				f_chdrive(dst);
-				f_open(&fp_dst, path, FA_CREATE_ALWAYS | FA_WRITE);
-				f_lseek(&fp_dst, fno.fsize);
-				f_lseek(&fp_dst, 0);
-
-				// Open file for reading.
-				f_chdrive(src);
-				f_open(&fp_src, path, FA_READ);
-
-				while (file_size)
-				{
-					u32 chunk_size = MIN(file_size, SZ_4M); // 4MB chunks.
-					file_size -= chunk_size;
-
-					// Copy file to buffer.
-					f_read(&fp_src, (void *)SDXC_BUF_ALIGNED, chunk_size, NULL);
-					manual_system_maintenance(true);
-
-					// Write file to disk.
-					f_write(&fp_dst, (void *)SDXC_BUF_ALIGNED, chunk_size, NULL);
-				}
-				f_close(&fp_src);
-
-				// Finalize copied file.
-				f_close(&fp_dst);
-				f_chdrive(dst);
-				f_chmod(path, fno.fattrib, 0xFF);
-
-				f_chdrive(src);
-			}
-
-			// If total is > 1GB exit.
-			if (*total_size > (RAM_DISK_SZ - SZ_16M)) // 0x2400000.
-			{
-				// Skip next folders and return.
-				res = -1;
-				break;
-			}
-		}
-		else // It's a directory.
-		{
-			if (!memcmp("System Volume Information", fno.fname, 25))
-				continue;
-
-			// Create folder to destination.
-			if (dst)
-			{
-				f_chdrive(dst);
-				f_mkdir(path);
-				f_chmod(path, fno.fattrib, 0xFF);
-			}
-
-			// Enter the directory.
-			res = _stat_and_copy_files(src, dst, path, total_files, total_size, labels);
-			if (res != FR_OK)
-				break;
-
-			if (labels)
-			{
-				// Clear folder path.
-				path[dirLength] = 0;
-				lv_label_set_text(labels[0], path);
-			}
-		}
-	}
-
-out:
-	f_closedir(&dir);
-
-	return res;
-}
-
 static void _create_gpt_partition(gpt_t *gpt, u8 *gpt_idx, u32 *curr_part_lba, u32 size_lba, char *name, int name_size)
 {
 	const u8 linux_part_guid[] = { 0xAF, 0x3D, 0xC6, 0x0F,  0x83, 0x84,  0x72, 0x47,  0x8E, 0x79,  0x3D, 0x69, 0xD8, 0x47, 0x7D, 0xE4 };
@@ -1306,16 +1166,22 @@ static int _backup_and_restore_files(bool backup, lv_obj_t **labels)
 			f_mkdir("warmboot_mariko");
 	}
 
+	// Set up copy engine. Files are copied through the SDXC buffer.
+	copy_files_init(src_drv, dst_drv, (u8 *)SDXC_BUF_ALIGNED, labels[1]);
+
 	// Copy all or hekate/Nyx files.
-	res = _stat_and_copy_files(src_drv, dst_drv, path, &total_files, &total_size, labels);
+	res = copy_files_stat(src_drv, dst_drv, path, &total_files, &total_size, labels);
 
 	// If incomplete backup mode, copy MWS also.
 	if (!res && backup_mws)
 	{
 		strcpy(path, "warmboot_mariko");
-		res = _stat_and_copy_files(src_drv, dst_drv, path, &total_files, &total_size, labels);
+		res = copy_files_stat(src_drv, dst_drv, path, &total_files, &total_size, labels);
 	}
 
+	// Write out remaining files.
+	copy_files_end();
+
 	free(path);
 
 	return res;
@@ -1951,7 +1817,7 @@ static void _create_mbox_check_files_total_size()
 	path[0] = 0;
 
 	// Check total size of files.
-	int res = _stat_and_copy_files("sd:", NULL, path, &total_files, &total_size, NULL);
+	int res = copy_files_stat("sd:", NULL, path, &total_files, &total_size, NULL);
 
 	// Not more than 1.0GB.
 	part_info.backup_possible = !res && !(total_size > (RAM_DISK_SZ - SZ_16M));
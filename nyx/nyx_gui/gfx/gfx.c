@@ -19,6 +19,8 @@
 #include <string.h>
 #include "gfx.h"
 
+#define GFX_LAND_BAND_ROWS 8 // 32 byte framebuffer line.
+
 // Global gfx console and context.
 gfx_ctxt_t gfx_ctxt;
 gfx_con_t gfx_con;
@@ -499,32 +501,50 @@ void gfx_set_pixel(u32 x, u32 y, u32 color)
 
 void __attribute__((optimize("unroll-loops"))) gfx_set_rect_land_pitch(u32 *fb, const u32 *buf, u32 stride, u32 pos_x, u32 pos_y, u32 pos_x2, u32 pos_y2)
 {
-	u32 *ptr = (u32 *)buf;
-
 	u32 pixels_w = pos_x2 - pos_x + 1;
 
-	if (!(pixels_w % 8))
+	/*
+	 * Transpose in bands of 8 rows aligned to framebuffer lines.
+	 * Each source column of a band becomes one 32 byte burst in the portrait framebuffer,
+	 * while the 8 source rows are streamed sequentially.
+	 */
+	for (u32 y = pos_y; y < (pos_y2 + 1);)
 	{
-		for (u32 y = pos_y; y < (pos_y2 + 1); y++)
-			for (u32 x = pos_x; x < (pos_x2 + 1); x+=8)
+		u32 y_end = MIN(ALIGN(y + 1, GFX_LAND_BAND_ROWS), pos_y2 + 1);
+		u32 rows = y_end - y;
+		const u32 *src = &buf[(y - pos_y) * pixels_w];
+		u32 *fbx = &fb[pos_x * stride + y];
+
+		if (rows == GFX_LAND_BAND_ROWS)
+		{
+			for (u32 x = 0; x < pixels_w; x++)
 			{
-				u32 *fbx = &fb[x * stride + y];
-
-				fbx[0]          = *ptr++;
-				fbx[stride]     = *ptr++;
-				fbx[stride * 2] = *ptr++;
-				fbx[stride * 3] = *ptr++;
-				fbx[stride * 4] = *ptr++;
-				fbx[stride * 5] = *ptr++;
-				fbx[stride * 6] = *ptr++;
-				fbx[stride * 7] = *ptr++;
+				const u32 *ptr = &src[x];
+
+				fbx[0] = ptr[0];
+				fbx[1] = ptr[pixels_w];
+				fbx[2] = ptr[pixels_w * 2];
+				fbx[3] = ptr[pixels_w * 3];
+				fbx[4] = ptr[pixels_w * 4];
+				fbx[5] = ptr[pixels_w * 5];
+				fbx[6] = ptr[pixels_w * 6];
+				fbx[7] = ptr[pixels_w * 7];
+
+				fbx += stride;
 			}
-	}
-	else
-	{
-		for (u32 y = pos_y; y < (pos_y2 + 1); y++)
-			for (u32 x = pos_x; x < (pos_x2 + 1); x++)
-				fb[x * stride + y] = *ptr++;
+		}
+		else
+		{
+			for (u32 x = 0; x < pixels_w; x++)
+			{
+				for (u32 i = 0; i < rows; i++)
+					fbx[i] = src[x + i * pixels_w];
+
+				fbx += stride;
+			}
+		}
+
+		y = y_end;
 	}
 }
 
@@ -213,37 +213,34 @@ void load_saved_configuration()
 	if (!ini_parse(&ini_sections, "bootloader/hekate_ipl.ini", false))
 		goto skip_main_cfg_parse;
 
-	// Load hekate configuration.
-	LIST_FOREACH_ENTRY(ini_sec_t, ini_sec, &ini_sections, link)
+	// Load hekate configuration. Only parse config section.
+	ini_sec_t *cfg_sec = ini_find_section(&ini_sections, "config");
+	if (cfg_sec)
 	{
-		// Only parse config section.
-		if (ini_sec->type == INI_CHOICE && !strcmp(ini_sec->name, "config"))
+		LIST_FOREACH_ENTRY(ini_kv_t, kv, &cfg_sec->kvs, link)
 		{
-			LIST_FOREACH_ENTRY(ini_kv_t, kv, &ini_sec->kvs, link)
+			if (!strcmp("autoboot", kv->key))
+				h_cfg.autoboot = atoi(kv->val);
+			else if (!strcmp("autoboot_list", kv->key))
+				h_cfg.autoboot_list = atoi(kv->val);
+			else if (!strcmp("bootwait", kv->key))
+				h_cfg.bootwait = atoi(kv->val);
+			else if (!strcmp("backlight", kv->key))
 			{
-				if (!strcmp("autoboot", kv->key))
-					h_cfg.autoboot = atoi(kv->val);
-				else if (!strcmp("autoboot_list", kv->key))
-					h_cfg.autoboot_list = atoi(kv->val);
-				else if (!strcmp("bootwait", kv->key))
-					h_cfg.bootwait = atoi(kv->val);
-				else if (!strcmp("backlight", kv->key))
-				{
-					h_cfg.backlight = atoi(kv->val);
-					if (h_cfg.backlight <= 20)
-						h_cfg.backlight = 30;
-				}
-				else if (!strcmp("autohosoff", kv->key))
-					h_cfg.autohosoff = atoi(kv->val);
-				else if (!strcmp("autonogc", kv->key))
-					h_cfg.autonogc = atoi(kv->val);
-				else if (!strcmp("updater2p", kv->key))
-					h_cfg.updater2p = atoi(kv->val);
-				else if (!strcmp("bootprotect", kv->key))
-					h_cfg.bootprotect = atoi(kv->val);
+				h_cfg.backlight = atoi(kv->val);
+				if (h_cfg.backlight <= 20)
+					h_cfg.backlight = 30;
 			}
-
-			break;
+			else if (!strcmp("autohosoff", kv->key))
+				h_cfg.autohosoff = atoi(kv->val);
+			else if (!strcmp("autonogc", kv->key))
+				h_cfg.autonogc = atoi(kv->val);
+			else if (!strcmp("updater2p", kv->key))
+				h_cfg.updater2p = atoi(kv->val);
+			else if (!strcmp("bootprotect", kv->key))
+				h_cfg.bootprotect = atoi(kv->val);
+			else if (!strcmp("boottrace", kv->key))
+				h_cfg.boottrace = atoi(kv->val);
 		}
 	}
 
@@ -253,35 +250,32 @@ skip_main_cfg_parse:
 	if (!ini_parse(&ini_nyx_sections, "bootloader/nyx.ini", false))
 		return;
 
-	// Load Nyx configuration.
-	LIST_FOREACH_ENTRY(ini_sec_t, ini_sec, &ini_nyx_sections, link)
+	// Load Nyx configuration. Only parse config section.
+	ini_sec_t *nyx_sec = ini_find_section(&ini_nyx_sections, "config");
+	if (nyx_sec)
 	{
-		// Only parse config section.
-		if (ini_sec->type == INI_CHOICE && !strcmp(ini_sec->name, "config"))
+		LIST_FOREACH_ENTRY(ini_kv_t, kv, &nyx_sec->kvs, link)
 		{
-			LIST_FOREACH_ENTRY(ini_kv_t, kv, &ini_sec->kvs, link)
-			{
-				if (!strcmp("themecolor", kv->key))
-					n_cfg.theme_color = atoi(kv->val);
-				else if (!strcmp("entries5col", kv->key))
-					n_cfg.entries_5_columns = atoi(kv->val) == 1;
-				else if (!strcmp("timeoff", kv->key))
-					n_cfg.timeoff = strtol(kv->val, NULL, 16);
-				else if (!strcmp("homescreen", kv->key))
-					n_cfg.home_screen = atoi(kv->val);
-				else if (!strcmp("verification", kv->key))
-					n_cfg.verification = atoi(kv->val);
-				else if (!strcmp("umsemmcrw", kv->key))
-					n_cfg.ums_emmc_rw = atoi(kv->val) == 1;
-				else if (!strcmp("jcdisable", kv->key))
-					n_cfg.jc_disable = atoi(kv->val) == 1;
-				else if (!strcmp("jcforceright", kv->key))
-					n_cfg.jc_force_right = atoi(kv->val) == 1;
-				else if (!strcmp("bpmpclock", kv->key))
-					n_cfg.bpmp_clock = strtol(kv->val, NULL, 10);
-			}
-
-			break;
+			if (!strcmp("themecolor", kv->key))
+				n_cfg.theme_color = atoi(kv->val);
+			else if (!strcmp("entries5col", kv->key))
+				n_cfg.entries_5_columns = atoi(kv->val) == 1;
+			else if (!strcmp("timeoff", kv->key))
+				n_cfg.timeoff = strtol(kv->val, NULL, 16);
+			else if (!strcmp("homescreen", kv->key))
+				n_cfg.home_screen = atoi(kv->val);
+			else if (!strcmp("verification", kv->key))
+				n_cfg.verification = atoi(kv->val);
+			else if (!strcmp("umsemmcrw", kv->key))
+				n_cfg.ums_emmc_rw = atoi(kv->val) == 1;
+			else if (!strcmp("umswcache", kv->key))
+				n_cfg.ums_write_cache = atoi(kv->val) == 1;
+			else if (!strcmp("jcdisable", kv->key))
+				n_cfg.jc_disable = atoi(kv->val) == 1;
+			else if (!strcmp("jcforceright", kv->key))
+				n_cfg.jc_force_right = atoi(kv->val) == 1;
+			else if (!strcmp("bpmpclock", kv->key))
+				n_cfg.bpmp_clock = strtol(kv->val, NULL, 10);
 		}
 	}
 
@@ -0,0 +1,386 @@
+/*
+ * Host trace replay test for the BIS cluster cache.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <storage/nx_emmc_bis.h>
+#include <storage/sd.h>
+
+#define CLUSTER_SECTORS 32
+#define CLUSTER_SIZE    (CLUSTER_SECTORS * EMMC_BLOCKSIZE)
+#define CACHE_ENTRIES   16384 // Same as BIS_CACHE_MAX_ENTRIES.
+#define PART_SECTORS    (SZ_512M / EMMC_BLOCKSIZE) // Twice the cache size.
+#define PART_CLUSTERS   (PART_SECTORS / CLUSTER_SECTORS)
+#define MAX_REQ_SECTORS 256
+
+// Cache header is small. Size for it plus all entries with their flags.
+unsigned char bis_cache_mem[SZ_1M + CACHE_ENTRIES * (CLUSTER_SIZE + 16)] __attribute__((aligned(64)));
+unsigned char bis_lookup_mem[PART_CLUSTERS * sizeof(u32)] __attribute__((aligned(64)));
+
+static u8 *img; // Encrypted partition.
+static u8 *ref; // Plain partition model.
+static u32 rng = 0x2468ACE1;
+static u32 fail_read_sector = -1;
+static u32 dev_reads = 0;
+static u32 dev_writes = 0;
+
+sdmmc_storage_t sd_storage;
+
+static u32 _rand()
+{
+	// Xorshift32.
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+
+	return rng;
+}
+
+// Keystream word for a cluster, sector in cluster and word in sector. Stands in for AES-XTS.
+static u32 _ks(u64 cluster, u32 sector, u32 word)
+{
+	u32 x = (u32)cluster * 0x9E3779B1 ^ (sector << 7 | word) * 0x85EBCA77;
+	x ^= x >> 15;
+	x *= 0x2C1B3C6D;
+	x ^= x >> 12;
+
+	return x;
+}
+
+static void _xts(u64 cluster, u32 sector, u8 *dst, const u8 *src, u32 size)
+{
+	for (u32 i = 0; i < size / 4; i++)
+	{
+		u32 v;
+		memcpy(&v, src + i * 4, 4);
+		v ^= _ks(cluster, sector + i / (EMMC_BLOCKSIZE / 4), i % (EMMC_BLOCKSIZE / 4));
+		memcpy(dst + i * 4, &v, 4);
+	}
+}
+
+// The tweak buffer keeps the sector position in the cluster, like the real tweak does.
+int se_aes_xts_crypt_sec_nx(u32 tweak_ks, u32 crypt_ks, u32 enc, u64 sec, u8 *tweak, bool regen_tweak, u32 tweak_exp, void *dst, void *src, u32 sec_size)
+{
+	u32 pos = 0;
+
+	if (!regen_tweak)
+		memcpy(&pos, tweak, sizeof(u32));
+	pos += tweak_exp;
+
+	if (pos + sec_size / EMMC_BLOCKSIZE > CLUSTER_SECTORS || tweak_ks != 5 || crypt_ks != 4)
+		return 0;
+
+	_xts(sec, pos, dst, src, sec_size);
+
+	pos += sec_size / EMMC_BLOCKSIZE;
+	memcpy(tweak, &pos, sizeof(u32));
+
+	return 1;
+}
+
+int se_aes_xts_crypt_nx(u32 tweak_ks, u32 crypt_ks, u32 enc, u64 sec, void *dst, void *src, u32 sec_size, u32 num_secs)
+{
+	if (sec_size != CLUSTER_SIZE || tweak_ks != 5 || crypt_ks != 4)
+		return 0;
+
+	for (u32 i = 0; i < num_secs; i++)
+		_xts(sec + i, 0, (u8 *)dst + i * sec_size, (u8 *)src + i * sec_size, sec_size);
+
+	return 1;
+}
+
+int emmc_part_read(emmc_part_t *part, u32 sector_off, u32 num_sectors, void *buf)
+{
+	if (sector_off + num_sectors > PART_SECTORS)
+		return 0;
+
+	// Inject a read error once.
+	if (fail_read_sector >= sector_off && fail_read_sector < sector_off + num_sectors)
+	{
+		fail_read_sector = -1;
+		memset(buf, 0xEE, num_sectors * EMMC_BLOCKSIZE);
+
+		return 0;
+	}
+
+	dev_reads++;
+	memcpy(buf, img + (u64)sector_off * EMMC_BLOCKSIZE, num_sectors * EMMC_BLOCKSIZE);
+
+	return 1;
+}
+
+int emmc_part_write(emmc_part_t *part, u32 sector_off, u32 num_sectors, void *buf)
+{
+	if (sector_off + num_sectors > PART_SECTORS)
+		return 0;
+
+	dev_writes++;
+	memcpy(img + (u64)sector_off * EMMC_BLOCKSIZE, buf, num_sectors * EMMC_BLOCKSIZE);
+
+	return 1;
+}
+
+int sdmmc_storage_read(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf)
+{
+	return 0;
+}
+
+int sdmmc_storage_write(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf)
+{
+	return 0;
+}
+
+static void _img_init()
+{
+	for (u32 s = 0; s < PART_SECTORS; s++)
+	{
+		u32 *p = (u32 *)(ref + (u64)s * EMMC_BLOCKSIZE);
+		for (u32 i = 0; i < EMMC_BLOCKSIZE / 4; i++)
+			p[i] = s * 0x01000193 + i;
+	}
+
+	for (u32 c = 0; c < PART_CLUSTERS; c++)
+		_xts(c, 0, img + (u64)c * CLUSTER_SIZE, ref + (u64)c * CLUSTER_SIZE, CLUSTER_SIZE);
+}
+
+// Whole image must decrypt to the model after a flush.
+static int _img_verify()
+{
+	u8 *buf = malloc(CLUSTER_SIZE);
+
+	for (u32 c = 0; c < PART_CLUSTERS; c++)
+	{
+		_xts(c, 0, buf, img + (u64)c * CLUSTER_SIZE, CLUSTER_SIZE);
+		if (memcmp(buf, ref + (u64)c * CLUSTER_SIZE, CLUSTER_SIZE))
+		{
+			printf("  cluster %d not written back\n", c);
+			free(buf);
+			return 0;
+		}
+	}
+	free(buf);
+
+	return 1;
+}
+
+typedef enum
+{
+	TRACE_SEQUENTIAL,
+	TRACE_HOT_SET,
+	TRACE_RANDOM,
+} trace_t;
+
+static void _trace_next(trace_t type, u32 *sector, u32 *count, bool *write)
+{
+	static u32 seq = 0;
+
+	switch (type)
+	{
+	case TRACE_SEQUENTIAL:
+		// Large reads over the whole partition, twice the cache size.
+		*count = MAX_REQ_SECTORS;
+		*sector = seq;
+		*write = false;
+		seq = (seq + *count) % PART_SECTORS;
+		break;
+	case TRACE_HOT_SET:
+		// 90% of accesses to a 64MB hot set, 30% writes. Like save data and NCA tables.
+		*count = 1 + _rand() % 64;
+		if (_rand() % 10)
+			*sector = _rand() % (SZ_64M / EMMC_BLOCKSIZE);
+		else
+			*sector = _rand() % PART_SECTORS;
+		*write = !(_rand() % 3);
+		break;
+	case TRACE_RANDOM:
+		*count = 1 + _rand() % MAX_REQ_SECTORS;
+		*sector = _rand() % PART_SECTORS;
+		*write = !(_rand() % 2);
+		break;
+	}
+
+	if (*sector + *count > PART_SECTORS)
+		*count = PART_SECTORS - *sector;
+}
+
+static int _replay(const char *name, trace_t type, bool cache, u32 ops)
+{
+	emmc_part_t part;
+	u8 *buf = malloc(MAX_REQ_SECTORS * EMMC_BLOCKSIZE);
+	nx_emmc_bis_cache_stats_t stats;
+	int res = 0;
+
+	memset(&part, 0, sizeof(part));
+	part.lba_start = 0x100000;
+	part.lba_end = part.lba_start + PART_SECTORS - 1;
+	strcpy(part.name, "SYSTEM");
+
+	nx_emmc_bis_init(&part, cache, 0);
+	dev_reads = dev_writes = 0;
+
+	for (u32 op = 0; op < ops; op++)
+	{
+		u32 sector, count;
+		bool write;
+
+		_trace_next(type, &sector, &count, &write);
+
+		if (write && cache)
+		{
+			for (u32 i = 0; i < count * EMMC_BLOCKSIZE; i++)
+				buf[i] = _rand();
+			if (!nx_emmc_bis_write(sector, count, buf))
+			{
+				printf("  op %d: write of %d sectors at %d failed\n", op, count, sector);
+				goto out;
+			}
+			memcpy(ref + (u64)sector * EMMC_BLOCKSIZE, buf, count * EMMC_BLOCKSIZE);
+		}
+		else
+		{
+			if (!nx_emmc_bis_read(sector, count, buf))
+			{
+				printf("  op %d: read of %d sectors at %d failed\n", op, count, sector);
+				goto out;
+			}
+			if (memcmp(buf, ref + (u64)sector * EMMC_BLOCKSIZE, count * EMMC_BLOCKSIZE))
+			{
+				printf("  op %d: read of %d sectors at %d returned wrong data\n", op, count, sector);
+				goto out;
+			}
+		}
+	}
+
+	nx_emmc_bis_cache_stats(&stats);
+	nx_emmc_bis_end();
+
+	if (!_img_verify())
+		goto out;
+
+	if (cache)
+	{
+		u32 lookups = stats.hits + stats.misses;
+		printf("  %-22s OK  hit %5.1f%%, %d evictions, %d write-backs, %d/%d device reads/writes\n",
+			name, lookups ? stats.hits * 100.0 / lookups : 0, stats.evictions, stats.writebacks, dev_reads, dev_writes);
+	}
+	else
+		printf("  %-22s OK  %d device reads\n", name, dev_reads);
+
+	res = 1;
+
+out:
+	free(buf);
+
+	return res;
+}
+
+// A failed read must not leave its clusters mapped with stale data.
+static int _failed_read()
+{
+	emmc_part_t part;
+	u8 *buf = malloc(CLUSTER_SIZE);
+	u32 sector = 1000 * CLUSTER_SECTORS;
+	int res = 0;
+
+	memset(&part, 0, sizeof(part));
+	part.lba_end = PART_SECTORS - 1;
+	strcpy(part.name, "USER");
+
+	nx_emmc_bis_init(&part, true, 0);
+
+	fail_read_sector = sector;
+	if (nx_emmc_bis_read(sector, CLUSTER_SECTORS, buf))
+		goto out;
+
+	if (!nx_emmc_bis_read(sector, CLUSTER_SECTORS, buf) || memcmp(buf, ref + (u64)sector * EMMC_BLOCKSIZE, CLUSTER_SIZE))
+		goto out;
+
+	res = 1;
+
+out:
+	nx_emmc_bis_end();
+	free(buf);
+	printf("  %-22s %s\n", "failed read unmapped", res ? "OK" : "FAIL");
+
+	return res;
+}
+
+// One batched miss must not take the same entry twice when the clock wraps within it.
+static int _batched_miss_wrap()
+{
+	emmc_part_t part;
+	u8 *buf = malloc(4 * CLUSTER_SIZE);
+	u32 cluster = CACHE_ENTRIES + 1000;
+	int res = 0;
+
+	memset(&part, 0, sizeof(part));
+	part.lba_end = PART_SECTORS - 1;
+	strcpy(part.name, "USER");
+
+	nx_emmc_bis_init(&part, true, 0);
+
+	// Fill the cache backwards, one cluster per miss. Then access all but the entry under the clock hand.
+	for (int i = CACHE_ENTRIES - 1; i >= 0; i--)
+		if (!nx_emmc_bis_read(i * CLUSTER_SECTORS, 1, buf))
+			goto out;
+	for (u32 i = 0; i < CACHE_ENTRIES - 1; i++)
+		if (!nx_emmc_bis_read(i * CLUSTER_SECTORS, 1, buf))
+			goto out;
+
+	if (!nx_emmc_bis_read(cluster * CLUSTER_SECTORS, 4 * CLUSTER_SECTORS, buf))
+		goto out;
+
+	// Read the batch back from cache, one cluster at a time.
+	for (u32 i = 0; i < 4; i++)
+	{
+		u32 sector = (cluster + i) * CLUSTER_SECTORS;
+		if (!nx_emmc_bis_read(sector, CLUSTER_SECTORS, buf) || memcmp(buf, ref + (u64)sector * EMMC_BLOCKSIZE, CLUSTER_SIZE))
+			goto out;
+	}
+
+	res = 1;
+
+out:
+	nx_emmc_bis_end();
+	free(buf);
+	printf("  %-22s %s\n", "batched miss wrap", res ? "OK" : "FAIL");
+
+	return res;
+}
+
+int main()
+{
+	img = malloc((u64)PART_SECTORS * EMMC_BLOCKSIZE);
+	ref = malloc((u64)PART_SECTORS * EMMC_BLOCKSIZE);
+
+	_img_init();
+
+	int ok = _replay("no cache, random", TRACE_RANDOM, false, 20000) &&
+			 _replay("sequential", TRACE_SEQUENTIAL, true, 3 * PART_SECTORS / MAX_REQ_SECTORS) &&
+			 _replay("hot set", TRACE_HOT_SET, true, 200000) &&
+			 _replay("random", TRACE_RANDOM, true, 100000) &&
+			 _failed_read() &&
+			 _batched_miss_wrap();
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+
+	free(ref);
+	free(img);
+
+	return !ok;
+}
@@ -0,0 +1,18 @@
+/*
+ * Host memory map. BIS cache and lookup table live in test buffers.
+ */
+
+#ifndef _TEST_MEMORY_MAP_H_
+#define _TEST_MEMORY_MAP_H_
+
+#include "../../bdk/memory_map.h"
+
+extern unsigned char bis_cache_mem[];
+extern unsigned char bis_lookup_mem[];
+
+#undef NX_BIS_CACHE_ADDR
+#undef NX_BIS_LOOKUP_ADDR
+#define NX_BIS_CACHE_ADDR  (bis_cache_mem)
+#define NX_BIS_LOOKUP_ADDR (bis_lookup_mem)
+
+#endif
@@ -0,0 +1,415 @@
+/*
+ * Minimal AArch64 interpreter for running the CCPLEX job worker on the host.
+ * Only the integer, load/store and branch instructions the worker uses are implemented.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "a64.h"
+
+#define BITS(v, hi, lo) (((v) >> (lo)) & ((1ULL << ((hi) - (lo) + 1)) - 1))
+
+static uint64_t _sext(uint64_t v, uint32_t bits)
+{
+	uint64_t m = 1ULL << (bits - 1);
+
+	return (v ^ m) - m;
+}
+
+static uint64_t _ones(uint32_t n)
+{
+	return n >= 64 ? ~0ULL : (1ULL << n) - 1;
+}
+
+static uint64_t _reg(a64_t *cpu, uint32_t r, bool sf)
+{
+	uint64_t v = r == 31 ? 0 : cpu->x[r];
+
+	return sf ? v : (uint32_t)v;
+}
+
+static void _set_reg(a64_t *cpu, uint32_t r, uint64_t v, bool sf)
+{
+	if (r != 31)
+		cpu->x[r] = sf ? v : (uint32_t)v;
+}
+
+static uint64_t _ror(uint64_t v, uint32_t sh, uint32_t size)
+{
+	if (!sh)
+		return v;
+
+	return ((v >> sh) | (v << (size - sh))) & _ones(size);
+}
+
+// DecodeBitMasks() of the ARM ARM, wmask only.
+static bool _bitmask(uint32_t n, uint32_t imms, uint32_t immr, bool sf, uint64_t *mask)
+{
+	uint32_t len = 31 - __builtin_clz((n << 6) | (~imms & 0x3F));
+	if (len < 1 || (!sf && n))
+		return false;
+
+	uint32_t size = 1 << len;
+	uint32_t s = imms & (size - 1);
+	uint32_t r = immr & (size - 1);
+	if (s == size - 1)
+		return false;
+
+	uint64_t elem = _ror(_ones(s + 1), r, size);
+	uint64_t res = 0;
+	for (uint32_t i = 0; i < 64; i += size)
+		res |= elem << i;
+
+	*mask = sf ? res : (uint32_t)res;
+
+	return true;
+}
+
+static uint64_t _shift(uint64_t v, uint32_t type, uint32_t amount, bool sf)
+{
+	uint32_t size = sf ? 64 : 32;
+
+	switch (type)
+	{
+	case 0:
+		v <<= amount;
+		break;
+	case 1:
+		v >>= amount;
+		break;
+	case 2:
+		v = sf ? (uint64_t)((int64_t)v >> amount) : (uint32_t)((int32_t)v >> amount);
+		break;
+	case 3:
+		v = _ror(v, amount, size);
+		break;
+	}
+
+	return v & _ones(size);
+}
+
+static uint64_t _add_sub(a64_t *cpu, uint64_t a, uint64_t b, bool sub, bool set_flags, bool sf)
+{
+	uint32_t size = sf ? 64 : 32;
+	uint64_t mask = _ones(size);
+
+	a &= mask;
+	b &= mask;
+	if (sub)
+		b = ~b & mask;
+
+	unsigned __int128 sum = (unsigned __int128)a + b + sub;
+	uint64_t res = (uint64_t)sum & mask;
+
+	if (set_flags)
+	{
+		uint64_t sign = 1ULL << (size - 1);
+		cpu->n = !!(res & sign);
+		cpu->z = !res;
+		cpu->c = !!(sum >> size);
+		cpu->v = !((a ^ b) & sign) && ((a ^ res) & sign);
+	}
+
+	return res;
+}
+
+static bool _cond(a64_t *cpu, uint32_t cond)
+{
+	bool res;
+
+	switch (cond >> 1)
+	{
+	case 0:
+		res = cpu->z;
+		break;
+	case 1:
+		res = cpu->c;
+		break;
+	case 2:
+		res = cpu->n;
+		break;
+	case 3:
+		res = cpu->v;
+		break;
+	case 4:
+		res = cpu->c && !cpu->z;
+		break;
+	case 5:
+		res = cpu->n == cpu->v;
+		break;
+	case 6:
+		res = cpu->n == cpu->v && !cpu->z;
+		break;
+	default:
+		return true;
+	}
+
+	return (cond & 1) ? !res : res;
+}
+
+static bool _access(a64_t *cpu, uint64_t addr, uint32_t size, bool write)
+{
+	for (uint32_t i = 0; i < cpu->ranges_cnt; i++)
+	{
+		const a64_range_t *r = &cpu->ranges[i];
+		if (addr >= r->start && addr + size <= r->end && (!write || r->write))
+			return addr + size <= cpu->mem_size;
+	}
+
+	cpu->fault_addr = addr;
+
+	return false;
+}
+
+static a64_res_t _ldst(a64_t *cpu, uint32_t ins, uint64_t addr, uint32_t size, bool load)
+{
+	uint32_t rt = BITS(ins, 4, 0);
+
+	if (!_access(cpu, addr, size, !load))
+		return A64_FAULT;
+
+	if (load)
+	{
+		uint64_t v = 0;
+		memcpy(&v, cpu->mem + addr, size);
+		_set_reg(cpu, rt, v, true);
+	}
+	else
+	{
+		uint64_t v = _reg(cpu, rt, true);
+		memcpy(cpu->mem + addr, &v, size);
+	}
+
+	return A64_OK;
+}
+
+static a64_res_t _step(a64_t *cpu, bool *stored)
+{
+	uint32_t ins;
+
+	if (cpu->pc + 4 > cpu->mem_size)
+		return A64_FAULT;
+	memcpy(&ins, cpu->mem + cpu->pc, 4);
+
+	uint64_t next = cpu->pc + 4;
+	bool sf = ins >> 31;
+	uint32_t rd = BITS(ins, 4, 0);
+	uint32_t rn = BITS(ins, 9, 5);
+	uint32_t rm = BITS(ins, 20, 16);
+
+	*stored = false;
+
+	if ((ins & 0x9F000000) == 0x10000000) // ADR.
+	{
+		uint64_t imm = (BITS(ins, 23, 5) << 2) | BITS(ins, 30, 29);
+		_set_reg(cpu, rd, cpu->pc + _sext(imm, 21), true);
+	}
+	else if ((ins & 0x1F000000) == 0x11000000) // ADD/SUB (immediate).
+	{
+		uint64_t imm = BITS(ins, 21, 10) << (BITS(ins, 22, 22) ? 12 : 0);
+		uint64_t res = _add_sub(cpu, _reg(cpu, rn, sf), imm, BITS(ins, 30, 30), BITS(ins, 29, 29), sf);
+		_set_reg(cpu, rd, res, sf);
+	}
+	else if ((ins & 0x1F800000) == 0x12000000) // Logical (immediate).
+	{
+		uint64_t imm;
+		if (!_bitmask(BITS(ins, 22, 22), BITS(ins, 15, 10), BITS(ins, 21, 16), sf, &imm))
+			return A64_UNDEF;
+
+		uint64_t a = _reg(cpu, rn, sf), res;
+		switch (BITS(ins, 30, 29))
+		{
+		case 0:
+			res = a & imm;
+			break;
+		case 1:
+			res = a | imm;
+			break;
+		case 2:
+			res = a ^ imm;
+			break;
+		default:
+			return A64_UNDEF;
+		}
+		_set_reg(cpu, rd, res, sf);
+	}
+	else if ((ins & 0x1F800000) == 0x12800000) // Move wide.
+	{
+		uint32_t hw = BITS(ins, 22, 21) * 16;
+		uint64_t imm = BITS(ins, 20, 5) << hw;
+
+		switch (BITS(ins, 30, 29))
+		{
+		case 0:
+			_set_reg(cpu, rd, ~imm, sf);
+			break;
+		case 2:
+			_set_reg(cpu, rd, imm, sf);
+			break;
+		case 3:
+			_set_reg(cpu, rd, (_reg(cpu, rd, true) & ~(0xFFFFULL << hw)) | imm, sf);
+			break;
+		default:
+			return A64_UNDEF;
+		}
+	}
+	else if ((ins & 0x7F800000) == 0x53000000) // UBFM.
+	{
+		uint32_t size = sf ? 64 : 32;
+		uint32_t immr = BITS(ins, 21, 16);
+		uint32_t imms = BITS(ins, 15, 10);
+		uint64_t src = _reg(cpu, rn, sf), res;
+
+		if (imms >= immr)
+			res = (src >> immr) & _ones(imms - immr + 1);
+		else
+			res = (src & _ones(imms + 1)) << (size - immr);
+		_set_reg(cpu, rd, res, sf);
+	}
+	else if ((ins & 0x1F000000) == 0x0A000000) // Logical (shifted register).
+	{
+		uint64_t b = _shift(_reg(cpu, rm, sf), BITS(ins, 23, 22), BITS(ins, 15, 10), sf);
+		uint64_t a = _reg(cpu, rn, sf), res;
+
+		if (BITS(ins, 21, 21))
+			b = ~b & _ones(sf ? 64 : 32);
+
+		switch (BITS(ins, 30, 29))
+		{
+		case 0:
+			res = a & b;
+			break;
+		case 1:
+			res = a | b;
+			break;
+		case 2:
+			res = a ^ b;
+			break;
+		default:
+			return A64_UNDEF;
+		}
+		_set_reg(cpu, rd, res, sf);
+	}
+	else if ((ins & 0x1F200000) == 0x0B000000) // ADD/SUB (shifted register).
+	{
+		uint64_t b = _shift(_reg(cpu, rm, sf), BITS(ins, 23, 22), BITS(ins, 15, 10), sf);
+		uint64_t res = _add_sub(cpu, _reg(cpu, rn, sf), b, BITS(ins, 30, 30), BITS(ins, 29, 29), sf);
+		_set_reg(cpu, rd, res, sf);
+	}
+	else if ((ins & 0x1F200000) == 0x0B200000) // ADD/SUB (extended register). Only UXTW/UXTX.
+	{
+		uint32_t option = BITS(ins, 15, 13);
+		uint64_t b = _reg(cpu, rm, true);
+
+		if (option == 2)
+			b = (uint32_t)b;
+		else if (option != 3)
+			return A64_UNDEF;
+
+		b <<= BITS(ins, 12, 10);
+		uint64_t res = _add_sub(cpu, _reg(cpu, rn, sf), b, BITS(ins, 30, 30), BITS(ins, 29, 29), sf);
+		_set_reg(cpu, rd, res, sf);
+	}
+	else if ((ins & 0x7FE00C00) == 0x1A800000) // CSEL.
+		_set_reg(cpu, rd, _cond(cpu, BITS(ins, 15, 12)) ? _reg(cpu, rn, sf) : _reg(cpu, rm, sf), sf);
+	else if ((ins & 0x3B000000) == 0x39000000) // LDR/STR (unsigned immediate).
+	{
+		uint32_t size = 1 << BITS(ins, 31, 30);
+		uint32_t opc = BITS(ins, 23, 22);
+		if (opc > 1)
+			return A64_UNDEF;
+
+		uint64_t addr = _reg(cpu, rn, true) + BITS(ins, 21, 10) * size;
+		a64_res_t res = _ldst(cpu, ins, addr, size, opc);
+		if (res)
+			return res;
+		*stored = !opc;
+	}
+	else if ((ins & 0x3B200C00) == 0x38200800) // LDR/STR (register offset).
+	{
+		uint32_t size = 1 << BITS(ins, 31, 30);
+		uint32_t opc = BITS(ins, 23, 22);
+		uint32_t option = BITS(ins, 15, 13);
+		if (opc > 1)
+			return A64_UNDEF;
+
+		uint64_t off = _reg(cpu, rm, true);
+		if (option == 2)
+			off = (uint32_t)off;
+		else if (option != 3)
+			return A64_UNDEF;
+		if (BITS(ins, 12, 12))
+			off <<= BITS(ins, 31, 30);
+
+		a64_res_t res = _ldst(cpu, ins, _reg(cpu, rn, true) + off, size, opc);
+		if (res)
+			return res;
+		*stored = !opc;
+	}
+	else if ((ins & 0x7C000000) == 0x14000000) // B/BL.
+	{
+		if (sf)
+			cpu->x[30] = next;
+		next = cpu->pc + _sext(BITS(ins, 25, 0) << 2, 28);
+	}
+	else if ((ins & 0xFF000010) == 0x54000000) // B.cond.
+	{
+		if (_cond(cpu, BITS(ins, 3, 0)))
+			next = cpu->pc + _sext(BITS(ins, 23, 5) << 2, 21);
+	}
+	else if ((ins & 0x7E000000) == 0x34000000) // CBZ/CBNZ.
+	{
+		bool zero = !_reg(cpu, rd, sf);
+		if (zero != BITS(ins, 24, 24))
+			next = cpu->pc + _sext(BITS(ins, 23, 5) << 2, 21);
+	}
+	else if ((ins & 0x7E000000) == 0x36000000) // TBZ/TBNZ.
+	{
+		uint32_t bit = (BITS(ins, 31, 31) << 5) | BITS(ins, 23, 19);
+		bool set = (_reg(cpu, rd, true) >> bit) & 1;
+		if (set == BITS(ins, 24, 24))
+			next = cpu->pc + _sext(BITS(ins, 18, 5) << 2, 16);
+	}
+	else if ((ins & 0xFFFFFC1F) == 0xD65F0000) // RET.
+		next = _reg(cpu, rn, true);
+	else if ((ins & 0xFFF00000) == 0xD5300000) // MRS.
+		_set_reg(cpu, rd, 0, true);
+	else if ((ins & 0xFFC00000) == 0xD5000000) // MSR, barriers, cache and TLB maintenance.
+		;
+	else
+		return A64_UNDEF;
+
+	cpu->pc = next;
+
+	return A64_OK;
+}
+
+a64_res_t a64_run(a64_t *cpu, uint64_t max_steps, bool (*done)(a64_t *cpu))
+{
+	for (uint64_t i = 0; i < max_steps; i++)
+	{
+		bool stored;
+		a64_res_t res = _step(cpu, &stored);
+
+		cpu->steps++;
+		if (res)
+			return res;
+
+		if (stored && done(cpu))
+			return A64_OK;
+	}
+
+	return A64_TIMEOUT;
+}
@@ -0,0 +1,56 @@
+/*
+ * Minimal AArch64 interpreter for running the CCPLEX job worker on the host.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _A64_H_
+#define _A64_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum
+{
+	A64_OK      = 0,
+	A64_UNDEF   = 1, // Instruction not supported.
+	A64_FAULT   = 2, // Access outside of the allowed ranges.
+	A64_TIMEOUT = 3,
+} a64_res_t;
+
+typedef struct _a64_range_t
+{
+	uint64_t start;
+	uint64_t end;
+	bool write;
+} a64_range_t;
+
+typedef struct _a64_t
+{
+	uint64_t x[32]; // x[31] reads as zero.
+	uint64_t pc;
+	bool n, z, c, v;
+
+	uint8_t *mem; // Flat memory at address 0.
+	uint64_t mem_size;
+	const a64_range_t *ranges; // Allowed data accesses.
+	uint32_t ranges_cnt;
+
+	uint64_t steps;
+	uint64_t fault_addr;
+} a64_t;
+
+// Runs until done() returns true after a store. System instructions are nops and MRS reads zero.
+a64_res_t a64_run(a64_t *cpu, uint64_t max_steps, bool (*done)(a64_t *cpu));
+
+#endif
@@ -0,0 +1,579 @@
+/*
+ * Host fuzz and benchmark target for the BLZ decoder.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libs/compr/blz.h>
+
+#include "a64.h"
+
+#define FUZZ_ITERS    20000
+#define FUZZ_MAX_OUT  SZ_64K
+#define BENCH_OUT     SZ_2M
+#define BENCH_ITERS   20
+#define BLZ_PAD       SZ_8K // Back-references of corrupt streams may read past the output.
+#define CCPLEX_ITERS  2000
+#define CCPLEX_STEPS  100000000
+
+// CCPLEX job worker memory. Payload is at 0, job buffer follows it like an arena allocation.
+#define CCPLEX_MBOX_OFF  0x1C0
+#define CCPLEX_MBOX_SIZE 0x40
+#define CCPLEX_BUF_OFF   0x1000
+#define CCPLEX_MEM_SIZE  (CCPLEX_BUF_OFF + FUZZ_MAX_OUT + 0x100)
+
+typedef struct _blz_stream_t
+{
+	u8 *comp;      // Compressed data with footer.
+	u32 comp_size;
+	u8 *out;       // Expected output.
+	u32 out_size;
+} blz_stream_t;
+
+static const u8 ccplex_job_payload[] = {
+#include "ccplex_job_payload.inc"
+};
+
+static u32 rng_state = 1;
+
+static u32 _rand()
+{
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+
+	return rng_state;
+}
+
+/*
+ * Decoder from before the fast path, used as reference.
+ * The only change is a bounds check before reading a control byte,
+ * so that corrupt streams can't read before the buffer on the host.
+ */
+static int _blz_ref_uncompress(unsigned char *dataBuf, unsigned int compSize, const blz_footer *footer)
+{
+	u32 addl_size = footer->addl_size;
+	u32 header_size = footer->header_size;
+	u32 cmp_and_hdr_size = footer->cmp_and_hdr_size;
+
+	unsigned char* cmp_start = &dataBuf[compSize] - cmp_and_hdr_size;
+	u32 cmp_ofs = cmp_and_hdr_size - header_size;
+	u32 out_ofs = cmp_and_hdr_size + addl_size;
+
+	while (out_ofs)
+	{
+		if (cmp_ofs < 1)
+			return 0; // Out of bounds.
+
+		unsigned char control = cmp_start[--cmp_ofs];
+		for (unsigned int i=0; i<8; i++)
+		{
+			if (control & 0x80)
+			{
+				if (cmp_ofs < 2)
+					return 0; // Out of bounds.
+
+				cmp_ofs -= 2;
+				u16 seg_val = ((unsigned int)(cmp_start[cmp_ofs + 1]) << 8) | cmp_start[cmp_ofs];
+				u32 seg_size = ((seg_val >> 12) & 0xF) + 3;
+				u32 seg_ofs = (seg_val & 0x0FFF) + 3;
+				if (out_ofs < seg_size) // Kernel restricts segment copy to stay in bounds.
+					seg_size = out_ofs;
+
+				out_ofs -= seg_size;
+
+				for (unsigned int j = 0; j < seg_size; j++)
+					cmp_start[out_ofs + j] = cmp_start[out_ofs + j + seg_ofs];
+			}
+			else
+			{
+				// Copy directly.
+				if (cmp_ofs < 1)
+					return 0; //out of bounds
+
+				cmp_start[--out_ofs] = cmp_start[--cmp_ofs];
+			}
+			control <<= 1;
+			if (out_ofs == 0) // Blz works backwards, so if it reaches byte 0, it's done.
+				return 1;
+		}
+	}
+
+	return 1;
+}
+
+/*
+ * Generate a valid stream by emitting random tokens and decoding them while going.
+ * Literal bytes are skewed towards few values to look like code and data sections.
+ */
+static bool _stream_try_gen(blz_stream_t *s, u32 out_size, u32 match_pct)
+{
+	u8 *tokens = malloc(out_size * 2 + out_size / 8 + 16);
+	u8 *out = malloc(out_size);
+	u32 tok_len = 0;
+	u32 out_ofs = out_size;
+	u32 ctrl_pos = 0;
+	u32 ctrl_bit = 8;
+	u32 max_lead = 0;
+
+	while (out_ofs)
+	{
+		// Tokens are consumed in groups of 8 behind a control byte.
+		if (ctrl_bit == 8)
+		{
+			ctrl_pos = tok_len++;
+			tokens[ctrl_pos] = 0;
+			ctrl_bit = 0;
+		}
+
+		u32 decoded = out_size - out_ofs;
+		if (decoded >= 3 && out_ofs >= 3 && (_rand() % 100) < match_pct)
+		{
+			u32 seg_size = 3 + _rand() % 16;
+			u32 seg_ofs = 3 + _rand() % 4096;
+			if (seg_size > out_ofs)
+				seg_size = out_ofs;
+
+			// Short distances, like runs of the same bytes.
+			if (!(_rand() % 4))
+				seg_ofs = 3 + _rand() % 4;
+
+			// Only reference already decoded data. Copy goes upwards, so it can't overlap either.
+			if (seg_ofs > decoded)
+				seg_ofs = 3 + _rand() % (decoded - 2);
+			if (seg_size > seg_ofs)
+				seg_size = seg_ofs;
+
+			u16 seg_val = ((seg_size - 3) << 12) | (seg_ofs - 3);
+			tokens[tok_len++] = seg_val >> 8;
+			tokens[tok_len++] = seg_val & 0xFF;
+			tokens[ctrl_pos] |= 0x80 >> ctrl_bit;
+
+			out_ofs -= seg_size;
+			for (u32 j = 0; j < seg_size; j++)
+				out[out_ofs + j] = out[out_ofs + j + seg_ofs];
+		}
+		else
+		{
+			u8 lit = (_rand() % 3) ? (_rand() & 0xF) : _rand();
+			tokens[tok_len++] = lit;
+			out[--out_ofs] = lit;
+		}
+
+		ctrl_bit++;
+
+		// Track how far output runs ahead of input.
+		u32 lead = out_size - out_ofs - tok_len;
+		if ((int)lead > (int)max_lead)
+			max_lead = lead;
+	}
+
+	/*
+	 * Output must be bigger than the stream, otherwise it can't be described by a footer.
+	 * Decoding is in place, so output must never overwrite input that is not read yet.
+	 */
+	if (tok_len + sizeof(blz_footer) > out_size || max_lead > out_size - tok_len)
+	{
+		free(tokens);
+		free(out);
+
+		return false;
+	}
+
+	// Stream is read backwards, so store tokens in reverse and append the footer.
+	blz_footer footer;
+	footer.header_size = sizeof(blz_footer);
+	footer.cmp_and_hdr_size = tok_len + sizeof(blz_footer);
+	footer.addl_size = out_size - footer.cmp_and_hdr_size;
+
+	s->comp_size = footer.cmp_and_hdr_size;
+	s->comp = malloc(s->comp_size);
+	for (u32 i = 0; i < tok_len; i++)
+		s->comp[tok_len - 1 - i] = tokens[i];
+	memcpy(s->comp + tok_len, &footer, sizeof(footer));
+
+	s->out = out;
+	s->out_size = out_size;
+
+	free(tokens);
+
+	return true;
+}
+
+static void _stream_gen(blz_stream_t *s, u32 out_size, u32 match_pct)
+{
+	// Raise match ratio until the output compresses and can be decoded in place.
+	while (!_stream_try_gen(s, out_size, match_pct))
+	{
+		match_pct += 10;
+		if (match_pct > 100)
+			out_size += 16;
+	}
+}
+
+static void _stream_free(blz_stream_t *s)
+{
+	free(s->comp);
+	free(s->out);
+}
+
+// Decode in place like pkg2_decompress_kip does. Returns the decoder result.
+static int _decode(int mode, const u8 *comp, u32 comp_size, u8 *buf, u32 buf_size)
+{
+	blz_footer footer;
+
+	if (mode == 2)
+		return blz_uncompress_srcdest(comp, comp_size, buf, buf_size);
+
+	if (!blz_srcdest_prepare(comp, comp_size, buf, buf_size, &footer))
+		return 0;
+
+	if (mode == 0)
+		return _blz_ref_uncompress(buf, comp_size, &footer);
+
+	return blz_uncompress_inplace(buf, comp_size, &footer);
+}
+
+static u32 _out_size(const u8 *comp, u32 comp_size)
+{
+	blz_footer footer;
+	if (!blz_get_footer(comp, comp_size, &footer))
+		return 0;
+
+	return footer.cmp_and_hdr_size + footer.addl_size;
+}
+
+static a64_t ccplex_cpu;
+static u8 *ccplex_mem;
+
+static bool _ccplex_job_done(a64_t *cpu)
+{
+	return *(u32 *)(cpu->mem + CCPLEX_MBOX_OFF) == 2;
+}
+
+/*
+ * Run the job like pkg2_decompress_kip offloads it to the CCPLEX worker.
+ * Worker may only access the mailbox and the job buffer. Returns the job result or -1 on emulation failure.
+ */
+static int _ccplex_decode(const u8 *comp, u32 comp_size, u8 *buf, u32 buf_size)
+{
+	blz_footer footer;
+	u8 *job_buf = ccplex_mem + CCPLEX_BUF_OFF;
+	u32 *mbox = (u32 *)(ccplex_mem + CCPLEX_MBOX_OFF);
+
+	memset(job_buf, 0, CCPLEX_MEM_SIZE - CCPLEX_BUF_OFF);
+	if (!blz_srcdest_prepare(comp, comp_size, job_buf, buf_size, &footer))
+		return 0;
+
+	const a64_range_t ranges[2] = {
+		{ CCPLEX_MBOX_OFF, CCPLEX_MBOX_OFF + CCPLEX_MBOX_SIZE, true },
+		{ CCPLEX_BUF_OFF,  CCPLEX_BUF_OFF + buf_size,         true },
+	};
+	ccplex_cpu.ranges = ranges;
+	ccplex_cpu.ranges_cnt = 2;
+
+	mbox[1] = 0;
+	mbox[2] = CCPLEX_BUF_OFF;
+	mbox[3] = comp_size;
+	mbox[4] = footer.cmp_and_hdr_size;
+	mbox[5] = footer.header_size;
+	mbox[6] = footer.addl_size;
+	mbox[0] = 1;
+
+	a64_res_t res = a64_run(&ccplex_cpu, CCPLEX_STEPS, _ccplex_job_done);
+	if (res)
+	{
+		const char *res_names[4] = { "ok", "undefined instruction", "fault", "timeout" };
+		printf("FAIL ccplex: %s at pc 0x%llX (addr 0x%llX)\n", res_names[res],
+			(unsigned long long)ccplex_cpu.pc, (unsigned long long)ccplex_cpu.fault_addr);
+		return -1;
+	}
+
+	memcpy(buf, job_buf, buf_size);
+
+	return mbox[1];
+}
+
+// The worker must decode like the safe decoder, since both are used for the same KIPs.
+static int _ccplex()
+{
+	u32 valid = 0, corrupt = 0, footers = 0;
+	u8 *ref = malloc(FUZZ_MAX_OUT + BLZ_PAD);
+	u8 *out = malloc(FUZZ_MAX_OUT);
+
+	ccplex_mem = calloc(1, CCPLEX_MEM_SIZE);
+	memcpy(ccplex_mem, ccplex_job_payload, sizeof(ccplex_job_payload));
+	ccplex_cpu.mem = ccplex_mem;
+	ccplex_cpu.mem_size = CCPLEX_MEM_SIZE;
+
+	for (u32 iter = 0; iter < CCPLEX_ITERS * 2; iter++)
+	{
+		blz_stream_t s;
+		bool corrupt_footer = iter >= CCPLEX_ITERS;
+		_stream_gen(&s, 1 + _rand() % (corrupt_footer ? 4096 : FUZZ_MAX_OUT), _rand() % 100);
+
+		int res = _ccplex_decode(s.comp, s.comp_size, out, s.out_size);
+		if (res != 1 || memcmp(out, s.out, s.out_size))
+		{
+			printf("FAIL ccplex: valid stream %d (out %d) mismatch\n", iter, s.out_size);
+			return 1;
+		}
+		valid++;
+
+		if (corrupt_footer)
+		{
+			blz_footer footer;
+			blz_get_footer(s.comp, s.comp_size, &footer);
+			switch (_rand() % 3)
+			{
+			case 0:
+				footer.cmp_and_hdr_size = _rand();
+				break;
+			case 1:
+				footer.header_size = _rand();
+				break;
+			case 2:
+				footer.addl_size = _rand();
+				break;
+			}
+			memcpy(s.comp + s.comp_size - sizeof(blz_footer), &footer, sizeof(blz_footer));
+			footers++;
+		}
+		else
+		{
+			u32 flips = 1 + _rand() % 8;
+			for (u32 i = 0; i < flips && s.comp_size > sizeof(blz_footer); i++)
+				s.comp[_rand() % (s.comp_size - sizeof(blz_footer))] ^= 1 << (_rand() % 8);
+			corrupt++;
+		}
+
+		memset(ref, 0, FUZZ_MAX_OUT + BLZ_PAD);
+		int ref_res = blz_uncompress_srcdest(s.comp, s.comp_size, ref, s.out_size);
+		res = _ccplex_decode(s.comp, s.comp_size, out, s.out_size);
+		if (res < 0 || !res != !ref_res || (res && memcmp(out, ref, s.out_size)))
+		{
+			printf("FAIL ccplex: corrupt stream %d differs from safe decoder (%d vs %d)\n", iter, res, ref_res);
+			return 1;
+		}
+
+		_stream_free(&s);
+	}
+
+	printf("ok    ccplex worker: %d valid, %d corrupt streams, %d corrupt footers, %llu instructions\n",
+		valid, corrupt, footers, (unsigned long long)ccplex_cpu.steps);
+
+	free(ccplex_mem);
+	free(out);
+	free(ref);
+
+	return 0;
+}
+
+static int _fuzz()
+{
+	const char *mode_names[3] = { "ref", "fast", "safe" };
+	u32 valid = 0, corrupt = 0, safe_rejects = 0;
+	u8 *bufs[3];
+
+	for (u32 m = 0; m < 3; m++)
+		bufs[m] = malloc(FUZZ_MAX_OUT + BLZ_PAD);
+
+	for (u32 iter = 0; iter < FUZZ_ITERS; iter++)
+	{
+		blz_stream_t s;
+		_stream_gen(&s, 1 + _rand() % FUZZ_MAX_OUT, _rand() % 100);
+
+		// Valid streams must decode exactly with all decoders.
+		for (u32 m = 0; m < 3; m++)
+		{
+			memset(bufs[m], 0, FUZZ_MAX_OUT + BLZ_PAD);
+			if (!_decode(m, s.comp, s.comp_size, bufs[m], s.out_size) || memcmp(bufs[m], s.out, s.out_size))
+			{
+				printf("FAIL %s: valid stream %d (out %d) mismatch\n", mode_names[m], iter, s.out_size);
+				return 1;
+			}
+		}
+		valid++;
+
+		// Corrupt some stream bytes. Fast must behave exactly like the reference.
+		u32 flips = 1 + _rand() % 8;
+		for (u32 i = 0; i < flips && s.comp_size > sizeof(blz_footer); i++)
+			s.comp[_rand() % (s.comp_size - sizeof(blz_footer))] ^= 1 << (_rand() % 8);
+
+		int res[3];
+		for (u32 m = 0; m < 3; m++)
+		{
+			memset(bufs[m], 0, FUZZ_MAX_OUT + BLZ_PAD);
+			res[m] = _decode(m, s.comp, s.comp_size, bufs[m], s.out_size);
+		}
+
+		if (res[0] != res[1] || (res[0] && memcmp(bufs[0], bufs[1], FUZZ_MAX_OUT + BLZ_PAD)))
+		{
+			printf("FAIL fast: corrupt stream %d differs from reference\n", iter);
+			return 1;
+		}
+
+		// Safe mode may reject more, but anything it accepts must match.
+		if (res[2] && (!res[0] || memcmp(bufs[0], bufs[2], s.out_size)))
+		{
+			printf("FAIL safe: corrupt stream %d accepted with different output\n", iter);
+			return 1;
+		}
+		if (res[0] && !res[2])
+			safe_rejects++;
+		corrupt++;
+
+		_stream_free(&s);
+	}
+
+	// Corrupt footers may only be tried in safe mode.
+	for (u32 iter = 0; iter < FUZZ_ITERS; iter++)
+	{
+		blz_stream_t s;
+		_stream_gen(&s, 1 + _rand() % 4096, 50);
+
+		// Footer is not aligned.
+		blz_footer footer;
+		blz_get_footer(s.comp, s.comp_size, &footer);
+		switch (_rand() % 3)
+		{
+		case 0:
+			footer.cmp_and_hdr_size = _rand();
+			break;
+		case 1:
+			footer.header_size = _rand();
+			break;
+		case 2:
+			footer.addl_size = _rand();
+			break;
+		}
+		memcpy(s.comp + s.comp_size - sizeof(blz_footer), &footer, sizeof(blz_footer));
+
+		memset(bufs[2], 0, FUZZ_MAX_OUT + BLZ_PAD);
+		blz_uncompress_srcdest(s.comp, s.comp_size, bufs[2], s.out_size);
+
+		_stream_free(&s);
+	}
+
+	printf("ok    %d valid, %d corrupt streams, %d corrupt footers (safe rejected %d that ref accepted)\n",
+		valid, corrupt, FUZZ_ITERS, safe_rejects);
+
+	for (u32 m = 0; m < 3; m++)
+		free(bufs[m]);
+
+	return 0;
+}
+
+static double _now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int _bench_one(const char *name, const u8 *comp, u32 comp_size)
+{
+	const char *mode_names[3] = { "ref", "fast", "safe" };
+	u32 out_size = _out_size(comp, comp_size);
+	u8 *bufs[3];
+
+	if (!out_size)
+		return 1;
+
+	printf("%s: %d -> %d bytes\n", name, comp_size, out_size);
+	for (u32 m = 0; m < 3; m++)
+	{
+		bufs[m] = calloc(1, out_size + BLZ_PAD);
+
+		double t = _now();
+		for (u32 i = 0; i < BENCH_ITERS; i++)
+		{
+			if (!_decode(m, comp, comp_size, bufs[m], out_size))
+			{
+				printf("FAIL %s: decode failed\n", mode_names[m]);
+				return 1;
+			}
+		}
+		t = (_now() - t) / BENCH_ITERS;
+
+		printf("  %-4s %8.3f ms %8.2f MB/s\n", mode_names[m], t * 1000, out_size / t / 1e6);
+	}
+
+	int err = memcmp(bufs[0], bufs[1], out_size) || memcmp(bufs[0], bufs[2], out_size);
+	if (err)
+		printf("FAIL output differs from reference\n");
+
+	for (u32 m = 0; m < 3; m++)
+		free(bufs[m]);
+
+	return err;
+}
+
+static int _bench(int argc, char **argv)
+{
+	int err = 0;
+	const u32 match_pcts[3] = { 20, 50, 80 };
+
+	for (u32 i = 0; i < 3; i++)
+	{
+		char name[32];
+		blz_stream_t s;
+
+		_stream_gen(&s, BENCH_OUT, match_pcts[i]);
+		sprintf(name, "generated %d%% matches", match_pcts[i]);
+		err |= _bench_one(name, s.comp, s.comp_size);
+		_stream_free(&s);
+	}
+
+	// Real compressed KIP sections, e.g. extracted with hactool.
+	for (int i = 0; i < argc; i++)
+	{
+		FILE *fp = fopen(argv[i], "rb");
+		if (!fp)
+		{
+			printf("FAIL cannot open %s\n", argv[i]);
+			err = 1;
+			continue;
+		}
+
+		fseek(fp, 0, SEEK_END);
+		u32 size = ftell(fp);
+		fseek(fp, 0, SEEK_SET);
+		u8 *comp = malloc(size);
+		if (fread(comp, 1, size, fp) != size)
+			size = 0;
+		fclose(fp);
+
+		err |= _bench_one(argv[i], comp, size);
+		free(comp);
+	}
+
+	return err;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc > 1 && !strcmp(argv[1], "bench"))
+		return _bench(argc - 2, argv + 2);
+
+	if (argc > 1 && !strcmp(argv[1], "ccplex"))
+		return _ccplex();
+
+	return _fuzz();
+}
@@ -0,0 +1,142 @@
+'''
+This program is free software; you can redistribute it and/or modify it
+under the terms and conditions of the GNU General Public License,
+version 2, as published by the Free Software Foundation.
+
+This program is distributed in the hope it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+'''
+
+# CCPLEX job worker for bdk/soc/ccplex_job.c. Mailbox (8 words) follows the code at 0x1C0, on its own cache line.
+
+from keystone import *
+
+CODE = b'''
+	mrs  x0, s3_1_c15_c2_1 // CPUECTLR. SMPEN must be set before caches are enabled.
+	orr  x0, x0, #0x40
+	msr  s3_1_c15_c2_1, x0
+	isb
+	adr  x20, 0x1C0 // Mailbox.
+	mov  x0, #0xFF // MAIR attribute 0: normal write-back.
+	msr  mair_el3, x0
+	movz x0, #0x3520 // TCR: 4GB, 4KB granule, write-back inner shareable walks.
+	movk x0, #0x8080, lsl #16
+	msr  tcr_el3, x0
+	ldr  w0, [x20, #0x1C]
+	msr  ttbr0_el3, x0
+	tlbi alle3
+	dsb  sy
+	isb
+	mrs  x0, sctlr_el3
+	mov  x1, #0x1005 // MMU, D-cache and I-cache.
+	orr  x0, x0, x1
+	msr  sctlr_el3, x0
+	isb
+wait:
+	dc   civac, x20 // Drop stale mailbox line.
+	dsb  sy
+	ldr  w4, [x20, #0x0]
+	cmp  w4, #1
+	b.ne wait
+	ldr  w5, [x20, #0x08]
+	ldr  w6, [x20, #0x0C]
+	ldr  w7, [x20, #0x10]
+	ldr  w8, [x20, #0x14]
+	ldr  w9, [x20, #0x18]
+	mov  w10, #0
+	cmp  w7, w6
+	b.hi done
+	cmp  w8, w7
+	b.hi done
+	add  x11, x5, x6
+	sub  x11, x11, x7
+	sub  w12, w7, w8
+	add  w13, w7, w9
+	bl   flush // Drop stale buffer lines.
+	mov  w14, w13
+loop:
+	cbz  w14, ok
+	cbz  w12, fail
+	sub  w12, w12, #1
+	ldrb w15, [x11, w12, uxtw]
+	mov  w16, #8
+bit:
+	cbz  w14, ok
+	tbz  w15, #7, literal
+	cmp  w12, #2
+	b.lo fail
+	sub  w12, w12, #2
+	add  x17, x11, w12, uxtw
+	ldrb w21, [x17]
+	ldrb w22, [x17, #1]
+	orr  w21, w21, w22, lsl #8
+	ubfx w22, w21, #12, #4
+	add  w22, w22, #3
+	and  w23, w21, #0xFFF
+	add  w23, w23, #3
+	cmp  w14, w22
+	csel w22, w14, w22, lo
+	sub  w14, w14, w22
+	add  w24, w14, w23
+	add  w24, w24, w22
+	cmp  w24, w13
+	b.hi fail
+	cmp  w14, w12
+	b.lo fail
+	add  x17, x11, w14, uxtw
+	add  x25, x17, w23, uxtw
+	mov  w24, #0
+copy:
+	ldrb w26, [x25, w24, uxtw]
+	strb w26, [x17, w24, uxtw]
+	add  w24, w24, #1
+	cmp  w24, w22
+	b.lo copy
+	b    next
+literal:
+	cbz  w12, fail
+	sub  w12, w12, #1
+	sub  w14, w14, #1
+	cmp  w14, w12
+	b.lo fail
+	ldrb w26, [x11, w12, uxtw]
+	strb w26, [x11, w14, uxtw]
+next:
+	lsl  w15, w15, #1
+	subs w16, w16, #1
+	b.ne bit
+	b    loop
+ok:
+	mov  w10, #1
+fail:
+	bl   flush // Write back output.
+done:
+	str  w10, [x20, #0x04]
+	dmb  sy
+	mov  w4, #2
+	str  w4, [x20, #0x0]
+	dc   civac, x20
+	dsb  sy
+	b    wait
+flush:
+	bic  x0, x11, #0x3F
+	add  x1, x11, w13, uxtw
+flush_line:
+	dc   civac, x0
+	add  x0, x0, #0x40
+	cmp  x0, x1
+	b.lo flush_line
+	dsb  sy
+	ret
+'''
+try:
+	ks = Ks(KS_ARCH_ARM64, KS_MODE_LITTLE_ENDIAN)
+	encoding, count = ks.asm(CODE, 0x0)
+	print("%s = %s (number of statements: %u)" %(CODE, ', '.join([('0x%02x' % (x)) for x in encoding]), count))
+except KsError as e:
+	print("ERROR: %s" %e)
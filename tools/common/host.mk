@@ -0,0 +1,26 @@
+# Shared setup of the host tests and benches. Included by tools/<name>/Makefile.
+
+NATIVE_CC ?= gcc
+
+ifeq (, $(shell which $(NATIVE_CC) 2>/dev/null))
+$(error "Native GCC is missing. Please install it first. If it's path is custom, set it with export NATIVE_CC=<path to native gcc toolchain>")
+endif
+
+COMMONDIR := ../common
+BDKDIR    := ../../bdk
+BLDIR     := ../../bootloader
+NYXDIR    := ../../nyx/nyx_gui
+LVDIR     := $(BDKDIR)/libs/lvgl
+
+# Host shims for mem/heap.h and GFX_INC. Firmware sources find them with -I$(COMMONDIR).
+COMMON_DEPS := $(COMMONDIR)/mem/heap.h $(COMMONDIR)/test_gfx.h
+
+SANITIZE := -fsanitize=address,undefined -fno-sanitize-recover=all
+
+FFSRCS := $(BDKDIR)/libs/fatfs/ff.c $(BDKDIR)/libs/fatfs/ffunicode.c
+
+.DEFAULT_GOAL := all
+
+# FatFs reads past the path terminator, so it is built without sanitizers.
+fatfs.o: $(FFSRCS) $(COMMON_DEPS)
+	@$(NATIVE_CC) $(CFLAGS) -r -nostdlib -o $@ $(FFSRCS)
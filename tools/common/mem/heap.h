@@ -0,0 +1,7 @@
+/*
+ * Host heap. Uses libc allocator.
+ */
+
+#include <stdlib.h>
+
+#include <utils/types.h>
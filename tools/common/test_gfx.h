@@ -0,0 +1,10 @@
+/*
+ * Host gfx. Each test provides gfx_printf, to drop or count error prints.
+ */
+
+#ifndef _TEST_GFX_H_
+#define _TEST_GFX_H_
+
+void gfx_printf(const char *fmt, ...);
+
+#endif
@@ -0,0 +1,639 @@
+/*
+ * Host test for the partition manager copy engine. Backs up and restores a tree between FAT images.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libs/fatfs/ff.h>
+#include <libs/fatfs/diskio.h>
+#include <storage/ramdisk.h>
+
+#include "../../nyx/nyx_gui/frontend/fe_copy_files.h"
+
+#define SD_SECTORS   (0x110000000ULL >> 9) // 4.25GB. FAT32 with 64KB clusters needs 4GB.
+#define RAM_SECTORS  (RAM_DISK_SZ >> 9)
+#define MAX_FILES    4096
+#define PATH_SZ      0x1000
+#define DRIVE_NUM    (DRIVE_RAM + 1)
+
+typedef struct _disk_t
+{
+	u8 *img;
+	u64 sectors_max;
+	u32 reads;
+	u32 writes;
+	u64 sectors;
+} disk_t;
+
+typedef struct _model_file_t
+{
+	char path[256];
+	u8 *data;
+	u32 size;
+	u8 attr;
+	bool dir;
+	bool skipped; // Not copied.
+} model_file_t;
+
+static disk_t disks[DRIVE_NUM];
+static FATFS fs[DRIVE_NUM];
+static const char *drives[DRIVE_NUM] = { "sd:", "ram:" };
+
+static model_file_t model[MAX_FILES];
+static u32 model_cnt;
+
+static u32 rng_state = 1;
+static u32 fail_writes_after = -1; // Destination writes left before the disk fails.
+
+static u32 _rand()
+{
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+
+	return rng_state;
+}
+
+void gfx_printf(const char *fmt, ...)
+{
+}
+
+void *ff_memalloc(UINT msize)
+{
+	return malloc(msize);
+}
+
+void ff_memfree(void *mblock)
+{
+	free(mblock);
+}
+
+DWORD get_fattime()
+{
+	return ((2022 - 1980) << 25) | (1 << 21) | (1 << 16) | (12 << 11);
+}
+
+u32 get_tmr_ms()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+void manual_system_maintenance(bool refresh)
+{
+}
+
+void lv_label_set_text(lv_obj_t *label, const char *text)
+{
+}
+
+DSTATUS disk_initialize(BYTE pdrv)
+{
+	return 0;
+}
+
+DSTATUS disk_status(BYTE pdrv)
+{
+	return 0;
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
+{
+	if (pdrv >= DRIVE_NUM || sector + count > disks[pdrv].sectors_max)
+		return RES_PARERR;
+
+	memcpy(buff, disks[pdrv].img + ((u64)sector << 9), count << 9);
+	disks[pdrv].reads++;
+	disks[pdrv].sectors += count;
+
+	return RES_OK;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
+{
+	if (pdrv >= DRIVE_NUM || sector + count > disks[pdrv].sectors_max)
+		return RES_PARERR;
+
+	if (!fail_writes_after)
+		return RES_ERROR;
+	fail_writes_after--;
+
+	memcpy(disks[pdrv].img + ((u64)sector << 9), buff, count << 9);
+	disks[pdrv].writes++;
+	disks[pdrv].sectors += count;
+
+	return RES_OK;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)
+{
+	switch (cmd)
+	{
+	case GET_SECTOR_COUNT:
+		*(DWORD *)buff = disks[pdrv].sectors_max;
+		break;
+	case GET_BLOCK_SIZE:
+		*(DWORD *)buff = 1;
+		break;
+	}
+
+	return RES_OK;
+}
+
+DRESULT disk_set_info(BYTE pdrv, BYTE cmd, void *buff)
+{
+	return RES_OK;
+}
+
+// SD is FAT32 with 64KB clusters like the partition manager formats it. Ram disk is exFAT with 32KB clusters like ram_disk_init.
+static int _format(u32 drive)
+{
+	u8 *work = malloc(SZ_4M);
+	BYTE opt = drive == DRIVE_RAM ? (FM_EXFAT | FM_SFD) : FM_FAT32;
+	DWORD au = drive == DRIVE_RAM ? RAMDISK_CLUSTER_SZ : SZ_64K;
+
+	// Images are sparse, so only used sectors take host memory.
+	f_mount(NULL, drives[drive], 1);
+	free(disks[drive].img);
+	disks[drive].sectors_max = drive == DRIVE_RAM ? RAM_SECTORS : SD_SECTORS;
+	disks[drive].img = calloc(1, disks[drive].sectors_max << 9);
+
+	int res = f_mkfs(drives[drive], opt, au, work, SZ_4M);
+	if (!res)
+		res = f_mount(&fs[drive], drives[drive], 1);
+	free(work);
+
+	return res;
+}
+
+static void _model_add(const char *path, u32 size, u8 attr, bool dir)
+{
+	model_file_t *f = &model[model_cnt++];
+
+	strcpy(f->path, path);
+	f->size = size;
+	f->attr = attr;
+	f->dir = dir;
+	f->skipped = strstr(path, "System Volume Information") != NULL;
+	f->data = NULL;
+
+	if (dir)
+		return;
+
+	// Mix of compressible and random data. Patterns differ per file so that misplaced data is caught.
+	f->data = malloc(size + 1);
+	u32 pattern = _rand();
+	for (u32 i = 0; i < size; i++)
+		f->data[i] = (_rand() & 3) ? (u8)(pattern + i / 64) : (u8)_rand();
+}
+
+static void _model_gen()
+{
+	char path[256];
+	u32 dirs = 0;
+
+	_model_add("bootloader", 0, 0, true);
+	_model_add("bootloader/System Volume Information", 0, AM_HID | AM_SYS, true);
+	_model_add("bootloader/System Volume Information/IndexerVolumeGuid", 76, AM_ARC, false);
+
+	// Folders up to 4 levels deep, with long names.
+	const char *dir_names[] = { "sys", "payloads", "ini", "res", "a very long folder name to need lfn entries" };
+	for (u32 i = 0; i < 24; i++)
+	{
+		if (!dirs || (_rand() % 3))
+			snprintf(path, sizeof(path), "bootloader/%s %d", dir_names[_rand() % 5], i);
+		else
+		{
+			// Nest in a previous folder if it is not too deep.
+			const char *parent = model[model_cnt - 1 - (_rand() % dirs)].path;
+			if (strlen(parent) > 150)
+				parent = "bootloader";
+			snprintf(path, sizeof(path), "%s/%s %d", parent, dir_names[_rand() % 5], i);
+		}
+		_model_add(path, 0, (_rand() % 4) ? 0 : AM_HID, true);
+		dirs++;
+	}
+
+	u32 dir_first = 3;
+	u32 dir_last = model_cnt;
+
+	// Many small files.
+	const u8 attrs[] = { 0, AM_ARC, AM_RDO, AM_HID, AM_SYS | AM_HID, AM_ARC | AM_RDO };
+	for (u32 i = 0; i < 1500; i++)
+	{
+		u32 size;
+		switch (_rand() % 20)
+		{
+		case 0:
+			size = 0;
+			break;
+		case 1:
+			size = SZ_512K + _rand() % (SZ_1M - SZ_512K + 1);
+			break;
+		default:
+			size = _rand() % SZ_16K;
+			break;
+		}
+
+		snprintf(path, sizeof(path), "%s/file_%04d.bin", model[dir_first + _rand() % (dir_last - dir_first)].path, i);
+		_model_add(path, size, attrs[_rand() % sizeof(attrs)], false);
+	}
+
+	// Files around and above the copy chunk size.
+	const u32 big_sizes[] = { SZ_1M, SZ_1M + 1, SZ_4M, SZ_4M + 513, SZ_8M + SZ_1M + 7, SZ_16M + 3 };
+	for (u32 i = 0; i < sizeof(big_sizes) / sizeof(u32); i++)
+	{
+		snprintf(path, sizeof(path), "%s/big_%d.bin", model[dir_first + _rand() % (dir_last - dir_first)].path, i);
+		_model_add(path, big_sizes[i], attrs[i % sizeof(attrs)], false);
+	}
+}
+
+static int _model_write(u32 drive)
+{
+	FIL fp;
+
+	f_chdrive(drives[drive]);
+	for (u32 i = 0; i < model_cnt; i++)
+	{
+		model_file_t *f = &model[i];
+
+		if (f->dir)
+		{
+			if (f_mkdir(f->path))
+				return 1;
+		}
+		else
+		{
+			UINT bw;
+			if (f_open(&fp, f->path, FA_CREATE_ALWAYS | FA_WRITE) || f_write(&fp, f->data, f->size, &bw) || bw != f->size)
+				return 1;
+			f_close(&fp);
+		}
+		f_chmod(f->path, f->attr, 0xFF);
+	}
+
+	return 0;
+}
+
+static int _model_check(u32 drive, bool copied)
+{
+	FIL fp;
+	FILINFO fno;
+	u8 *buf = malloc(SZ_16M + SZ_1M);
+
+	f_chdrive(drives[drive]);
+	for (u32 i = 0; i < model_cnt; i++)
+	{
+		model_file_t *f = &model[i];
+		bool expected = !copied || !f->skipped;
+
+		if (f_stat(f->path, &fno) != FR_OK)
+		{
+			if (!expected)
+				continue;
+
+			printf("FAIL %s: %s missing\n", drives[drive], f->path);
+			return 1;
+		}
+
+		if (!expected)
+		{
+			printf("FAIL %s: %s should have been skipped\n", drives[drive], f->path);
+			return 1;
+		}
+
+		if ((fno.fattrib & (AM_RDO | AM_HID | AM_SYS | AM_ARC)) != f->attr || !!(fno.fattrib & AM_DIR) != f->dir)
+		{
+			printf("FAIL %s: %s attributes %02X, expected %02X\n", drives[drive], f->path, fno.fattrib, f->attr);
+			return 1;
+		}
+
+		if (f->dir)
+			continue;
+
+		UINT br;
+		if (fno.fsize != f->size || f_open(&fp, f->path, FA_READ) || f_read(&fp, buf, f->size, &br) || br != f->size)
+		{
+			printf("FAIL %s: %s size %d, expected %d\n", drives[drive], f->path, (u32)fno.fsize, f->size);
+			return 1;
+		}
+		f_close(&fp);
+
+		if (memcmp(buf, f->data, f->size))
+		{
+			printf("FAIL %s: %s data mismatch\n", drives[drive], f->path);
+			return 1;
+		}
+	}
+
+	free(buf);
+
+	return 0;
+}
+
+// Old copy loop, without contiguous preallocation. Used to compare disk commands.
+static int _ref_copy(const char *src, const char *dst, char *path, u8 *buf)
+{
+	FRESULT res;
+	FIL fp_src;
+	FIL fp_dst;
+	DIR dir;
+	FILINFO fno;
+
+	f_chdrive(src);
+
+	res = f_opendir(&dir, path);
+	if (res != FR_OK)
+		return res;
+
+	u32 dirLength = strlen(path);
+
+	for (;;)
+	{
+		path[dirLength] = 0;
+
+		res = f_readdir(&dir, &fno);
+		if (res != FR_OK || fno.fname[0] == 0)
+			break;
+
+		memcpy(&path[dirLength], "/", 1);
+		strcpy(&path[dirLength + 1], fno.fname);
+
+		if (!(fno.fattrib & AM_DIR))
+		{
+			u32 file_size = fno.fsize;
+
+			f_chdrive(dst);
+			f_open(&fp_dst, path, FA_CREATE_ALWAYS | FA_WRITE);
+			f_lseek(&fp_dst, fno.fsize);
+			f_lseek(&fp_dst, 0);
+
+			f_chdrive(src);
+			f_open(&fp_src, path, FA_READ);
+
+			while (file_size)
+			{
+				u32 chunk_size = MIN(file_size, SZ_4M);
+				file_size -= chunk_size;
+
+				f_read(&fp_src, buf, chunk_size, NULL);
+				f_write(&fp_dst, buf, chunk_size, NULL);
+			}
+			f_close(&fp_src);
+
+			f_close(&fp_dst);
+			f_chdrive(dst);
+			f_chmod(path, fno.fattrib, 0xFF);
+
+			f_chdrive(src);
+		}
+		else
+		{
+			if (!memcmp("System Volume Information", fno.fname, 25))
+				continue;
+
+			f_chdrive(dst);
+			f_mkdir(path);
+			f_chmod(path, fno.fattrib, 0xFF);
+
+			res = _ref_copy(src, dst, path, buf);
+			if (res != FR_OK)
+				break;
+		}
+	}
+
+	f_closedir(&dir);
+
+	return res;
+}
+
+static double _now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void _stats_reset()
+{
+	for (u32 i = 0; i < DRIVE_NUM; i++)
+	{
+		disks[i].reads = 0;
+		disks[i].writes = 0;
+		disks[i].sectors = 0;
+	}
+}
+
+static void _stats_print(const char *name, double t, u32 files)
+{
+	printf("  %-8s %5d files/s, sd %5d rd %5d wr, ram %5d rd %5d wr\n", name, (u32)(files / t),
+		disks[DRIVE_SD].reads, disks[DRIVE_SD].writes, disks[DRIVE_RAM].reads, disks[DRIVE_RAM].writes);
+}
+
+// Copy with the old loop to a freshly formatted drive and print its disk commands.
+static int _ref_run(u32 src, u32 dst, u8 *buf, u32 files)
+{
+	char *path = malloc(PATH_SZ);
+
+	if (_format(dst))
+		return 1;
+
+	strcpy(path, "bootloader");
+	f_chdrive(drives[dst]);
+	f_mkdir("bootloader");
+
+	_stats_reset();
+	double t = _now();
+	_ref_copy(drives[src], drives[dst], path, buf);
+	t = _now() - t;
+	free(path);
+
+	if (_model_check(dst, true))
+		return 1;
+	_stats_print("old", t, files);
+
+	return 0;
+}
+
+// Copy like _backup_and_restore_files does for a partial backup.
+static int _copy(u32 src, u32 dst, u8 *buf, u32 *total_files, u32 *total_size)
+{
+	char *path = malloc(PATH_SZ);
+	lv_obj_t *labels[2] = { (lv_obj_t *)1, (lv_obj_t *)2 };
+
+	strcpy(path, "bootloader");
+	f_chdrive(drives[dst]);
+	f_mkdir("bootloader");
+
+	*total_files = 0;
+	*total_size = 0;
+
+	copy_files_init(drives[src], drives[dst], buf, labels[1]);
+	int res = copy_files_stat(drives[src], drives[dst], path, total_files, total_size, labels);
+	copy_files_end();
+
+	free(path);
+
+	return res;
+}
+
+// Errors must stop the copy and be returned, not skipped.
+static int _copy_errors(u8 *buf)
+{
+	u32 total_files, total_size;
+	char *path = malloc(PATH_SZ);
+	int res = 1;
+
+	// Destination disk fails in the middle of the copy.
+	if (_format(DRIVE_RAM))
+		goto out;
+	fail_writes_after = 2000;
+	int err = _copy(DRIVE_SD, DRIVE_RAM, buf, &total_files, &total_size);
+	fail_writes_after = -1;
+	if (!err)
+	{
+		printf("FAIL write error: copy returned success after %d files\n", total_files);
+		goto out;
+	}
+	printf("ok    write error stops the copy after %d files\n", total_files);
+
+	// Folders nested too deep are refused by size check and copy.
+	f_chdrive("sd:");
+	strcpy(path, "bootloader");
+	for (u32 i = 0; i < 70; i++)
+	{
+		strcat(path, "/d");
+		if (f_mkdir(path))
+			goto out;
+	}
+
+	strcpy(path, "bootloader");
+	total_files = 0;
+	total_size = 0;
+	if (copy_files_stat("sd:", NULL, path, &total_files, &total_size, NULL) != FR_DENIED)
+	{
+		printf("FAIL depth: size check did not stop at the depth limit\n");
+		goto out;
+	}
+	if (_format(DRIVE_RAM) || _copy(DRIVE_SD, DRIVE_RAM, buf, &total_files, &total_size) != FR_DENIED)
+	{
+		printf("FAIL depth: copy did not stop at the depth limit\n");
+		goto out;
+	}
+	printf("ok    folders nested deeper than the limit are refused\n");
+
+	res = 0;
+
+out:
+	free(path);
+
+	return res;
+}
+
+int main()
+{
+	u32 exp_files = 0, exp_size = 0;
+	u32 total_files, total_size;
+	u8 *buf = malloc(COPY_BUF_SZ);
+
+	_model_gen();
+	for (u32 i = 0; i < model_cnt; i++)
+	{
+		if (model[i].dir || model[i].skipped)
+			continue;
+
+		exp_files++;
+		exp_size += MAX(model[i].size, RAMDISK_CLUSTER_SZ);
+	}
+
+	if (_format(DRIVE_SD) || _format(DRIVE_RAM) || _model_write(DRIVE_SD) || _model_check(DRIVE_SD, false))
+	{
+		printf("FAIL: could not create source image\n");
+		return 1;
+	}
+
+	// Size check only.
+	char *path = malloc(PATH_SZ);
+	strcpy(path, "bootloader");
+	total_files = 0;
+	total_size = 0;
+	if (copy_files_stat("sd:", NULL, path, &total_files, &total_size, NULL) || total_files != exp_files || total_size != exp_size)
+	{
+		printf("FAIL stat: %d files %d bytes, expected %d files %d bytes\n", total_files, total_size, exp_files, exp_size);
+		return 1;
+	}
+	free(path);
+
+	// Backup to ram disk.
+	_stats_reset();
+	double t = _now();
+	if (_copy(DRIVE_SD, DRIVE_RAM, buf, &total_files, &total_size) || total_files != exp_files || total_size != exp_size)
+	{
+		printf("FAIL backup: %d files %d bytes\n", total_files, total_size);
+		return 1;
+	}
+	t = _now() - t;
+	if (disks[DRIVE_SD].writes)
+	{
+		printf("FAIL backup: %d writes to source\n", disks[DRIVE_SD].writes);
+		return 1;
+	}
+	if (_model_check(DRIVE_RAM, true))
+		return 1;
+	printf("ok    backup %d files, %d MB\n", total_files, total_size / SZ_1M);
+	_stats_print("new", t, total_files);
+
+	if (_ref_run(DRIVE_SD, DRIVE_RAM, buf, total_files))
+		return 1;
+
+	// Restore to a freshly formatted SD.
+	if (_format(DRIVE_SD))
+		return 1;
+	_stats_reset();
+	t = _now();
+	if (_copy(DRIVE_RAM, DRIVE_SD, buf, &total_files, &total_size) || total_files != exp_files)
+	{
+		printf("FAIL restore: %d files\n", total_files);
+		return 1;
+	}
+	t = _now() - t;
+	if (disks[DRIVE_RAM].writes)
+	{
+		printf("FAIL restore: %d writes to source\n", disks[DRIVE_RAM].writes);
+		return 1;
+	}
+	if (_model_check(DRIVE_SD, true))
+		return 1;
+	printf("ok    restore %d files\n", total_files);
+	_stats_print("new", t, total_files);
+
+	if (_ref_run(DRIVE_RAM, DRIVE_SD, buf, total_files))
+		return 1;
+
+	if (_copy_errors(buf))
+		return 1;
+
+	for (u32 i = 0; i < DRIVE_NUM; i++)
+		free(disks[i].img);
+	free(buf);
+
+	return 0;
+}
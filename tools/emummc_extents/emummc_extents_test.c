@@ -0,0 +1,343 @@
+/*
+ * Host test for file based emuMMC extents on a FAT32 image.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libs/fatfs/ff.h>
+#include <libs/fatfs/diskio.h>
+#include <emummc_extents.h>
+#include <storage/sd.h>
+
+#define IMG_SECTORS  (SZ_128M >> 9)
+#define CLUSTER_SZ   SZ_1K
+#define EXTENTS_MAX  2048
+
+static u8 *img;
+static u32 err_prints = 0;
+static u32 sd_xfers = 0;
+static FATFS fs;
+
+sdmmc_storage_t sd_storage;
+
+void gfx_printf(const char *fmt, ...)
+{
+	err_prints++;
+}
+
+void *ff_memalloc(UINT msize)
+{
+	return malloc(msize);
+}
+
+void ff_memfree(void *mblock)
+{
+	free(mblock);
+}
+
+DSTATUS disk_initialize(BYTE pdrv)
+{
+	return 0;
+}
+
+DSTATUS disk_status(BYTE pdrv)
+{
+	return 0;
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
+{
+	if (sector + count > IMG_SECTORS)
+		return RES_PARERR;
+
+	memcpy(buff, img + ((u64)sector << 9), count << 9);
+
+	return RES_OK;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
+{
+	if (sector + count > IMG_SECTORS)
+		return RES_PARERR;
+
+	memcpy(img + ((u64)sector << 9), buff, count << 9);
+
+	return RES_OK;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)
+{
+	switch (cmd)
+	{
+	case GET_SECTOR_COUNT:
+		*(DWORD *)buff = IMG_SECTORS;
+		break;
+	case GET_BLOCK_SIZE:
+		*(DWORD *)buff = 1;
+		break;
+	}
+
+	return RES_OK;
+}
+
+DRESULT disk_set_info(BYTE pdrv, BYTE cmd, void *buff)
+{
+	return RES_OK;
+}
+
+// Mapped emuMMC accesses go straight to the SD card, which is the same image.
+int sdmmc_storage_read(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf)
+{
+	sd_xfers++;
+
+	return disk_read(0, buf, sector, num_sectors) == RES_OK;
+}
+
+int sdmmc_storage_write(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf)
+{
+	sd_xfers++;
+
+	return disk_write(0, buf, sector, num_sectors) == RES_OK;
+}
+
+// Every sector is tagged with its file and emuMMC sector.
+static void _fill_sector(u8 *buf, u32 tag, u32 sector)
+{
+	for (u32 i = 0; i < 512; i += 8)
+	{
+		memcpy(buf + i, &tag, 4);
+		memcpy(buf + i + 4, &sector, 4);
+	}
+}
+
+/*
+ * Write files of sectors each. Clusters are allocated in order, so writing
+ * chunk clusters to every file in turn fragments them into runs of chunk clusters.
+ * A filler file is written between chunks too, so runs of different files never touch.
+ */
+static int _create_files(const char *dir, u32 files, u32 sectors, u32 chunk, u32 base_tag)
+{
+	FIL fp[16];
+	FIL filler;
+	char path[64];
+	u8 buf[512];
+
+	f_mkdir(dir);
+	for (u32 i = 0; i < files; i++)
+	{
+		sprintf(path, "%s/%02d", dir, i);
+		if (f_open(&fp[i], path, FA_WRITE | FA_CREATE_ALWAYS))
+			return 0;
+	}
+	sprintf(path, "%s/filler", dir);
+	if (f_open(&filler, path, FA_WRITE | FA_CREATE_ALWAYS))
+		return 0;
+
+	u32 chunk_sectors = chunk ? chunk * (CLUSTER_SZ >> 9) : sectors;
+	for (u32 done = 0; done < sectors; done += chunk_sectors)
+	{
+		for (u32 i = 0; i < files; i++)
+		{
+			for (u32 s = done; s < done + chunk_sectors && s < sectors; s++)
+			{
+				_fill_sector(buf, base_tag + i, s);
+				if (f_write(&fp[i], buf, 512, NULL))
+					return 0;
+			}
+
+			if (chunk)
+			{
+				memset(buf, 0xFF, sizeof(buf));
+				for (u32 s = 0; s < (CLUSTER_SZ >> 9); s++)
+					f_write(&filler, buf, 512, NULL);
+			}
+		}
+	}
+
+	for (u32 i = 0; i < files; i++)
+		f_close(&fp[i]);
+	f_close(&filler);
+
+	return 1;
+}
+
+// Build extents like emuMMC init does for the user partition. Returns extent count or 0.
+static u32 _build(const char *dir, u32 files, u32 file_sectors, emummc_extent_t *extents, u32 max_cnt)
+{
+	char path[64];
+	u32 cnt = 0;
+
+	for (u32 i = 0; i < files; i++)
+	{
+		sprintf(path, "%s/%02d", dir, i);
+		if (!emummc_extents_add_file(extents, &cnt, max_cnt, path, i * file_sectors))
+			return 0;
+	}
+
+	return cnt;
+}
+
+// Every emuMMC sector must map to the image sector that FatFs wrote it to.
+static int _verify(const emummc_extent_t *extents, u32 cnt, u32 files, u32 file_sectors, u32 base_tag)
+{
+	u8 expected[512];
+	u32 total = files * file_sectors;
+
+	for (u32 sector = 0; sector < total; sector++)
+	{
+		u32 i = emummc_extents_find(extents, cnt, sector);
+		if (sector < extents[i].sector || sector - extents[i].sector >= extents[i].num_sectors)
+		{
+			printf("  sector %d not mapped\n", sector);
+			return 0;
+		}
+
+		u32 sd_sector = extents[i].sd_sector + sector - extents[i].sector;
+		_fill_sector(expected, base_tag + sector / file_sectors, sector % file_sectors);
+		if (memcmp(img + ((u64)sd_sector << 9), expected, 512))
+		{
+			printf("  sector %d maps to wrong SD sector %d\n", sector, sd_sector);
+			return 0;
+		}
+	}
+
+	// Extents must be sorted and not overlap.
+	for (u32 i = 1; i < cnt; i++)
+	{
+		if (extents[i].sector != extents[i - 1].sector + extents[i - 1].num_sectors)
+		{
+			printf("  extent %d is not contiguous to previous\n", i);
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+// Random reads and writes through the extents, checked against the files as FatFs sees them.
+static int _verify_rw(const emummc_extent_t *extents, u32 cnt, const char *dir, u32 files, u32 file_sectors, u32 base_tag)
+{
+	u8 *buf = malloc(64 << 9);
+	u8 expected[512];
+	u32 total = files * file_sectors;
+	u32 seed = 1;
+	int ok = 1;
+
+	for (u32 j = 0; j < 500 && ok; j++)
+	{
+		seed = seed * 1103515245 + 12345;
+		u32 num = 1 + (seed >> 16) % 64;
+		u32 sector = (seed >> 4) % (total - num + 1);
+
+		ok &= emummc_extents_rw(extents, cnt, sector, num, buf, false);
+		for (u32 s = 0; s < num && ok; s++)
+		{
+			_fill_sector(expected, base_tag + (sector + s) / file_sectors, (sector + s) % file_sectors);
+			ok &= !memcmp(buf + (s << 9), expected, 512);
+		}
+	}
+	if (!ok)
+		printf("  read through extents returned wrong data\n");
+
+	// Write a range that spans extents and files, then read it back through FatFs.
+	u32 sector = file_sectors - 40;
+	for (u32 s = 0; s < 64; s++)
+		_fill_sector(buf + (s << 9), 0xFFFF, sector + s);
+	ok &= emummc_extents_rw(extents, cnt, sector, 64, buf, true);
+
+	for (u32 s = 0; s < 64 && ok; s++)
+	{
+		FIL fp;
+		char path[64];
+		u32 file_sector = (sector + s) % file_sectors;
+
+		sprintf(path, "%s/%02d", dir, (sector + s) / file_sectors);
+		ok &= !f_open(&fp, path, FA_READ) && !f_lseek(&fp, (u64)file_sector << 9) &&
+			!f_read(&fp, expected, 512, NULL) && !memcmp(expected, buf + (s << 9), 512);
+		f_close(&fp);
+	}
+	if (!ok)
+		printf("  write through extents did not land in the files\n");
+
+	// Past the end.
+	ok &= !emummc_extents_rw(extents, cnt, total - 8, 16, buf, false);
+
+	free(buf);
+
+	return ok;
+}
+
+static int _check(const char *name, int ok)
+{
+	printf("%s %s\n", ok ? "ok  " : "FAIL", name);
+
+	return !ok;
+}
+
+int main()
+{
+	emummc_extent_t *extents = malloc(EXTENTS_MAX * sizeof(emummc_extent_t));
+	u8 *work = malloc(SZ_64K);
+	int err = 0;
+	u32 cnt;
+
+	img = calloc(1, (u64)IMG_SECTORS << 9);
+	if (f_mkfs("", FM_FAT32, CLUSTER_SZ, work, SZ_64K) || f_mount(&fs, "", 1))
+	{
+		printf("FAIL cannot create FAT32 image\n");
+		return 1;
+	}
+
+	// Files written one after the other merge into a single extent.
+	_create_files("contig", 2, 2048, 0, 0x100);
+	cnt = _build("contig", 2, 2048, extents, EXTENTS_MAX);
+	err |= _check("contiguous files merge into one extent", cnt == 1 && _verify(extents, cnt, 2, 2048, 0x100));
+
+	// 4 files of 1MB in runs of 8 clusters.
+	_create_files("frag", 4, 2048, 8, 0x200);
+	cnt = _build("frag", 4, 2048, extents, EXTENTS_MAX);
+	err |= _check("fragmented files map every sector", cnt == 4 * 2048 / 16 && _verify(extents, cnt, 4, 2048, 0x200));
+
+	sd_xfers = 0;
+	err |= _check("fragmented files read and write", _verify_rw(extents, cnt, "frag", 4, 2048, 0x200) && sd_xfers);
+
+	// Extent array full. Must fail without writing past it.
+	cnt = _build("frag", 4, 2048, extents, 100);
+	err |= _check("extent limit is respected", !cnt);
+
+	// 2100 single cluster runs are more than the cluster table holds. Fallback must be silent.
+	_create_files("worst", 1, 4200, 1, 0x300);
+	err_prints = 0;
+	cnt = _build("worst", 1, 4200, extents, EXTENTS_MAX);
+	err |= _check("too fragmented file falls back silently", !cnt && !err_prints);
+
+	// 2047 runs is the most that fits.
+	_create_files("limit", 1, 4094, 1, 0x400);
+	err_prints = 0;
+	cnt = _build("limit", 1, 4094, extents, EXTENTS_MAX);
+	err |= _check("2047 runs still map", cnt == 2047 && !err_prints && _verify(extents, cnt, 1, 4094, 0x400));
+
+	// Missing file.
+	cnt = 0;
+	err |= _check("missing file fails", !emummc_extents_add_file(extents, &cnt, EXTENTS_MAX, "frag/99", 0));
+
+	free(img);
+	free(work);
+	free(extents);
+
+	return err;
+}
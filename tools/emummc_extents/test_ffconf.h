@@ -0,0 +1,9 @@
+/*
+ * Bootloader FatFs configuration, with mkfs enabled to create test images.
+ */
+
+#include "../../bootloader/libs/fatfs/ffconf.h"
+
+#undef FF_USE_MKFS
+#define FF_USE_MKFS   1
+#define FF_MKFS_LABEL "EMUMMC TEST"
@@ -0,0 +1,131 @@
+/*
+ * Host test and benchmark for the Nyx landscape framebuffer flush.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// bdk.h clashes with libc, so only import the flush from gfx.c.
+typedef uint32_t u32;
+void gfx_set_rect_land_pitch(u32 *fb, const u32 *buf, u32 stride, u32 pos_x, u32 pos_y, u32 pos_x2, u32 pos_y2);
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+#define FB_W      720  // Portrait framebuffer line (stride).
+#define FB_H      1280
+#define RECT_RUNS 2000
+
+static u32 fb_ref[FB_W * FB_H];
+static u32 fb_new[FB_W * FB_H];
+static u32 src[FB_W * FB_H];
+
+// Original flush. One pixel store per framebuffer line.
+static void _land_pitch_ref(u32 *fb, const u32 *buf, u32 stride, u32 pos_x, u32 pos_y, u32 pos_x2, u32 pos_y2)
+{
+	const u32 *ptr = buf;
+
+	for (u32 y = pos_y; y < (pos_y2 + 1); y++)
+		for (u32 x = pos_x; x < (pos_x2 + 1); x++)
+			fb[x * stride + y] = *ptr++;
+}
+
+static u32 _rand_range(u32 min, u32 max)
+{
+	return min + (u32)rand() % (max - min + 1);
+}
+
+static int _test()
+{
+	for (u32 i = 0; i < FB_W * FB_H; i++)
+		src[i] = (u32)rand();
+
+	for (u32 run = 0; run < RECT_RUNS; run++)
+	{
+		u32 x1 = _rand_range(0, FB_H - 1);
+		u32 y1 = _rand_range(0, FB_W - 1);
+		u32 x2 = _rand_range(x1, MIN(x1 + (run & 1 ? 63 : FB_H), FB_H - 1));
+		u32 y2 = _rand_range(y1, MIN(y1 + (run & 1 ? 63 : FB_W), FB_W - 1));
+
+		// Seed both framebuffers identically so out of rect stores are caught.
+		u32 seed = (u32)rand();
+		for (u32 i = 0; i < FB_W * FB_H; i++)
+			fb_ref[i] = fb_new[i] = seed ^ i;
+
+		_land_pitch_ref(fb_ref, src, FB_W, x1, y1, x2, y2);
+		gfx_set_rect_land_pitch(fb_new, src, FB_W, x1, y1, x2, y2);
+
+		if (memcmp(fb_ref, fb_new, sizeof(fb_ref)))
+		{
+			printf("FAIL: rect %u,%u - %u,%u\n", x1, y1, x2, y2);
+			return 1;
+		}
+	}
+
+	printf("OK: land pitch flush matches reference\n");
+
+	return 0;
+}
+
+static double _now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void _bench_rect(const char *name, u32 x1, u32 y1, u32 x2, u32 y2, u32 iters)
+{
+	double t0 = _now();
+	for (u32 i = 0; i < iters; i++)
+		_land_pitch_ref(fb_ref, src, FB_W, x1, y1, x2, y2);
+	double t_ref = _now() - t0;
+
+	t0 = _now();
+	for (u32 i = 0; i < iters; i++)
+		gfx_set_rect_land_pitch(fb_new, src, FB_W, x1, y1, x2, y2);
+	double t_new = _now() - t0;
+
+	double mpix = (double)(x2 - x1 + 1) * (y2 - y1 + 1) * iters / 1e6;
+	printf("%-12s ref %8.1f Mpix/s  banded %8.1f Mpix/s  (%.2fx)\n",
+		name, mpix / t_ref, mpix / t_new, t_ref / t_new);
+}
+
+static void _bench()
+{
+	for (u32 i = 0; i < FB_W * FB_H; i++)
+		src[i] = (u32)rand();
+
+	_bench_rect("full screen", 0, 0, FB_H - 1, FB_W - 1, 200);
+	_bench_rect("window", 160, 90, 1119, 629, 400);
+	_bench_rect("button", 301, 203, 540, 282, 20000);
+	_bench_rect("cursor", 500, 300, 511, 315, 500000);
+}
+
+int main(int argc, char **argv)
+{
+	srand(1);
+
+	if (argc > 1 && !strcmp(argv[1], "bench"))
+	{
+		_bench();
+		return 0;
+	}
+
+	return _test();
+}
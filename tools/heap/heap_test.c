@@ -0,0 +1,336 @@
+/*
+ * Host stress test and benchmark for the bdk heap and its slab front-end.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// malloc/calloc/free are the bdk allocator here. Don't include stdlib.h.
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <mem/arena.h>
+#include <mem/heap.h>
+
+#define HEAP_SZ     (SZ_512M)
+#define LIVE_MAX    8192
+#define BENCH_LIVE  2048
+#define BENCH_OPS   500000
+
+#ifdef BDK_MALLOC_NO_DEFRAG
+#define HEAP_NAME "bootloader"
+#define STRESS_OPS 300000 // Freed nodes are never reused.
+#else
+#define HEAP_NAME "nyx"
+#define STRESS_OPS 2000000
+#endif
+
+typedef struct _slot_t
+{
+	u8 *ptr;
+	u32 size;
+	u8 tag;
+} slot_t;
+
+static u8 heap_mem[HEAP_SZ] __attribute__((aligned(SZ_4K)));
+static slot_t slots[LIVE_MAX];
+static u32 rng = 0x12345678;
+
+void gfx_printf(const char *fmt, ...)
+{
+}
+
+static u32 _rand()
+{
+	// Xorshift32.
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+
+	return rng;
+}
+
+// Small objects like LVGL and ini nodes, with some medium and large buffers.
+static u32 _rand_size(u32 medium_pct, u32 large_pct)
+{
+	u32 pick = _rand() % 100;
+
+	if (pick < large_pct)
+		return 4097 + _rand() % (SZ_64K - 4096);
+	if (pick < large_pct + medium_pct)
+		return 513 + _rand() % (4096 - 512);
+
+	return 1 + _rand() % HEAP_SLAB_MAX_SZ;
+}
+
+static int _check_ptr(const u8 *ptr, u32 size)
+{
+	if (!ptr || ((uintptr_t)ptr & 31))
+		return 0;
+
+	return ptr >= heap_mem && (ptr + size) <= (heap_mem + HEAP_SZ);
+}
+
+static int _check_fill(const slot_t *slot)
+{
+	for (u32 i = 0; i < slot->size; i++)
+		if (slot->ptr[i] != slot->tag)
+			return 0;
+
+	return 1;
+}
+
+static u32 _slab_used()
+{
+	heap_monitor_t mon;
+	u32 used = 0;
+
+	heap_monitor(&mon, false);
+	for (u32 i = 0; i < HEAP_SLAB_CLASSES; i++)
+		used += mon.slab[i].used;
+
+	return used;
+}
+
+static int _stress()
+{
+	u32 large_pct = 10;
+	u32 live_small = 0;
+	u8 tag = 0;
+
+#ifdef BDK_MALLOC_NO_DEFRAG
+	large_pct = 1;
+#endif
+
+	for (u32 op = 0; op < STRESS_OPS; op++)
+	{
+		slot_t *slot = &slots[_rand() % LIVE_MAX];
+
+		if (slot->ptr)
+		{
+			if (!_check_fill(slot))
+			{
+				printf("FAIL op %d: object of %d bytes was overwritten\n", op, slot->size);
+				return 0;
+			}
+
+			if (slot->size <= HEAP_SLAB_MAX_SZ)
+				live_small--;
+
+			free(slot->ptr);
+			slot->ptr = NULL;
+
+			continue;
+		}
+
+		slot->size = _rand_size(20, large_pct);
+		slot->tag = ++tag;
+
+		// calloc must clear the whole object, even if it reuses a dirty slot.
+		if (op & 1)
+		{
+			slot->ptr = calloc(1, slot->size);
+			for (u32 i = 0; slot->ptr && i < slot->size; i++)
+			{
+				if (slot->ptr[i])
+				{
+					printf("FAIL op %d: calloc of %d bytes not cleared\n", op, slot->size);
+					return 0;
+				}
+			}
+		}
+		else
+			slot->ptr = malloc(slot->size);
+
+		if (!_check_ptr(slot->ptr, slot->size))
+		{
+			printf("FAIL op %d: bad pointer %p for %d bytes\n", op, slot->ptr, slot->size);
+			return 0;
+		}
+
+		memset(slot->ptr, slot->tag, slot->size);
+
+		if (slot->size <= HEAP_SLAB_MAX_SZ)
+			live_small++;
+
+		if (!(op % 100000) && _slab_used() != live_small)
+		{
+			printf("FAIL op %d: slab used %d, live small objects %d\n", op, _slab_used(), live_small);
+			return 0;
+		}
+	}
+
+	for (u32 i = 0; i < LIVE_MAX; i++)
+	{
+		if (slots[i].ptr && !_check_fill(&slots[i]))
+		{
+			printf("FAIL final check: object of %d bytes was overwritten\n", slots[i].size);
+			return 0;
+		}
+
+		free(slots[i].ptr);
+		slots[i].ptr = NULL;
+	}
+
+	if (_slab_used())
+	{
+		printf("FAIL slab objects still used after freeing all\n");
+		return 0;
+	}
+
+	printf("  %-22s OK\n", "random stress");
+
+	return 1;
+}
+
+// Fill all slab chunks, so small allocations overflow to the node allocator.
+static int _exhaust()
+{
+	const u32 objs_max = HEAP_SLAB_CHUNKS_MAX * (HEAP_SLAB_CHUNK_SZ / 32) + 50000;
+	static u8 *objs[HEAP_SLAB_CHUNKS_MAX * (HEAP_SLAB_CHUNK_SZ / 32) + 50000];
+
+	for (u32 i = 0; i < objs_max; i++)
+	{
+		objs[i] = malloc(32);
+		if (!_check_ptr(objs[i], 32))
+		{
+			printf("FAIL exhaust: bad pointer at object %d\n", i);
+			return 0;
+		}
+		memset(objs[i], (u8)i, 32);
+	}
+
+	heap_monitor_t mon;
+	heap_monitor(&mon, false);
+	if (mon.slab_chunks != HEAP_SLAB_CHUNKS_MAX || mon.slab[0].used != mon.slab[0].total)
+	{
+		printf("FAIL exhaust: %d chunks, %d/%d used\n", mon.slab_chunks, mon.slab[0].used, mon.slab[0].total);
+		return 0;
+	}
+
+	for (u32 i = 0; i < objs_max; i++)
+	{
+		for (u32 j = 0; j < 32; j++)
+		{
+			if (objs[i][j] != (u8)i)
+			{
+				printf("FAIL exhaust: object %d was overwritten\n", i);
+				return 0;
+			}
+		}
+		free(objs[i]);
+	}
+
+	if (_slab_used())
+	{
+		printf("FAIL exhaust: slab objects still used\n");
+		return 0;
+	}
+
+	printf("  %-22s OK\n", "slab exhaustion");
+
+	return 1;
+}
+
+// Arena blocks are reused on reset and given back to the heap on free.
+static int _arena()
+{
+	arena_t arena;
+	heap_monitor_t mon;
+
+	heap_monitor(&mon, false);
+	u32 used = mon.used;
+
+	arena_init(&arena, SZ_64K);
+
+	u8 *a = arena_alloc(&arena, 100);
+	u8 *b = arena_alloc(&arena, SZ_64K); // Spills to a new block.
+	u8 *c = arena_alloc(&arena, 200);
+	int ok = !((uintptr_t)a & (ARENA_ALIGN - 1)) && !((uintptr_t)b & (ARENA_ALIGN - 1)) && arena.used == 128 + SZ_64K + 224;
+
+	arena_reset(&arena);
+	ok = ok && arena_alloc(&arena, 100) == a && arena_alloc(&arena, SZ_64K) == b && arena_alloc(&arena, 200) == c;
+
+	arena_free(&arena);
+	heap_monitor(&mon, false);
+	ok = ok && mon.used == used;
+
+	printf("  %-22s %s\n", "arena reuse and free", ok ? "OK" : "FAIL");
+
+	return ok;
+}
+
+static double _now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Keep a live set and replace a random object on every op. Reports ns per free + malloc.
+static void _bench_churn(const char *name, u32 medium_pct)
+{
+	for (u32 i = 0; i < BENCH_LIVE; i++)
+	{
+		slots[i].size = _rand_size(medium_pct, 0);
+		slots[i].ptr = malloc(slots[i].size);
+	}
+
+	double t0 = _now();
+	for (u32 op = 0; op < BENCH_OPS; op++)
+	{
+		slot_t *slot = &slots[_rand() % BENCH_LIVE];
+
+		free(slot->ptr);
+		slot->size = _rand_size(medium_pct, 0);
+		slot->ptr = malloc(slot->size);
+		slot->ptr[0] = 0;
+	}
+	double t = _now() - t0;
+
+	for (u32 i = 0; i < BENCH_LIVE; i++)
+	{
+		free(slots[i].ptr);
+		slots[i].ptr = NULL;
+	}
+
+	heap_monitor_t mon;
+	heap_monitor(&mon, false);
+
+	printf("  %-22s %8.1f ns/op, %d nodes\n", name, t * 1e9 / BENCH_OPS, mon.nodes_total);
+}
+
+int main(int argc, char **argv)
+{
+	bool bench = argc > 1 && !strcmp(argv[1], "bench");
+
+	printf("%s heap, %s:\n", HEAP_NAME, HEAP_SLAB_CHUNKS_MAX ? "slab" : "no slab");
+
+	heap_init(heap_mem);
+
+	if (bench)
+	{
+		_bench_churn("small objects", 0);
+		_bench_churn("20% medium objects", 20);
+
+		return 0;
+	}
+
+	int ok = _stress() && _exhaust() && _arena();
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+
+	return !ok;
+}
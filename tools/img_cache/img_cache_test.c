@@ -0,0 +1,353 @@
+/*
+ * Host test for the Nyx pre-decoded image cache on a FAT image.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libs/fatfs/ff.h>
+#include <libs/fatfs/diskio.h>
+
+#include "../../nyx/nyx_gui/frontend/gui_img_cache.h"
+
+#define IMG_SECTORS (SZ_64M >> 9)
+#define ICON_SZ     200
+
+static u8 *img;
+static FATFS fs;
+static DWORD fattime = ((2022 - 1980) << 25) | (1 << 21) | (1 << 16);
+
+void gfx_printf(const char *fmt, ...)
+{
+}
+
+void *ff_memalloc(UINT msize)
+{
+	return malloc(msize);
+}
+
+void ff_memfree(void *mblock)
+{
+	free(mblock);
+}
+
+DWORD get_fattime()
+{
+	return fattime;
+}
+
+DSTATUS disk_initialize(BYTE pdrv)
+{
+	return 0;
+}
+
+DSTATUS disk_status(BYTE pdrv)
+{
+	return 0;
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
+{
+	if (pdrv || sector + count > IMG_SECTORS)
+		return RES_PARERR;
+
+	memcpy(buff, img + ((u64)sector << 9), count << 9);
+
+	return RES_OK;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
+{
+	if (pdrv || sector + count > IMG_SECTORS)
+		return RES_PARERR;
+
+	memcpy(img + ((u64)sector << 9), buff, count << 9);
+
+	return RES_OK;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)
+{
+	switch (cmd)
+	{
+	case GET_SECTOR_COUNT:
+		*(DWORD *)buff = IMG_SECTORS;
+		break;
+	case GET_BLOCK_SIZE:
+		*(DWORD *)buff = 1;
+		break;
+	}
+
+	return RES_OK;
+}
+
+DRESULT disk_set_info(BYTE pdrv, BYTE cmd, void *buff)
+{
+	return RES_OK;
+}
+
+// Same as the SD helpers, minus the mount check.
+void *sd_file_read(const char *path, u32 *fsize)
+{
+	FIL fp;
+	if (f_open(&fp, path, FA_READ) != FR_OK)
+		return NULL;
+
+	u32 size = f_size(&fp);
+	if (fsize)
+		*fsize = size;
+
+	void *buf = malloc(size);
+	if (f_read(&fp, buf, size, NULL) != FR_OK)
+	{
+		free(buf);
+		f_close(&fp);
+
+		return NULL;
+	}
+
+	f_close(&fp);
+
+	return buf;
+}
+
+int sd_save_to_file(void *buf, u32 size, const char *filename)
+{
+	FIL fp;
+	u32 res = f_open(&fp, filename, FA_CREATE_ALWAYS | FA_WRITE);
+	if (res)
+		return res;
+
+	f_write(&fp, buf, size, NULL);
+	f_close(&fp);
+
+	return 0;
+}
+
+static int _write_file(const char *path, const void *buf, u32 size)
+{
+	FIL fp;
+	UINT bw = 0;
+
+	if (f_open(&fp, path, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+		return 0;
+	f_write(&fp, buf, size, &bw);
+	f_close(&fp);
+
+	return bw == size;
+}
+
+// Stand-in for a BMP. Only its size and timestamp are checked by the cache.
+static int _write_bmp(const char *path, u32 size, FILINFO *fno)
+{
+	u8 *buf = calloc(1, size);
+	int res = _write_file(path, buf, size) && f_stat(path, fno) == FR_OK;
+	free(buf);
+
+	return res;
+}
+
+// Round icon with flat color bands, laid out like a decoded 32-bit BMP with alpha.
+static lv_img_dsc_t *_icon_new(u32 seed)
+{
+	u32 data_size = ICON_SZ * ICON_SZ * 4;
+	lv_img_dsc_t *img_desc = malloc(sizeof(lv_img_dsc_t) + data_size);
+	u8 *data = (u8 *)img_desc + sizeof(lv_img_dsc_t);
+
+	for (u32 y = 0; y < ICON_SZ; y++)
+	{
+		for (u32 x = 0; x < ICON_SZ; x++)
+		{
+			int d = (x - 100) * (x - 100) + (y - 100) * (y - 100);
+			u8 *px = &data[(y * ICON_SZ + x) * 4];
+
+			if (d >= 100 * 100)
+			{
+				memset(px, 0, 4);
+				continue;
+			}
+
+			px[0] = (x / 16) * 16 + seed;
+			px[1] = (y / 16) * 16;
+			px[2] = 0xC0;
+			px[3] = d < 90 * 90 ? 0xFF : (100 * 100 - d) * 255 / (100 * 100 - 90 * 90);
+		}
+	}
+
+	memset(&img_desc->header, 0, sizeof(lv_img_header_t));
+	img_desc->header.cf = LV_IMG_CF_TRUE_COLOR_ALPHA;
+	img_desc->header.w = ICON_SZ;
+	img_desc->header.h = ICON_SZ;
+	img_desc->data_size = data_size;
+	img_desc->data = data;
+
+	return img_desc;
+}
+
+static int _img_equal(const lv_img_dsc_t *a, const lv_img_dsc_t *b)
+{
+	return a && b &&
+		!memcmp(&a->header, &b->header, sizeof(lv_img_header_t)) &&
+		a->data_size == b->data_size &&
+		!((uptr)a->data & 0xF) &&
+		!memcmp(a->data, b->data, a->data_size);
+}
+
+// Finds the only cache file.
+static int _cache_file(char *path, FILINFO *fno)
+{
+	DIR dir;
+	int cnt = 0;
+
+	if (f_opendir(&dir, IMG_CACHE_DIR) != FR_OK)
+		return 0;
+
+	while (f_readdir(&dir, fno) == FR_OK && fno->fname[0])
+	{
+		sprintf(path, IMG_CACHE_DIR"/%s", fno->fname);
+		cnt++;
+	}
+	f_closedir(&dir);
+
+	return cnt == 1;
+}
+
+static void _cache_clear()
+{
+	char path[64];
+	FILINFO fno;
+
+	while (_cache_file(path, &fno))
+		f_unlink(path);
+}
+
+// Loads the cache and frees the image. Returns if the cache was used.
+static int _hit(const char *path, const FILINFO *fno, const lv_img_dsc_t *expected)
+{
+	lv_img_dsc_t *cached = img_cache_load(path, fno);
+	int res = cached != NULL;
+
+	if (cached && expected && !_img_equal(cached, expected))
+		res = -1;
+	free(cached);
+
+	return res;
+}
+
+static int _check(const char *name, int ok)
+{
+	printf("  %-34s %s\n", name, ok ? "OK" : "FAIL");
+
+	return !ok;
+}
+
+int main()
+{
+	const char *bmp = "bootloader/res/icon_switch.bmp";
+	char cache_path[64];
+	FILINFO fno, cache_fno;
+	u8 *work = malloc(SZ_64K);
+	int err = 0;
+
+	img = calloc(1, (u64)IMG_SECTORS << 9);
+	if (f_mkfs("sd:", FM_FAT32, 512, work, SZ_64K) || f_mount(&fs, "sd:", 1) ||
+		f_mkdir("bootloader") || f_mkdir("bootloader/res") || !_write_bmp(bmp, 160138, &fno))
+	{
+		printf("FAIL: cannot create FAT32 image\n");
+		return 1;
+	}
+	free(work);
+
+	lv_img_dsc_t *icon = _icon_new(0);
+
+	err |= _check("first load misses", _hit(bmp, &fno, NULL) == 0);
+
+	// Saved payload must come back as is, aligned and smaller than the decoded image.
+	img_cache_save(bmp, &fno, icon);
+	err |= _check("cached image matches", _hit(bmp, &fno, icon) == 1);
+	err |= _check("cache is compressed", _cache_file(cache_path, &cache_fno) && cache_fno.fsize < icon->data_size / 2);
+
+	// Overwriting the BMP with a new size or timestamp must skip the cache.
+	FILINFO old_fno = fno;
+	fattime += 1 << 5;
+	_write_bmp(bmp, 160138, &fno);
+	err |= _check("new timestamp misses", fno.ftime != old_fno.ftime && _hit(bmp, &fno, NULL) == 0);
+	_write_bmp(bmp, 160142, &fno);
+	err |= _check("new size misses", _hit(bmp, &fno, NULL) == 0);
+
+	// Saving again replaces the stale entry.
+	lv_img_dsc_t *icon2 = _icon_new(7);
+	img_cache_save(bmp, &fno, icon2);
+	err |= _check("stale entry is replaced", _hit(bmp, &fno, icon2) == 1 && _cache_file(cache_path, &cache_fno));
+
+	// An entry of another BMP under this name, as on a hash collision, must not be used.
+	const char *other = "bootloader/res/icon_payload.bmp";
+	char other_cache_path[64];
+	FILINFO other_fno;
+	_write_bmp(other, 160142, &other_fno);
+	_cache_clear();
+	img_cache_save(other, &other_fno, icon);
+	_cache_file(other_cache_path, &cache_fno);
+	f_rename(other_cache_path, cache_path);
+	err |= _check("entry of other path is ignored", _hit(other, &other_fno, NULL) == 0 && _hit(bmp, &fno, NULL) == 0);
+
+	// Damaged files fall back to decoding.
+	_cache_clear();
+	img_cache_save(bmp, &fno, icon2);
+	_cache_file(cache_path, &cache_fno);
+	u32 size;
+	u8 *cache = sd_file_read(cache_path, &size);
+
+	_write_file(cache_path, cache, size - 1);
+	err |= _check("truncated entry is ignored", _hit(bmp, &fno, NULL) == 0);
+
+	_write_file(cache_path, cache, 16);
+	err |= _check("header only entry is ignored", _hit(bmp, &fno, NULL) == 0);
+
+	u8 *bad = malloc(size);
+	memcpy(bad, cache, size);
+	memset(bad + size / 2, 0xFF, size - size / 2);
+	_write_file(cache_path, bad, size);
+	err |= _check("corrupt payload is ignored", _hit(bmp, &fno, NULL) == 0);
+
+	memcpy(bad, cache, size);
+	bad[0] ^= 1;
+	_write_file(cache_path, bad, size);
+	err |= _check("bad magic is ignored", _hit(bmp, &fno, NULL) == 0);
+
+	_write_file(cache_path, cache, size);
+	err |= _check("restored entry is used", _hit(bmp, &fno, icon2) == 1);
+	free(bad);
+	free(cache);
+
+	// Paths that do not fit in the header are never cached.
+	_cache_clear();
+	const char *long_bmp = "bootloader/res/a_very_long_directory_name_for_icons/and_an_even_longer_file_name_for_the_launch_entry_icon.bmp";
+	FILINFO long_fno;
+	f_mkdir("bootloader/res/a_very_long_directory_name_for_icons");
+	_write_bmp(long_bmp, 160138, &long_fno);
+	img_cache_save(long_bmp, &long_fno, icon);
+	err |= _check("long path is not cached", strlen(long_bmp) >= 104 && !_cache_file(cache_path, &cache_fno) &&
+		_hit(long_bmp, &long_fno, NULL) == 0);
+
+	free(icon);
+	free(icon2);
+	free(img);
+
+	printf("%s\n", err ? "FAIL" : "PASS");
+
+	return err;
+}
@@ -0,0 +1,516 @@
+/*
+ * Host test for compiled ini snapshots on a FAT image.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libs/fatfs/ff.h>
+#include <libs/fatfs/diskio.h>
+#include <utils/ini.h>
+
+#define IMG_SECTORS  (SZ_32M >> 9)
+#define DUMP_SZ      SZ_64K
+#define FUZZ_RUNS    20000
+
+#define INI_PATH     "bootloader/hekate_ipl.ini"
+#define INI_DIR      "bootloader/ini"
+
+// Mirrors ini.c.
+typedef struct _ini_snap_hdr_t
+{
+	u32 magic;
+	u32 version;
+	u32 src_sig;
+	u32 size;
+	u32 sec_cnt;
+	u32 kv_cnt;
+	u32 hash_mask;
+	u32 kv_off;
+	u32 hash_off;
+	u32 str_off;
+} ini_snap_hdr_t;
+
+static const char *ini_main =
+	"[config]\n"
+	"autoboot=0\n"
+	"autoboot_list=0\n"
+	"bootwait=3\n"
+	"\n"
+	"{-- Custom Firmwares --}\n"
+	"[CFW - sysMMC]\n"
+	"fss0=atmosphere/package3\n"
+	"kip1patch=nosigchk\n"
+	"emummc_force_disable=1\n"
+	"icon=bootloader/res/icon_payload.bmp\n"
+	"\n"
+	"[CFW - emuMMC]\n"
+	"fss0=atmosphere/package3\n"
+	"kip1patch=nosigchk\n"
+	"emummcforce=1\n"
+	"#Comment line\n"
+	"\n"
+	"[Stock]\n"
+	"fss0=atmosphere/package3\n"
+	"stock=1\n"
+	"{}\n"
+	"[Payload]\n"
+	"payload=bootloader/payloads/fusee.bin\n";
+
+static const char *ini_extra[] = {
+	"[Linux]\n"
+	"l4t=1\n"
+	"boot_prefixes=switchroot/ubuntu/\n",
+	"[Android]\n"
+	"l4t=1\n"
+	"boot_prefixes=switchroot/android/\n"
+	"id=SWANDR\n"
+};
+
+static u8 *img;
+static FATFS fs;
+
+void gfx_printf(const char *fmt, ...)
+{
+}
+
+void *ff_memalloc(UINT msize)
+{
+	return malloc(msize);
+}
+
+void ff_memfree(void *mblock)
+{
+	free(mblock);
+}
+
+DWORD get_fattime()
+{
+	// 2022-01-01 12:00:00. Constant, same as the bootloader without RTC.
+	return ((2022 - 1980) << 25) | (1 << 21) | (1 << 16) | (12 << 11);
+}
+
+DSTATUS disk_initialize(BYTE pdrv)
+{
+	return 0;
+}
+
+DSTATUS disk_status(BYTE pdrv)
+{
+	return 0;
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
+{
+	if (sector + count > IMG_SECTORS)
+		return RES_PARERR;
+
+	memcpy(buff, img + ((u64)sector << 9), count << 9);
+
+	return RES_OK;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
+{
+	if (sector + count > IMG_SECTORS)
+		return RES_PARERR;
+
+	memcpy(img + ((u64)sector << 9), buff, count << 9);
+
+	return RES_OK;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)
+{
+	switch (cmd)
+	{
+	case GET_SECTOR_COUNT:
+		*(DWORD *)buff = IMG_SECTORS;
+		break;
+	case GET_BLOCK_SIZE:
+		*(DWORD *)buff = 1;
+		break;
+	}
+
+	return RES_OK;
+}
+
+DRESULT disk_set_info(BYTE pdrv, BYTE cmd, void *buff)
+{
+	return RES_OK;
+}
+
+char *strcpy_ns(char *dst, char *src)
+{
+	if (!src || !dst)
+		return NULL;
+
+	// Remove starting space.
+	u32 len = strlen(src);
+	if (len && src[0] == ' ')
+	{
+		len--;
+		src++;
+	}
+
+	strcpy(dst, src);
+
+	return dst;
+}
+
+static int _write_file(const char *path, const void *buf, u32 size)
+{
+	FIL fp;
+
+	if (f_open(&fp, path, FA_WRITE | FA_CREATE_ALWAYS))
+		return 0;
+
+	UINT bw;
+	int res = f_write(&fp, buf, size, &bw);
+	f_close(&fp);
+
+	return !res && bw == size;
+}
+
+static u8 *_read_file(const char *path, u32 *size)
+{
+	FIL fp;
+
+	if (f_open(&fp, path, FA_READ))
+		return NULL;
+
+	*size = f_size(&fp);
+	u8 *buf = malloc(*size + 1);
+	f_read(&fp, buf, *size, NULL);
+	f_close(&fp);
+
+	return buf;
+}
+
+// Serialize a parsed ini and touch every string and lookup, so ASan sees bad pointers.
+static void _dump(link_t *list, char *out)
+{
+	u32 idx = 0;
+
+	out[0] = 0;
+	LIST_FOREACH_ENTRY(ini_sec_t, sec, list, link)
+	{
+		u32 len = strlen(out);
+		snprintf(out + len, DUMP_SZ - len, "%d:%08X:[%s]\n", sec->type, sec->color, sec->name ? sec->name : "");
+
+		if (ini_get_section(list, idx) != sec)
+			strcat(out, "!idx\n");
+		if (sec->name && sec->type == INI_CHOICE && !ini_find_section(list, sec->name))
+			strcat(out, "!find\n");
+
+		LIST_FOREACH_ENTRY(ini_kv_t, kv, &sec->kvs, link)
+		{
+			len = strlen(out);
+			snprintf(out + len, DUMP_SZ - len, "%s=%s\n", kv->key, kv->val);
+		}
+
+		idx++;
+	}
+
+	ini_find_section(list, "missing section");
+}
+
+static int _parse_dump(char *ini_path, bool is_dir, char *out)
+{
+	LIST_INIT(ini_sections);
+
+	if (!ini_parse(&ini_sections, ini_path, is_dir))
+		return 0;
+
+	_dump(&ini_sections, out);
+	ini_free(&ini_sections);
+
+	return 1;
+}
+
+static void _snap_path(char *path, const char *ini_path)
+{
+	DIR dir;
+	FILINFO fno;
+
+	// Only one snapshot per test, so just find it.
+	ini_invalidate(ini_path);
+	path[0] = 0;
+	if (!f_findfirst(&dir, &fno, INI_CACHE_DIR, "*.bin") && fno.fname[0])
+		sprintf(path, "%s/%s", INI_CACHE_DIR, fno.fname);
+	f_closedir(&dir);
+}
+
+// Targeted corruptions. Each one must be rejected and the ini parsed as text.
+static int _test_reject(char *ini_path, bool is_dir, const char *ref, const u8 *snap, u32 snap_size, const char *snap_path)
+{
+	char *out = malloc(DUMP_SZ);
+	u8 *bad = malloc(snap_size + 16);
+	ini_snap_hdr_t *hdr = (ini_snap_hdr_t *)bad;
+	ini_sec_t *secs = (ini_sec_t *)(hdr + 1);
+	ini_kv_t *kvs;
+	u16 *hash;
+	int failed = 0;
+
+	for (u32 c = 0; c < 15; c++)
+	{
+		u32 size = snap_size;
+
+		memcpy(bad, snap, snap_size);
+		kvs  = (ini_kv_t *)(bad + hdr->kv_off);
+		hash = (u16 *)(bad + hdr->hash_off);
+
+		const char *name;
+		switch (c)
+		{
+		case 0:
+			name = "size mismatch";
+			size = snap_size - 4;
+			break;
+		case 1:
+			name = "kv count overflow";
+			hdr->kv_cnt = 0x40000000;
+			break;
+		case 2:
+			name = "section count overflow";
+			hdr->sec_cnt = 0x10000000;
+			break;
+		case 3:
+			name = "hash mask not pow2";
+			hdr->hash_mask--;
+			break;
+		case 4:
+			name = "section name out of bounds";
+			secs[0].name = (char *)(size_t)(snap_size + 4);
+			break;
+		case 5:
+			name = "section name in header";
+			secs[0].name = (char *)(size_t)4;
+			break;
+		case 6:
+			name = "key out of bounds";
+			kvs[0].key = (char *)(size_t)0xFFFFFFF0;
+			break;
+		case 7:
+			name = "value out of bounds";
+			kvs[hdr->kv_cnt - 1].val = (char *)(size_t)snap_size;
+			break;
+		case 8:
+			name = "kv range out of bounds";
+			secs[hdr->sec_cnt - 1].kvs.next = (link_t *)(size_t)0xFFFFFFFF;
+			break;
+		case 9:
+			name = "kv ranges overlap";
+			secs[1].kvs.prev = (link_t *)(size_t)0;
+			break;
+		case 10:
+			name = "string table not terminated";
+			bad[snap_size - 1] = 'x';
+			break;
+		case 11:
+			name = "hash index out of bounds";
+			for (u32 i = 0; i <= hdr->hash_mask; i++)
+				if (hash[i])
+					hash[i] = hdr->sec_cnt + 1;
+			break;
+		case 12:
+			name = "hash table full";
+			for (u32 i = 0; i <= hdr->hash_mask; i++)
+				hash[i] = 1;
+			break;
+		case 14:
+			name = "string table cut";
+			size = hdr->str_off;
+			hdr->size = size;
+			break;
+		case 13:
+			name = "hash to unnamed section";
+			for (u32 i = 0; i < hdr->sec_cnt; i++)
+			{
+				if (!secs[i].name)
+				{
+					for (u32 j = 0; j <= hdr->hash_mask; j++)
+						if (hash[j])
+							hash[j] = i + 1;
+					break;
+				}
+			}
+			break;
+		}
+
+		_write_file(snap_path, bad, size);
+
+		u32 new_size;
+		int parsed = _parse_dump(ini_path, is_dir, out);
+		u8 *now = _read_file(snap_path, &new_size);
+		int ok = parsed && !strcmp(out, ref) && new_size == snap_size && !memcmp(now, snap, snap_size);
+		free(now);
+
+		printf("  %-28s %s\n", name, ok ? "OK" : "FAIL");
+		failed |= !ok;
+	}
+
+	free(bad);
+	free(out);
+
+	return !failed;
+}
+
+// Random corruptions. Either the snapshot is rejected and rebuilt, or it is accepted without bad accesses.
+static int _test_fuzz(char *ini_path, bool is_dir, const char *ref, const u8 *snap, u32 snap_size, const char *snap_path)
+{
+	char *out = malloc(DUMP_SZ);
+	u8 *bad = malloc(snap_size + 64);
+	u32 rejected = 0;
+	u32 accepted = 0;
+
+	for (u32 run = 0; run < FUZZ_RUNS; run++)
+	{
+		u32 size = snap_size;
+		memcpy(bad, snap, snap_size);
+
+		u32 flips = 1 + rand() % 4;
+		for (u32 i = 0; i < flips; i++)
+		{
+			u32 pos = rand() % snap_size;
+			switch (rand() % 4)
+			{
+			case 0:
+				bad[pos] ^= 1 << (rand() % 8);
+				break;
+			case 1:
+				bad[pos] = rand();
+				break;
+			case 2:
+				// Mostly header and table fields.
+				pos = (rand() % (snap_size / 4)) & ~3;
+				pos %= 256;
+				*(u32 *)(bad + pos) = rand() % (snap_size * 2);
+				break;
+			case 3:
+				size = sizeof(ini_snap_hdr_t) + rand() % (snap_size - sizeof(ini_snap_hdr_t) + 32);
+				if (size > snap_size)
+					memset(bad + snap_size, rand(), size - snap_size);
+				((ini_snap_hdr_t *)bad)->size = size;
+				break;
+			}
+		}
+
+		if (size == snap_size && !memcmp(bad, snap, snap_size))
+			continue;
+
+		_write_file(snap_path, bad, size);
+
+		u32 new_size;
+		if (!_parse_dump(ini_path, is_dir, out))
+		{
+			printf("  run %d: parse failed\n", run);
+			return 0;
+		}
+
+		u8 *now = _read_file(snap_path, &new_size);
+		if (new_size == snap_size && !memcmp(now, snap, snap_size))
+		{
+			rejected++;
+			if (strcmp(out, ref))
+			{
+				printf("  run %d: fallback differs from text parse\n", run);
+				free(now);
+				return 0;
+			}
+		}
+		else
+			accepted++;
+		free(now);
+	}
+
+	printf("  %d corrupted snapshots: %d rejected, %d accepted\n", rejected + accepted, rejected, accepted);
+
+	free(bad);
+	free(out);
+
+	return 1;
+}
+
+static int _test_source(const char *name, char *ini_path, bool is_dir)
+{
+	char snap_path[64];
+	char *ref = malloc(DUMP_SZ);
+	char *out = malloc(DUMP_SZ);
+	int res = 0;
+
+	printf("%s:\n", name);
+
+	// First parse compiles the snapshot, second one loads it.
+	_snap_path(snap_path, ini_path);
+	if (!_parse_dump(ini_path, is_dir, ref))
+		goto out;
+
+	_snap_path(snap_path, "");
+	if (!snap_path[0] || !_parse_dump(ini_path, is_dir, out) || strcmp(out, ref))
+	{
+		printf("  snapshot load FAIL\n");
+		goto out;
+	}
+	printf("  %-28s OK\n", "snapshot load");
+
+	u32 snap_size;
+	u8 *snap = _read_file(snap_path, &snap_size);
+
+	res = _test_reject(ini_path, is_dir, ref, snap, snap_size, snap_path) &&
+		  _test_fuzz(ini_path, is_dir, ref, snap, snap_size, snap_path);
+
+	free(snap);
+	f_unlink(snap_path);
+
+out:
+	free(out);
+	free(ref);
+
+	return res;
+}
+
+int main()
+{
+	u8 work[FF_MAX_SS];
+	char path[64];
+
+	srand(1);
+
+	img = calloc(1, (u64)IMG_SECTORS << 9);
+	if (f_mkfs("", FM_ANY, 0, work, sizeof(work)) || f_mount(&fs, "", 1))
+	{
+		printf("FAIL cannot create FAT image\n");
+		return 1;
+	}
+
+	f_mkdir("bootloader");
+	f_mkdir("bootloader/sys");
+	f_mkdir(INI_DIR);
+	_write_file(INI_PATH, ini_main, strlen(ini_main));
+	for (u32 i = 0; i < ARRAY_SIZE(ini_extra); i++)
+	{
+		sprintf(path, INI_DIR"/%02d.ini", i);
+		_write_file(path, ini_extra[i], strlen(ini_extra[i]));
+	}
+
+	int ok = _test_source("ini file", INI_PATH, false) &&
+			 _test_source("ini folder", INI_DIR, true);
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+
+	return !ok;
+}
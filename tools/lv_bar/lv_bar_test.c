@@ -0,0 +1,173 @@
+/*
+ * Host test for partial bar redraws in LVGL.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Every value change is redrawn with only the areas the bar invalidated, then the whole
+ * screen is redrawn. Both frames must match, and the partial one must flush less.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <lvgl.h>
+
+static lv_color_t fb[LV_HOR_RES * LV_VER_RES];
+static lv_color_t partial[LV_HOR_RES * LV_VER_RES];
+static u32 flushed; // Pixels flushed since last reset.
+static u32 seed = 1;
+
+u32 get_tmr_ms()
+{
+	return 0;
+}
+
+static void _disp_flush(int32_t x1, int32_t y1, int32_t x2, int32_t y2, const lv_color_t *color_p)
+{
+	for (int32_t y = y1; y <= y2; y++)
+	{
+		memcpy(&fb[y * LV_HOR_RES + x1], color_p, (x2 - x1 + 1) * sizeof(lv_color_t));
+		color_p += x2 - x1 + 1;
+	}
+	flushed += (x2 - x1 + 1) * (y2 - y1 + 1);
+
+	lv_flush_ready();
+}
+
+static u32 _rand()
+{
+	seed = seed * 1103515245 + 12345;
+
+	return seed >> 16;
+}
+
+static int _check(const char *name, bool ok)
+{
+	printf("  %-30s %s\n", name, ok ? "OK" : "FAIL");
+
+	return ok;
+}
+
+// Change the value, redraw what got invalidated and compare with a full redraw.
+static bool _set_value(lv_obj_t *bar, int16_t value, u32 *partial_px)
+{
+	lv_bar_set_value(bar, value);
+	flushed = 0;
+	lv_refr_now();
+	*partial_px += flushed;
+	memcpy(partial, fb, sizeof(fb));
+
+	lv_obj_invalidate(lv_scr_act());
+	lv_refr_now();
+
+	return !memcmp(partial, fb, sizeof(fb));
+}
+
+static int _bar_values(const char *name, lv_obj_t *bar, bool partial_expected)
+{
+	bool ok = true;
+	u32 partial_px = 0;
+	int16_t min = lv_bar_get_min_value(bar);
+	int16_t max = lv_bar_get_max_value(bar);
+
+	lv_obj_invalidate(lv_scr_act());
+	lv_refr_now();
+
+	// Progress like steps, then random jumps including both ends.
+	for (int32_t v = min; v <= max && ok; v += 1 + (max - min) / 50)
+		ok &= _set_value(bar, v, &partial_px);
+	for (u32 i = 0; i < 100 && ok; i++)
+		ok &= _set_value(bar, min + (int32_t)(_rand() % (max - min + 1)), &partial_px);
+	ok &= _set_value(bar, min, &partial_px);
+	ok &= _set_value(bar, max, &partial_px);
+
+	// About half the bar moves on average, so partial redraws must flush less than whole ones.
+	u32 steps = 50 + 100 + 2;
+	u32 bar_px = lv_obj_get_width(bar) * lv_obj_get_height(bar);
+	if (partial_expected)
+		ok &= partial_px < steps * bar_px * 3 / 4;
+
+	return _check(name, ok);
+}
+
+int main()
+{
+	lv_disp_drv_t disp_drv;
+	static lv_style_t bg, indic;
+	int ok = 1;
+
+	lv_init();
+	lv_disp_drv_init(&disp_drv);
+	disp_drv.disp_flush = _disp_flush;
+	lv_disp_drv_register(&disp_drv);
+
+	// Nyx like progress bar, with a rounded and shadowed indicator.
+	lv_style_copy(&bg, &lv_style_pretty);
+	bg.body.main_color = LV_COLOR_HEX(0x3D3D3D);
+	bg.body.grad_color = LV_COLOR_HEX(0x3D3D3D);
+	bg.body.radius = 8;
+	lv_style_copy(&indic, &lv_style_pretty_color);
+	indic.body.main_color = LV_COLOR_HEX(0x00FFC9);
+	indic.body.grad_color = LV_COLOR_HEX(0x00B8FF);
+	indic.body.radius = 6;
+	indic.body.padding.hor = 4;
+	indic.body.padding.ver = 4;
+	indic.body.shadow.width = 6;
+	indic.body.shadow.color = LV_COLOR_HEX(0x00FFC9);
+
+	lv_obj_t *bar = lv_bar_create(lv_scr_act(), NULL);
+	lv_obj_set_pos(bar, 100, 300);
+	lv_obj_set_size(bar, 1000, 40);
+	lv_bar_set_style(bar, LV_BAR_STYLE_BG, &bg);
+	lv_bar_set_style(bar, LV_BAR_STYLE_INDIC, &indic);
+	lv_bar_set_range(bar, 0, 100);
+	ok &= _bar_values("horizontal bar", bar, true);
+
+	lv_bar_set_range(bar, -1000, 3000);
+	ok &= _bar_values("horizontal bar, wide range", bar, true);
+
+	// Gradient is stretched over the indicator height, so vertical bars with one redraw whole.
+	lv_obj_set_size(bar, 40, 500);
+	lv_obj_set_pos(bar, 600, 100);
+	lv_bar_set_range(bar, 0, 100);
+	ok &= _bar_values("vertical bar, gradient", bar, false);
+
+	indic.body.grad_color = indic.body.main_color;
+	lv_obj_refresh_style(bar);
+	ok &= _bar_values("vertical bar", bar, true);
+
+	// Partially off screen, so invalidation gets clipped.
+	lv_obj_set_size(bar, 800, 30);
+	lv_obj_set_pos(bar, 900, 700);
+	ok &= _bar_values("clipped bar", bar, false);
+
+	lv_obj_set_size(bar, 1000, 40);
+	lv_obj_set_pos(bar, 100, 300);
+	lv_bar_set_range(bar, -100, 100);
+	lv_bar_set_sym(bar, true);
+	ok &= _bar_values("symmetric bar", bar, false);
+	lv_obj_del(bar);
+
+	// Knob moves too, so sliders still redraw whole.
+	lv_obj_t *slider = lv_slider_create(lv_scr_act(), NULL);
+	lv_obj_set_pos(slider, 100, 300);
+	lv_obj_set_size(slider, 1000, 40);
+	lv_slider_set_range(slider, 0, 100);
+	ok &= _bar_values("slider", slider, false);
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+
+	return !ok;
+}
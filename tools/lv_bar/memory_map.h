@@ -0,0 +1,15 @@
+/*
+ * Host memory map. LVGL pool and VDB are static arrays.
+ */
+
+#ifndef _TEST_MEMORY_MAP_H_
+#define _TEST_MEMORY_MAP_H_
+
+#include "../../bdk/memory_map.h"
+
+#undef NYX_LV_MEM_ADR
+#undef NYX_LV_VDB_ADR
+#define NYX_LV_MEM_ADR 0
+#define NYX_LV_VDB_ADR 0
+
+#endif
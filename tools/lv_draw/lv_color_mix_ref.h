@@ -0,0 +1,22 @@
+/*
+ * Previous lv_color_mix, which shifted green down before mixing. Forced into the reference build.
+ */
+
+#ifndef _LV_COLOR_MIX_REF_H_
+#define _LV_COLOR_MIX_REF_H_
+
+#include <lv_misc/lv_color.h>
+
+#define lv_color_mix ref_lv_color_mix
+
+static inline lv_color_t lv_color_mix(const lv_color_t c1, const lv_color_t c2, uint8_t mix)
+{
+    lv_color_t ret;
+    uint32_t rb = (((c1.full & 0x00FF00FF) * mix) + ((c2.full & 0x00FF00FF) * (255 - mix))) >> 8;
+    uint32_t g = (((((c1.full & 0x0000FF00) >> 8) * mix) + (((c2.full & 0x0000FF00) >> 8) * (255 - mix))) >> 8) << 8;
+    ret.full = 0xFF000000 | (0x00FF00FF & rb) | (0x0000FF00 & g);
+
+    return ret;
+}
+
+#endif
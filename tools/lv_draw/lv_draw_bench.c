@@ -0,0 +1,236 @@
+/*
+ * Host render benchmark for the LVGL software renderer, with Nyx like screens.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Built twice, against the current lv_draw_vbasic.c and against the reference generated from it.
+ * Both print a checksum per screen, so the frames can be compared.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <lv_core/lv_vdb.h>
+#include <lv_draw/lv_draw.h>
+#include <lv_draw/lv_draw_rect.h>
+#include <lv_hal/lv_hal_disp.h>
+
+#define FRAMES_TEST   1
+#define FRAMES_BENCH  100
+
+#define COLOR_SHADOW_LIGHT     LV_COLOR_HEX(0xAAAAAA)
+#define COLOR_SHADOW_DARK      LV_COLOR_HEX(0x1F1F1F)
+#define COLOR_HOS_BG           LV_COLOR_HEX(0x2D2D2D)
+#define COLOR_HOS_BG_LIGHT     LV_COLOR_HEX(0x3D3D3D)
+#define COLOR_HOS_LIGHT_BORDER LV_COLOR_HEX(0x4D4D4D)
+
+typedef struct _screen_t
+{
+	const char *name;
+	void (*draw)();
+} screen_t;
+
+static lv_color_t vdb_buf[LV_HOR_RES * LV_VER_RES];
+static lv_color_t wallpaper[LV_HOR_RES * LV_VER_RES];
+static lv_color_t icon[200 * 200];
+static lv_vdb_t vdb = { { 0, 0, LV_HOR_RES - 1, LV_VER_RES - 1 }, vdb_buf };
+static lv_disp_t disp;
+static lv_area_t screen_area = { 0, 0, LV_HOR_RES - 1, LV_VER_RES - 1 };
+static lv_style_t panel, btn, darken, ddlist, sb;
+
+lv_vdb_t *lv_vdb_get()
+{
+	return &vdb;
+}
+
+lv_disp_t *lv_disp_get_active()
+{
+	return &disp;
+}
+
+void lv_font_builtin_init()
+{
+}
+
+static void _style_init()
+{
+	// Hekate theme panel and button, Nyx mbox darken and transparent drop down list.
+	memset(&panel, 0, sizeof(lv_style_t));
+	panel.body.main_color = COLOR_HOS_BG;
+	panel.body.grad_color = COLOR_HOS_BG;
+	panel.body.radius = 4;
+	panel.body.opa = LV_OPA_COVER;
+	panel.body.border.width = 1;
+	panel.body.border.color = COLOR_HOS_LIGHT_BORDER;
+	panel.body.border.part = LV_BORDER_FULL;
+	panel.body.border.opa = LV_OPA_COVER;
+	panel.body.shadow.color = COLOR_SHADOW_LIGHT;
+	panel.body.shadow.type = LV_SHADOW_BOTTOM;
+	panel.body.shadow.width = 4;
+
+	btn = panel;
+	btn.body.main_color = COLOR_HOS_BG_LIGHT;
+	btn.body.grad_color = COLOR_HOS_BG_LIGHT;
+	btn.body.radius = 6;
+	btn.body.border.width = 0;
+	btn.body.shadow.color = COLOR_SHADOW_DARK;
+	btn.body.shadow.width = 6;
+
+	memset(&darken, 0, sizeof(lv_style_t));
+	darken.body.main_color = LV_COLOR_BLACK;
+	darken.body.grad_color = LV_COLOR_BLACK;
+	darken.body.opa = LV_OPA_30;
+
+	ddlist = darken;
+	ddlist.body.main_color = COLOR_HOS_BG_LIGHT;
+	ddlist.body.grad_color = COLOR_HOS_BG_LIGHT;
+	ddlist.body.radius = 4;
+	ddlist.body.opa = 180;
+
+	sb = darken;
+	sb.body.opa = LV_OPA_40;
+}
+
+// Smooth photo like gradient with some noise, so neighbour pixels mostly differ.
+static void _image_init()
+{
+	u32 seed = 1;
+
+	for (u32 y = 0; y < LV_VER_RES; y++)
+	{
+		for (u32 x = 0; x < LV_HOR_RES; x++)
+		{
+			seed = seed * 1103515245 + 12345;
+			u32 n = (seed >> 16) & 7;
+			wallpaper[y * LV_HOR_RES + x] = LV_COLOR_MAKE((x * 255 / LV_HOR_RES) ^ n, (y * 255 / LV_VER_RES) + n, 0x60 + n);
+		}
+	}
+
+	// Round icon with an anti-aliased edge, like the 32-bit BMP icons with alpha.
+	for (u32 y = 0; y < 200; y++)
+	{
+		for (u32 x = 0; x < 200; x++)
+		{
+			int d = (x - 100) * (x - 100) + (y - 100) * (y - 100);
+			lv_color_t *px = &icon[y * 200 + x];
+
+			*px = LV_COLOR_MAKE(x, y, 0xC0);
+			px->alpha = d < 90 * 90 ? LV_OPA_COVER : (d < 100 * 100 ? (100 * 100 - d) * 255 / (100 * 100 - 90 * 90) : 0);
+		}
+	}
+}
+
+static void _rect(lv_coord_t x, lv_coord_t y, lv_coord_t w, lv_coord_t h, const lv_style_t *style)
+{
+	lv_area_t a = { x, y, x + w - 1, y + h - 1 };
+	lv_draw_rect(&a, &screen_area, style, LV_OPA_COVER);
+}
+
+static void _map(lv_coord_t x, lv_coord_t y, lv_coord_t w, lv_coord_t h, const lv_color_t *map, lv_opa_t opa, bool alpha)
+{
+	lv_area_t a = { x, y, x + w - 1, y + h - 1 };
+	map_fp(&a, &screen_area, (const uint8_t *)map, opa, false, alpha, LV_COLOR_BLACK, LV_OPA_TRANSP);
+}
+
+// Wallpaper, status bar and the six launcher icons.
+static void _draw_home()
+{
+	_map(0, 0, LV_HOR_RES, LV_VER_RES, wallpaper, LV_OPA_COVER, false);
+	_rect(0, 0, LV_HOR_RES, 64, &sb);
+
+	for (u32 i = 0; i < 6; i++)
+		_map(90 + (i % 3) * 400, 140 + (i / 3) * 290, 200, 200, icon, LV_OPA_COVER, true);
+}
+
+// Tool window with a panel, shadowed buttons and a translucent drop down list.
+static void _draw_window()
+{
+	_map(0, 0, LV_HOR_RES, LV_VER_RES, wallpaper, LV_OPA_COVER, false);
+	_rect(0, 64, LV_HOR_RES, LV_VER_RES - 64, &panel);
+
+	for (u32 i = 0; i < 8; i++)
+		_rect(60 + (i % 2) * 620, 120 + (i / 2) * 130, 540, 80, &btn);
+
+	_rect(700, 200, 400, 320, &ddlist);
+}
+
+// Window darkened by a message box, like every confirmation and result popup.
+static void _draw_mbox()
+{
+	_draw_window();
+	_rect(0, 0, LV_HOR_RES, LV_VER_RES, &darken);
+	_rect(240, 160, 800, 400, &panel);
+	_rect(540, 460, 200, 60, &btn);
+}
+
+// Wallpaper fading in over the home screen.
+static void _draw_fade()
+{
+	_draw_home();
+	_map(0, 0, LV_HOR_RES, LV_VER_RES, wallpaper, LV_OPA_50, false);
+}
+
+static const screen_t screens[] = {
+	{ "home",   _draw_home   },
+	{ "window", _draw_window },
+	{ "mbox",   _draw_mbox   },
+	{ "fade",   _draw_fade   },
+};
+
+static u32 _checksum()
+{
+	u32 sum = 0;
+
+	for (u32 i = 0; i < LV_HOR_RES * LV_VER_RES; i++)
+		sum = (sum << 5) + (sum >> 27) + vdb_buf[i].full;
+
+	return sum;
+}
+
+int main(int argc, char **argv)
+{
+	bool bench = argc > 1 && !strcmp(argv[1], "bench");
+	u32 frames = bench ? FRAMES_BENCH : FRAMES_TEST;
+
+	_style_init();
+	_image_init();
+
+	for (u32 i = 0; i < sizeof(screens) / sizeof(screen_t); i++)
+	{
+		double best = 1e9;
+
+		for (u32 j = 0; j < frames; j++)
+		{
+			struct timespec ts0, ts1;
+			memset(vdb_buf, 0, sizeof(vdb_buf));
+
+			clock_gettime(CLOCK_MONOTONIC, &ts0);
+			screens[i].draw();
+			clock_gettime(CLOCK_MONOTONIC, &ts1);
+
+			double t = (ts1.tv_sec - ts0.tv_sec) + (ts1.tv_nsec - ts0.tv_nsec) / 1e9;
+			if (t < best)
+				best = t;
+		}
+
+		if (bench)
+			printf("  %-7s %8.1f us/frame\n", screens[i].name, best * 1e6);
+		else
+			printf("  %-7s %08X\n", screens[i].name, _checksum());
+	}
+
+	return 0;
+}
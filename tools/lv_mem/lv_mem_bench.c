@@ -0,0 +1,387 @@
+/*
+ * Host trace replay benchmark for the LVGL lv_mem allocator.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Recorded traces have one operation per line:
+ *   a <ptr> <size>          lv_mem_alloc
+ *   r <ptr> <new ptr> <size> lv_mem_realloc
+ *   f <ptr>                 lv_mem_free
+ * Pointers are hex and only identify allocations. Other lines are ignored.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <utils/types.h>
+
+#include "lv_mem.h"
+
+#define GEN_WINDOWS  300
+#define BENCH_ITERS  3
+#define MAX_ALLOCS   (1 << 20)
+
+typedef struct _op_t
+{
+	uint8_t type;
+	uint32_t id;
+	uint32_t size;
+} op_t;
+
+typedef struct _trace_t
+{
+	const char *name;
+	op_t *ops;
+	uint32_t cnt;
+	uint32_t ids;
+} trace_t;
+
+typedef struct _allocator_t
+{
+	const char *name;
+	void (*init)(void);
+	void *(*alloc)(uint32_t size);
+	void (*free)(const void *data);
+	void *(*realloc)(void *data, uint32_t size);
+	void (*monitor)(lv_mem_monitor_t *mon);
+} allocator_t;
+
+void  ref_lv_mem_init(void);
+void *ref_lv_mem_alloc(uint32_t size);
+void  ref_lv_mem_free(const void *data);
+void *ref_lv_mem_realloc(void *data, uint32_t size);
+void  ref_lv_mem_monitor(lv_mem_monitor_t *mon);
+
+static const allocator_t allocators[2] = {
+	{ "old", ref_lv_mem_init, ref_lv_mem_alloc, ref_lv_mem_free, ref_lv_mem_realloc, ref_lv_mem_monitor },
+	{ "new", lv_mem_init,     lv_mem_alloc,     lv_mem_free,     lv_mem_realloc,     lv_mem_monitor     },
+};
+
+static uint32_t rng_state = 1;
+
+static uint32_t _rand()
+{
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+
+	return rng_state;
+}
+
+static void _trace_add(trace_t *t, uint8_t type, uint32_t id, uint32_t size)
+{
+	if (!(t->cnt & 0xFFFF))
+		t->ops = realloc(t->ops, (t->cnt + 0x10000) * sizeof(op_t));
+
+	t->ops[t->cnt].type = type;
+	t->ops[t->cnt].id = id;
+	t->ops[t->cnt].size = size;
+	t->cnt++;
+}
+
+// Object sizes of the Nyx widgets. Mostly objects, ext attributes and short label texts.
+static uint32_t _gen_size()
+{
+	uint32_t r = _rand() % 100;
+
+	if (r < 35)
+		return 60 + _rand() % 40;     // lv_obj_t.
+	if (r < 65)
+		return 8 + _rand() % 120;     // Ext attributes, styles, animations.
+	if (r < 92)
+		return 4 + _rand() % 64;      // Label texts.
+	if (r < 99)
+		return 256 + _rand() % 4096;  // Long label texts, lists.
+	return SZ_16K + _rand() % SZ_256K; // Image and canvas buffers.
+}
+
+/*
+ * Nyx like session. The main menu and status bar stay allocated, windows with tens to thousands of objects
+ * are opened and closed, the status bar label is updated and some objects outlive their window.
+ */
+static void _trace_gen(trace_t *t)
+{
+	uint32_t *live = malloc(MAX_ALLOCS * sizeof(uint32_t));
+	uint32_t persistent = 3000;
+	uint32_t status_id;
+
+	t->name = "generated";
+
+	for (uint32_t i = 0; i < persistent; i++)
+		_trace_add(t, 'a', t->ids++, _gen_size());
+	status_id = t->ids;
+	_trace_add(t, 'a', t->ids++, 24);
+
+	for (uint32_t w = 0; w < GEN_WINDOWS; w++)
+	{
+		uint32_t r = _rand() % 10;
+		uint32_t objs = r < 5 ? 20 + _rand() % 60 : (r < 9 ? 200 + _rand() % 400 : 1000 + _rand() % 2000);
+		uint32_t cnt = 0;
+
+		for (uint32_t i = 0; i < objs; i++)
+		{
+			live[cnt++] = t->ids;
+			_trace_add(t, 'a', t->ids++, _gen_size());
+
+			// Label text updates.
+			if (!(_rand() % 8))
+				_trace_add(t, 'r', live[_rand() % cnt], 4 + _rand() % 200);
+			if (!(_rand() % 64))
+				_trace_add(t, 'r', status_id, 16 + _rand() % 24);
+		}
+
+		// Close window. Children are deleted mostly in creation order.
+		for (uint32_t i = 0; i < cnt; i++)
+		{
+			uint32_t j = i + ((_rand() % 4) ? 0 : _rand() % (cnt - i));
+			uint32_t id = live[j];
+			live[j] = live[i];
+
+			// Some objects, like cached lists and icons, outlive the window.
+			if (!(_rand() % 200))
+				continue;
+			_trace_add(t, 'f', id, 0);
+		}
+	}
+
+	free(live);
+}
+
+// Pointer to id map for recorded traces.
+typedef struct _ptr_map_t
+{
+	uint64_t *keys;
+	uint32_t *vals;
+	uint32_t size;
+} ptr_map_t;
+
+static uint32_t *_map_get(ptr_map_t *m, uint64_t key, bool insert)
+{
+	uint32_t h = (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & (m->size - 1);
+
+	while (m->keys[h] && m->keys[h] != key)
+		h = (h + 1) & (m->size - 1);
+
+	if (!m->keys[h])
+	{
+		if (!insert)
+			return NULL;
+		m->keys[h] = key;
+	}
+
+	return &m->vals[h];
+}
+
+static int _trace_load(trace_t *t, const char *path)
+{
+	char line[128];
+	ptr_map_t map;
+	FILE *fp = fopen(path, "r");
+
+	if (!fp)
+	{
+		printf("FAIL: could not open %s\n", path);
+		return 1;
+	}
+
+	t->name = path;
+	map.size = MAX_ALLOCS * 2;
+	map.keys = calloc(map.size, sizeof(uint64_t));
+	map.vals = calloc(map.size, sizeof(uint32_t));
+
+	// Freed pointers are reused by later allocations, so ids are assigned on alloc.
+	while (fgets(line, sizeof(line), fp))
+	{
+		unsigned long long ptr, new_ptr;
+		unsigned int size;
+		uint32_t *id;
+
+		if (sscanf(line, "a %llx %u", &ptr, &size) == 2)
+		{
+			*_map_get(&map, ptr, true) = t->ids;
+			_trace_add(t, 'a', t->ids++, size);
+		}
+		else if (sscanf(line, "r %llx %llx %u", &ptr, &new_ptr, &size) == 3 && (id = _map_get(&map, ptr, false)))
+		{
+			uint32_t val = *id;
+			*id = UINT32_MAX;
+			_trace_add(t, 'r', val, size);
+			*_map_get(&map, new_ptr, true) = val;
+		}
+		else if (sscanf(line, "f %llx", &ptr) == 1 && (id = _map_get(&map, ptr, false)) && *id != UINT32_MAX)
+		{
+			_trace_add(t, 'f', *id, 0);
+			*id = UINT32_MAX;
+		}
+	}
+
+	fclose(fp);
+	free(map.keys);
+	free(map.vals);
+
+	return 0;
+}
+
+static void _fill(uint8_t *p, uint32_t id, uint32_t size)
+{
+	for (uint32_t i = 0; i < size; i++)
+		p[i] = (uint8_t)(id * 7 + i);
+}
+
+static bool _check(const uint8_t *p, uint32_t id, uint32_t size)
+{
+	for (uint32_t i = 0; i < size; i++)
+		if (p[i] != (uint8_t)(id * 7 + i))
+			return false;
+
+	return true;
+}
+
+// Replay a trace. With verify, every allocation holds an id pattern that must survive until it is freed.
+static double _replay(const allocator_t *a, const trace_t *t, bool verify, lv_mem_monitor_t *mon, uint32_t *peak)
+{
+	void **ptrs = calloc(t->ids, sizeof(void *));
+	uint32_t *sizes = verify ? calloc(t->ids, sizeof(uint32_t)) : NULL;
+	uint32_t used = 0;
+
+	a->init();
+
+	struct timespec ts0, ts1;
+	clock_gettime(CLOCK_MONOTONIC, &ts0);
+
+	for (uint32_t i = 0; i < t->cnt; i++)
+	{
+		const op_t *op = &t->ops[i];
+
+		switch (op->type)
+		{
+		case 'a':
+			ptrs[op->id] = a->alloc(op->size);
+			if (verify)
+			{
+				if (!ptrs[op->id])
+					return -1;
+				_fill(ptrs[op->id], op->id, op->size);
+				sizes[op->id] = op->size;
+			}
+			break;
+		case 'r':
+			if (verify && !_check(ptrs[op->id], op->id, sizes[op->id]))
+				return -1;
+			ptrs[op->id] = a->realloc(ptrs[op->id], op->size);
+			if (verify)
+			{
+				if (!ptrs[op->id] || !_check(ptrs[op->id], op->id, MIN(op->size, sizes[op->id])))
+					return -1;
+				_fill(ptrs[op->id], op->id, op->size);
+				sizes[op->id] = op->size;
+			}
+			break;
+		case 'f':
+			if (verify && !_check(ptrs[op->id], op->id, sizes[op->id]))
+				return -1;
+			a->free(ptrs[op->id]);
+			ptrs[op->id] = NULL;
+			break;
+		}
+
+		if (peak && !(i & 0x3FF))
+		{
+			lv_mem_monitor_t m;
+			a->monitor(&m);
+			used = MAX(used, m.total_size - m.free_size);
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &ts1);
+
+	a->monitor(mon);
+	if (peak)
+		*peak = used;
+
+	free(ptrs);
+	free(sizes);
+
+	return (ts1.tv_sec - ts0.tv_sec) + (ts1.tv_nsec - ts0.tv_nsec) / 1e9;
+}
+
+static int _test(const trace_t *t)
+{
+	for (uint32_t i = 0; i < 2; i++)
+	{
+		lv_mem_monitor_t mon;
+		if (_replay(&allocators[i], t, true, &mon, NULL) < 0)
+		{
+			printf("FAIL %s: data corrupted replaying %s\n", allocators[i].name, t->name);
+			return 1;
+		}
+	}
+
+	printf("ok    %s: %d ops\n", t->name, t->cnt);
+
+	return 0;
+}
+
+static void _bench(const trace_t *t)
+{
+	printf("%s: %d ops\n", t->name, t->cnt);
+
+	for (uint32_t i = 0; i < 2; i++)
+	{
+		lv_mem_monitor_t mon;
+		uint32_t peak;
+		double best = 1e9;
+
+		for (uint32_t j = 0; j < BENCH_ITERS; j++)
+			best = MIN(best, _replay(&allocators[i], t, false, &mon, j ? NULL : &peak));
+
+		printf("  %s %8.1f ns/op, peak %6d KB, end: %6d free entries, frag %3d%%\n", allocators[i].name,
+			best * 1e9 / t->cnt, peak / SZ_1K, mon.free_cnt, mon.frag_pct);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	bool bench = argc > 1 && !strcmp(argv[1], "bench");
+	trace_t t = {0};
+
+	_trace_gen(&t);
+	if (bench)
+		_bench(&t);
+	else if (_test(&t))
+		return 1;
+
+	// Recorded traces.
+	for (int i = bench ? 2 : 1; i < argc; i++)
+	{
+		trace_t rt = {0};
+		if (_trace_load(&rt, argv[i]))
+			return 1;
+
+		if (bench)
+			_bench(&rt);
+		else if (_test(&rt))
+			return 1;
+
+		free(rt.ops);
+	}
+
+	free(t.ops);
+
+	return 0;
+}
@@ -0,0 +1,13 @@
+/*
+ * Host memory map. LVGL pool is a static array in lv_mem.c.
+ */
+
+#ifndef _TEST_MEMORY_MAP_H_
+#define _TEST_MEMORY_MAP_H_
+
+#include "../../bdk/memory_map.h"
+
+#undef NYX_LV_MEM_ADR
+#define NYX_LV_MEM_ADR 0
+
+#endif
@@ -0,0 +1,184 @@
+/*
+ * Host benchmark for the pipelined eMMC backup loop, on the mock controller clock.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Replays the read/write loop of _dump_emmc_part, with and without queuing the next
+ * eMMC read before the SD write. The eMMC card is loaded from an image file if given,
+ * and the SD card is written back to the output image, so both can be compared.
+ * Times are on the virtual clock of the mock controller, at the given card speeds.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mock_ctrl.h"
+
+#define NUM_SECTORS_PER_ITER 8192 // 4MB Cache.
+
+typedef struct _speed_t
+{
+	const char *name;
+	u32 emmc_mb_s;
+	u32 sd_mb_s;
+} speed_t;
+
+static const speed_t speeds[] = {
+	{ "HS400 / SDR104",  300, 90 },
+	{ "HS400 / SDR50",   300, 40 },
+	{ "HS400 / HS25",    300, 20 },
+	{ "HS200 / SDR104",  150, 90 },
+};
+
+static u8 bufs[NUM_SECTORS_PER_ITER * 512 * 2] __attribute__((aligned(8)));
+
+// Same flow as _dump_emmc_part, minus GUI, hashing and split parts.
+static int _dump(u32 total_sectors, bool pipeline_reads)
+{
+	u8 *buf = bufs;
+	u8 *bufNext = bufs + NUM_SECTORS_PER_ITER * 512;
+	bool chunkQueued = false;
+	u32 lba_curr = 0;
+
+	while (total_sectors > 0)
+	{
+		u32 num = MIN(total_sectors, NUM_SECTORS_PER_ITER);
+
+		int res_read;
+		if (chunkQueued)
+			res_read = !sdmmc_storage_async_wait(&emmc_storage);
+		else
+			res_read = !sdmmc_storage_read(&emmc_storage, lba_curr, num, buf);
+		chunkQueued = false;
+
+		if (res_read)
+			return 0;
+
+		// Queue next chunk so it gets read while this one is written.
+		u32 numNext = MIN(total_sectors - num, NUM_SECTORS_PER_ITER);
+		if (pipeline_reads && numNext)
+			chunkQueued = sdmmc_storage_read_async(&emmc_storage, lba_curr + num, numNext, bufNext);
+
+		if (!sdmmc_storage_write(&sd_storage, lba_curr, num, buf))
+		{
+			if (chunkQueued)
+				sdmmc_storage_async_wait(&emmc_storage);
+
+			return 0;
+		}
+
+		lba_curr += num;
+		total_sectors -= num;
+
+		// Swap buffers. Queued chunk becomes the current one.
+		if (pipeline_reads)
+		{
+			u8 *bufTmp = buf;
+			buf = bufNext;
+			bufNext = bufTmp;
+		}
+	}
+
+	return 1;
+}
+
+static u64 _run(const speed_t *speed, u32 sectors, bool pipeline_reads, bool *match)
+{
+	mock_reset();
+	mock_emmc.mb_s = speed->emmc_mb_s;
+	mock_sd.mb_s = speed->sd_mb_s;
+	memset(mock_sd.disk, 0, (u64)sectors * 512);
+
+	if (!_dump(sectors, pipeline_reads))
+	{
+		*match = false;
+		return 0;
+	}
+
+	*match &= !memcmp(mock_emmc.disk, mock_sd.disk, (u64)sectors * 512);
+
+	return mock_us;
+}
+
+static u32 _load_image(const char *path)
+{
+	FILE *fp = fopen(path, "rb");
+	if (!fp)
+		return 0;
+
+	fseek(fp, 0, SEEK_END);
+	u64 size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	u32 sectors = size / 512;
+	mock_init(sectors);
+	if (fread(mock_emmc.disk, 512, sectors, fp) != sectors)
+		sectors = 0;
+	fclose(fp);
+
+	return sectors;
+}
+
+static int _save_image(const char *path, u32 sectors)
+{
+	FILE *fp = fopen(path, "wb");
+	if (!fp)
+		return 0;
+
+	int res = fwrite(mock_sd.disk, 512, sectors, fp) == sectors;
+	fclose(fp);
+
+	return res;
+}
+
+int main(int argc, char **argv)
+{
+	bool match = true;
+	u32 sectors = MOCK_DISK_SECTORS * 4;
+
+	if (argc > 1)
+	{
+		sectors = _load_image(argv[1]);
+		if (!sectors)
+		{
+			printf("Failed to load %s\n", argv[1]);
+			return 1;
+		}
+	}
+	else
+		mock_init(sectors);
+
+	printf("  %u MB backup\n", sectors / 2048);
+	printf("  %-28s %10s %10s %5s\n", "eMMC / SD speed", "sequential", "pipelined", "gain");
+	for (u32 i = 0; i < sizeof(speeds) / sizeof(speed_t); i++)
+	{
+		u64 seq_us = _run(&speeds[i], sectors, false, &match);
+		u64 pipe_us = _run(&speeds[i], sectors, true, &match);
+
+		printf("  %-14s %3u / %2u MB/s %8.2f s %8.2f s %4.0f%%\n", speeds[i].name,
+			speeds[i].emmc_mb_s, speeds[i].sd_mb_s, seq_us / 1e6, pipe_us / 1e6,
+			pipe_us ? (double)seq_us * 100 / pipe_us - 100 : 0);
+	}
+
+	if (argc > 2 && !_save_image(argv[2], sectors))
+	{
+		printf("Failed to save %s\n", argv[2]);
+		return 1;
+	}
+
+	printf("%s\n", match ? "PASS: SD card matches eMMC" : "FAIL: SD card differs from eMMC");
+
+	return !match;
+}
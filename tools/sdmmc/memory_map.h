@@ -0,0 +1,17 @@
+/*
+ * Host memory map. The SDMMC bounce buffer lives in a test buffer.
+ */
+
+#ifndef _TEST_MEMORY_MAP_H_
+#define _TEST_MEMORY_MAP_H_
+
+#include "../../bdk/memory_map.h"
+
+extern unsigned char sdmmc_up_mem[];
+
+#undef SDMMC_UPPER_BUFFER
+#undef SDMMC_UP_BUF_SZ
+#define SDMMC_UPPER_BUFFER (sdmmc_up_mem)
+#define SDMMC_UP_BUF_SZ    SZ_64M
+
+#endif
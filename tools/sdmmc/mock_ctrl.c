@@ -0,0 +1,319 @@
+/*
+ * Mock SDMMC controller for host tests. Replaces sdmmc_driver.c.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Every controller has a flat card. Background transfers stay busy for a few polls and
+ * move data only when they are ended, so a buffer used too early shows up as wrong data.
+ * Blocking transfers move data at once.
+ *
+ * With a transfer rate set, transfers take time on a virtual clock instead. Blocking ones
+ * advance it, background ones stay busy until it reaches their end.
+ */
+
+#include <stdlib.h>
+
+#include "mock_ctrl.h"
+#include <storage/mmc.h>
+
+unsigned char sdmmc_up_mem[SZ_64M];
+u8 mock_nodma_mem[SZ_1M];
+
+sdmmc_t sd_sdmmc, emmc_sdmmc;
+sdmmc_storage_t sd_storage, emmc_storage;
+mock_ctrl_t mock_sd, mock_emmc;
+u64 mock_us;
+
+static mock_ctrl_t *_mock_get(sdmmc_t *sdmmc)
+{
+	return sdmmc->id == SDMMC_4 ? &mock_emmc : &mock_sd;
+}
+
+static u64 _mock_xfer_us(mock_ctrl_t *ctrl, sdmmc_req_t *req)
+{
+	return ctrl->mb_s ? (u64)req->num_sectors * 512 / ctrl->mb_s : 0;
+}
+
+static int _mock_xfer(mock_ctrl_t *ctrl, u32 arg, sdmmc_req_t *req)
+{
+	u32 sector = ctrl->byte_access ? arg >> 9 : arg;
+
+	if (sector + req->num_sectors > ctrl->sectors)
+		return 0;
+
+	if (req->is_write)
+		memcpy(ctrl->disk + (u64)sector * 512, req->buf, req->num_sectors * 512);
+	else
+		memcpy(req->buf, ctrl->disk + (u64)sector * 512, req->num_sectors * 512);
+
+	return 1;
+}
+
+static void _mock_storage_init(sdmmc_storage_t *storage, sdmmc_t *sdmmc, u32 id)
+{
+	memset(sdmmc, 0, sizeof(sdmmc_t));
+	memset(storage, 0, sizeof(sdmmc_storage_t));
+	sdmmc->id = id;
+	storage->sdmmc = sdmmc;
+	storage->has_sector_access = 1;
+	storage->initialized = 1;
+}
+
+static void _mock_ctrl_reset(mock_ctrl_t *ctrl)
+{
+	u8 *disk = ctrl->disk;
+	u32 sectors = ctrl->sectors;
+
+	memset(ctrl, 0, sizeof(mock_ctrl_t));
+	ctrl->disk = disk;
+	ctrl->sectors = sectors;
+}
+
+void mock_init(u32 sectors)
+{
+	u32 seed = 0x2468ACE1;
+
+	mock_sd.disk = malloc((u64)sectors * 512);
+	mock_emmc.disk = malloc((u64)sectors * 512);
+	mock_sd.sectors = sectors;
+	mock_emmc.sectors = sectors;
+
+	for (u64 i = 0; i < (u64)sectors * 512; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		mock_sd.disk[i] = seed >> 16;
+		mock_emmc.disk[i] = seed >> 24;
+	}
+
+	mock_reset();
+}
+
+void mock_reset()
+{
+	mock_us = 0;
+	_mock_ctrl_reset(&mock_sd);
+	_mock_ctrl_reset(&mock_emmc);
+	_mock_storage_init(&sd_storage, &sd_sdmmc, SDMMC_1);
+	_mock_storage_init(&emmc_storage, &emmc_sdmmc, SDMMC_4);
+}
+
+bool mc_client_has_access(void *address)
+{
+	return (u8 *)address < mock_nodma_mem || (u8 *)address >= mock_nodma_mem + sizeof(mock_nodma_mem);
+}
+
+void sdmmc_init_cmd(sdmmc_cmd_t *cmdbuf, u16 cmd, u32 arg, u32 rsp_type, u32 check_busy)
+{
+	cmdbuf->cmd = cmd;
+	cmdbuf->arg = arg;
+	cmdbuf->rsp_type = rsp_type;
+	cmdbuf->check_busy = check_busy;
+}
+
+int sdmmc_execute_cmd(sdmmc_t *sdmmc, sdmmc_cmd_t *cmd, sdmmc_req_t *req, u32 *blkcnt_out)
+{
+	mock_ctrl_t *ctrl = _mock_get(sdmmc);
+
+	// A blocking command while a background transfer runs is a driver misuse.
+	if (ctrl->active)
+		return 0;
+
+	if (!req)
+		return 1;
+
+	if (ctrl->fail_sync || !_mock_xfer(ctrl, cmd->arg, req))
+		return 0;
+
+	mock_us += _mock_xfer_us(ctrl, req);
+	ctrl->sync_xfers++;
+	if (blkcnt_out)
+		*blkcnt_out = req->num_sectors;
+
+	return 1;
+}
+
+int sdmmc_execute_cmd_async(sdmmc_t *sdmmc, sdmmc_cmd_t *cmd, sdmmc_req_t *req)
+{
+	mock_ctrl_t *ctrl = _mock_get(sdmmc);
+
+	if (ctrl->active || ctrl->fail_start)
+		return 0;
+
+	ctrl->active = true;
+	ctrl->req = *req;
+	ctrl->sector = cmd->arg;
+	ctrl->busy_polls = MOCK_BUSY_POLLS;
+	ctrl->done_us = mock_us + _mock_xfer_us(ctrl, req);
+	ctrl->async_xfers++;
+
+	return 1;
+}
+
+u32 sdmmc_execute_cmd_async_poll(sdmmc_t *sdmmc)
+{
+	mock_ctrl_t *ctrl = _mock_get(sdmmc);
+
+	if (!ctrl->active)
+		return SDMMC_ASYNC_IDLE;
+
+	if (ctrl->mb_s)
+	{
+		if (mock_us < ctrl->done_us)
+		{
+			mock_us += MOCK_POLL_US;
+			return SDMMC_ASYNC_BUSY;
+		}
+	}
+	else if (ctrl->busy_polls)
+	{
+		ctrl->busy_polls--;
+		return SDMMC_ASYNC_BUSY;
+	}
+
+	return ctrl->fail_async ? SDMMC_ASYNC_ERROR : SDMMC_ASYNC_DONE;
+}
+
+int sdmmc_execute_cmd_async_end(sdmmc_t *sdmmc, u32 *blkcnt_out)
+{
+	mock_ctrl_t *ctrl = _mock_get(sdmmc);
+
+	if (!ctrl->active)
+		return 0;
+
+	// Blocks until the transfer is done.
+	mock_us = MAX(mock_us, ctrl->done_us);
+
+	ctrl->active = false;
+	if (ctrl->fail_async || !_mock_xfer(ctrl, ctrl->sector, &ctrl->req))
+		return 0;
+
+	if (blkcnt_out)
+		*blkcnt_out = ctrl->req.num_sectors;
+
+	return 1;
+}
+
+int sdmmc_stop_transmission(sdmmc_t *sdmmc, u32 *rsp)
+{
+	_mock_get(sdmmc)->stops++;
+
+	return 1;
+}
+
+int sdmmc_get_rsp(sdmmc_t *sdmmc, u32 *rsp, u32 size, u32 type)
+{
+	rsp[0] = R1_STATE(R1_STATE_TRAN);
+
+	return 1;
+}
+
+static bool _mock_reinit(mock_ctrl_t *ctrl)
+{
+	// Controller reset drops any background transfer.
+	ctrl->inits++;
+	ctrl->active = false;
+	if (ctrl->heal_on_init)
+	{
+		ctrl->fail_start = false;
+		ctrl->fail_async = false;
+		ctrl->fail_sync = false;
+	}
+
+	return !ctrl->fail_init;
+}
+
+bool sd_initialize(bool power_cycle)
+{
+	return _mock_reinit(&mock_sd);
+}
+
+bool emmc_initialize(bool power_cycle)
+{
+	return _mock_reinit(&mock_emmc);
+}
+
+int sd_init_retry(bool power_cycle)
+{
+	return _mock_reinit(&mock_sd);
+}
+
+int emmc_init_retry(bool power_cycle)
+{
+	return _mock_reinit(&mock_emmc);
+}
+
+void sd_error_count_increment(u8 type)
+{
+}
+
+void emmc_error_count_increment(u8 type)
+{
+}
+
+u32 get_tmr_ms()
+{
+	return 0;
+}
+
+void msleep(u32 ms)
+{
+}
+
+// Only used by card init.
+int sdmmc_init(sdmmc_t *sdmmc, u32 id, u32 power, u32 bus_width, u32 type, int powersave_enable)
+{
+	return 0;
+}
+
+void sdmmc_end(sdmmc_t *sdmmc)
+{
+}
+
+int sdmmc_get_io_power(sdmmc_t *sdmmc)
+{
+	return 0;
+}
+
+u32 sdmmc_get_bus_width(sdmmc_t *sdmmc)
+{
+	return 0;
+}
+
+void sdmmc_set_bus_width(sdmmc_t *sdmmc, u32 bus_width)
+{
+}
+
+void sdmmc_save_tap_value(sdmmc_t *sdmmc)
+{
+}
+
+int sdmmc_setup_clock(sdmmc_t *sdmmc, u32 type)
+{
+	return 0;
+}
+
+void sdmmc_card_clock_powersave(sdmmc_t *sdmmc, int powersave_enable)
+{
+}
+
+int sdmmc_tuning_execute(sdmmc_t *sdmmc, u32 type, u32 cmd)
+{
+	return 0;
+}
+
+int sdmmc_enable_low_voltage(sdmmc_t *sdmmc)
+{
+	return 0;
+}
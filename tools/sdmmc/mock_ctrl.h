@@ -0,0 +1,67 @@
+/*
+ * Mock SDMMC controller for host tests. Replaces sdmmc_driver.c.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MOCK_CTRL_H_
+#define _MOCK_CTRL_H_
+
+#include <string.h>
+
+#include <storage/emmc.h>
+#include <storage/sd.h>
+#include <storage/sdmmc.h>
+#include <utils/types.h>
+
+#define MOCK_DISK_SECTORS (SZ_64M / 512)
+#define MOCK_BUSY_POLLS   3
+#define MOCK_POLL_US      1
+
+/*! Flat card behind one controller. */
+typedef struct _mock_ctrl_t
+{
+	u8  *disk;
+	u32 sectors;
+
+	// Configuration.
+	u32 mb_s;          // Transfer rate in MB/s on the virtual clock. 0 for untimed.
+	bool byte_access;  // SDSC card. Commands take byte addresses.
+	bool fail_start;   // Background transfers fail to start.
+	bool fail_async;   // Background transfers end with an error.
+	bool fail_sync;    // Blocking transfers fail.
+	bool fail_init;    // Reinit fails.
+	bool heal_on_init; // Reinit clears all failures.
+
+	// Background transfer.
+	bool active;
+	sdmmc_req_t req;
+	u32 sector;
+	u32 busy_polls;
+	u64 done_us;
+
+	// Counters.
+	u32 async_xfers;
+	u32 sync_xfers;
+	u32 stops;
+	u32 inits;
+} mock_ctrl_t;
+
+extern mock_ctrl_t mock_sd, mock_emmc;
+extern u8 mock_nodma_mem[];
+extern u64 mock_us;
+
+void mock_init(u32 sectors);
+void mock_reset();
+
+#endif
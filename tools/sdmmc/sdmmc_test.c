@@ -0,0 +1,311 @@
+/*
+ * Host test for the SDMMC storage async request API, against a mock controller.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The storage layer is built as is and runs on top of mock_ctrl.c, which replaces
+ * sdmmc_driver.c with a flat card per controller.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mock_ctrl.h"
+
+#define TEST_SECTORS 64
+
+static u8 dma_buf[0x10010 * 512] __attribute__((aligned(8)));
+static u8 ref_buf[0x10010 * 512];
+
+static int _check(const char *name, bool ok)
+{
+	printf("  %-30s %s\n", name, ok ? "OK" : "FAIL");
+
+	return ok;
+}
+
+static void _fill(void *buf, u32 size, u32 seed)
+{
+	u8 *pbuf = (u8 *)buf;
+
+	for (u32 i = 0; i < size; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		pbuf[i] = seed >> 16;
+	}
+}
+
+static bool _card_eq(mock_ctrl_t *ctrl, u32 sector, const void *buf, u32 num_sectors)
+{
+	return !memcmp(ctrl->disk + (u64)sector * 512, buf, num_sectors * 512);
+}
+
+static int _read_background()
+{
+	bool ok = true;
+
+	mock_reset();
+	memset(dma_buf, 0, TEST_SECTORS * 512);
+
+	ok &= sdmmc_storage_read_async(&emmc_storage, 100, TEST_SECTORS, dma_buf) == 1;
+	ok &= mock_emmc.active;
+	ok &= sdmmc_storage_async_poll(&emmc_storage) == SDMMC_ASYNC_BUSY;
+
+	// Data only lands on completion.
+	ok &= !_card_eq(&mock_emmc, 100, dma_buf, TEST_SECTORS);
+
+	ok &= sdmmc_storage_async_wait(&emmc_storage) == 1;
+	ok &= _card_eq(&mock_emmc, 100, dma_buf, TEST_SECTORS);
+	ok &= mock_emmc.sync_xfers == 0 && mock_emmc.async_xfers == 1;
+	ok &= sdmmc_storage_async_poll(&emmc_storage) == SDMMC_ASYNC_IDLE;
+
+	return _check("read in background", ok);
+}
+
+static int _write_background()
+{
+	bool ok = true;
+
+	mock_reset();
+	_fill(dma_buf, TEST_SECTORS * 512, 1);
+
+	ok &= sdmmc_storage_write_async(&emmc_storage, 7, TEST_SECTORS, dma_buf) == 1;
+	while (sdmmc_storage_async_poll(&emmc_storage) == SDMMC_ASYNC_BUSY)
+		;
+	ok &= sdmmc_storage_async_poll(&emmc_storage) == SDMMC_ASYNC_DONE;
+	ok &= sdmmc_storage_async_wait(&emmc_storage) == 1;
+	ok &= _card_eq(&mock_emmc, 7, dma_buf, TEST_SECTORS);
+	ok &= mock_emmc.sync_xfers == 0 && mock_emmc.async_xfers == 1;
+
+	return _check("write in background", ok);
+}
+
+static int _one_per_storage()
+{
+	bool ok = true;
+
+	mock_reset();
+
+	ok &= sdmmc_storage_async_poll(&emmc_storage) == SDMMC_ASYNC_IDLE;
+	ok &= sdmmc_storage_async_wait(&emmc_storage) == 0;
+
+	ok &= sdmmc_storage_read_async(&emmc_storage, 0, TEST_SECTORS, dma_buf) == 1;
+	ok &= sdmmc_storage_read_async(&emmc_storage, 0, TEST_SECTORS, dma_buf) == 0;
+	ok &= sdmmc_storage_write_async(&emmc_storage, 0, TEST_SECTORS, dma_buf) == 0;
+	ok &= sdmmc_storage_async_wait(&emmc_storage) == 1;
+	ok &= sdmmc_storage_async_wait(&emmc_storage) == 0;
+	ok &= mock_emmc.async_xfers == 1;
+
+	return _check("one request per storage", ok);
+}
+
+static int _both_controllers()
+{
+	bool ok = true;
+	u8 *sd_buf = dma_buf + TEST_SECTORS * 512;
+
+	mock_reset();
+	_fill(sd_buf, TEST_SECTORS * 512, 2);
+
+	// Read from eMMC while writing to SD, like backup and restore do.
+	ok &= sdmmc_storage_read_async(&emmc_storage, 300, TEST_SECTORS, dma_buf) == 1;
+	ok &= sdmmc_storage_write_async(&sd_storage, 900, TEST_SECTORS, sd_buf) == 1;
+	ok &= mock_emmc.active && mock_sd.active;
+
+	ok &= sdmmc_storage_async_wait(&sd_storage) == 1;
+	ok &= sdmmc_storage_async_poll(&emmc_storage) != SDMMC_ASYNC_IDLE;
+	ok &= sdmmc_storage_async_wait(&emmc_storage) == 1;
+
+	ok &= _card_eq(&mock_emmc, 300, dma_buf, TEST_SECTORS);
+	ok &= _card_eq(&mock_sd, 900, sd_buf, TEST_SECTORS);
+	ok &= mock_emmc.async_xfers == 1 && mock_sd.async_xfers == 1;
+
+	return _check("both controllers in flight", ok);
+}
+
+static int _non_dma_buffer()
+{
+	bool ok = true;
+
+	mock_reset();
+	memset(mock_nodma_mem, 0, TEST_SECTORS * 512);
+
+	// Not reachable by the controller. Served through the bounce buffer on wait.
+	ok &= sdmmc_storage_read_async(&emmc_storage, 40, TEST_SECTORS, mock_nodma_mem) == 1;
+	ok &= !mock_emmc.active;
+	ok &= sdmmc_storage_async_poll(&emmc_storage) == SDMMC_ASYNC_DONE;
+	ok &= sdmmc_storage_async_wait(&emmc_storage) == 1;
+	ok &= _card_eq(&mock_emmc, 40, mock_nodma_mem, TEST_SECTORS);
+	ok &= mock_emmc.async_xfers == 0 && mock_emmc.sync_xfers == 1;
+
+	// Unaligned buffer.
+	ok &= sdmmc_storage_read_async(&emmc_storage, 40, TEST_SECTORS, dma_buf + 4) == 1;
+	ok &= !mock_emmc.active;
+	ok &= sdmmc_storage_async_wait(&emmc_storage) == 1;
+	ok &= _card_eq(&mock_emmc, 40, dma_buf + 4, TEST_SECTORS);
+
+	return _check("non DMA buffer served on wait", ok);
+}
+
+static int _large_request()
+{
+	bool ok = true;
+	u32 num = 0x10010;
+
+	mock_reset();
+
+	// Over a single command. Split in two by the synchronous path.
+	ok &= sdmmc_storage_read_async(&emmc_storage, 16, num, dma_buf) == 1;
+	ok &= !mock_emmc.active;
+	ok &= sdmmc_storage_async_wait(&emmc_storage) == 1;
+	ok &= _card_eq(&mock_emmc, 16, dma_buf, num);
+	ok &= mock_emmc.async_xfers == 0 && mock_emmc.sync_xfers == 2;
+
+	return _check("large request served on wait", ok);
+}
+
+static int _xfer_error()
+{
+	bool ok = true;
+
+	mock_reset();
+	_fill(dma_buf, TEST_SECTORS * 512, 3);
+
+	// Background write fails. Wait stops the transfer and redoes it with retries.
+	mock_emmc.fail_async = true;
+	ok &= sdmmc_storage_write_async(&emmc_storage, 500, TEST_SECTORS, dma_buf) == 1;
+	while (sdmmc_storage_async_poll(&emmc_storage) == SDMMC_ASYNC_BUSY)
+		;
+	ok &= sdmmc_storage_async_poll(&emmc_storage) == SDMMC_ASYNC_ERROR;
+	ok &= sdmmc_storage_async_wait(&emmc_storage) == 1;
+	ok &= _card_eq(&mock_emmc, 500, dma_buf, TEST_SECTORS);
+	ok &= mock_emmc.stops == 1 && mock_emmc.sync_xfers == 1;
+
+	// Failed start is served synchronously too.
+	mock_reset();
+	mock_emmc.fail_start = true;
+	ok &= sdmmc_storage_read_async(&emmc_storage, 500, TEST_SECTORS, dma_buf) == 1;
+	ok &= !mock_emmc.active;
+	ok &= sdmmc_storage_async_poll(&emmc_storage) == SDMMC_ASYNC_DONE;
+	ok &= sdmmc_storage_async_wait(&emmc_storage) == 1;
+	ok &= _card_eq(&mock_emmc, 500, dma_buf, TEST_SECTORS);
+	ok &= mock_emmc.stops == 1 && mock_emmc.sync_xfers == 1;
+
+	return _check("transfer error retried on wait", ok);
+}
+
+static int _hard_error()
+{
+	bool ok = true;
+
+	mock_reset();
+
+	// Everything fails, including the reinit. Error is reported and the storage is free again.
+	mock_emmc.fail_async = true;
+	mock_emmc.fail_sync = true;
+	mock_emmc.fail_init = true;
+	ok &= sdmmc_storage_read_async(&emmc_storage, 0, TEST_SECTORS, dma_buf) == 1;
+	ok &= sdmmc_storage_async_wait(&emmc_storage) == 0;
+	ok &= mock_emmc.inits == 1;
+	ok &= sdmmc_storage_async_poll(&emmc_storage) == SDMMC_ASYNC_IDLE;
+
+	// Reinit recovers it.
+	mock_reset();
+	mock_emmc.fail_async = true;
+	mock_emmc.fail_sync = true;
+	mock_emmc.heal_on_init = true;
+	ok &= sdmmc_storage_read_async(&emmc_storage, 0, TEST_SECTORS, dma_buf) == 1;
+	ok &= sdmmc_storage_async_wait(&emmc_storage) == 1;
+	ok &= mock_emmc.inits == 1;
+	ok &= _card_eq(&mock_emmc, 0, dma_buf, TEST_SECTORS);
+
+	return _check("hard error reported on wait", ok);
+}
+
+static int _byte_access()
+{
+	bool ok = true;
+
+	mock_reset();
+	sd_storage.has_sector_access = 0;
+	mock_sd.byte_access = true;
+	_fill(dma_buf, TEST_SECTORS * 512, 4);
+
+	// SDSC cards take byte addresses.
+	ok &= sdmmc_storage_write_async(&sd_storage, 1000, TEST_SECTORS, dma_buf) == 1;
+	ok &= mock_sd.active;
+	ok &= sdmmc_storage_async_wait(&sd_storage) == 1;
+	ok &= _card_eq(&mock_sd, 1000, dma_buf, TEST_SECTORS);
+
+	return _check("SDSC byte address", ok);
+}
+
+static int _random_requests()
+{
+	bool ok = true;
+	u32 seed = 5;
+
+	mock_reset();
+
+	// Random mix on both controllers, checked against a reference copy of the card.
+	memcpy(ref_buf, mock_sd.disk, TEST_SECTORS * 8 * 512);
+	for (u32 i = 0; i < 2000 && ok; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		u32 sector = (seed >> 8) % (TEST_SECTORS * 7);
+		u32 num = 1 + (seed >> 20) % TEST_SECTORS;
+		bool write = seed & 1;
+
+		mock_sd.fail_async = !(seed % 13);
+		mock_sd.fail_start = !(seed % 17);
+
+		if (write)
+		{
+			_fill(dma_buf, num * 512, seed);
+			memcpy(ref_buf + sector * 512, dma_buf, num * 512);
+			ok &= sdmmc_storage_write_async(&sd_storage, sector, num, dma_buf) == 1;
+		}
+		else
+			ok &= sdmmc_storage_read_async(&sd_storage, sector, num, dma_buf) == 1;
+
+		while (sdmmc_storage_async_poll(&sd_storage) == SDMMC_ASYNC_BUSY)
+			;
+		ok &= sdmmc_storage_async_wait(&sd_storage) == 1;
+		ok &= !memcmp(dma_buf, ref_buf + sector * 512, num * 512);
+	}
+	ok &= !memcmp(mock_sd.disk, ref_buf, TEST_SECTORS * 8 * 512);
+
+	return _check("random requests", ok);
+}
+
+int main()
+{
+	mock_init(MOCK_DISK_SECTORS);
+
+	int ok = _read_background() &
+			 _write_background() &
+			 _one_per_storage() &
+			 _both_controllers() &
+			 _non_dma_buffer() &
+			 _large_request() &
+			 _xfer_error() &
+			 _hard_error() &
+			 _byte_access() &
+			 _random_requests();
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+
+	return !ok;
+}
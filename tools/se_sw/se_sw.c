@@ -0,0 +1,344 @@
+/*
+ * Software AES-128 and SHA256, checked against the Security Engine known answers.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "se_sw.h"
+
+// No hardware dependencies. This file must also build for the host.
+
+#define ROR32(x, s)  (((x) >> (s)) | ((x) << (32 - (s))))
+
+// Rotate each byte of a word left.
+#define ROTL8X4(w, s) ((((w) << (s)) & (0x01010101u * (u8)(0xFF << (s)))) | (((w) >> (8 - (s))) & (0x01010101u * (0xFF >> (8 - (s))))))
+
+// Multiply all 4 bytes of a column by x in GF(2^8).
+#define AES_XTIME4(w) ((((w) & 0x7F7F7F7F) << 1) ^ ((((w) >> 7) & 0x01010101) * 0x1B))
+
+static const u32 _sha256_k[64] = {
+	0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5,
+	0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+	0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
+	0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+	0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC,
+	0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+	0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7,
+	0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+	0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13,
+	0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+	0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3,
+	0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+	0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5,
+	0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+	0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208,
+	0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+};
+
+static const u32 _sha256_iv[8] = {
+	0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
+};
+
+static u32 _load_le32(const u8 *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((u32)p[3] << 24);
+}
+
+static void _store_le32(u8 *p, u32 v)
+{
+	p[0] = v;
+	p[1] = v >> 8;
+	p[2] = v >> 16;
+	p[3] = v >> 24;
+}
+
+static u32 _load_be32(const u8 *p)
+{
+	return ((u32)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+static void _store_be32(u8 *p, u32 v)
+{
+	p[0] = v >> 24;
+	p[1] = v >> 16;
+	p[2] = v >> 8;
+	p[3] = v;
+}
+
+// Multiply 4 packed GF(2^8) elements with 4 others.
+static u32 _aes_gf_mul4(u32 a, u32 b)
+{
+	u32 r = 0;
+
+	for (u32 i = 0; i < 8; i++)
+	{
+		r ^= a & (((b >> i) & 0x01010101) * 0xFF);
+		a = AES_XTIME4(a);
+	}
+
+	return r;
+}
+
+// Invert 4 packed GF(2^8) elements as x^254. Zero maps to zero.
+static u32 _aes_gf_inv4(u32 x)
+{
+	u32 x2   = _aes_gf_mul4(x, x);
+	u32 x3   = _aes_gf_mul4(x2, x);
+	u32 x12  = _aes_gf_mul4(x3, x3);
+	x12      = _aes_gf_mul4(x12, x12);
+	u32 x15  = _aes_gf_mul4(x12, x3);
+	u32 x240 = _aes_gf_mul4(x15, x15);
+	x240     = _aes_gf_mul4(x240, x240);
+	x240     = _aes_gf_mul4(x240, x240);
+	x240     = _aes_gf_mul4(x240, x240);
+
+	return _aes_gf_mul4(_aes_gf_mul4(x240, x12), x2);
+}
+
+// S-box of 4 bytes. Computed without tables, so timing does not depend on data.
+static u32 _aes_sub_word(u32 w)
+{
+	u32 q = _aes_gf_inv4(w);
+
+	return q ^ ROTL8X4(q, 1) ^ ROTL8X4(q, 2) ^ ROTL8X4(q, 3) ^ ROTL8X4(q, 4) ^ 0x63636363;
+}
+
+static u32 _aes_inv_sub_word(u32 w)
+{
+	return _aes_gf_inv4(ROTL8X4(w, 1) ^ ROTL8X4(w, 3) ^ ROTL8X4(w, 6) ^ 0x05050505);
+}
+
+static u32 _aes_mix_column(u32 w)
+{
+	u32 w8 = ROR32(w, 8);
+
+	return AES_XTIME4(w ^ w8) ^ w8 ^ ROR32(w, 16) ^ ROR32(w, 24);
+}
+
+static u32 _aes_inv_mix_column(u32 w)
+{
+	// Pre-multiply so that a regular mix column produces the inverse.
+	u32 x = AES_XTIME4(w ^ ROR32(w, 16));
+
+	return _aes_mix_column(w ^ AES_XTIME4(x));
+}
+
+void se_sw_aes_key_set(se_sw_aes_ctx_t *ctx, const void *key)
+{
+	const u8 *pkey = (const u8 *)key;
+	u32 rcon = 1;
+
+	for (u32 i = 0; i < 4; i++)
+		ctx->rk[i] = _load_le32(pkey + i * 4);
+
+	for (u32 i = 4; i < (SE_SW_AES_ROUNDS + 1) * 4; i++)
+	{
+		u32 t = ctx->rk[i - 1];
+		if (!(i % 4))
+		{
+			t = _aes_sub_word(ROR32(t, 8)) ^ rcon;
+			rcon = ((rcon << 1) ^ ((rcon & 0x80) ? 0x1B : 0)) & 0xFF;
+		}
+		ctx->rk[i] = ctx->rk[i - 4] ^ t;
+	}
+}
+
+static void _se_sw_aes_encrypt(const se_sw_aes_ctx_t *ctx, u32 *s)
+{
+	u32 t[4];
+	const u32 *rk = ctx->rk;
+
+	for (u32 c = 0; c < 4; c++)
+		s[c] ^= rk[c];
+
+	for (u32 round = 1; round <= SE_SW_AES_ROUNDS; round++)
+	{
+		// Shift rows and sub bytes.
+		for (u32 c = 0; c < 4; c++)
+		{
+			t[c] = _aes_sub_word((s[c] & 0xFF) | (s[(c + 1) & 3] & 0xFF00) |
+				(s[(c + 2) & 3] & 0xFF0000) | (s[(c + 3) & 3] & 0xFF000000));
+		}
+
+		// Mix columns and add round key.
+		rk += 4;
+		for (u32 c = 0; c < 4; c++)
+			s[c] = (round != SE_SW_AES_ROUNDS ? _aes_mix_column(t[c]) : t[c]) ^ rk[c];
+	}
+}
+
+static void _se_sw_aes_decrypt(const se_sw_aes_ctx_t *ctx, u32 *s)
+{
+	u32 t[4];
+	const u32 *rk = &ctx->rk[SE_SW_AES_ROUNDS * 4];
+
+	for (u32 c = 0; c < 4; c++)
+		s[c] ^= rk[c];
+
+	for (u32 round = SE_SW_AES_ROUNDS; round > 0; round--)
+	{
+		// Inverse shift rows and sub bytes.
+		for (u32 c = 0; c < 4; c++)
+		{
+			t[c] = _aes_inv_sub_word((s[c] & 0xFF) | (s[(c + 3) & 3] & 0xFF00) |
+				(s[(c + 2) & 3] & 0xFF0000) | (s[(c + 1) & 3] & 0xFF000000));
+		}
+
+		// Add round key and inverse mix columns.
+		rk -= 4;
+		for (u32 c = 0; c < 4; c++)
+			s[c] = round != 1 ? _aes_inv_mix_column(t[c] ^ rk[c]) : (t[c] ^ rk[c]);
+	}
+}
+
+void se_sw_aes_crypt_block(const se_sw_aes_ctx_t *ctx, u32 enc, void *dst, const void *src)
+{
+	u32 s[4];
+	const u8 *psrc = (const u8 *)src;
+	u8 *pdst = (u8 *)dst;
+
+	for (u32 c = 0; c < 4; c++)
+		s[c] = _load_le32(psrc + c * 4);
+
+	if (enc)
+		_se_sw_aes_encrypt(ctx, s);
+	else
+		_se_sw_aes_decrypt(ctx, s);
+
+	for (u32 c = 0; c < 4; c++)
+		_store_le32(pdst + c * 4, s[c]);
+}
+
+void se_sw_aes_crypt_ecb(const se_sw_aes_ctx_t *ctx, u32 enc, void *dst, const void *src, u32 size)
+{
+	const u8 *psrc = (const u8 *)src;
+	u8 *pdst = (u8 *)dst;
+
+	for (u32 i = 0; i < (size >> 4); i++)
+		se_sw_aes_crypt_block(ctx, enc, pdst + i * 16, psrc + i * 16);
+}
+
+void se_sw_aes_crypt_ctr(const se_sw_aes_ctx_t *ctx, void *dst, const void *src, u32 size, const void *ctr)
+{
+	u8 counter[16];
+	u8 keystream[16];
+	const u8 *psrc = (const u8 *)src;
+	u8 *pdst = (u8 *)dst;
+
+	memcpy(counter, ctr, 16);
+
+	while (size)
+	{
+		u32 block_size = size < 16 ? size : 16;
+
+		se_sw_aes_crypt_block(ctx, 1, keystream, counter);
+		for (u32 i = 0; i < block_size; i++)
+			pdst[i] = psrc[i] ^ keystream[i];
+
+		// Increment big endian counter.
+		for (int i = 0xF; i >= 0; i--)
+			if (++counter[i])
+				break;
+
+		size -= block_size;
+		psrc += block_size;
+		pdst += block_size;
+	}
+}
+
+void se_sw_sha256_init(u32 *state)
+{
+	memcpy(state, _sha256_iv, sizeof(_sha256_iv));
+}
+
+void se_sw_sha256_load(u32 *state, const void *hash)
+{
+	for (u32 i = 0; i < 8; i++)
+		state[i] = _load_be32((const u8 *)hash + i * 4);
+}
+
+void se_sw_sha256_store(void *hash, const u32 *state)
+{
+	for (u32 i = 0; i < 8; i++)
+		_store_be32((u8 *)hash + i * 4, state[i]);
+}
+
+void se_sw_sha256_blocks(u32 *state, const void *src, u32 num_blocks)
+{
+	u32 w[64];
+	const u8 *psrc = (const u8 *)src;
+
+	while (num_blocks--)
+	{
+		for (u32 i = 0; i < 16; i++)
+			w[i] = _load_be32(psrc + i * 4);
+
+		for (u32 i = 16; i < 64; i++)
+		{
+			u32 s0 = ROR32(w[i - 15], 7) ^ ROR32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+			u32 s1 = ROR32(w[i - 2], 17) ^ ROR32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+			w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+		}
+
+		u32 a = state[0], b = state[1], c = state[2], d = state[3];
+		u32 e = state[4], f = state[5], g = state[6], h = state[7];
+
+		for (u32 i = 0; i < 64; i++)
+		{
+			u32 t1 = h + (ROR32(e, 6) ^ ROR32(e, 11) ^ ROR32(e, 25)) + ((e & f) ^ (~e & g)) + _sha256_k[i] + w[i];
+			u32 t2 = (ROR32(a, 2) ^ ROR32(a, 13) ^ ROR32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+			h = g;
+			g = f;
+			f = e;
+			e = d + t1;
+			d = c;
+			c = b;
+			b = a;
+			a = t1 + t2;
+		}
+
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
+		state[5] += f;
+		state[6] += g;
+		state[7] += h;
+
+		psrc += SE_SW_SHA256_BLOCK;
+	}
+}
+
+void se_sw_sha256_finish(u32 *state, const void *src, u32 size, u64 total_size)
+{
+	u8 block[SE_SW_SHA256_BLOCK * 2];
+	u32 full_blocks = size / SE_SW_SHA256_BLOCK;
+	u32 rem = size % SE_SW_SHA256_BLOCK;
+
+	se_sw_sha256_blocks(state, src, full_blocks);
+
+	// Pad remainder and append message length in bits.
+	memset(block, 0, sizeof(block));
+	memcpy(block, (const u8 *)src + full_blocks * SE_SW_SHA256_BLOCK, rem);
+	block[rem] = 0x80;
+
+	u32 pad_blocks = rem < (SE_SW_SHA256_BLOCK - 8) ? 1 : 2;
+	u8 *plen = block + pad_blocks * SE_SW_SHA256_BLOCK - 8;
+	_store_be32(plen, (u32)(total_size >> 29));
+	_store_be32(plen + 4, (u32)(total_size << 3));
+
+	se_sw_sha256_blocks(state, block, pad_blocks);
+}
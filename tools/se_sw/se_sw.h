@@ -0,0 +1,42 @@
+/*
+ * Software AES-128 and SHA256, checked against the Security Engine known answers.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SE_SW_H_
+#define _SE_SW_H_
+
+#include <utils/types.h>
+
+#define SE_SW_AES_ROUNDS     10
+#define SE_SW_SHA256_BLOCK   64
+
+// Expanded AES-128 key. Round keys are stored as 4 columns of 32-bit words.
+typedef struct _se_sw_aes_ctx_t
+{
+	u32 rk[(SE_SW_AES_ROUNDS + 1) * 4];
+} se_sw_aes_ctx_t;
+
+void se_sw_aes_key_set(se_sw_aes_ctx_t *ctx, const void *key);
+void se_sw_aes_crypt_block(const se_sw_aes_ctx_t *ctx, u32 enc, void *dst, const void *src);
+void se_sw_aes_crypt_ecb(const se_sw_aes_ctx_t *ctx, u32 enc, void *dst, const void *src, u32 size);
+void se_sw_aes_crypt_ctr(const se_sw_aes_ctx_t *ctx, void *dst, const void *src, u32 size, const void *ctr);
+
+void se_sw_sha256_init(u32 *state);
+void se_sw_sha256_load(u32 *state, const void *hash);
+void se_sw_sha256_store(void *hash, const u32 *state);
+void se_sw_sha256_blocks(u32 *state, const void *src, u32 num_blocks);
+void se_sw_sha256_finish(u32 *state, const void *src, u32 size, u64 total_size);
+
+#endif
@@ -0,0 +1,216 @@
+/*
+ * Host known-answer tests and benchmark for the software SE backend.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "se_sw.h"
+
+#define BENCH_SIZE (16 * 1024 * 1024)
+
+typedef struct _aes_kat_t
+{
+	const char *name;
+	const char *key;
+	const char *pt;
+	const char *ct;
+	const char *ctr; // NULL for ECB.
+} aes_kat_t;
+
+typedef struct _sha_kat_t
+{
+	const char *name;
+	const char *msg;
+	u32 repeat;
+	const char *hash;
+} sha_kat_t;
+
+static const aes_kat_t aes_kats[] = {
+	{ "FIPS-197 C.1",
+		"000102030405060708090a0b0c0d0e0f",
+		"00112233445566778899aabbccddeeff",
+		"69c4e0d86a7b0430d8cdb78070b4c55a", NULL },
+	{ "SP800-38A F.1.1 ECB",
+		"2b7e151628aed2a6abf7158809cf4f3c",
+		"6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+		"30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710",
+		"3ad77bb40d7a3660a89ecaf32466ef97f5d3d58503b9699de785895a96fdbaaf"
+		"43b1cd7f598ece23881b00e3ed0306887b0c785e27e8ad3f8223207104725dd4", NULL },
+	{ "SP800-38A F.5.1 CTR",
+		"2b7e151628aed2a6abf7158809cf4f3c",
+		"6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+		"30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710",
+		"874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff"
+		"5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe03d1792170a0f3009cee",
+		"f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff" },
+};
+
+static const sha_kat_t sha_kats[] = {
+	{ "empty", "", 1,
+		"e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+	{ "abc", "abc", 1,
+		"ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+	{ "448 bit", "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1,
+		"248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" },
+	{ "1M 'a'", "a", 1000000,
+		"cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" },
+};
+
+static u32 _unhex(u8 *out, const char *hex)
+{
+	u32 len = strlen(hex) / 2;
+
+	for (u32 i = 0; i < len; i++)
+		sscanf(hex + i * 2, "%2hhx", &out[i]);
+
+	return len;
+}
+
+static int _check(const char *name, const void *res, const void *exp, u32 size)
+{
+	int ok = !memcmp(res, exp, size);
+
+	printf("%-5s %s\n", ok ? "ok" : "FAIL", name);
+
+	return ok ? 0 : 1;
+}
+
+static int _test_aes(const aes_kat_t *kat)
+{
+	u8 key[16], ctr[16];
+	u8 pt[64], ct[64], out[64];
+	se_sw_aes_ctx_t ctx;
+	int err = 0;
+
+	_unhex(key, kat->key);
+	u32 size = _unhex(pt, kat->pt);
+	_unhex(ct, kat->ct);
+	se_sw_aes_key_set(&ctx, key);
+
+	if (kat->ctr)
+	{
+		_unhex(ctr, kat->ctr);
+		se_sw_aes_crypt_ctr(&ctx, out, pt, size, ctr);
+		err |= _check(kat->name, out, ct, size);
+
+		// Odd sizes must keep the keystream position.
+		se_sw_aes_crypt_ctr(&ctx, out, pt, size - 5, ctr);
+		err |= _check("CTR partial block", out, ct, size - 5);
+
+		return err;
+	}
+
+	se_sw_aes_crypt_ecb(&ctx, 1, out, pt, size);
+	err |= _check(kat->name, out, ct, size);
+
+	se_sw_aes_crypt_ecb(&ctx, 0, out, ct, size);
+	err |= _check("  decrypt", out, pt, size);
+
+	return err;
+}
+
+static int _test_sha(const sha_kat_t *kat)
+{
+	u8 hash[32], exp[32];
+	u32 state[8];
+	u32 msg_len = strlen(kat->msg);
+	u32 size = msg_len * kat->repeat;
+	u8 *msg = malloc(size + 1);
+
+	for (u32 i = 0; i < kat->repeat; i++)
+		memcpy(msg + i * msg_len, kat->msg, msg_len);
+	_unhex(exp, kat->hash);
+
+	se_sw_sha256_init(state);
+	se_sw_sha256_finish(state, msg, size, size);
+	se_sw_sha256_store(hash, state);
+	int err = _check(kat->name, hash, exp, sizeof(hash));
+
+	// Chunked with an intermediate hash, like se_calc_sha256 with SHA_CONTINUE.
+	if (size >= 128)
+	{
+		u32 chunk = (size / 2) & ~(SE_SW_SHA256_BLOCK - 1);
+
+		se_sw_sha256_init(state);
+		se_sw_sha256_blocks(state, msg, chunk / SE_SW_SHA256_BLOCK);
+		se_sw_sha256_store(hash, state);
+		se_sw_sha256_load(state, hash);
+		se_sw_sha256_finish(state, msg + chunk, size - chunk, size);
+		se_sw_sha256_store(hash, state);
+		err |= _check("  chunked", hash, exp, sizeof(hash));
+	}
+
+	free(msg);
+
+	return err;
+}
+
+static double _now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void _bench()
+{
+	u8 key[16] = { 0 };
+	u8 ctr[16] = { 0 };
+	u32 state[8];
+	se_sw_aes_ctx_t ctx;
+	u8 *buf = malloc(BENCH_SIZE);
+
+	memset(buf, 0xA5, BENCH_SIZE);
+	se_sw_aes_key_set(&ctx, key);
+
+	double t = _now();
+	se_sw_aes_crypt_ecb(&ctx, 1, buf, buf, BENCH_SIZE);
+	printf("AES-128 ECB enc: %7.2f MB/s\n", BENCH_SIZE / (_now() - t) / 1e6);
+
+	t = _now();
+	se_sw_aes_crypt_ecb(&ctx, 0, buf, buf, BENCH_SIZE);
+	printf("AES-128 ECB dec: %7.2f MB/s\n", BENCH_SIZE / (_now() - t) / 1e6);
+
+	t = _now();
+	se_sw_aes_crypt_ctr(&ctx, buf, buf, BENCH_SIZE, ctr);
+	printf("AES-128 CTR:     %7.2f MB/s\n", BENCH_SIZE / (_now() - t) / 1e6);
+
+	t = _now();
+	se_sw_sha256_init(state);
+	se_sw_sha256_finish(state, buf, BENCH_SIZE, BENCH_SIZE);
+	printf("SHA256:          %7.2f MB/s\n", BENCH_SIZE / (_now() - t) / 1e6);
+
+	free(buf);
+}
+
+int main(int argc, char **argv)
+{
+	int err = 0;
+
+	for (u32 i = 0; i < sizeof(aes_kats) / sizeof(aes_kats[0]); i++)
+		err |= _test_aes(&aes_kats[i]);
+
+	for (u32 i = 0; i < sizeof(sha_kats) / sizeof(sha_kats[0]); i++)
+		err |= _test_sha(&sha_kats[i]);
+
+	if (argc > 1 && !strcmp(argv[1], "bench"))
+		_bench();
+
+	return err;
+}
@@ -0,0 +1,21 @@
+/*
+ * Host memory map. UMS buffers live in test buffers.
+ */
+
+#ifndef _TEST_MEMORY_MAP_H_
+#define _TEST_MEMORY_MAP_H_
+
+#include "../../bdk/memory_map.h"
+
+extern unsigned char sdxc_mem[];
+extern unsigned char ep_in_mem[];
+extern unsigned char ep_out_mem[];
+
+#undef SDXC_BUF_ALIGNED
+#undef USB_EP_BULK_IN_BUF_ADDR
+#undef USB_EP_BULK_OUT_BUF_ADDR
+#define SDXC_BUF_ALIGNED         (sdxc_mem)
+#define USB_EP_BULK_IN_BUF_ADDR  (ep_in_mem)
+#define USB_EP_BULK_OUT_BUF_ADDR (ep_out_mem)
+
+#endif
@@ -0,0 +1,13 @@
+/*
+ * Nyx gfx pulls in the whole bdk. Only the parts UMS uses are included here.
+ */
+
+#ifndef _UMS_GFX_H_
+#define _UMS_GFX_H_
+
+#include <mem/minerva.h>
+#include <storage/emmc.h>
+
+#include "test_gfx.h"
+
+#endif
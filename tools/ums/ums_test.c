@@ -0,0 +1,636 @@
+/*
+ * Host test for the UMS gadget read ring and write cache.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The gadget is included as is, so its static SCSI handlers can be driven directly.
+ * SD card is a flat buffer that can be told to fail reads or writes. Background card reads
+ * and USB IN transfers stay busy for a few random polls and move data only when reaped,
+ * so a buffer reused too early shows up as wrong data on the host side.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../bdk/usb/usb_gadget_ums.c"
+
+#define DISK_SECTORS (SZ_64M >> UMS_DISK_LBA_SHIFT)
+#define AU_KB        4096
+
+unsigned char sdxc_mem[SZ_16M + SZ_8M];
+unsigned char ep_in_mem[SZ_8M];
+unsigned char ep_out_mem[SZ_8M];
+
+sdmmc_t sd_sdmmc, emmc_sdmmc;
+sdmmc_storage_t sd_storage, emmc_storage;
+
+static u8 *disk;  // Card contents.
+static u8 *model; // What the host wrote.
+static u8 *host;  // What the host received.
+static u32 host_len;
+static u32 now = 0;
+static bool fail_writes = false;
+static u32 fail_read_sector = -1;
+static u32 overlaps; // Card polls while a USB transfer was running.
+static u32 partition_switches;
+static bool fail_partition_switch = false;
+static u32 rng = 0x13579BDF;
+static usbd_gadget_ums_t ums;
+static char label[128];
+
+static u32 _rand()
+{
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+
+	return rng;
+}
+
+u32 get_tmr_ms()
+{
+	return now;
+}
+
+static struct
+{
+	bool pending;
+	u32 sector;
+	u32 num_sectors;
+	void *buf;
+	u32 busy_polls;
+} card;
+
+static struct
+{
+	bool active;
+	u8  *buf;
+	u32 len;
+	u32 busy_polls;
+} ep_in;
+
+int sdmmc_storage_read(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf)
+{
+	if (sector + num_sectors > DISK_SECTORS)
+		return 0;
+
+	if (fail_read_sector >= sector && fail_read_sector < sector + num_sectors)
+		return 0;
+
+	memcpy(buf, disk + ((u64)sector << UMS_DISK_LBA_SHIFT), num_sectors << UMS_DISK_LBA_SHIFT);
+
+	return 1;
+}
+
+int sdmmc_storage_write(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf)
+{
+	if (fail_writes || sector + num_sectors > DISK_SECTORS)
+		return 0;
+
+	memcpy(disk + ((u64)sector << UMS_DISK_LBA_SHIFT), buf, num_sectors << UMS_DISK_LBA_SHIFT);
+
+	return 1;
+}
+
+int sdmmc_storage_read_async(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf)
+{
+	if (card.pending)
+		return 0;
+
+	card.pending = true;
+	card.sector = sector;
+	card.num_sectors = num_sectors;
+	card.buf = buf;
+	card.busy_polls = _rand() % 4;
+
+	return 1;
+}
+
+u32 sdmmc_storage_async_poll(sdmmc_storage_t *storage)
+{
+	if (!card.pending)
+		return SDMMC_ASYNC_IDLE;
+
+	if (ep_in.active)
+		overlaps++;
+
+	if (card.busy_polls)
+	{
+		card.busy_polls--;
+		return SDMMC_ASYNC_BUSY;
+	}
+
+	return SDMMC_ASYNC_DONE;
+}
+
+int sdmmc_storage_async_wait(sdmmc_storage_t *storage)
+{
+	if (!card.pending)
+		return 0;
+
+	card.pending = false;
+
+	return sdmmc_storage_read(storage, card.sector, card.num_sectors, card.buf);
+}
+
+static int _ep1_in_write(u8 *buf, u32 len, u32 *actual, u32 sync_timeout)
+{
+	if (ep_in.active || sync_timeout != USB_XFER_START)
+		return USB_ERROR_XFER_ERROR;
+
+	ep_in.active = true;
+	ep_in.buf = buf;
+	ep_in.len = len;
+	ep_in.busy_polls = _rand() % 4;
+
+	return USB_RES_OK;
+}
+
+static bool _ep1_in_writing_busy()
+{
+	if (ep_in.busy_polls)
+	{
+		ep_in.busy_polls--;
+		return true;
+	}
+
+	return false;
+}
+
+static int _ep1_in_writing_finish(u32 *actual, u32 sync_timeout)
+{
+	if (!ep_in.active)
+		return USB_ERROR_XFER_ERROR;
+
+	// Data leaves the buffer only now.
+	memcpy(host + host_len, ep_in.buf, ep_in.len);
+	host_len += ep_in.len;
+	*actual = ep_in.len;
+	ep_in.active = false;
+
+	return USB_RES_OK;
+}
+
+u32 sd_storage_get_ssr_au(sdmmc_storage_t *storage)
+{
+	return AU_KB;
+}
+
+// Not reached by the tested paths.
+void gfx_printf(const char *fmt, ...) {}
+void msleep(u32 ms) {}
+u8   btn_read_vol() { return 0; }
+u32  hw_get_chip_id() { return 0; }
+bool emmc_initialize(bool power_cycle) { return false; }
+bool sd_mount() { return false; }
+void sd_unmount() {}
+void sd_end() {}
+int  sdmmc_storage_end(sdmmc_storage_t *storage) { return 0; }
+void minerva_periodic_training() {}
+void usb_device_get_ops(usb_ops_t *ops) {}
+void xusb_device_get_ops(usb_ops_t *ops) {}
+
+int sdmmc_storage_set_mmc_partition(sdmmc_storage_t *storage, u32 partition)
+{
+	if (fail_partition_switch)
+		return 0;
+
+	storage->partition = partition;
+	partition_switches++;
+
+	return 1;
+}
+
+static void _set_text(void *lbl, const char *text)
+{
+	strncpy(label, text, sizeof(label) - 1);
+}
+
+static void _ums_test_init()
+{
+	memset(&ums, 0, sizeof(ums));
+	memset(disk, 0, (u64)DISK_SECTORS << UMS_DISK_LBA_SHIFT);
+	memset(model, 0, (u64)DISK_SECTORS << UMS_DISK_LBA_SHIFT);
+	memset(&card, 0, sizeof(card));
+	memset(&ep_in, 0, sizeof(ep_in));
+	label[0] = 0;
+	fail_writes = false;
+	fail_read_sector = -1;
+	host_len = 0;
+	overlaps = 0;
+	partition_switches = 0;
+	fail_partition_switch = false;
+	emmc_storage.partition = 0;
+
+	usb_ops.usb_device_ep1_in_write = _ep1_in_write;
+	usb_ops.usb_device_ep1_in_writing_busy = _ep1_in_writing_busy;
+	usb_ops.usb_device_ep1_in_writing_finish = _ep1_in_writing_finish;
+
+	ums.lun_cnt = 1;
+	ums.lun = &ums.luns[0];
+	ums.lun->type = MMC_SD;
+	ums.lun->storage = &sd_storage;
+	ums.lun->num_sectors = DISK_SECTORS;
+	ums.lun->write_cache = 1;
+	ums.set_text = _set_text;
+	ums.bulk_ctxt.bulk_in_buf = ep_in_mem;
+
+	_ums_wcache_init(&ums);
+}
+
+static bool _host_write(u32 lba, u32 count, bool fua)
+{
+	u8 *buf = ep_out_mem;
+
+	for (u32 i = 0; i < count << UMS_DISK_LBA_SHIFT; i++)
+		buf[i] = _rand();
+
+	if (!_ums_wcache_write(&ums, lba, count, buf, fua))
+		return false;
+
+	memcpy(model + ((u64)lba << UMS_DISK_LBA_SHIFT), buf, count << UMS_DISK_LBA_SHIFT);
+
+	return true;
+}
+
+// Runs READ(10) and collects what the host gets, including the last buffer sent with the reply.
+static int _host_read(u32 lba, u32 count)
+{
+	ums.cmnd[0] = SC_READ_10;
+	memset(&ums.cmnd[1], 0, SCSI_MAX_CMD_SZ - 1);
+	put_array_le_to_be32(lba, &ums.cmnd[2]);
+	ums.data_size_from_cmnd = count << UMS_DISK_LBA_SHIFT;
+	ums.residue = ums.data_size_from_cmnd;
+	ums.lun->sense_data = SS_NO_SENSE;
+	host_len = 0;
+
+	int res = _scsi_read(&ums, &ums.bulk_ctxt);
+	if (res != UMS_RES_IO_ERROR || ep_in.active || card.pending)
+		return 0;
+
+	memcpy(host + host_len, ums.bulk_ctxt.bulk_in_buf, ums.bulk_ctxt.bulk_in_length);
+	host_len += ums.bulk_ctxt.bulk_in_length;
+
+	return 1;
+}
+
+static bool _host_matches(u32 lba, u32 count)
+{
+	return host_len == count << UMS_DISK_LBA_SHIFT &&
+		!memcmp(host, model + ((u64)lba << UMS_DISK_LBA_SHIFT), count << UMS_DISK_LBA_SHIFT);
+}
+
+static bool _disk_matches(u32 lba, u32 count)
+{
+	return !memcmp(disk + ((u64)lba << UMS_DISK_LBA_SHIFT), model + ((u64)lba << UMS_DISK_LBA_SHIFT), count << UMS_DISK_LBA_SHIFT);
+}
+
+// Runs the checks every command goes through first. Returns the reply and sense.
+static int _host_cmd(u8 opcode, u32 *sense)
+{
+	ums.cmnd[0] = opcode;
+	memset(&ums.cmnd[1], 0, SCSI_MAX_CMD_SZ - 1);
+	ums.cmnd_size = 6;
+	ums.data_dir = DATA_DIR_NONE;
+	ums.data_size = 0;
+	ums.data_size_from_cmnd = 0;
+
+	int res = _ums_check_scsi_cmd(&ums, 6, DATA_DIR_NONE, 0, 1);
+	*sense = ums.lun->sense_data;
+
+	return res;
+}
+
+// SD GPP, eMMC GPP and eMMC BOOT0 in one session. eMMC luns take the upper half of the card model.
+static void _ums_test_init_luns()
+{
+	_ums_test_init();
+
+	ums.lun_cnt = 3;
+	ums.luns[1].type = MMC_EMMC;
+	ums.luns[1].partition = EMMC_GPP + 1;
+	ums.luns[1].storage = &emmc_storage;
+	ums.luns[1].offset = DISK_SECTORS / 2;
+	ums.luns[1].num_sectors = DISK_SECTORS / 4;
+	ums.luns[1].write_cache = 1;
+	ums.luns[2] = ums.luns[1];
+	ums.luns[2].partition = EMMC_BOOT0 + 1;
+	ums.luns[2].offset = DISK_SECTORS / 2 + DISK_SECTORS / 4;
+	ums.luns[0].num_sectors = DISK_SECTORS / 2;
+	for (u32 i = 0; i < ums.lun_cnt; i++)
+		ums.luns[i].removable = 1;
+
+	_ums_wcache_init(&ums);
+	ums.bulk_ctxt.bulk_out_buf = ep_out_mem;
+}
+
+// Receives a CBW for a lun and runs the checks every command goes through first.
+static int _host_cbw(u8 lun, u8 opcode, u32 *sense)
+{
+	bulk_recv_pkt_t *cbw = (bulk_recv_pkt_t *)ums.bulk_ctxt.bulk_out_buf;
+
+	memset(cbw, 0, sizeof(bulk_recv_pkt_t));
+	cbw->Signature = USB_BULK_CB_SIG;
+	cbw->Lun = lun;
+	cbw->Length = 6;
+	cbw->CDB[0] = opcode;
+	ums.bulk_ctxt.bulk_out_length_actual = USB_BULK_CB_WRAP_LEN;
+
+	int res = received_cbw(&ums, &ums.bulk_ctxt);
+	if (res)
+		return res;
+
+	ums.data_size_from_cmnd = 0;
+	res = _ums_check_scsi_cmd(&ums, 6, DATA_DIR_NONE, 0, 1);
+	*sense = ums.lun->sense_data;
+
+	return res;
+}
+
+static int _check(const char *name, bool ok)
+{
+	printf("  %-30s %s\n", name, ok ? "OK" : "FAIL");
+
+	return ok;
+}
+
+// A failed idle flush keeps its data and fails the next command once.
+static int _deferred_error()
+{
+	u32 sense;
+	bool ok = true;
+
+	_ums_test_init();
+
+	ok &= _host_write(100, 8, false);
+	ok &= !_disk_matches(100, 8);
+
+	fail_writes = true;
+	now += UMS_WCACHE_IDLE_MS;
+	_ums_wcache_idle_flush(&ums);
+	ok &= ums.wcache.end != 0 && !strncmp(label, "#FFDD00 Error:#", 15);
+
+	ok &= _host_cmd(SC_TEST_UNIT_READY, &sense) == UMS_RES_INVALID_ARG && sense == SS_WRITE_ERROR;
+	ok &= _host_cmd(SC_TEST_UNIT_READY, &sense) == UMS_RES_OK && sense == SS_NO_SENSE;
+
+	// Retried only after another idle period.
+	fail_writes = false;
+	_ums_wcache_idle_flush(&ums);
+	ok &= ums.wcache.end != 0;
+	now += UMS_WCACHE_IDLE_MS;
+	_ums_wcache_idle_flush(&ums);
+	ok &= !ums.wcache.end && _disk_matches(100, 8);
+
+	return _check("deferred write error", ok);
+}
+
+// VERIFY reads the card, so cached writes in its range must reach it first.
+static int _verify_flush()
+{
+	bool ok = true;
+
+	_ums_test_init();
+
+	ok &= _host_write(5000, 64, false);
+	ok &= !_disk_matches(5000, 64);
+
+	ums.cmnd[0] = SC_VERIFY;
+	memset(&ums.cmnd[1], 0, SCSI_MAX_CMD_SZ - 1);
+	put_array_le_to_be32(5010, &ums.cmnd[2]);
+	put_array_le_to_be16(4, &ums.cmnd[7]);
+	ok &= _scsi_verify(&ums, &ums.bulk_ctxt) == UMS_RES_OK && ums.lun->sense_data == SS_NO_SENSE;
+	ok &= !ums.wcache.end && _disk_matches(5000, 64);
+
+	// Failed flush is reported and data stays cached.
+	ok &= _host_write(9000, 8, false);
+	fail_writes = true;
+	put_array_le_to_be32(9000, &ums.cmnd[2]);
+	ok &= _scsi_verify(&ums, &ums.bulk_ctxt) == UMS_RES_INVALID_ARG && ums.lun->sense_data == SS_WRITE_ERROR;
+	ok &= ums.wcache.end != 0;
+
+	fail_writes = false;
+	ok &= _ums_wcache_flush(&ums) && _disk_matches(9000, 8);
+
+	return _check("verify flushes cached range", ok);
+}
+
+// Random writes, some FUA, over a few AUs. Card must match the host after the final flush.
+static int _random_writes()
+{
+	bool ok = true;
+
+	_ums_test_init();
+
+	for (u32 i = 0; i < 20000 && ok; i++)
+	{
+		u32 count = 1 + _rand() % 256;
+		u32 lba = _rand() % (AU_KB * 2 * 4);
+
+		ok &= _host_write(lba, count, !(_rand() % 16));
+		if (!(_rand() % 64))
+		{
+			now += UMS_WCACHE_IDLE_MS;
+			_ums_wcache_idle_flush(&ums);
+		}
+	}
+
+	ok &= _ums_wcache_flush(&ums) && _disk_matches(0, DISK_SECTORS);
+
+	return _check("random writes", ok);
+}
+
+// Reads of every size through the ring, with the card read running under USB transfers.
+static int _ring_reads()
+{
+	bool ok = true;
+
+	_ums_test_init();
+
+	for (u32 i = 0; i < DISK_SECTORS << UMS_DISK_LBA_SHIFT; i++)
+		disk[i] = model[i] = _rand();
+
+	for (u32 i = 0; i < 2000 && ok; i++)
+	{
+		u32 count = 1 + _rand() % (i % 4 ? 256 : 8192);
+		u32 lba = _rand() % (DISK_SECTORS - count);
+
+		ok &= _host_read(lba, count) && ums.lun->sense_data == SS_NO_SENSE && _host_matches(lba, count);
+	}
+
+	// Ends at the last sector.
+	ok &= _host_read(DISK_SECTORS - 300, 300) && _host_matches(DISK_SECTORS - 300, 300);
+	ok &= overlaps != 0;
+
+	return _check("ring reads", ok);
+}
+
+// A failed card read sends what was read before it and reports where it failed.
+static int _ring_read_error()
+{
+	bool ok = true;
+
+	_ums_test_init();
+
+	for (u32 i = 0; i < DISK_SECTORS << UMS_DISK_LBA_SHIFT; i++)
+		disk[i] = model[i] = _rand();
+
+	// 1MB read in 64KB IOs. Fail the 6th one.
+	fail_read_sector = 1000 + 5 * 128 + 7;
+	ok &= _host_read(1000, 2048);
+	ok &= ums.lun->sense_data == SS_UNRECOVERED_READ_ERROR && ums.lun->sense_data_info == 1000 + 5 * 128;
+	ok &= host_len == 5 * SZ_64K && !memcmp(host, model + (1000 << UMS_DISK_LBA_SHIFT), host_len);
+	ok &= !strncmp(label, "#FFDD00 Error:#", 15);
+
+	return _check("ring read error", ok);
+}
+
+// Reads see cached writes.
+static int _read_after_write()
+{
+	bool ok = true;
+
+	_ums_test_init();
+
+	ok &= _host_write(7000, 40, false);
+	ok &= _host_read(6990, 64) && _host_matches(6990, 64);
+
+	return _check("read after cached write", ok);
+}
+
+// Throughput updates must not hide an error on the label.
+static int _stats_keep_error()
+{
+	bool ok = true;
+
+	_ums_test_init();
+	ums.set_text = _ums_set_text;
+	ums_label_set_text = _set_text;
+
+	ums.set_text(ums.label, "#FFDD00 Error:# SDMMC Read!");
+	ums.stats.read_bytes = SZ_1M;
+	now += UMS_STATS_UPDATE_MS;
+	_ums_update_stats(&ums);
+	ok &= !strcmp(label, "#FFDD00 Error:# SDMMC Read!");
+
+	ums.set_text(ums.label, "#C7EA46 Status:# Started UMS");
+	ums.stats.read_bytes = SZ_1M;
+	now += UMS_STATS_UPDATE_MS;
+	_ums_update_stats(&ums);
+	ok &= !strncmp(label, "#C7EA46 Status:# Read", 21);
+
+	return _check("stats keep error on label", ok);
+}
+
+// Each CBW selects its lun. eMMC luns switch the shared storage to their partition on demand.
+static int _multi_lun()
+{
+	u32 sense;
+	bool ok = true;
+
+	_ums_test_init_luns();
+
+	// Write cache is only kept for the SD lun.
+	ok &= ums.luns[0].write_cache && !ums.luns[1].write_cache && !ums.luns[2].write_cache;
+
+	ok &= _host_cbw(3, SC_TEST_UNIT_READY, &sense) == UMS_RES_INVALID_ARG;
+
+	// Reset unit attention is per lun.
+	for (u32 i = 0; i < ums.lun_cnt; i++)
+		ums.luns[i].unit_attention_data = SS_RESET_OCCURRED;
+	ok &= _host_cbw(1, SC_TEST_UNIT_READY, &sense) == UMS_RES_INVALID_ARG && sense == SS_RESET_OCCURRED;
+	ok &= ums.lun == &ums.luns[1];
+	ok &= _host_cbw(1, SC_TEST_UNIT_READY, &sense) == UMS_RES_OK;
+	ok &= _host_cbw(2, SC_TEST_UNIT_READY, &sense) == UMS_RES_INVALID_ARG && sense == SS_RESET_OCCURRED;
+	ok &= _host_cbw(0, SC_TEST_UNIT_READY, &sense) == UMS_RES_INVALID_ARG && sense == SS_RESET_OCCURRED;
+	ok &= _host_cbw(2, SC_TEST_UNIT_READY, &sense) == UMS_RES_OK && ums.lun == &ums.luns[2];
+
+	// Only switch the eMMC partition when the lun changes it.
+	ok &= emmc_storage.partition == EMMC_BOOT0 && partition_switches == 1;
+	ok &= _host_cbw(2, SC_TEST_UNIT_READY, &sense) == UMS_RES_OK && partition_switches == 1;
+	ok &= _host_cbw(0, SC_TEST_UNIT_READY, &sense) == UMS_RES_OK && partition_switches == 1;
+	ok &= _host_cbw(1, SC_TEST_UNIT_READY, &sense) == UMS_RES_OK;
+	ok &= emmc_storage.partition == EMMC_GPP && partition_switches == 2;
+
+	fail_partition_switch = true;
+	ok &= _host_cbw(2, SC_TEST_UNIT_READY, &sense) == UMS_RES_INVALID_ARG && sense == SS_COMMUNICATION_FAILURE;
+	fail_partition_switch = false;
+
+	// Reads use the lun offset.
+	for (u32 i = 0; i < 3 * SZ_1M; i++)
+		disk[((u64)ums.luns[2].offset << UMS_DISK_LBA_SHIFT) + i] = _rand();
+	memcpy(model, disk + ((u64)ums.luns[2].offset << UMS_DISK_LBA_SHIFT), 3 * SZ_1M);
+	ok &= _host_cbw(2, SC_READ_10, &sense) == UMS_RES_OK;
+	ok &= _host_read(0, (3 * SZ_1M) >> UMS_DISK_LBA_SHIFT) && _host_matches(0, (3 * SZ_1M) >> UMS_DISK_LBA_SHIFT);
+
+	return _check("multiple luns", ok);
+}
+
+// A failed SD cache flush is only reported on the SD lun. Session ends when every lun is ejected.
+static int _multi_lun_eject()
+{
+	u32 sense;
+	bool ok = true;
+
+	_ums_test_init_luns();
+
+	ums.lun = &ums.luns[0];
+	ok &= _host_write(100, 8, false);
+	fail_writes = true;
+	now += UMS_WCACHE_IDLE_MS;
+	_ums_wcache_idle_flush(&ums);
+	fail_writes = false;
+	ok &= _host_cbw(1, SC_TEST_UNIT_READY, &sense) == UMS_RES_OK;
+	ok &= _host_cbw(0, SC_TEST_UNIT_READY, &sense) == UMS_RES_INVALID_ARG && sense == SS_WRITE_ERROR;
+
+	ums.luns[1].prevent_medium_removal = 1;
+	ok &= _ums_luns_removal_prevented(&ums);
+	ums.luns[1].prevent_medium_removal = 0;
+	ok &= !_ums_luns_removal_prevented(&ums);
+
+	ums.luns[0].unmounted = 1;
+	ums.luns[2].unmounted = 1;
+	ok &= !_ums_luns_unmounted(&ums);
+	ok &= _host_cbw(2, SC_TEST_UNIT_READY, &sense) == UMS_RES_INVALID_ARG && sense == SS_MEDIUM_NOT_PRESENT;
+	ok &= _host_cbw(1, SC_TEST_UNIT_READY, &sense) == UMS_RES_OK;
+	ums.luns[1].unmounted = 1;
+	ok &= _ums_luns_unmounted(&ums);
+
+	return _check("multiple luns eject", ok);
+}
+
+int main()
+{
+	disk = malloc((u64)DISK_SECTORS << UMS_DISK_LBA_SHIFT);
+	model = malloc((u64)DISK_SECTORS << UMS_DISK_LBA_SHIFT);
+	host = malloc(SZ_8M);
+
+	int ok = _ring_reads() &
+			 _ring_read_error() &
+			 _read_after_write() &
+			 _stats_keep_error() &
+			 _deferred_error() &
+			 _verify_flush() &
+			 _random_writes() &
+			 _multi_lun() &
+			 _multi_lun_eject();
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+
+	free(host);
+	free(model);
+	free(disk);
+
+	return !ok;
+}